@@ -9,6 +9,16 @@ export type Action =
        * Ignore the command in catter, but still execute the original command.
        */
       type: "skip";
+
+      /**
+       * Capture policy for this command, overrides `options.capture`.
+       */
+      capture?: CatterCaptureMode;
+
+      /**
+       * Tail size in bytes for this command, overrides `options.captureLimit`.
+       */
+      captureLimit?: number;
     }
   | {
       /**
@@ -32,6 +42,30 @@ export type Action =
        * Replacement command data for the modified command.
        */
       data: CommandData;
+
+      /**
+       * Capture policy for this command, overrides `options.capture`.
+       */
+      capture?: CatterCaptureMode;
+
+      /**
+       * Tail size in bytes for this command, overrides `options.captureLimit`.
+       */
+      captureLimit?: number;
+    }
+  | {
+      /**
+       * Create the command's output files as placeholders instead of running it.
+       *
+       * Objects get a minimal valid object file for the host, archives an empty archive and
+       * other outputs an empty file. The command reports exit code 0.
+       */
+      type: "fake";
+
+      /**
+       * Files to create, relative paths resolve against the command's working directory.
+       */
+      outputs: string[];
     };
 
 /**
@@ -39,6 +73,40 @@ export type Action =
  */
 export type ActionType = Action["type"];
 
+/**
+ * What running a process cost.
+ */
+export type ProcessUsage = {
+  /**
+   * Start and end in microseconds of a monotonic clock shared by every process
+   * of the machine.
+   */
+  startUs: number;
+  endUs: number;
+
+  /**
+   * CPU time in user and kernel mode, in microseconds.
+   *
+   * This and the counters below are absent where the platform reports no
+   * rusage (Windows), and when the process that ran the command had another
+   * child running meanwhile, whose usage could not be told apart. They include
+   * the children the process waited for.
+   */
+  userUs?: number;
+  systemUs?: number;
+
+  /**
+   * Peak resident set size in KiB.
+   */
+  maxRssKiB?: number;
+
+  /**
+   * Blocks read from and written to the file system.
+   */
+  readBlocks?: number;
+  writeBlocks?: number;
+};
+
 /**
  * Process result reported for a completed execution.
  */
@@ -57,6 +125,11 @@ export type ProcessResult = {
    * Captured standard error content.
    */
   stderr: string;
+
+  /**
+   * Resource usage, absent when the command was not run, e.g. dropped.
+   */
+  usage?: ProcessUsage;
 };
 
 /**
@@ -91,6 +164,30 @@ export type CatterRuntime = {
  */
 export type CatterStdioMode = "inherit" | "capture";
 
+/**
+ * How much of a command's stdout/stderr is collected for `onExecution`.
+ *
+ * - `"none"`: the command writes to the inherited stdout/stderr directly, nothing is copied
+ *   through catter and `onExecution` receives empty output.
+ * - `"tail"`: output is relayed and its last `captureLimit` bytes are kept.
+ * - `"full"`: output is relayed and kept entirely.
+ */
+export type CatterCaptureMode = "none" | "tail" | "full";
+
+/**
+ * Executable basename globs (for example `"*gcc*"`) selecting which commands reach the script.
+ *
+ * A command is captured when it matches no `deny` glob and, if `allow` is not empty, at least
+ * one `allow` glob. Other commands are executed directly by the hook without going through
+ * `onCommand`/`onExecution`, but their descendants are still checked against the filter.
+ *
+ * The root build-system command is always captured.
+ */
+export type CatterExecFilter = {
+  allow: string[];
+  deny: string[];
+};
+
 /**
  * Configuration passed to the script before command capture begins.
  */
@@ -133,6 +230,45 @@ export type CatterConfig = {
      * Controls whether target stdout/stderr is printed by catter while it is captured.
      */
     stdioMode: CatterStdioMode;
+
+    /**
+     * Restricts which commands are captured, every command is captured when absent.
+     *
+     * Only honored by the `"inject"` runtime on Linux and macOS. On Windows a filter with any
+     * pattern fails the session before the build starts.
+     */
+    execFilter?: CatterExecFilter;
+
+    /**
+     * Lets `catter-proxy` replace itself with the command it injects instead of spawning it and
+     * waiting for it, which saves one process per command.
+     *
+     * Output of these commands is not captured, `onExecution` receives empty `stdOut` and
+     * `stdErr`. Their exit code is `-1` on kernels that cannot report it (before Linux 6.15).
+     * Only honored by the `"inject"` runtime on Linux, ignored elsewhere.
+     */
+    execThrough?: boolean;
+
+    /**
+     * Default capture policy of every command, `"tail"` when absent. `skip` and `modify` actions
+     * can override it per command.
+     *
+     * With `"none"` the build-system command inherits catter's stdout/stderr as well, unless
+     * `stdioMode` is `"capture"`.
+     */
+    capture?: CatterCaptureMode;
+
+    /**
+     * Bytes of stdout and of stderr kept per command in `"tail"` mode, 65536 when absent.
+     */
+    captureLimit?: number;
+
+    /**
+     * Path of a replay file (line-delimited, version 2) that every command, result and capture
+     * error of the build is recorded into. The file is replaced. Only honored by the `"inject"`
+     * runtime.
+     */
+    record?: string;
   };
 
   /**
@@ -231,6 +367,17 @@ export function service_on_command(
 export function service_on_execution(
   cb: (id: number, result: ProcessResult) => Promise<void>,
 ): void;
+
+export type BytecodeCacheStats = {
+  hits: number;
+  misses: number;
+};
+
+/**
+ * Hit and miss counters of the session's bytecode cache for scripts and the
+ * files they import, all zero when the cache is off.
+ */
+export function bytecode_cache_stats(): BytecodeCacheStats;
 // io
 export function stdout_print(content: string): void;
 export function stdout_print_red(content: string): void;
@@ -286,6 +433,29 @@ export function http_request(
   proxyUrl: string,
 ): Promise<RawHttpResponse>;
 
+export function http_server_listen(host: string, port: number): number;
+export function http_server_port(serverId: number): number;
+export function http_server_route(
+  serverId: number,
+  path: string,
+  contentType: string,
+  body: string,
+): void;
+export function http_server_stream(
+  serverId: number,
+  path: string,
+  history: number,
+): void;
+export function http_server_publish(
+  serverId: number,
+  path: string,
+  event: string,
+  data: string,
+): void;
+export function http_server_end(serverId: number, path: string): void;
+export function http_server_subscribers(serverId: number, path: string): number;
+export function http_server_close(serverId: number): void;
+
 // fs
 export function fs_exists(path: string): boolean;
 export function fs_is_file(path: string): boolean;
@@ -354,6 +524,12 @@ export function file_write_n(
   buf_size: number,
   buf: ArrayBuffer,
 ): void;
+export function file_read_until(
+  fd: number,
+  delimiter: string,
+  latin1: boolean,
+): string;
+export function file_read_all(fd: number, latin1: boolean): string;
 
 // option
 export type OptionItem = {
@@ -400,3 +576,97 @@ export function option_parse(
   cb: (parseRes: string | OptionItem) => boolean,
   visibility?: number,
 ): void;
+
+/**
+ * Item `i` has id `ids[i]`, starts at `args[indices[i]]`, and owns
+ * `strings[offsets[i]]` (its key) followed by its values up to
+ * `strings[offsets[i + 1]]`.
+ */
+export type PackedOptionItems = {
+  ids: Uint32Array;
+  indices: Uint32Array;
+  offsets: Uint32Array;
+  strings: string[];
+  error?: string;
+};
+
+/**
+ * Parses the whole argument array in one native call. On a parse error the
+ * items before the failing argument are returned together with `error`.
+ *
+ * @param args from argv[1]
+ */
+export function option_parse_all(
+  table: OptionTable,
+  args: string[],
+  visibility?: number,
+): PackedOptionItems;
+
+export type OptionCacheStats = {
+  hits: number;
+  partialHits: number;
+  misses: number;
+  reusedArgs: number;
+  parsedArgs: number;
+  evictions: number;
+  entries: number;
+  bytes: number;
+  budget: number;
+};
+
+export function option_cache_stats(): OptionCacheStats;
+
+/**
+ * @param bytes memory budget of the session's option parse cache, 0 disables it
+ */
+export function option_cache_set_budget(bytes: number): void;
+
+// compiler
+export type BuiltinCompilerIdentity = {
+  kind: "gcc" | "clang" | "clang-cl" | "msvc" | "nvcc" | "unknown";
+  dialect: "gcc" | "clang" | "msvc" | "nvcc" | "unknown";
+  targetPrefix?: string;
+};
+
+/**
+ * Identifies the builtin compiler of `exe`, or of `argv0` when `exe` is not a
+ * known compiler and `argv0` is not empty. Memoized for the session.
+ */
+export function compiler_identify(
+  exe: string,
+  argv0: string,
+): BuiltinCompilerIdentity;
+
+export type CompilerProbe = {
+  /** Default target triple, empty when the driver does not print one. */
+  target: string;
+  /** Builtin `#include <...>` search directories, in search order. */
+  includes: string[];
+  /** Predefined macros as `NAME=VALUE`. */
+  macros: string[];
+};
+
+/**
+ * Probes a gcc or clang style `compiler` for `language` ("c", "c++", ...) as
+ * it would run with the command line `args`. A bare `compiler` is searched in
+ * the PATH of `env`, or of catter when `env` is empty. Only the flags that
+ * change the answer (target, sysroot, standard, `-m*`, `-O*`, ...) are kept,
+ * and answers are cached per session and on disk by executable, size and
+ * mtime. Rejects when the compiler cannot be found or the probe fails.
+ */
+export function compiler_probe(
+  compiler: string,
+  language: string,
+  args: string[],
+  env: string[],
+): Promise<CompilerProbe>;
+
+export type CompilerProbeStats = {
+  hits: number;
+  joined: number;
+  diskHits: number;
+  probes: number;
+  failures: number;
+};
+
+export function compiler_probe_stats(): CompilerProbeStats;
@@ -8,76 +8,7 @@ import type {
   CompilerTargetFact,
 } from "./types.js";
 
-import { platform } from "catter/os";
-
-const VERSION_PATTERN = String.raw`(?:[-_]?\d+(?:[._-][0-9a-zA-Z]+)*)?`;
-const COMPILER_PATTERN_FLAGS = platform() === "windows" ? "i" : "";
-
-function createCompilerRegex(
-  basePattern: string,
-  withVersion: boolean,
-): RegExp {
-  const optionalPathPrefix = String.raw`(?:.*[\\/])?`;
-  const versionPattern = withVersion ? VERSION_PATTERN : "";
-  const executableSuffix = String.raw`(?:\.exe)?`;
-  return new RegExp(
-    `^${optionalPathPrefix}${basePattern}${versionPattern}${executableSuffix}$`,
-    COMPILER_PATTERN_FLAGS,
-  );
-}
-
-type BuiltinCompilerRule = {
-  kind: CompilerKind;
-  dialect: CompilerDialect;
-  executable: RegExp;
-  targetPrefix?: boolean;
-};
-
-const BUILTIN_COMPILER_RULES: readonly BuiltinCompilerRule[] = [
-  {
-    kind: "gcc",
-    dialect: "gcc",
-    executable: createCompilerRegex(
-      String.raw`(?:([^\\/]+)-)?(?:cc|c\+\+)`,
-      false,
-    ),
-    targetPrefix: true,
-  },
-  {
-    kind: "gcc",
-    dialect: "gcc",
-    executable: createCompilerRegex(
-      String.raw`(?:([^\\/]+)-)?(?:gcc|g\+\+)`,
-      true,
-    ),
-    targetPrefix: true,
-  },
-  {
-    kind: "clang",
-    dialect: "clang",
-    executable: createCompilerRegex(
-      String.raw`(?:([^\\/]+)-)?clang(?:\+\+)?`,
-      true,
-    ),
-    targetPrefix: true,
-  },
-  {
-    kind: "clang-cl",
-    dialect: "msvc",
-    executable: createCompilerRegex(String.raw`(?:([^\\/]+)-)?clang-cl`, true),
-    targetPrefix: true,
-  },
-  {
-    kind: "msvc",
-    dialect: "msvc",
-    executable: createCompilerRegex(String.raw`cl`, false),
-  },
-  {
-    kind: "nvcc",
-    dialect: "nvcc",
-    executable: createCompilerRegex(String.raw`(?:[^\\/]+-)?nvcc`, true),
-  },
-];
+import { compiler_identify } from "catter/native";
 
 type BuiltinCompilerIdentity = {
   kind: CompilerKind;
@@ -85,19 +16,17 @@ type BuiltinCompilerIdentity = {
   targetPrefix?: string;
 };
 
-function identifyBuiltinCompiler(executable: string): BuiltinCompilerIdentity {
-  for (const rule of BUILTIN_COMPILER_RULES) {
-    const match = rule.executable.exec(executable);
-    if (match !== null) {
-      return {
-        kind: rule.kind,
-        dialect: rule.dialect,
-        targetPrefix: rule.targetPrefix === true ? match[1] : undefined,
-      };
-    }
-  }
-
-  return { kind: "unknown", dialect: "unknown" };
+/**
+ * The builtin rules live natively: an optional `<target>-` prefix, the driver
+ * name (`cc`, `c++`, `gcc`, `g++`, `clang`, `clang++`, `clang-cl`, `cl`,
+ * `nvcc`), an optional version and an optional `.exe`, case-insensitive on
+ * Windows. Answers are memoized per session by executable.
+ */
+function identifyBuiltinCompiler(
+  executable: string,
+  argv0 = "",
+): BuiltinCompilerIdentity {
+  return compiler_identify(executable, argv0) as BuiltinCompilerIdentity;
 }
 
 /** Identifies the builtin compiler family for an executable path or name. */
@@ -170,7 +99,7 @@ export class CompilerIdentifier {
       };
     }
 
-    const builtin = identifyBuiltinCompiler(command.exe);
+    const builtin = identifyBuiltinCompiler(command.exe, command.argv[0]);
     return {
       key: `builtin:${builtin.kind}`,
       dialect: builtin.dialect,
@@ -4,3 +4,9 @@ export {
   outputConventionFromArtifactModel,
   targetFromTriple,
 } from "./target.js";
+export {
+  compilerProbeStats,
+  probeCompiler,
+  type CompilerProbe,
+  type CompilerProbeStats,
+} from "./probe.js";
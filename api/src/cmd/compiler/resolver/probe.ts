@@ -0,0 +1,61 @@
+import { compiler_probe, compiler_probe_stats } from "catter/native";
+
+/** What a gcc or clang style driver reports about itself. */
+export type CompilerProbe = {
+  /** Default target triple, empty when the driver does not print one. */
+  target: string;
+  /** Builtin `#include <...>` search directories, in search order. */
+  includes: string[];
+  /** Predefined macros as `NAME=VALUE`. */
+  macros: string[];
+};
+
+export type CompilerProbeStats = {
+  /** Queries answered from the session memo. */
+  hits: number;
+  /** Queries that waited for a probe of the same key already running. */
+  joined: number;
+  /** Queries answered from the on-disk cache. */
+  diskHits: number;
+  /** Compilers actually spawned. */
+  probes: number;
+  failures: number;
+};
+
+/**
+ * Asks a gcc or clang style compiler for its default target, builtin include
+ * directories and predefined macros, as it would compile `language` with the
+ * command line `args`.
+ *
+ * Only the flags that change the answer are kept (`--target`, `--sysroot`,
+ * `-std=`, `-m32` and other `-m*`, `-O*`, ...), and answers are cached per
+ * session and on disk by the resolved executable, its size and mtime, so a
+ * build with thousands of commands spawns each compiler a handful of times.
+ * Concurrent probes of one compiler share a single spawn. A bare compiler name
+ * is searched in the PATH of `env`, the environment of the command, or of
+ * catter when it is empty.
+ *
+ * @example
+ * ```typescript
+ * const probe = await probeCompiler(cmd.exe, "c++", cmd.argv, cmd.env);
+ * const args = probe.includes.map((dir) => `-isystem${dir}`);
+ * ```
+ */
+export async function probeCompiler(
+  compiler: string,
+  language: string,
+  args: readonly string[],
+  env: readonly string[] = [],
+): Promise<CompilerProbe> {
+  return (await compiler_probe(
+    compiler,
+    language,
+    [...args],
+    [...env],
+  )) as CompilerProbe;
+}
+
+/** Returns the counters of the session's compiler probe cache. */
+export function compilerProbeStats(): CompilerProbeStats {
+  return compiler_probe_stats() as CompilerProbeStats;
+}
@@ -34,6 +34,22 @@ export type AnalyzedData = {
   readonly argv: readonly string[];
 };
 
+/**
+ * Quotes one argument for display in a command line. Arguments made only of
+ * characters no shell treats specially are returned as they are, all others
+ * as a JSON string.
+ *
+ * @example
+ * ```ts
+ * ["cc", "-DNAME=a b"].map(cmd.quoteArgument).join(" "); // cc "-DNAME=a b"
+ * ```
+ */
+export function quoteArgument(argument: string): string {
+  return /^[A-Za-z0-9_@%+=:,./\\-]+$/.test(argument)
+    ? argument
+    : JSON.stringify(argument);
+}
+
 export abstract class AnalysisError extends Error {
   abstract readonly kind: string;
   constructor(message: string) {
@@ -2,6 +2,14 @@ import {
   http_client_close,
   http_client_create,
   http_client_request,
+  http_server_close,
+  http_server_end,
+  http_server_listen,
+  http_server_port,
+  http_server_publish,
+  http_server_route,
+  http_server_stream,
+  http_server_subscribers,
 } from "catter/native";
 
 export {};
@@ -219,6 +227,122 @@ export async function json<T = unknown>(
   return getDefaultClient().json<T>(url, options);
 }
 
+export type ServerOptions = {
+  /**
+   * Address to listen on. Default: `127.0.0.1`, so the server is only
+   * reachable from this machine.
+   */
+  host?: string;
+  /**
+   * Port to listen on, `0` picks a free one, see {@link Server.port}.
+   */
+  port: number;
+};
+
+/**
+ * A server-sent event stream of a {@link Server}.
+ */
+export class EventStream {
+  constructor(
+    private readonly server: Server,
+    readonly path: string,
+  ) {}
+
+  /**
+   * Sends an event to every subscriber. `data` is sent as is, so objects
+   * should be passed through `JSON.stringify` first.
+   *
+   * This never waits for the subscribers: a browser that cannot keep up is
+   * disconnected instead of slowing down the build.
+   */
+  publish(event: string, data: string): void {
+    http_server_publish(this.server.id(), this.path, event, data);
+  }
+
+  /**
+   * Ends the stream. Subscribers are closed once they received every event,
+   * later ones receive the kept history and are closed right away.
+   */
+  end(): void {
+    http_server_end(this.server.id(), this.path);
+  }
+
+  subscribers(): number {
+    return http_server_subscribers(this.server.id(), this.path);
+  }
+}
+
+/**
+ * An HTTP server answering requests natively on a thread of its own while
+ * the script goes on. It serves fixed documents and server-sent event
+ * streams, e.g. a dashboard page and the events it shows.
+ *
+ * For now the server does not run on catter's event loop: it polls POSIX
+ * sockets from its own thread, so it is not available on Windows and the
+ * constructor throws there. The server is closed when the script ends at the
+ * latest.
+ *
+ * @example
+ * ```ts
+ * import { Server } from "catter/http";
+ *
+ * const server = new Server({ port: 8300 });
+ * server.route("/", "text/html", dashboardHtml);
+ * const events = server.stream("/events", { history: 10_000 });
+ * events.publish("command", JSON.stringify({ id: 1, argv: ["cc", "a.c"] }));
+ * ```
+ */
+export class Server {
+  private serverId: number | undefined;
+
+  constructor(options: ServerOptions) {
+    this.serverId = http_server_listen(
+      options.host ?? "127.0.0.1",
+      options.port,
+    );
+  }
+
+  /**
+   * The port the server listens on.
+   */
+  port(): number {
+    return http_server_port(this.id());
+  }
+
+  /**
+   * Serves `body` at `path`, replacing what was there.
+   */
+  route(path: string, contentType: string, body: string): void {
+    http_server_route(this.id(), path, contentType, body);
+  }
+
+  /**
+   * Opens an event stream at `path`. New subscribers first receive the last
+   * `history` events, so a page opened late still sees the whole build.
+   */
+  stream(path: string, options: { history?: number } = {}): EventStream {
+    http_server_stream(this.id(), path, options.history ?? 0);
+    return new EventStream(this, path);
+  }
+
+  close(): void {
+    if (this.serverId === undefined) {
+      return;
+    }
+
+    http_server_close(this.serverId);
+    this.serverId = undefined;
+  }
+
+  /** @internal */
+  id(): number {
+    if (this.serverId === undefined) {
+      throw new Error("HTTP server is closed");
+    }
+    return this.serverId;
+  }
+}
+
 function flattenHeaders(headers: HeaderInit | undefined): string[] {
   if (!headers) {
     return [];
@@ -1,7 +1,9 @@
 import {
   file_close,
   file_open,
+  file_read_all,
   file_read_n,
+  file_read_until,
   file_seek_read,
   file_seek_write,
   file_tell_read,
@@ -292,6 +294,48 @@ export class FileStream {
     return bytesRead;
   }
 
+  /**
+   * Reads text up to a delimiter or EOF at the current read position.
+   *
+   * The scan runs natively over a large read buffer and the text is returned as one string,
+   * so long lines cost a single call instead of one call per byte. The delimiter is consumed
+   * but NOT included in the result.
+   *
+   * @param delimiter - The text to stop at, or `null` to read until EOF.
+   * @param encoding - How bytes are decoded. `"ascii"` maps each byte to the character
+   *                   with the same code, `"utf-8"` decodes UTF-8.
+   * @returns The decoded text before the delimiter, or up to EOF if it is not found.
+   * @throws Will throw if the file ID is invalid.
+   *
+   * @example
+   * ```typescript
+   * const line = stream.readTextUntil("\n", "utf-8");
+   * ```
+   */
+  public readTextUntil(
+    delimiter: string | null,
+    encoding: SupportedTextEncodings,
+  ): string {
+    return file_read_until(this.fd, delimiter ?? "", encoding === "ascii");
+  }
+
+  /**
+   * Reads text from the current read position to EOF in one native read.
+   *
+   * @param encoding - How bytes are decoded, see `readTextUntil`.
+   * @returns The decoded text. The read position is left at EOF.
+   * @throws Will throw if the file ID is invalid.
+   *
+   * @example
+   * ```typescript
+   * stream.seekRead(0, SeekWhence.SET);
+   * const content = stream.readTextToEnd("utf-8");
+   * ```
+   */
+  public readTextToEnd(encoding: SupportedTextEncodings): string {
+    return file_read_all(this.fd, encoding === "ascii");
+  }
+
   /**
    * Writes bytes to the file at the current write position.
    *
@@ -478,11 +522,18 @@ export interface EnDecStreamImpl {
    * Reads until a delimiter or EOF is reached.
    *
    * @param raw - The underlying binary stream to read from.
-   * @param delimiter - The delimiter character to stop at, or `null` to read until EOF.
-   * @param bufSize - The temporary byte-buffer size used for chunked reads.
+   * @param delimiter - The delimiter to stop at, or `null` to read until EOF.
    * @returns The decoded string read before the delimiter or EOF.
    */
-  readUntil(raw: FileStream, delimiter: string | null, bufSize: number): string;
+  readUntil(raw: FileStream, delimiter: string | null): string;
+
+  /**
+   * Reads and decodes everything from the read position to EOF.
+   *
+   * @param raw - The underlying binary stream to read from.
+   * @returns The decoded remainder of the file.
+   */
+  readToEnd(raw: FileStream): string;
 
   /**
    * Decodes raw bytes to a string.
@@ -505,31 +556,11 @@ const asciiEnDecStreamImpl: EnDecStreamImpl = {
   write(raw: FileStream, data: string): void {
     raw.write(this.encode(data));
   },
-  readUntil(
-    raw: FileStream,
-    delimiter: string | null,
-    bufSize: number = 32,
-  ): string {
-    const needCmp = delimiter !== null;
-    const delimiterCode = needCmp ? delimiter!.charCodeAt(0) : -1;
-    let result = "";
-    const buffer = new Uint8Array(bufSize);
-    while (true) {
-      const bytesRead = raw.readBuf(buffer);
-      for (let i = 0; i < bytesRead; i++) {
-        const byte = buffer[i];
-        if (byte === delimiterCode) {
-          raw.seekRead(i - bytesRead + 1, SeekWhence.CUR);
-          return result;
-        } else {
-          result += String.fromCharCode(byte);
-        }
-      }
-      if (bytesRead < bufSize) {
-        break;
-      }
-    }
-    return result;
+  readUntil(raw: FileStream, delimiter: string | null): string {
+    return raw.readTextUntil(delimiter, "ascii");
+  },
+  readToEnd(raw: FileStream): string {
+    return raw.readTextToEnd("ascii");
   },
   read(raw: FileStream, chars: number): string {
     const bytes = raw.read(chars);
@@ -615,38 +646,10 @@ const utf8EnDecStreamImpl: EnDecStreamImpl = {
     raw.write(this.encode(data));
   },
   readUntil(raw: FileStream, delimiter: string | null): string {
-    const delimiterBytes = delimiter === null ? null : this.encode(delimiter);
-    const collected: number[] = [];
-    const matchedDelimiter: number[] = [];
-
-    while (true) {
-      const next = raw.read(1);
-      if (next.length === 0) {
-        collected.push(...matchedDelimiter);
-        break;
-      }
-
-      if (delimiterBytes === null) {
-        collected.push(next[0]);
-        continue;
-      }
-
-      matchedDelimiter.push(next[0]);
-      const matchedPrefix = delimiterBytes
-        .slice(0, matchedDelimiter.length)
-        .every((byte, index) => byte === matchedDelimiter[index]);
-      if (matchedPrefix) {
-        if (matchedDelimiter.length === delimiterBytes.length) {
-          break;
-        }
-        continue;
-      }
-
-      collected.push(...matchedDelimiter);
-      matchedDelimiter.length = 0;
-    }
-
-    return this.decode(new Uint8Array(collected));
+    return raw.readTextUntil(delimiter, "utf-8");
+  },
+  readToEnd(raw: FileStream): string {
+    return raw.readTextToEnd("utf-8");
   },
   read(raw: FileStream, chars: number): string {
     let result = "";
@@ -815,9 +818,9 @@ export class TextFileStream {
    * Reads until a delimiter character is encountered or EOF is reached.
    *
    * The delimiter is consumed from the stream but NOT included in the returned string.
-   * Reads in buffered chunks (default 32 bytes) for efficiency.
+   * The scan runs natively over a large read buffer, see `FileStream.readTextUntil`.
    *
-   * @param delimiter - The character that marks the end of the read. Common examples: `"\n"` for lines.
+   * @param delimiter - The text that marks the end of the read. Common examples: `"\n"` for lines.
    * @returns The string up to (but not including) the delimiter. Returns everything up to EOF
    *          if the delimiter is not found.
    * @throws Will throw if the underlying read fails.
@@ -828,7 +831,7 @@ export class TextFileStream {
    * ```
    */
   public readUntil(delimiter: string): string {
-    return this.encodingImpl.readUntil(this.fileStream, delimiter, 32);
+    return this.encodingImpl.readUntil(this.fileStream, delimiter);
   }
 
   /**
@@ -873,7 +876,7 @@ export class TextFileStream {
   /**
    * Reads the entire file contents as a single decoded string.
    *
-   * Determines file size, seeks to start, reads all bytes, and decodes them.
+   * Seeks to start and reads and decodes all bytes in one native read.
    *
    * @returns The complete file contents as a string.
    * @throws Will throw if file size, seek, or read operations fail.
@@ -885,8 +888,8 @@ export class TextFileStream {
    * ```
    */
   public readEntireFile(): string {
-    const raw = this.fileStream.readEntireFile();
-    return this.encodingImpl.decode(raw);
+    this.fileStream.seekRead(0, SeekWhence.SET);
+    return this.encodingImpl.readToEnd(this.fileStream);
   }
 
   /**
@@ -1,7 +1,18 @@
-import { option_get_info, option_parse } from "catter/native";
+import {
+  option_cache_set_budget,
+  option_cache_stats,
+  option_get_info,
+  option_parse_all,
+} from "catter/native";
+import type { PackedOptionItems } from "catter/native";
 import { err, ok, type Result } from "catter/neverthrow";
 import { OptionKindClass } from "./types.js";
-import type { OptionInfo, OptionItem, OptionTable } from "./types.js";
+import type {
+  OptionCacheStats,
+  OptionInfo,
+  OptionItem,
+  OptionTable,
+} from "./types.js";
 
 /**
  * Helpers for working with generated compiler option tables.
@@ -47,7 +58,12 @@ export { NvccID } from "./nvcc.js";
 export { NvccFlag } from "./nvcc.js";
 export { NvccVisibility } from "./nvcc.js";
 export { OptionKindClass } from "./types.js";
-export type { OptionInfo, OptionItem, OptionTable } from "./types.js";
+export type {
+  OptionCacheStats,
+  OptionInfo,
+  OptionItem,
+  OptionTable,
+} from "./types.js";
 
 const RENDER_JOINED = 1 << 2;
 const RENDER_SEPARATE = 1 << 3;
@@ -93,6 +109,37 @@ function renderTokensCanonical(info: OptionInfo, item: OptionItem): string[] {
   }
 }
 
+function unpackItem(packed: PackedOptionItems, i: number): OptionItem {
+  const start = packed.offsets[i];
+  return {
+    values: packed.strings.slice(start + 1, packed.offsets[i + 1]),
+    key: packed.strings[start],
+    id: packed.ids[i],
+    index: packed.indices[i],
+  };
+}
+
+/**
+ * Parses `args` in one native call, then feeds the items and a trailing error
+ * (if any) to `cb` until it returns `false`.
+ */
+function forEachParsed(
+  table: OptionTable,
+  args: string[],
+  visibility: number,
+  cb: (parseRes: string | OptionItem) => boolean,
+): void {
+  const packed = option_parse_all(table, args, visibility);
+  for (let i = 0; i < packed.ids.length; ++i) {
+    if (!cb(unpackItem(packed, i))) {
+      return;
+    }
+  }
+  if (packed.error !== undefined) {
+    cb(packed.error);
+  }
+}
+
 /**
  * Renders a parsed option item back into a command-line fragment.
  *
@@ -142,22 +189,15 @@ export function collect(
   args: string[],
   visibility = ALL_OPTION_VISIBILITY,
 ): Result<OptionItem[], string> {
-  const items: OptionItem[] = [];
-  let failure: string | undefined;
-  option_parse(
-    table,
-    args,
-    (parseRes) => {
-      if (typeof parseRes === "string") {
-        failure = parseRes;
-        return false;
-      }
-      items.push(parseRes);
-      return true;
-    },
-    visibility,
-  );
-  return failure === undefined ? ok(items) : err(failure);
+  const packed = option_parse_all(table, args, visibility);
+  if (packed.error !== undefined) {
+    return err(packed.error);
+  }
+  const items: OptionItem[] = new Array(packed.ids.length);
+  for (let i = 0; i < items.length; ++i) {
+    items[i] = unpackItem(packed, i);
+  }
+  return ok(items);
 }
 
 /**
@@ -200,7 +240,7 @@ export function replace(
     ]);
     nextToAdd = endIndex;
   };
-  option_parse(table, args, (parseRes) => {
+  forEachParsed(table, args, ALL_OPTION_VISIBILITY, (parseRes) => {
     const res: Result<Readonly<OptionItem>, string> = typeof parseRes ===
     "string"
       ? err(parseRes)
@@ -240,7 +280,10 @@ export function replace(
 }
 
 /**
- * Streams parser results to a callback without collecting them first.
+ * Feeds parser results to a callback one at a time.
+ *
+ * The whole array is parsed in a single native call up front; returning
+ * `false` from `cb` skips the remaining items.
  *
  * @param table - The option table that should be used to interpret `args`, such as `"clang"` or `"nvcc"`.
  * @param args - The raw argument array to parse, usually without the executable name.
@@ -266,14 +309,9 @@ export function parse(
   cb: (parseRes: Result<OptionItem, string>) => boolean,
   visibility = ALL_OPTION_VISIBILITY,
 ): void {
-  option_parse(
-    table,
-    args,
-    (parseRes) => {
-      return cb(typeof parseRes === "string" ? err(parseRes) : ok(parseRes));
-    },
-    visibility,
-  );
+  forEachParsed(table, args, visibility, (parseRes) => {
+    return cb(typeof parseRes === "string" ? err(parseRes) : ok(parseRes));
+  });
 }
 
 /**
@@ -298,6 +336,38 @@ export function info(table: OptionTable, item: OptionItem) {
   return option_get_info(table, item.id) as OptionInfo;
 }
 
+/**
+ * Returns the counters of the session's option parse cache.
+ *
+ * Every parse in this module goes through a cache that lives for one catter
+ * session. An argument array seen before is answered from it, and an array
+ * sharing a prefix or suffix with the previous one (same table and visibility)
+ * reuses the items parsed there, so only the differing arguments are parsed.
+ *
+ * @returns Hit, reuse and memory counters since the session started.
+ *
+ * @example
+ * ```typescript
+ * import { cacheStats } from "catter/option";
+ *
+ * const stats = cacheStats();
+ * println(`${stats.hits + stats.partialHits} of ${stats.hits + stats.partialHits + stats.misses} parses reused`);
+ * ```
+ */
+export function cacheStats(): OptionCacheStats {
+  return option_cache_stats() as OptionCacheStats;
+}
+
+/**
+ * Sets the memory budget of the option parse cache.
+ *
+ * @param bytes - Budget in bytes, least recently used entries are evicted
+ * beyond it. `0` disables the cache.
+ */
+export function setCacheBudget(bytes: number): void {
+  option_cache_set_budget(bytes);
+}
+
 /**
  * Re-parses argument spans collected from one option table and keeps only the
  * spans that pass a second-stage filter.
@@ -35,6 +35,20 @@ export type OptionItem = {
   index: number;
 };
 
+export type OptionCacheStats = {
+  /** Argument arrays answered entirely from the cache. */
+  hits: number;
+  /** Argument arrays that reused a prefix or suffix of the previous parse. */
+  partialHits: number;
+  misses: number;
+  reusedArgs: number;
+  parsedArgs: number;
+  evictions: number;
+  entries: number;
+  bytes: number;
+  budget: number;
+};
+
 export type OptionTable =
   | "clang"
   | "lld-coff"
@@ -1,4 +1,5 @@
 import {
+  bytecode_cache_stats,
   service_on_command,
   service_on_execution,
   service_on_finish,
@@ -30,15 +31,19 @@ export * from "./runtime.js";
 export type {
   Action,
   ActionType,
+  BytecodeCacheStats,
   CatterConfig,
   CatterErr,
   CatterStdioMode,
+  CatterCaptureMode,
+  CatterExecFilter,
   CatterRuntime,
   CommandData,
   ProcessResult,
+  ProcessUsage,
 } from "catter/native";
 
-import type { ActionType } from "catter/native";
+import type { ActionType, BytecodeCacheStats } from "catter/native";
 
 /**
  * Supported command actions.
@@ -50,6 +55,7 @@ export const ActionKind = [
   "drop",
   "abort",
   "modify",
+  "fake",
 ] as const satisfies readonly ActionType[];
 
 const defaultRuntime = new ServiceRuntime();
@@ -122,3 +128,17 @@ export function register(service: RegisterableService): void {
   installRuntime();
   defaultRuntime.use(service);
 }
+
+/**
+ * Returns how many modules of this session were loaded from the on-disk
+ * bytecode cache (`hits`) and how many were compiled (`misses`).
+ *
+ * @example
+ * ```typescript
+ * const { hits, misses } = bytecodeCacheStats();
+ * println(`${hits} of ${hits + misses} modules loaded from the bytecode cache`);
+ * ```
+ */
+export function bytecodeCacheStats(): BytecodeCacheStats {
+  return bytecode_cache_stats();
+}
@@ -47,6 +47,7 @@ export interface CommandContext {
   drop(): void;
   abort(): void;
   modify(data: CommandData): void;
+  fake(outputs: readonly string[]): void;
   setAction(action: Action): void;
   ignoreDescendants(): void;
   stopPropagation(): void;
@@ -129,6 +130,11 @@ class RuntimeCommandContext implements CommandContext {
     this.currentAction = { type: "modify", data };
   }
 
+  fake(outputs: readonly string[]): void {
+    this.actionSet = true;
+    this.currentAction = { type: "fake", outputs: [...outputs] };
+  }
+
   setAction(action: Action): void {
     this.actionSet = true;
     this.currentAction = action;
@@ -186,6 +192,11 @@ class ParallelCommandContext implements CommandContext {
     this.currentAction = { type: "modify", data };
   }
 
+  fake(outputs: readonly string[]): void {
+    this.actionSet = true;
+    this.currentAction = { type: "fake", outputs: [...outputs] };
+  }
+
   setAction(action: Action): void {
     this.actionSet = true;
     this.currentAction = action;
@@ -13,6 +13,7 @@ import {
   CompilerPhase,
   Edge,
   Registry,
+  quoteArgument,
   type CommandAnalysis,
   type CommandAnalyzerError,
 } from "catter/cmd";
@@ -364,3 +365,8 @@ assertThrow(
     .analyze(invocation(["toy-bundle", "input.dat", "output.pkg"]))
     .isErr(),
 );
+
+expectEq(quoteArgument("-Iinclude/dir"), "-Iinclude/dir", "plain argument");
+expectEq(quoteArgument("C:\\src\\a.c"), "C:\\src\\a.c", "windows path");
+expectEq(quoteArgument("-DNAME=a b"), '"-DNAME=a b"', "argument with space");
+expectEq(quoteArgument(""), '""', "empty argument");
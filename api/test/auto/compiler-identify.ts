@@ -236,3 +236,14 @@ const custom = identifier.identifyCompilerCommand({
 });
 expectEq(custom.key, "project-clang", "custom rule key");
 expectEq(custom.dialect, "msvc", "custom rule dialect");
+
+const wrappedGcc = identifier.identifyCompilerCommand({
+  exe: "/opt/wrappers/compile-shim",
+  argv: ["aarch64-linux-gnu-g++", "-c", "main.cc"],
+});
+expectEq(wrappedGcc.key, "builtin:gcc", "argv[0] fallback key");
+expectEq(
+  wrappedGcc.target?.target.triple,
+  "aarch64-linux-gnu",
+  "argv[0] fallback target",
+);
@@ -72,6 +72,34 @@ TextFileStream.with(largeTextPath, "ascii", (stream) => {
   assertThrow(stream.readEntireFile() === largeText);
 });
 
+const utf8LinesPath = path.joinAll(testEnvPath, "b", "utf8-lines.txt");
+const longLine = "λ".repeat(1_500_000);
+assertThrow(createFileSync(utf8LinesPath));
+TextFileStream.with(utf8LinesPath, "utf-8", (stream) => {
+  stream.write("héllo\r\n" + longLine + "\n日本語→end→tail");
+});
+TextFileStream.with(utf8LinesPath, "utf-8", (stream) => {
+  assertThrow(stream.readLine() === "héllo");
+  assertThrow(stream.readLine() === longLine);
+  assertThrow(stream.readUntil("→") === "日本語");
+  assertThrow(stream.readUntil("→") === "end");
+  assertThrow(stream.readUntil("→") === "tail");
+  assertThrow(stream.readUntil("→") === "");
+  assertThrow(
+    stream.readEntireFile() ===
+      "héllo\r\n" + longLine + "\n日本語→end→tail",
+  );
+});
+TextFileStream.with(utf8LinesPath, "utf-8", (stream) => {
+  const lines = stream.readLines();
+  assertThrow(
+    lines.length === 3 &&
+      lines[0] === "héllo" &&
+      lines[1] === longLine &&
+      lines[2] === "日本語→end→tail",
+  );
+});
+
 const c_path = path.joinAll(testEnvPath, "c");
 assertThrow(existsSync(c_path));
 assertThrow(
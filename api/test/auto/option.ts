@@ -1,12 +1,15 @@
 import { assertThrow } from "catter/debug";
+import { option_parse, option_parse_all } from "catter/native";
 import {
   ClangID,
   ClangVisibility,
   NvccID,
+  cacheStats,
   collect,
   info,
   parse,
   replace,
+  setCacheBudget,
   stringify,
   type OptionInfo,
   type OptionItem,
@@ -676,3 +679,79 @@ expectEq(
   "-o 233 <input> <input> <input> <input> <input> <input> <input> <input> <input> <input> <input> -m64 -L<...> -L<...> -L<...> -L<...> -L<...> -L<...> -L<...> -L<...> -L<...> -lqjs -lcommon -lspdlogd -lztest -loption -lasync -luv -lcpptrace -ldwarf -lz -lzstd -lm -lpthread -ldl san!",
   "replace",
 );
+
+// option_parse_all packs the same items option_parse streams.
+
+const llvmCompileLine =
+  "-DGTEST_HAS_RTTI=0 -D_GNU_SOURCE -D__STDC_CONSTANT_MACROS -Ilib/Support -I../llvm/include -fPIC -fvisibility-inlines-hidden -Werror=date-time -Wall -Wextra -Wno-unused-parameter -O3 -DNDEBUG -std=c++17 -fno-exceptions -fno-rtti -MD -MT lib/Support/CMakeFiles/LLVMSupport.dir/APInt.cpp.o -MF lib/Support/CMakeFiles/LLVMSupport.dir/APInt.cpp.o.d -o lib/Support/CMakeFiles/LLVMSupport.dir/APInt.cpp.o -c ../llvm/lib/Support/APInt.cpp".split(
+    " ",
+  );
+const streamed: OptionItem[] = [];
+option_parse("clang", llvmCompileLine, (parseRes) => {
+  if (typeof parseRes === "string") {
+    throw new Error(`option_parse_all: unexpected parse error: ${parseRes}`);
+  }
+  streamed.push(parseRes);
+  return true;
+});
+const packed = option_parse_all("clang", llvmCompileLine);
+expectEq(packed.error, undefined, "packed error");
+expectEq(packed.ids.length, streamed.length, "packed length");
+expectEq(packed.offsets.length, streamed.length + 1, "packed offsets length");
+const packedCollected = collect("clang", llvmCompileLine);
+assertThrow(packedCollected.isOk());
+if (packedCollected.isOk()) {
+  streamed.forEach((item, i) => {
+    const other = packedCollected.value[i];
+    expectEq(other.id, item.id, `packed id ${i}`);
+    expectEq(other.index, item.index, `packed index ${i}`);
+    expectEq(other.key, item.key, `packed key ${i}`);
+    expectEq(other.values.join("\n"), item.values.join("\n"), `packed values ${i}`);
+  });
+}
+
+const partial = option_parse_all("clang", ["-Iinclude", "main.cc", "-o"]);
+expectEq(partial.ids.length, 2, "partial length");
+assertThrow(partial.error !== undefined && partial.error.includes("missing"));
+const partialSeen: string[] = [];
+parse("clang", ["-Iinclude", "main.cc", "-o"], (parseRes) => {
+  partialSeen.push(parseRes.isOk() ? parseRes.value.key : "error");
+  return true;
+});
+expectEq(partialSeen.join(), "-I,main.cc,error", "partial parse stream");
+
+// The parse cache reuses earlier parses without changing results.
+
+const otherCompileLine = llvmCompileLine.map((arg) =>
+  arg.replaceAll("APInt", "StringRef"),
+);
+const cachedItems = (args: string[]) => {
+  const res = collect("clang", args);
+  if (res.isErr()) {
+    throw new Error(`cache: unexpected parse error: ${res.error}`);
+  }
+  return res.value.map((item) => JSON.stringify(item));
+};
+const before = cacheStats();
+const cachedFirst = cachedItems(llvmCompileLine);
+const cachedOther = cachedItems(otherCompileLine);
+const cachedAgain = cachedItems(llvmCompileLine);
+const after = cacheStats();
+assertThrow(after.hits > before.hits);
+assertThrow(after.partialHits > before.partialHits);
+assertThrow(after.reusedArgs > before.reusedArgs);
+
+setCacheBudget(0);
+expectEq(cacheStats().entries, 0, "cache entries without budget");
+expectEq(
+  cachedItems(llvmCompileLine).join("\n"),
+  cachedFirst.join("\n"),
+  "cache first line",
+);
+expectEq(
+  cachedItems(otherCompileLine).join("\n"),
+  cachedOther.join("\n"),
+  "cache other line",
+);
+expectEq(cachedAgain.join("\n"), cachedFirst.join("\n"), "cache hit line");
+setCacheBudget(16 * 1024 * 1024);
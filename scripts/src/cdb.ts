@@ -9,6 +9,7 @@ import { path } from "catter/fs";
 import {
   CompilerAnalyzer,
   CompilerResolver,
+  quoteArgument,
   type CompilerAnalysis,
   type CompilerAnalysisError,
   type CompilerResolveDebug,
@@ -33,6 +34,7 @@ type CDBScriptOptions = {
   abortOnCaptureError: boolean;
   quiet: boolean;
   verbose: boolean;
+  fake: boolean;
 };
 
 const cdbCLI = cli.command({
@@ -63,6 +65,10 @@ const cdbCLI = cli.command({
     cli.flag("abort-on-capture-error", {
       description: "Abort when catter reports a command capture error.",
     }),
+    cli.flag("fake", {
+      description:
+        "Create placeholder objects instead of running plain compile commands.",
+    }),
     cli.flag("quiet", {
       short: "q",
       description: "Suppress informational output.",
@@ -114,6 +120,7 @@ function defaultOptions(outputPath: string): CDBScriptOptions {
     abortOnCaptureError: false,
     quiet: false,
     verbose: false,
+    fake: false,
   };
 }
 
@@ -129,12 +136,6 @@ function verboseLog(options: CDBScriptOptions, message: string): void {
   }
 }
 
-function quoteArgument(argument: string): string {
-  return /^[A-Za-z0-9_@%+=:,./\\-]+$/.test(argument)
-    ? argument
-    : JSON.stringify(argument);
-}
-
 function commandLine(command: CommandData): string {
   const argv = command.argv.length === 0 ? [command.exe] : command.argv;
   return argv.map(quoteArgument).join(" ");
@@ -177,6 +178,19 @@ function resolverNotes(debug: CompilerResolveDebug): string[] {
   return notes;
 }
 
+/**
+ * Outputs of a command that only compiles sources into objects, which can be
+ * faked. Anything else (links, generated headers, preprocessed sources) may
+ * be read by later commands and must really be built.
+ */
+function fakeableOutputs(analysis: CompilerAnalysis): string[] | undefined {
+  if (analysis.sourceFiles.length === 0 || analysis.writes.length === 0) {
+    return undefined;
+  }
+  const objects = analysis.writes.every((output) => /\.(o|obj)$/i.test(output));
+  return objects ? analysis.writes : undefined;
+}
+
 function compilerOutputs(analysis: CompilerAnalysis): string[] {
   const inferred = new Map(
     analysis.debug?.inferredWrites.map(
@@ -253,6 +267,10 @@ function compilerAnalysisErrorLog(
  * ]
  * ```
  *
+ * With `--fake`, commands that only compile sources into object files are not
+ * run: catter-proxy writes placeholder objects at the resolved outputs, so the
+ * build and its link steps still complete.
+ *
  * Output:
  * ```txt
  * CDB saved to /tmp/demo/build/compile_commands.json with 1 entries.
@@ -341,7 +359,13 @@ function cdb(savePath = "build/compile_commands.json"): CatterContextService {
         abortOnCaptureError: parsed["abort-on-capture-error"],
         quiet: parsed.quiet,
         verbose: parsed.verbose,
+        fake: parsed.fake,
       };
+      if (options.fake && !config.runtime.supportActions.includes("fake")) {
+        throw new Error(
+          `cdb: --fake is not supported by the ${config.runtime.type} runtime`,
+        );
+      }
       compilerAnalyzer = new CompilerAnalyzer({
         resolver: new CompilerResolver({ debug: options.verbose }),
       });
@@ -440,6 +464,13 @@ function cdb(savePath = "build/compile_commands.json"): CatterContextService {
         producers.set(output, parents);
       }
 
+      if (options.fake) {
+        const outputs = fakeableOutputs(analysis);
+        if (outputs !== undefined) {
+          ctx.fake(outputs);
+        }
+      }
+
       ctx.ignoreDescendants();
     },
 
@@ -0,0 +1,464 @@
+import { cli, run } from "catter/cli";
+import {
+  create,
+  register,
+  type CatterContextService,
+  type ProcessUsage,
+} from "catter/service";
+import { quoteArgument } from "catter/cmd";
+import { mkdir, path, writeText } from "catter/fs";
+import { println } from "catter/io";
+import { FlatTree } from "catter/data";
+import { monotonicUs } from "catter/time";
+
+const timelineCLI = cli.command({
+  name: "timeline",
+  description:
+    "Record when every captured command ran, write a Chrome trace and analyze the build parallelism.",
+  options: [
+    cli.string("output", {
+      short: "o",
+      valueName: "path",
+      description:
+        "Write the Chrome trace to this path. Default: timeline.json.",
+    }),
+    cli.number("top", {
+      short: "n",
+      valueName: "n",
+      description: "Number of critical path steps and idle gaps to print.",
+      integer: true,
+      min: 0,
+      default: 10,
+    }),
+    cli.number("minGap", {
+      short: "g",
+      valueName: "ms",
+      description: "Only report idle gaps lasting at least this long.",
+      min: 0,
+      default: 100,
+    }),
+  ] as const,
+  examples: [
+    "timeline -o build/timeline.json",
+    {
+      command: "timeline -n 20 -g 500",
+      description:
+        "Print the 20 longest critical steps and gaps of 0.5 s or more.",
+    },
+  ],
+});
+
+/**
+ * One captured command. Times are microseconds of the monotonic clock the
+ * native side reports `ProcessUsage` with.
+ */
+type Step = {
+  id: number;
+  parent?: number;
+  name: string;
+  command: string;
+  start: number;
+  end?: number;
+  code?: number;
+  usage?: ProcessUsage;
+};
+
+type FinishedStep = Step & { end: number };
+
+type IdleGap = {
+  start: number;
+  end: number;
+  after?: FinishedStep;
+  before?: FinishedStep;
+};
+
+type Parallelism = {
+  average: number;
+  peak: number;
+  gaps: IdleGap[];
+};
+
+function seconds(us: number): string {
+  return `${(us / 1_000_000).toFixed(2)} s`;
+}
+
+function duration(interval: { start: number; end: number }): number {
+  return interval.end - interval.start;
+}
+
+/**
+ * Sweeps the leaf commands, the ones doing the actual work while their
+ * parents only wait, over `[begin, end]`.
+ */
+function parallelismOf(
+  leaves: readonly FinishedStep[],
+  begin: number,
+  end: number,
+): Parallelism {
+  // Ends sort before starts at the same time, so back-to-back steps do not
+  // count as running together.
+  const events = leaves
+    .flatMap((step) => [
+      { time: step.start, delta: 1, step },
+      { time: step.end, delta: -1, step },
+    ])
+    .sort((left, right) => left.time - right.time || left.delta - right.delta);
+
+  let running = 0;
+  let peak = 0;
+  let idleSince = begin;
+  let lastEnded: FinishedStep | undefined;
+  const gaps: IdleGap[] = [];
+  for (const event of events) {
+    if (running === 0 && event.delta > 0 && event.time > idleSince) {
+      gaps.push({
+        start: idleSince,
+        end: event.time,
+        after: lastEnded,
+        before: event.step,
+      });
+    }
+    running += event.delta;
+    peak = Math.max(peak, running);
+    if (running === 0) {
+      idleSince = event.time;
+      lastEnded = event.step;
+    }
+  }
+  if (running === 0 && end > idleSince) {
+    gaps.push({ start: idleSince, end, after: lastEnded });
+  }
+
+  const busy = leaves.reduce((sum, step) => sum + duration(step), 0);
+  return {
+    average: end > begin ? busy / (end - begin) : 0,
+    peak,
+    gaps,
+  };
+}
+
+/**
+ * Walks back from the step that finished last: below every node the chain is
+ * its latest finishing child, then the latest child finishing before that one
+ * started, and so on. Every step on it held up the end of the build.
+ */
+function criticalPathOf(tree: FlatTree<number, FinishedStep>): FinishedStep[] {
+  const walker = tree.walk();
+  const path: FinishedStep[] = [];
+  const seen = new Set<number>();
+
+  const visit = (id: number | undefined) => {
+    const children = walker
+      .children(id)
+      .filter((childId) => !seen.has(childId))
+      .map((childId) => tree.node(childId)?.content)
+      .filter((step): step is FinishedStep => step !== undefined)
+      .sort((left, right) => right.end - left.end);
+
+    const chain: FinishedStep[] = [];
+    let bound = Infinity;
+    for (const child of children) {
+      if (child.end <= bound) {
+        chain.push(child);
+        bound = child.start;
+      }
+    }
+
+    for (const step of chain.reverse()) {
+      seen.add(step.id);
+      path.push(step);
+      visit(step.id);
+    }
+  };
+
+  visit(undefined);
+  return path;
+}
+
+/**
+ * Packs the steps into as few rows as possible, so the trace shows the
+ * parallelism of the build instead of one row per command.
+ */
+function lanesOf(steps: readonly FinishedStep[]): Map<number, number> {
+  const sorted = [...steps].sort(
+    (left, right) =>
+      left.start - right.start || duration(right) - duration(left),
+  );
+  const laneEnds: number[] = [];
+  const lanes = new Map<number, number>();
+  for (const step of sorted) {
+    let lane = laneEnds.findIndex((laneEnd) => laneEnd <= step.start);
+    if (lane < 0) {
+      lane = laneEnds.length;
+      laneEnds.push(step.end);
+    } else {
+      laneEnds[lane] = step.end;
+    }
+    lanes.set(step.id, lane);
+  }
+  return lanes;
+}
+
+function traceArgs(step: FinishedStep): Record<string, unknown> {
+  const args: Record<string, unknown> = {
+    id: step.id,
+    command: step.command,
+  };
+  if (step.parent !== undefined) {
+    args.parent = step.parent;
+  }
+  if (step.code !== undefined) {
+    args.code = step.code;
+  }
+  const usage = step.usage;
+  if (usage?.userUs !== undefined && usage.systemUs !== undefined) {
+    args.cpuMs = (usage.userUs + usage.systemUs) / 1000;
+  }
+  if (usage?.maxRssKiB !== undefined) {
+    args.maxRssKiB = usage.maxRssKiB;
+  }
+  return args;
+}
+
+/**
+ * Builds a Chrome trace event document: one complete event per command on a
+ * packed lane, plus the critical path on a row of its own.
+ */
+function chromeTraceOf(
+  steps: readonly FinishedStep[],
+  critical: readonly FinishedStep[],
+  begin: number,
+  parallelism: Parallelism,
+): object {
+  const pid = 1;
+  const criticalTid = 0;
+  const lanes = lanesOf(steps);
+  let laneCount = 0;
+  for (const lane of lanes.values()) {
+    laneCount = Math.max(laneCount, lane + 1);
+  }
+
+  const events: object[] = [
+    { name: "process_name", ph: "M", pid, tid: 0, args: { name: "build" } },
+    {
+      name: "thread_name",
+      ph: "M",
+      pid,
+      tid: criticalTid,
+      args: { name: "critical path" },
+    },
+  ];
+  for (let lane = 0; lane < laneCount; ++lane) {
+    events.push({
+      name: "thread_name",
+      ph: "M",
+      pid,
+      tid: lane + 1,
+      args: { name: `lane ${lane + 1}` },
+    });
+  }
+
+  const complete = (step: FinishedStep, tid: number, cat: string) => ({
+    name: step.name,
+    cat,
+    ph: "X",
+    ts: step.start - begin,
+    dur: duration(step),
+    pid,
+    tid,
+    args: traceArgs(step),
+  });
+  for (const step of steps) {
+    events.push(complete(step, (lanes.get(step.id) ?? 0) + 1, "command"));
+  }
+  for (const step of critical) {
+    events.push(complete(step, criticalTid, "critical"));
+  }
+
+  return {
+    displayTimeUnit: "ms",
+    traceEvents: events,
+    otherData: {
+      averageParallelism: parallelism.average,
+      peakParallelism: parallelism.peak,
+      criticalPath: critical.map((step) => step.id),
+    },
+  };
+}
+
+/**
+ * Service script that records when every captured command ran and analyzes
+ * the parallelism of the build.
+ *
+ * Commands are timed with the `usage` of their process result when the
+ * runtime reports it, otherwise from the moment catter saw them. At the end it
+ * writes a Chrome trace event file, viewable in Perfetto or `chrome://tracing`,
+ * and prints the average and peak number of leaf commands running at once, the
+ * longest steps on the critical path and the gaps during which no leaf command
+ * ran at all.
+ *
+ * Output:
+ * ```txt
+ * Timeline of 3 commands over 3.60 s saved to /tmp/demo/timeline.json.
+ * Parallelism: average 0.97, peak 2.
+ * Critical path: 3 commands, leaf commands take 2.50 s of it.
+ *      2.00 s  clang++ -c a.cc
+ *      0.50 s  ld a.o b.o -o app
+ * Idle gaps of at least 100 ms: 3, 1.10 s in total.
+ *      0.50 s  at +0.00 s, before clang++ -c a.cc
+ *      0.50 s  at +2.50 s, after clang++ -c a.cc, before ld a.o b.o -o app
+ *      0.10 s  at +3.50 s, after ld a.o b.o -o app
+ * ```
+ */
+function timeline(): CatterContextService {
+  const steps = new Map<number, Step>();
+  let outputPath = "timeline.json";
+  let top = 10;
+  let minGapUs = 100_000;
+
+  return create({
+    onStart(config) {
+      const res = run(timelineCLI, config.scriptArgs);
+      if (res === undefined) {
+        config.execute = false;
+        return config;
+      }
+
+      outputPath = res.output ?? outputPath;
+      top = res.top ?? top;
+      minGapUs = (res.minGap ?? 100) * 1000;
+      return config;
+    },
+
+    onCommand(ctx) {
+      const capture = ctx.capture;
+      if (capture.isErr()) {
+        steps.set(ctx.id, {
+          id: ctx.id,
+          name: "[capture error]",
+          command: capture.error.msg,
+          start: monotonicUs(),
+        });
+        return;
+      }
+
+      const command = capture.value;
+      const argv = command.argv.length === 0 ? [command.exe] : command.argv;
+      steps.set(ctx.id, {
+        id: ctx.id,
+        parent: command.parent,
+        name: path.filename(command.exe || argv[0] || ""),
+        command: argv.map(quoteArgument).join(" "),
+        start: monotonicUs(),
+      });
+    },
+
+    onExecution(ctx) {
+      const step = steps.get(ctx.id);
+      if (step === undefined) {
+        return;
+      }
+
+      const usage = ctx.result.usage;
+      step.start = usage?.startUs ?? step.start;
+      step.end = usage?.endUs ?? monotonicUs();
+      step.code = ctx.result.code;
+      step.usage = usage;
+    },
+
+    async onFinish(result) {
+      if (result.code !== 0) {
+        println(
+          `Build failed with exit code ${result.code}. Writing a partial timeline.`,
+        );
+      }
+
+      const finished = [...steps.values()].filter(
+        (step): step is FinishedStep => step.end !== undefined,
+      );
+      if (finished.length === 0) {
+        println("No finished commands found.");
+        return;
+      }
+
+      const tree = new FlatTree<number, FinishedStep>();
+      for (const step of finished) {
+        tree.justMergeNode({
+          id: step.id,
+          parent: step.parent === undefined ? [] : [step.parent],
+          content: step,
+        });
+      }
+      tree.assemble();
+
+      // Builds run far more commands than a spread may pass as arguments.
+      let begin = finished.reduce(
+        (min, step) => Math.min(min, step.start),
+        Infinity,
+      );
+      let end = finished.reduce((max, step) => Math.max(max, step.end), 0);
+      if (result.usage !== undefined) {
+        begin = Math.min(begin, result.usage.startUs);
+        end = Math.max(end, result.usage.endUs);
+      }
+
+      const leaves = finished.filter(
+        (step) => (tree.node(step.id)?.children.length ?? 0) === 0,
+      );
+      const parallelism = parallelismOf(leaves, begin, end);
+      const critical = criticalPathOf(tree);
+
+      const trace = chromeTraceOf(finished, critical, begin, parallelism);
+      await mkdir(path.toAncestor(path.absolute(outputPath)));
+      await writeText(outputPath, JSON.stringify(trace));
+
+      println(
+        `Timeline of ${finished.length} commands over ${seconds(end - begin)} saved to ${path.absolute(outputPath)}.`,
+      );
+      const unfinished = steps.size - finished.length;
+      if (unfinished > 0) {
+        println(`${unfinished} commands never finished and are left out.`);
+      }
+      println(
+        `Parallelism: average ${parallelism.average.toFixed(2)}, peak ${parallelism.peak}.`,
+      );
+
+      const leafIds = new Set(leaves.map((step) => step.id));
+      const criticalLeaves = critical.filter((step) => leafIds.has(step.id));
+      const criticalBusy = criticalLeaves.reduce(
+        (sum, step) => sum + duration(step),
+        0,
+      );
+      println(
+        `Critical path: ${critical.length} commands, leaf commands take ${seconds(criticalBusy)} of it.`,
+      );
+      const longest = [...criticalLeaves]
+        .sort((left, right) => duration(right) - duration(left))
+        .slice(0, top);
+      for (const step of longest) {
+        println(`  ${seconds(duration(step)).padStart(9)}  ${step.command}`);
+      }
+
+      const gaps = parallelism.gaps.filter((gap) => duration(gap) >= minGapUs);
+      const idle = gaps.reduce((sum, gap) => sum + duration(gap), 0);
+      println(
+        `Idle gaps of at least ${minGapUs / 1000} ms: ${gaps.length}, ${seconds(idle)} in total.`,
+      );
+      const widest = [...gaps]
+        .sort((left, right) => duration(right) - duration(left))
+        .slice(0, top);
+      for (const gap of widest) {
+        const where = [`at +${seconds(gap.start - begin)}`];
+        if (gap.after !== undefined) {
+          where.push(`after ${gap.after.command}`);
+        }
+        if (gap.before !== undefined) {
+          where.push(`before ${gap.before.command}`);
+        }
+        println(`  ${seconds(duration(gap)).padStart(9)}  ${where.join(", ")}`);
+      }
+    },
+  });
+}
+
+register(timeline());
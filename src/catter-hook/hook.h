@@ -7,7 +7,20 @@
 
 namespace catter::proxy::hook {
 /// Run the command with catter proxy hook
+///
+/// Only descendants matching `filter` are sent back through the proxy, the others are executed
+/// directly by the hook. With `CaptureMode::NONE` the command inherits the stdio of the caller and
+/// the result carries no output.
 kota::task<data::process_result> run(data::command command,
                                      data::ipcid_t id,
+                                     data::exec_filter filter = {},
+                                     data::capture_policy capture = {},
                                      std::string proxy_path = util::get_executable_path().string());
+
+/// Replace the current process by the command with catter proxy hook, only returns by throwing.
+[[noreturn]]
+void exec(data::command command,
+          data::ipcid_t id,
+          data::exec_filter filter = {},
+          std::string proxy_path = util::get_executable_path().string());
 }  // namespace catter::proxy::hook
@@ -12,8 +12,25 @@ constexpr static char OS_DIR_SEPARATOR = '/';
 namespace catter::config::hook {
 constexpr static char KEY_CATTER_PROXY_PATH[] = "__key_catter_proxy_path_v1";
 constexpr static char KEY_CATTER_COMMAND_ID[] = "__key_catter_command_id_v1";
-constexpr static auto KEYS_TO_INJECT =
-    std::array<std::string_view, 2>{KEY_CATTER_PROXY_PATH, KEY_CATTER_COMMAND_ID};
+/// Optional, e.g. `+*gcc*:+cc:-cc1*`. Patterns are executable basename globs separated by
+/// `EXEC_FILTER_SEPARATOR`, each prefixed by `EXEC_FILTER_ALLOW` or `EXEC_FILTER_DENY`.
+constexpr static char KEY_CATTER_EXEC_FILTER[] = "__key_catter_exec_filter_v1";
+/// Endpoint of the session, the same key as `config::ipc::KEY_CATTER_IPC_ENDPOINT`.
+constexpr static char KEY_CATTER_IPC_ENDPOINT[] = "__key_catter_ipc_endpoint_v1";
+/// Environment of the injected command, the same key as `config::ipc::KEY_CATTER_ENV_BASE`.
+constexpr static char KEY_CATTER_ENV_BASE[] = "__key_catter_env_base_v1";
+/// Span directory of a traced session, the same key as `config::ipc::KEY_CATTER_TRACE_DIR`. An
+/// ordinary variable of the build environment, not one of `KEYS_TO_INJECT`.
+constexpr static char KEY_CATTER_TRACE_DIR[] = "__key_catter_trace_dir_v1";
+constexpr static auto KEYS_TO_INJECT = std::array<std::string_view, 5>{KEY_CATTER_PROXY_PATH,
+                                                                       KEY_CATTER_COMMAND_ID,
+                                                                       KEY_CATTER_EXEC_FILTER,
+                                                                       KEY_CATTER_IPC_ENDPOINT,
+                                                                       KEY_CATTER_ENV_BASE};
+
+constexpr static char EXEC_FILTER_SEPARATOR = ':';
+constexpr static char EXEC_FILTER_ALLOW = '+';
+constexpr static char EXEC_FILTER_DENY = '-';
 
 #if defined(CATTER_LINUX)
 constexpr static char KEY_PRELOAD[] = "LD_PRELOAD";
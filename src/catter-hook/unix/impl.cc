@@ -1,9 +1,12 @@
 #include <algorithm>
+#include <cerrno>
 #include <climits>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <format>
+#include <string>
+#include <vector>
 #include <dirent.h>
 #include <spawn.h>
 #include <sys/wait.h>
@@ -11,18 +14,53 @@
 #include <cpptrace/exceptions.hpp>
 
 #include "hook.h"
+#include "config/ipc.h"
 #include "unix/config.h"
 #include "util/crossplat.h"
 #include "util/data.h"
+#include "util/env_delta.h"
 #include "util/kotatsu.h"
 #include "util/log.h"
 #include "util/pipe_proxy.h"
 
 namespace catter::proxy::hook {
 
-kota::task<data::process_result> run(data::command command,
-                                     data::ipcid_t id,
-                                     std::string proxy_path) {
+namespace {
+namespace cfg = catter::config::hook;
+
+static_assert(std::string_view(cfg::KEY_CATTER_IPC_ENDPOINT) ==
+              std::string_view(config::ipc::KEY_CATTER_IPC_ENDPOINT));
+static_assert(std::string_view(cfg::KEY_CATTER_ENV_BASE) ==
+              std::string_view(config::ipc::KEY_CATTER_ENV_BASE));
+
+/// Encode the filter in the format of `KEY_CATTER_EXEC_FILTER`.
+std::string encode_exec_filter(const data::exec_filter& filter) {
+    std::string spec;
+    auto append = [&](char kind, const std::string& pattern) {
+        if(pattern.empty() || pattern.contains(cfg::EXEC_FILTER_SEPARATOR)) {
+            throw cpptrace::runtime_error(
+                std::format("Invalid exec filter pattern: \"{}\"", pattern));
+        }
+        if(!spec.empty()) {
+            spec += cfg::EXEC_FILTER_SEPARATOR;
+        }
+        spec += kind;
+        spec += pattern;
+    };
+    for(const auto& pattern: filter.allow) {
+        append(cfg::EXEC_FILTER_ALLOW, pattern);
+    }
+    for(const auto& pattern: filter.deny) {
+        append(cfg::EXEC_FILTER_DENY, pattern);
+    }
+    return spec;
+}
+
+/// Set up the environment of `command` so that it is executed with the hook library.
+void attach_hook(data::command& command,
+                 data::ipcid_t id,
+                 const data::exec_filter& filter,
+                 const std::string& proxy_path) {
     LOG_INFO("new command id is: {}", id);
 
     const auto lib_path =
@@ -34,6 +72,9 @@ kota::task<data::process_result> run(data::command command,
             std::format("Catter-Proxy Hook library not found at path: {}", lib_path.string()));
     }
 
+    // The environment as catter decided it, the base of the deltas sent by the children.
+    const auto env_base = util::encode_env_base(command.env);
+
     bool preload_injected = false;
     std::string key_preload_prefix = std::string(catter::config::hook::KEY_PRELOAD) + "=";
     for(auto& env_item: command.env) {
@@ -48,9 +89,23 @@ kota::task<data::process_result> run(data::command command,
         command.env.push_back(
             std::format("{}={}", catter::config::hook::KEY_PRELOAD, lib_path.string()));
     }
+    // The proxy inherited the session keys, which may be stale for this command.
+    std::erase_if(command.env, [](const std::string& entry) {
+        return std::ranges::any_of(cfg::KEYS_TO_INJECT, [&](std::string_view key) {
+            return entry.starts_with(key) && entry.size() > key.size() && entry[key.size()] == '=';
+        });
+    });
     command.env.push_back(std::format("{}={}", catter::config::hook::KEY_CATTER_COMMAND_ID, id));
     command.env.push_back(
         std::format("{}={}", catter::config::hook::KEY_CATTER_PROXY_PATH, proxy_path));
+    if(auto spec = encode_exec_filter(filter); !spec.empty()) {
+        command.env.push_back(
+            std::format("{}={}", catter::config::hook::KEY_CATTER_EXEC_FILTER, spec));
+    }
+    if(auto endpoint = config::ipc::pipe_name(); !endpoint.empty()) {
+        command.env.push_back(std::format("{}={}", cfg::KEY_CATTER_IPC_ENDPOINT, endpoint));
+    }
+    command.env.push_back(std::format("{}={}", cfg::KEY_CATTER_ENV_BASE, env_base));
 
     std::string cmd_for_print = "";
     for(auto& arg: command.args) {
@@ -60,16 +115,56 @@ kota::task<data::process_result> run(data::command command,
              command.executable,
              cmd_for_print);
 
+}
+}  // namespace
+
+kota::task<data::process_result> run(data::command command,
+                                     data::ipcid_t id,
+                                     data::exec_filter filter,
+                                     data::capture_policy capture,
+                                     std::string proxy_path) {
+    attach_hook(command, id, filter, proxy_path);
+
     kota::process::options opts{
         .file = command.executable,
         .args = command.args,
         .env = command.env,
         .cwd = command.cwd,
         .streams = {kota::process::stdio::inherit(),
-                    kota::process::stdio::pipe(false, true),
-                    kota::process::stdio::pipe(false, true)}
+                    output_stdio(capture.mode),
+                    output_stdio(capture.mode)}
     };
-    return catter::capture_process_result(make_process_event(opts));
+    return catter::capture_process_result(make_process_event(opts), stdout, stderr, capture);
 };
 
+void exec(data::command command,
+          data::ipcid_t id,
+          data::exec_filter filter,
+          std::string proxy_path) {
+    attach_hook(command, id, filter, proxy_path);
+
+    if(!command.cwd.empty() && ::chdir(command.cwd.c_str()) != 0) {
+        throw cpptrace::runtime_error(
+            std::format("Failed to change directory to {}: {}", command.cwd, errno));
+    }
+
+    auto to_c_strings = [](std::vector<std::string>& values) {
+        std::vector<char*> result;
+        result.reserve(values.size() + 1);
+        for(auto& value: values) {
+            result.push_back(value.data());
+        }
+        result.push_back(nullptr);
+        return result;
+    };
+    auto argv = to_c_strings(command.args);
+    auto envp = to_c_strings(command.env);
+
+    // nothing buffered by the proxy may end up lost or in the output of the target
+    std::fflush(nullptr);
+    ::execve(command.executable.c_str(), argv.data(), envp.data());
+    throw cpptrace::runtime_error(
+        std::format("Failed to exec {}: errno {}", command.executable, errno));
+}
+
 };  // namespace catter::proxy::hook
@@ -1,5 +1,6 @@
 #include "env_sanitizer.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <list>
@@ -77,4 +78,64 @@ SanitizedEnv sanitize_environment(char* const envp[]) noexcept {
 
     return env;
 }
+
+SanitizedEnv inherit_environment(char* const envp[], const Session& session) noexcept {
+    namespace cfg = catter::config::hook;
+
+    auto env = sanitize_environment(envp);
+    env.entries.pop_back();
+
+    auto push_owned = [&](std::string entry) {
+        env.owned_entries.push_back(std::move(entry));
+        env.entries.push_back(env.owned_entries.back().data());
+    };
+
+    if(!session.hook_library.empty()) {
+        auto preload = std::ranges::find_if(env.entries, [](const char* entry) {
+            return catter::env::is_entry_of(entry, cfg::KEY_PRELOAD);
+        });
+        if(preload == env.entries.end()) {
+            push_owned(cfg::LD_PRELOAD_INIT_ENTRY + session.hook_library);
+        } else {
+            env.owned_entries.push_back(std::string(*preload) + catter::config::OS_PATH_SEPARATOR +
+                                        session.hook_library);
+            *preload = env.owned_entries.back().data();
+        }
+    }
+
+    push_owned(std::string(cfg::KEY_CATTER_PROXY_PATH) + "=" + session.proxy_path);
+    push_owned(std::string(cfg::KEY_CATTER_COMMAND_ID) + "=" + session.self_id);
+    if(!session.filter.spec.empty()) {
+        push_owned(std::string(cfg::KEY_CATTER_EXEC_FILTER) + "=" + session.filter.spec);
+    }
+    if(!session.endpoint.empty()) {
+        push_owned(std::string(cfg::KEY_CATTER_IPC_ENDPOINT) + "=" + session.endpoint);
+    }
+    env.entries.push_back(nullptr);
+
+    return env;
+}
+
+SanitizedEnv proxy_environment(char* const envp[], const Session& session) noexcept {
+    namespace cfg = catter::config::hook;
+
+    auto env = sanitize_environment(envp);
+    if(session.endpoint.empty() && session.env_base.empty()) {
+        return env;
+    }
+
+    env.entries.pop_back();
+    auto push_owned = [&](std::string entry) {
+        env.owned_entries.push_back(std::move(entry));
+        env.entries.push_back(env.owned_entries.back().data());
+    };
+    if(!session.endpoint.empty()) {
+        push_owned(std::string(cfg::KEY_CATTER_IPC_ENDPOINT) + "=" + session.endpoint);
+    }
+    if(!session.env_base.empty()) {
+        push_owned(std::string(cfg::KEY_CATTER_ENV_BASE) + "=" + session.env_base);
+    }
+    env.entries.push_back(nullptr);
+    return env;
+}
 }  // namespace catter
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "session.h"
+
 namespace catter {
 
 struct SanitizedEnv {
@@ -19,4 +21,15 @@ struct SanitizedEnv {
 /// Remove envs used by hook so the target process is not affected by them.
 [[nodiscard]]
 SanitizedEnv sanitize_environment(char* const envp[]) noexcept;
+
+/// Re-attach the hook of `session` to `envp`, for commands executed without the proxy, so that
+/// their descendants are still intercepted.
+[[nodiscard]]
+SanitizedEnv inherit_environment(char* const envp[], const Session& session) noexcept;
+
+/// The environment of catter-proxy: `envp` without the hook, plus the endpoint of `session` so
+/// that the proxy reaches the right catter even when the build tool scrubbed the environment, and
+/// the environment base of `session` so that it sends catter a delta.
+[[nodiscard]]
+SanitizedEnv proxy_environment(char* const envp[], const Session& session) noexcept;
 }  // namespace catter
@@ -0,0 +1,52 @@
+#include "exec_filter.h"
+
+#include <cstring>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <fnmatch.h>
+
+#include "debug.h"
+#include "unix/config.h"
+
+namespace {
+bool matches_any(const std::vector<std::string>& patterns, const char* name) noexcept {
+    for(const auto& pattern: patterns) {
+        if(::fnmatch(pattern.c_str(), name, 0) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace
+
+namespace catter {
+
+ExecFilter ExecFilter::parse(std::string_view spec) noexcept {
+    ExecFilter filter;
+    filter.spec = spec;
+    for(auto part: spec | std::views::split(config::hook::EXEC_FILTER_SEPARATOR)) {
+        std::string_view entry(part.begin(), part.end());
+        if(entry.size() < 2) {
+            WARN("ignore malformed exec filter entry: {}", entry);
+            continue;
+        }
+        switch(entry.front()) {
+            case config::hook::EXEC_FILTER_ALLOW: filter.allow.emplace_back(entry.substr(1)); break;
+            case config::hook::EXEC_FILTER_DENY: filter.deny.emplace_back(entry.substr(1)); break;
+            default: WARN("ignore malformed exec filter entry: {}", entry); break;
+        }
+    }
+    return filter;
+}
+
+bool ExecFilter::intercepts(const char* path) const noexcept {
+    const char* slash = std::strrchr(path, config::OS_DIR_SEPARATOR);
+    const char* name = slash == nullptr ? path : slash + 1;
+    if(matches_any(this->deny, name)) {
+        return false;
+    }
+    return this->allow.empty() || matches_any(this->allow, name);
+}
+
+}  // namespace catter
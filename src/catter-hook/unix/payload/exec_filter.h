@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace catter {
+
+/**
+ * Decides which execs are sent through catter-proxy.
+ *
+ * Parsed from the value of `KEY_CATTER_EXEC_FILTER`, see `unix/config.h` for the format.
+ */
+struct ExecFilter {
+    std::string spec{};
+    std::vector<std::string> allow{};
+    std::vector<std::string> deny{};
+
+    /// Malformed entries are ignored.
+    static ExecFilter parse(std::string_view spec) noexcept;
+
+    /**
+     * Whether the exec should go through the proxy.
+     *
+     * @param path the resolved executable, only its basename is matched.
+     */
+    bool intercepts(const char* path) const noexcept;
+};
+}  // namespace catter
@@ -17,6 +17,8 @@
 #include "error.h"
 #include "session.h"
 #include "shared/resolver.h"
+#include "unix/config.h"
+#include "util/span_trace.h"
 
 namespace {
 
@@ -154,6 +156,9 @@ PosixSpawnFn* resolve_posix_spawn() {
 
 void Executor::init(const char* const envp[]) noexcept {
     m_session = Session::make(envp);
+    if(auto dir = catter::env::get_env_value(envp, config::hook::KEY_CATTER_TRACE_DIR)) {
+        trace::start("catter-hook " + get_executable_path(), dir);
+    }
 
     try {
         m_execve = resolve_execve();
@@ -290,7 +295,22 @@ int Executor::run_execve(const char* executable, const char* const argv[], char*
         throw catter::PayloadError(ENOSYS, "hook function \"execve\" not initialized");
     }
 
-    auto clean_env = catter::sanitize_environment(envp);
+    // The image is replaced on success, so the spans of this process are written out first.
+    const auto begin = trace::enabled() ? trace::now() : 0;
+    auto exec = [&](const char* path, char* const exec_argv[], char* const exec_envp[]) {
+        if(begin != 0) {
+            trace::flush_before_exec("hook.execve", begin);
+        }
+        return m_execve(path, exec_argv, exec_envp);
+    };
+
+    if(m_session.is_valid() && !m_session.filter.intercepts(executable)) {
+        INFO("execve bypasses proxy for path: {}", executable);
+        auto env = catter::inherit_environment(envp, m_session);
+        return exec(executable, const_cast<char* const*>(argv), env.data());
+    }
+
+    auto clean_env = catter::proxy_environment(envp, m_session);
     auto args = argv_span(argv);
     if(!m_session.is_valid()) {
         auto command =
@@ -299,7 +319,7 @@ int Executor::run_execve(const char* executable, const char* const argv[], char*
                                         executable,
                                         args);
 
-        return m_execve(command.path.c_str(), command.c_argv().data(), clean_env.data());
+        return exec(command.path.c_str(), command.c_argv().data(), clean_env.data());
     }
 
     auto command = build_proxy_command(m_session, executable, args);
@@ -309,7 +329,7 @@ int Executor::run_execve(const char* executable, const char* const argv[], char*
          command.path,
          c_argv[0] == nullptr ? "" : c_argv[0]);
 
-    return m_execve(command.path.c_str(), c_argv.data(), clean_env.data());
+    return exec(command.path.c_str(), c_argv.data(), clean_env.data());
 }
 
 int Executor::run_posix_spawn(pid_t* pid,
@@ -321,7 +341,19 @@ int Executor::run_posix_spawn(pid_t* pid,
     if(m_posix_spawn == nullptr) {
         throw catter::PayloadError(ENOSYS, "hook function \"posix_spawn\" not initialized");
     }
-    auto clean_env = catter::sanitize_environment(envp);
+    trace::Span span("hook.posix_spawn");
+    if(m_session.is_valid() && !m_session.filter.intercepts(executable)) {
+        INFO("posix_spawn bypasses proxy for path: {}", executable);
+        auto env = catter::inherit_environment(envp, m_session);
+        return m_posix_spawn(pid,
+                             executable,
+                             file_actions,
+                             attrp,
+                             const_cast<char* const*>(argv),
+                             env.data());
+    }
+
+    auto clean_env = catter::proxy_environment(envp, m_session);
     auto args = argv_span(argv);
     if(!m_session.is_valid()) {
         auto command =
@@ -9,6 +9,7 @@
 #include "debug.h"
 #include "executor.h"
 #include "unix/config.h"
+#include "util/span_trace.h"
 
 #define EXPORT_SYMBOL __attribute__((visibility("default")))
 
@@ -71,6 +72,7 @@ extern "C" EXPORT_SYMBOL void on_unload() {
     if(not LOADED.exchange(false))
         return;
     INFO("catter hook library unloaded");
+    catter::trace::flush();
     // TODO: cleanup code here
 
     errno = 0;
@@ -1,11 +1,30 @@
 #include "session.h"
 
+#include <ranges>
 #include <string>
+#include <string_view>
 
 #include "debug.h"
 #include "environment.h"
 #include "unix/config.h"
 
+namespace {
+std::string find_hook_library(const char* const envp[]) noexcept {
+    auto preload = catter::env::get_env_value(envp, catter::config::hook::KEY_PRELOAD);
+    if(preload == nullptr) {
+        return {};
+    }
+    std::string_view libs = preload;
+    for(auto lib: libs | std::views::split(catter::config::OS_PATH_SEPARATOR)) {
+        std::string_view lib_sv(lib.begin(), lib.end());
+        if(lib_sv.ends_with(catter::config::hook::HOOK_LIB_NAME)) {
+            return std::string(lib_sv);
+        }
+    }
+    return {};
+}
+}  // namespace
+
 namespace catter {
 
 Session Session::make(const char* const envp[]) noexcept {
@@ -29,7 +48,24 @@ Session Session::make(const char* const envp[]) noexcept {
         return session;
     }
 
-    INFO("session from env: catter_proxy={}, self_id={}", session.proxy_path, session.self_id);
+    if(auto spec = catter::env::get_env_value(envp, config::hook::KEY_CATTER_EXEC_FILTER)) {
+        session.filter = ExecFilter::parse(spec);
+    }
+    if(auto endpoint = catter::env::get_env_value(envp, config::hook::KEY_CATTER_IPC_ENDPOINT)) {
+        session.endpoint = endpoint;
+    } else {
+        WARN("catter ipc endpoint not found in environment");
+    }
+    if(auto env_base = catter::env::get_env_value(envp, config::hook::KEY_CATTER_ENV_BASE)) {
+        session.env_base = env_base;
+    }
+    session.hook_library = find_hook_library(envp);
+
+    INFO("session from env: catter_proxy={}, self_id={}, exec_filter={}, endpoint={}",
+         session.proxy_path,
+         session.self_id,
+         session.filter.spec,
+         session.endpoint);
     return session;
 }
 }  // namespace catter
@@ -2,6 +2,8 @@
 
 #include <string>
 
+#include "exec_filter.h"
+
 namespace catter {
 
 /**
@@ -12,6 +14,14 @@ namespace catter {
 struct Session {
     std::string proxy_path{};
     std::string self_id{};
+    /// Optional, every exec is intercepted when it is empty.
+    ExecFilter filter{};
+    /// Path of this library found in the preload list, used to keep bypassed execs hooked.
+    std::string hook_library{};
+    /// IPC endpoint of the catter session, handed to the proxy.
+    std::string endpoint{};
+    /// Environment of the injected command, handed to the proxy as the base of its delta.
+    std::string env_base{};
 
     static Session make(const char* const envp[]) noexcept;
 
@@ -20,8 +20,10 @@
 #include <kota/async/async.h>
 #include <kota/meta/enum.h>
 
+#include "config/ipc.h"
 #include "util/crossplat.h"
 #include "util/data.h"
+#include "util/env_delta.h"
 #include "util/exception.h"
 #include "util/kotatsu.h"
 #include "util/log.h"
@@ -255,22 +257,36 @@ kota::task<int64_t, kota::error> wait_for_process_exit(RunningProcess process,
     co_return wait_ret->status;
 }
 
-StartedProcess start_process(data::command cmd, data::ipcid_t id, std::string proxy_path) {
+StartedProcess start_process(data::command cmd,
+                             data::ipcid_t id,
+                             std::string proxy_path,
+                             bool capture) {
     auto env = std::move(cmd.env);
+    // The environment as catter decided it, the base of the deltas sent by the children.
+    auto env_base = util::encode_env_base(env);
+    upsert_environment_variable(env, config::ipc::KEY_CATTER_ENV_BASE, std::move(env_base));
     upsert_environment_variable(env, win::ENV_VAR_IPC_ID<char>, std::to_string(id));
     upsert_environment_variable(env, win::ENV_VAR_PROXY_PATH<char>, proxy_path);
+    upsert_environment_variable(env,
+                                config::ipc::KEY_CATTER_IPC_ENDPOINT,
+                                std::string(config::ipc::pipe_name()));
 
     auto env_block = build_environment_block(std::move(env));  // Double null termination
 
-    auto stdout_pipe = create_capture_pipe("stdout");
-    auto stderr_pipe = create_capture_pipe("stderr");
+    // Without capture the child writes to our own handles, nothing is relayed.
+    AnonymousPipe stdout_pipe{};
+    AnonymousPipe stderr_pipe{};
+    if(capture) {
+        stdout_pipe = create_capture_pipe("stdout");
+        stderr_pipe = create_capture_pipe("stderr");
+    }
 
     STARTUPINFOA si{
         .cb = sizeof(STARTUPINFOA),
         .dwFlags = STARTF_USESTDHANDLES,
         .hStdInput = GetStdHandle(STD_INPUT_HANDLE),
-        .hStdOutput = stdout_pipe.write.get(),
-        .hStdError = stderr_pipe.write.get(),
+        .hStdOutput = capture ? stdout_pipe.write.get() : GetStdHandle(STD_OUTPUT_HANDLE),
+        .hStdError = capture ? stderr_pipe.write.get() : GetStdHandle(STD_ERROR_HANDLE),
     };
     PROCESS_INFORMATION pi{};
 
@@ -316,18 +332,34 @@ StartedProcess start_process(data::command cmd, data::ipcid_t id, std::string pr
 }
 }  // namespace
 
-kota::task<data::process_result> run(data::command cmd, data::ipcid_t id, std::string proxy_path) {
-
+kota::task<data::process_result> run(data::command cmd,
+                                     data::ipcid_t id,
+                                     data::exec_filter /*filter*/,
+                                     data::capture_policy capture,
+                                     std::string proxy_path) {
+    // Exec filters are rejected on Windows before the session starts, see `to_exec_filter`.
     return capture_process_result(
-        [cmd, id, proxy_path](kota::event_loop& loop) mutable -> catter::process_info {
+        [cmd, id, proxy_path, capture](kota::event_loop& loop) mutable -> catter::process_info {
             LOG_INFO("new command id is: {}", id);
-            auto started = start_process(std::move(cmd), id, std::move(proxy_path));
+            const bool piped = capture.mode != data::CaptureMode::NONE;
+            auto started = start_process(std::move(cmd), id, std::move(proxy_path), piped);
+            if(!piped) {
+                return {.wait_task = wait_for_process_exit(std::move(started.process), &loop)};
+            }
 
             return {
                 .wait_task = wait_for_process_exit(std::move(started.process), &loop),
                 .stdout_pipe = open_capture_pipe(std::move(started.stdout_read), "stdout", loop),
                 .stderr_pipe = open_capture_pipe(std::move(started.stderr_read), "stderr", loop),
             };
-        });
+        },
+        stdout,
+        stderr,
+        capture);
 };
+
+void exec(data::command, data::ipcid_t, data::exec_filter, std::string) {
+    // Windows has no execve that keeps the process identity the parent waits on.
+    throw cpptrace::runtime_error("exec-through is not supported on Windows");
+}
 };  // namespace catter::proxy::hook
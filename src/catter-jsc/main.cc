@@ -0,0 +1,79 @@
+// Compiles one ES module to QuickJS bytecode at build time.
+//
+// The pack.js rule runs it for every builtin module and script, so catter loads them with
+// JS_ReadObject instead of parsing their source on each start. It links the same QuickJS
+// package as catter-core, which keeps the bytecode version in sync with the runtime.
+//
+// usage: catter-jsc <input.js> <module name> <output file>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <print>
+#include <string>
+#include <quickjs.h>
+
+namespace {
+
+void print_exception(JSContext* ctx) {
+    JSValue exception = JS_GetException(ctx);
+    const char* message = JS_ToCString(ctx, exception);
+    std::println(stderr, "catter-jsc: {}", message != nullptr ? message : "<unknown exception>");
+    JS_FreeCString(ctx, message);
+    JS_FreeValue(ctx, exception);
+}
+
+/// Compiling does not resolve imports, catter's module loader does that when the bytecode is read.
+int compile(JSContext* ctx, const std::string& source, const char* module_name, const char* out) {
+    JSValue module = JS_Eval(ctx,
+                             source.c_str(),
+                             source.size(),
+                             module_name,
+                             JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_STRICT | JS_EVAL_FLAG_COMPILE_ONLY);
+    if(JS_IsException(module)) {
+        print_exception(ctx);
+        return 1;
+    }
+
+    size_t size = 0;
+    uint8_t* bytecode = JS_WriteObject(ctx, &size, module, JS_WRITE_OBJ_BYTECODE);
+    JS_FreeValue(ctx, module);
+    if(bytecode == nullptr) {
+        print_exception(ctx);
+        return 1;
+    }
+
+    std::ofstream output(out, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(bytecode), static_cast<std::streamsize>(size));
+    js_free(ctx, bytecode);
+    if(!output) {
+        std::println(stderr, "catter-jsc: cannot write {}", out);
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if(argc != 4) {
+        std::println(stderr, "usage: catter-jsc <input.js> <module name> <output file>");
+        return 2;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if(!input) {
+        std::println(stderr, "catter-jsc: cannot read {}", argv[1]);
+        return 1;
+    }
+    std::string source{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+
+    JSRuntime* runtime = JS_NewRuntime();
+    JSContext* ctx = JS_NewContext(runtime);
+
+    int code = compile(ctx, source, argv[2], argv[3]);
+
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(runtime);
+    return code;
+}
@@ -53,6 +53,32 @@ struct Peer {
         co_return;
     }
 
+    /// Protocol v2: check mode, register and ask for a decision in one round trip. With an
+    /// `env` delta, `cmd.env` is left empty.
+    kota::task<Request<RequestType::DECIDE>::Result> decide(data::ipcid_t parent_id,
+                                                             data::command cmd,
+                                                             data::env_delta env = {}) {
+        co_return co_await this->send_request<Request<RequestType::DECIDE>>({
+            .version = data::protocol_version,
+            .mode = data::ServiceMode::INJECT,
+            .parent_id = parent_id,
+            .cmd = std::move(cmd),
+            .env = std::move(env),
+        });
+    }
+
+    /// Protocol v2: ask catter to watch `pid` before exec'ing into the injected command.
+    kota::task<bool> handover(int64_t pid) {
+        co_return co_await this->send_request<Request<RequestType::HANDOVER>>({.pid = pid});
+    }
+
+    /// Protocol v2: report the result without waiting for the script to consume it. Awaiting the
+    /// answer makes sure the result reached catter before the proxy hangs up.
+    kota::task<void> complete(data::process_result result) {
+        co_await this->send_request<Request<RequestType::COMPLETE>>(result);
+        co_return;
+    }
+
     kota::task<void> report_error(data::ipcid_t parent_id, std::string error_msg) noexcept {
         try {
             co_await this->send_request<Request<RequestType::REPORT_ERROR>>({parent_id, error_msg});
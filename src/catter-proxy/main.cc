@@ -6,6 +6,9 @@
 #include <string>
 #include <system_error>
 #include <vector>
+#ifndef CATTER_WINDOWS
+#include <unistd.h>
+#endif
 #include <cpptrace/exceptions.hpp>
 #include <kota/async/async.h>
 #include <kota/deco/deco.h>
@@ -14,12 +17,16 @@
 #include "ipc.h"
 #include "option.h"
 #include "config/catter-proxy.h"
+#include "config/ipc.h"
 #include "shared/resolver.h"
 #include "util/crossplat.h"
+#include "util/env_delta.h"
+#include "util/fake_output.h"
 #include "util/guard.h"
 #include "util/kotatsu.h"
 #include "util/log.h"
 #include "util/output.h"
+#include "util/span_trace.h"
 
 using namespace catter;
 
@@ -51,7 +58,10 @@ std::string resolve_executable(std::string_view exe, const std::vector<std::stri
 #endif
 }
 
-kota::task<data::process_result> run(data::action act, data::ipcid_t id) {
+kota::task<data::process_result> run(data::action act,
+                                     data::ipcid_t id,
+                                     data::exec_filter filter,
+                                     data::capture_policy capture) {
     using catter::data::action;
 
     switch(act.type) {
@@ -63,17 +73,26 @@ kota::task<data::process_result> run(data::action act, data::ipcid_t id) {
                 .cwd = act.cmd.cwd,
                 .creation = {.windows_hide = true, .windows_verbatim_arguments = true},
                 .streams = {kota::process::stdio::inherit(),
-                             kota::process::stdio::pipe(false, true),
-                             kota::process::stdio::pipe(false, true)}
+                             output_stdio(capture.mode),
+                             output_stdio(capture.mode)}
             };
-            co_return co_await capture_process_result(make_process_event(opts));
+            co_return co_await capture_process_result(make_process_event(opts),
+                                                      stdout,
+                                                      stderr,
+                                                      capture);
         }
         case action::INJECT: {
-            co_return co_await proxy::hook::run(act.cmd, id);
+            co_return co_await proxy::hook::run(act.cmd, id, std::move(filter), capture);
         }
         case action::DROP: {
             co_return data::process_result{.code = 0};
         }
+        case action::FAKE: {
+            for(const auto& output: act.outputs) {
+                util::write_fake_output(std::filesystem::path(act.cmd.cwd) / output);
+            }
+            co_return data::process_result{.code = 0};
+        }
         default: {
             co_return data::process_result{.code = -1};
         }
@@ -82,8 +101,17 @@ kota::task<data::process_result> run(data::action act, data::ipcid_t id) {
 
 kota::task<int> proxy_main(const catter::proxy::ProxyOption& opt) noexcept {
     auto& current = kota::event_loop::current();
+    if(config::ipc::pipe_name().empty()) {
+        LOG_CRITICAL("{} is not set, catter-proxy must be started by a catter session",
+                     config::ipc::KEY_CATTER_IPC_ENDPOINT);
+        std::abort();
+    }
+    const auto connecting = trace::enabled() ? trace::now() : 0;
     auto ret =
         co_await kota::pipe::connect(config::ipc::pipe_name(), kota::pipe::options(), current);
+    if(connecting != 0) {
+        trace::record("proxy.connect", connecting, trace::now());
+    }
     if(!ret) {
         LOG_CRITICAL("Failed to connect to IPC pipe: {}, error: {}",
                      config::ipc::pipe_name(),
@@ -119,30 +147,73 @@ kota::task<int> proxy_main(const catter::proxy::ProxyOption& opt) noexcept {
                     throw cpptrace::runtime_error("missing command arguments after --");
                 }
 
-                if(!co_await peer.check_mode(data::ServiceMode::INJECT)) {
-                    throw cpptrace::runtime_error(
-                        "catter is not in inject mode, cannot handle the request");
-                }
+                auto env = catter::util::get_environment();
+                auto env_base = util::take_env_base(env);
 
                 data::command cmd = {
                     .cwd = std::filesystem::current_path().string(),
                     .args = *opt.args,
-                    .env = catter::util::get_environment(),
                 };
 
                 if(opt.exec.has_value()) {
                     cmd.executable = *opt.exec;
                 } else {
-                    cmd.executable = resolve_executable(cmd.args.at(0), cmd.env);
+                    cmd.executable = resolve_executable(cmd.args.at(0), env);
                 }
 
-                auto id = co_await peer.create(*opt.parent_id);
+                // Send only what changed since the parent command when there is one, and in
+                // full when catter no longer knows the environment of the parent.
+                data::env_delta delta;
+                if(env_base.has_value()) {
+                    delta = util::make_env_delta(*env_base, env);
+                } else {
+                    cmd.env = env;
+                }
+                const auto deciding = trace::enabled() ? trace::now() : 0;
+                auto decision = co_await peer.decide(*opt.parent_id, cmd, std::move(delta));
+                if(decision.env_missing) {
+                    cmd.env = env;
+                    decision = co_await peer.decide(*opt.parent_id, std::move(cmd));
+                }
+                if(deciding != 0) {
+                    trace::record("proxy.decide", deciding, trace::now());
+                }
+                if(!decision.accepted) {
+                    throw cpptrace::runtime_error(
+                        "catter rejected the request: not in inject mode or protocol mismatch");
+                }
+
+                if(decision.env_unchanged) {
+                    decision.act.cmd.env = std::move(env);
+                }
 
-                auto received_act = co_await peer.make_decision(cmd);
+#ifndef CATTER_WINDOWS
+                if(decision.exec_through && decision.act.type == action::INJECT &&
+                   co_await peer.handover(::getpid())) {
+                    // catter watches this pid from now on, which becomes the target below
+                    (void)peer.close();
+                    trace::flush();
+                    try {
+                        proxy::hook::exec(std::move(decision.act.cmd),
+                                          decision.id,
+                                          std::move(decision.filter));
+                    } catch(const std::exception& e) {
+                        // The peer is closed and catter only sees this pid exit, so log the
+                        // failure and exit like a shell that cannot run the command.
+                        LOG_CRITICAL("Failed to exec through catter-proxy: {}", e.what());
+                        log::flush_logger();
+                        ::_exit(127);
+                    }
+                }
+#endif
 
-                auto result = co_await run(received_act, id);
+                trace::Span running("proxy.run");
+                auto result = co_await run(std::move(decision.act),
+                                           decision.id,
+                                           std::move(decision.filter),
+                                           decision.capture);
 
-                co_await peer.finish(std::move(result));
+                co_await peer.complete(result);
 
                 co_return static_cast<int>(result.code);
             } catch(const std::exception& e) {
@@ -170,8 +241,11 @@ kota::task<int> proxy_main(const catter::proxy::ProxyOption& opt) noexcept {
 
 // we do not output in proxy, it must be invoked by main program.
 // usage: catter-proxy.exe -p <parent ipc id> [--exec <exe path>] -- <args...>
-// TODO: act as a fake compiler
 int main(int argc, char* argv[], [[maybe_unused]] char* envp[]) {
+    const auto started = trace::now();
+    const char* trace_dir = std::getenv(config::ipc::KEY_CATTER_TRACE_DIR);
+    trace::start("catter-proxy", trace_dir == nullptr ? "" : trace_dir);
+
     try {
         log::init_logger("catter-proxy.log",
                          util::get_catter_data_path() / config::proxy::LOG_PATH_REL,
@@ -189,6 +263,8 @@ int main(int argc, char* argv[], [[maybe_unused]] char* envp[]) {
               [&](const catter::proxy::Option& opt) { cli.usage(std::cerr); })
         .match(catter::proxy::Option::Cate::proxy,
                [&](const auto& opt) {
+                   // Logger and command line, what every intercepted exec pays up front.
+                   trace::record("proxy.startup", started, trace::now());
                    auto task = proxy_main(opt.proxy_opt);
                    kota::event_loop loop;
                    loop.schedule(task);
@@ -200,5 +276,6 @@ int main(int argc, char* argv[], [[maybe_unused]] char* envp[]) {
             ret = -1;
         })
         .execute(args);
+    trace::flush();
     return ret;
 }
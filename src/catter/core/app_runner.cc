@@ -2,16 +2,63 @@
 
 #include <exception>
 #include <filesystem>
+#include <format>
 #include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>
 #include <utility>
 
 #include "option.h"
 #include "runtime_driver.h"
-#include "js/builtin_files.h"
+#include "trace_export.h"
+#include "config/catter.h"
 #include "js/js.h"
+#include "util/crossplat.h"
+#include "util/log.h"
+#include "util/span_trace.h"
 
 namespace catter::app {
 
+std::optional<std::string> record_path(const core::CatterConfig& config) {
+    if(!config.record.has_value()) {
+        return std::nullopt;
+    }
+    return std::filesystem::absolute(config.record.value()).lexically_normal().string();
+}
+
+std::filesystem::path bytecode_cache_path() {
+    return util::get_catter_data_path() / catter::config::core::BYTECODE_CACHE_PATH_REL;
+}
+
+std::filesystem::path compiler_cache_path() {
+    return util::get_catter_data_path() / catter::config::core::COMPILER_CACHE_PATH_REL;
+}
+
+/// Starts recording spans when the run is traced, into a directory of its own that every process
+/// of the session finds through the environment.
+std::optional<std::filesystem::path> start_span_trace(const core::CatterConfig& config) {
+    if(!config.trace_spans.has_value()) {
+        return std::nullopt;
+    }
+    auto dir = util::get_catter_data_path() / catter::config::core::TRACE_PATH_REL /
+               std::format("{}-{:016x}", util::get_process_id(), util::unique_id());
+    std::filesystem::create_directories(dir);
+    trace::start("catter", dir.string());
+    return dir;
+}
+
+/// Merges the spans of the session into the trace file and drops the per-process files.
+void finish_span_trace(const core::CatterConfig& config, const std::filesystem::path& dir) {
+    trace::stop();
+    const auto output = std::filesystem::absolute(config.trace_spans.value());
+    const auto count = core::export_chrome_trace(dir, output);
+    LOG_INFO("Wrote {} spans to {}", count, output.string());
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
 struct RunContext {
     js::CatterConfig script_config;
     std::filesystem::path working_directory;
@@ -31,6 +78,7 @@ struct RunContext {
                         {
                             .log = config.log,
                             .stdioMode = config.stdio_mode.value(),
+                            .record = record_path(config),
                         }, .execute = true,
                                 },
             .working_directory = config.working_dir->path,
@@ -52,20 +100,21 @@ kota::task<> async_run(const core::CatterConfig& config) {
     auto context = RunContext::make(config);
 
     js::RuntimeScope runtime;
+    std::optional<std::filesystem::path> span_dir;
     std::exception_ptr error;
     try {
-        runtime.start({.pwd = context.working_directory});
+        span_dir = start_span_trace(config);
+        runtime.start({
+            .pwd = context.working_directory,
+            .api_trace_sampling = config.trace_api.value(),
+            .bytecode_cache = bytecode_cache_path(),
+            .compiler_cache = compiler_cache_path(),
+        });
 
         auto& script_path = context.script_config.scriptPath;
 
         if(script_path.starts_with("script::")) {
-            const auto source = js::load_builtin_script(script_path);
-            if(source.empty()) {
-                throw cpptrace::runtime_error(
-                    std::format("Unknown builtin script '{}'", context.script_config.scriptPath));
-            }
-
-            co_await js::run_script(source, script_path);
+            co_await js::run_builtin_script(script_path);
         } else {
 
             auto script_absolute_path =
@@ -87,6 +136,16 @@ kota::task<> async_run(const core::CatterConfig& config) {
 
     co_await runtime.stop();
 
+    if(span_dir.has_value()) {
+        try {
+            finish_span_trace(config, *span_dir);
+        } catch(...) {
+            if(!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
     if(error) {
         std::rethrow_exception(error);
     }
@@ -0,0 +1,60 @@
+#include "env_table.h"
+
+#include <iterator>
+#include <utility>
+
+#include "util/env_delta.h"
+
+namespace catter::ipc {
+
+void EnvTable::touch(Entry& entry) {
+    this->uses.splice(this->uses.end(), this->uses, entry.use);
+}
+
+void EnvTable::intern(uint64_t hash, Env env) {
+    if(auto it = this->envs.find(hash); it != this->envs.end()) {
+        it->second.env = std::move(env);
+        touch(it->second);
+        return;
+    }
+
+    this->uses.push_back(hash);
+    this->envs.emplace(hash, Entry{std::move(env), std::prev(this->uses.end())});
+    if(this->uses.size() > max_envs) {
+        this->envs.erase(this->uses.front());
+        this->uses.pop_front();
+    }
+}
+
+EnvTable::Env EnvTable::find(uint64_t hash) {
+    auto it = this->envs.find(hash);
+    if(it == this->envs.end()) {
+        return nullptr;
+    }
+    touch(it->second);
+    return it->second.env;
+}
+
+EnvTable::Env EnvTable::resolve(const data::env_delta& delta) {
+    auto base = this->find(delta.base);
+    if(!base) {
+        return nullptr;
+    }
+    if(delta.hash == delta.base && delta.removed.empty() && delta.added.empty()) {
+        return base;
+    }
+
+    auto env = util::apply_env_delta(*base, delta);
+    if(!env) {
+        return nullptr;
+    }
+    // Only share an interned environment with equal entries, in case two hashes collide.
+    if(auto known = this->find(delta.hash); known && *known == *env) {
+        return known;
+    }
+    auto interned = std::make_shared<const std::vector<std::string>>(std::move(*env));
+    this->intern(delta.hash, interned);
+    return interned;
+}
+
+}  // namespace catter::ipc
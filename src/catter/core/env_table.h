@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "util/data.h"
+
+namespace catter::ipc {
+
+/**
+ * The environments of one session, interned by `util::env_hash`.
+ *
+ * Nearly every command of a build runs with the environment of its parent, so the proxies send a
+ * delta against it (`data::env_delta`) and the table rebuilds the environment from the interned
+ * one. Environments are shared, an interned one is never copied to be looked up. The table keeps
+ * the `max_envs` most recently used environments only, a proxy whose base was evicted is asked
+ * for its environment in full.
+ */
+class EnvTable {
+public:
+    using Env = std::shared_ptr<const std::vector<std::string>>;
+
+    constexpr static size_t max_envs = 1024;
+
+    /// Interns `env` under `hash`, which must be `util::env_hash(*env)`.
+    void intern(uint64_t hash, Env env);
+
+    /// nullptr when no environment with `hash` is interned, a hit counts as a use.
+    Env find(uint64_t hash);
+
+    /// Rebuilds the environment `delta` describes, nullptr when its base is unknown or the
+    /// result does not match its hash.
+    Env resolve(const data::env_delta& delta);
+
+    size_t size() const {
+        return envs.size();
+    }
+
+private:
+    struct Entry {
+        Env env;
+        std::list<uint64_t>::iterator use;
+    };
+
+    /// Moves `entry` to the back of `uses`.
+    void touch(Entry& entry);
+
+    std::unordered_map<uint64_t, Entry> envs;
+    /// Least recently used first, the front is evicted first.
+    std::list<uint64_t> uses;
+};
+
+}  // namespace catter::ipc
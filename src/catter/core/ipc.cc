@@ -7,6 +7,7 @@
 #include <new>
 #include <optional>
 #include <print>
+#include <string>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -16,14 +17,22 @@
 #include <kota/meta/enum.h>
 #include <kota/ipc/codec/bincode.h>
 
+#include "process_watcher.h"
 #include "util/data.h"
 #include "util/enum.h"
+#include "util/env_delta.h"
 #include "util/log.h"
+#include "util/span_trace.h"
 
 namespace catter::ipc {
 using namespace data;
 
-kota::task<void> accept(std::unique_ptr<InjectService> service, kota::pipe client) {
+kota::task<void> accept(std::unique_ptr<InjectService> service,
+                        kota::pipe client,
+                        std::shared_ptr<EnvTable> envs) {
+    if(!envs) {
+        envs = std::make_shared<EnvTable>();
+    }
     kota::ipc::BincodePeer peer(kota::event_loop::current(),
                                 std::make_unique<kota::ipc::StreamTransport>(std::move(client)));
     using Context = kota::ipc::BincodePeer::RequestContext;
@@ -53,6 +62,115 @@ kota::task<void> accept(std::unique_ptr<InjectService> service, kota::pipe clien
             co_return nullptr;
         });
 
+    peer.on_request<Request<RequestType::DECIDE>>(
+        [&](const Context& ctx, const Request<RequestType::DECIDE>::Params& params)
+            -> kota::ipc::RequestResult<Request<RequestType::DECIDE>> {
+            using Result = Request<RequestType::DECIDE>::Result;
+            const auto begin = trace::enabled() ? trace::now() : 0;
+            auto reject = [](bool env_missing) {
+                return Result{
+                    .accepted = false,
+                    .id = 0,
+                    .act = {},
+                    .filter = {},
+                    .exec_through = false,
+                    .capture = {},
+                    .env_missing = env_missing,
+                    .env_unchanged = false,
+                };
+            };
+            if(params.version != data::protocol_version ||
+               params.mode != data::ServiceMode::INJECT) {
+                LOG_WARN("Rejecting proxy with protocol version {} in mode {}",
+                         params.version,
+                         static_cast<int>(params.mode));
+                co_return reject(false);
+            }
+
+            auto cmd = params.cmd;
+            uint64_t request_hash = 0;
+            EnvTable::Env env;
+            if(params.env.hash != 0) {
+                env = envs->resolve(params.env);
+                if(!env) {
+                    LOG_INFO("Unknown environment base {:016x}, asking for the full environment",
+                             params.env.base);
+                    co_return reject(true);
+                }
+                request_hash = params.env.hash;
+                cmd.env = *env;
+            }
+
+            auto id = co_await service->create(params.parent_id);
+            auto act = co_await service->make_decision(std::move(cmd));
+
+            // The environment an injected command runs with is the base of its children.
+            bool env_unchanged = false;
+            if(act.type == data::action::INJECT) {
+                const auto decided = util::env_hash(act.cmd.env);
+                if(!env) {
+                    request_hash = util::env_hash(params.cmd.env);
+                }
+                env_unchanged = decided == request_hash;
+                if(env_unchanged && env) {
+                    envs->intern(decided, std::move(env));
+                } else {
+                    envs->intern(decided,
+                                 std::make_shared<const std::vector<std::string>>(act.cmd.env));
+                }
+                if(env_unchanged) {
+                    act.cmd.env.clear();
+                }
+            }
+            if(begin != 0) {
+                trace::record("ipc.decide", begin, trace::now(), static_cast<uint32_t>(id));
+            }
+            co_return Result{
+                .accepted = true,
+                .id = id,
+                .act = std::move(act),
+                .filter = service->exec_filter(),
+                .exec_through = service->exec_through(),
+                .capture = service->capture_policy(),
+                .env_missing = false,
+                .env_unchanged = env_unchanged,
+            };
+        });
+
+    // COMPLETE is answered before the script runs, so the proxy exits without waiting for it. The
+    // service outlives the peer, hence on_execution runs once the proxy has hung up.
+    std::optional<kota::task<>> pending_finish;
+
+    // After HANDOVER the proxy becomes the target process, its exit is observed from here.
+    peer.on_request<Request<RequestType::HANDOVER>>(
+        [&](const Context& ctx, const Request<RequestType::HANDOVER>::Params& params)
+            -> kota::ipc::RequestResult<Request<RequestType::HANDOVER>> {
+            if(!service->exec_through() || pending_finish.has_value()) {
+                co_return false;
+            }
+            auto watcher = ProcessWatcher::open(params.pid);
+            if(!watcher.has_value()) {
+                LOG_WARN("Cannot watch process {}, proxy falls back to spawning", params.pid);
+                co_return false;
+            }
+            pending_finish.emplace(
+                [](InjectService& service, ProcessWatcher watcher) -> kota::task<> {
+                    co_await service.finish(co_await watcher.wait());
+                }(*service, std::move(*watcher)));
+            co_return true;
+        });
+
+    peer.on_request<Request<RequestType::COMPLETE>>(
+        [&](const Context& ctx, const Request<RequestType::COMPLETE>::Params& params)
+            -> kota::ipc::RequestResult<Request<RequestType::COMPLETE>> {
+            if(pending_finish.has_value()) {
+                LOG_WARN("Ignoring duplicated completion");
+                co_return nullptr;
+            }
+            pending_finish.emplace(service->finish(params));
+            co_return nullptr;
+        });
+
     peer.on_request<Request<RequestType::REPORT_ERROR>>(
         [&](const Context& ctx, const Request<RequestType::REPORT_ERROR>::Params& params)
             -> kota::ipc::RequestResult<Request<RequestType::REPORT_ERROR>> {
@@ -62,6 +180,9 @@ kota::task<void> accept(std::unique_ptr<InjectService> service, kota::pipe clien
 
     co_await peer.run();
     LOG_INFO("IPC peer disconnected");
+    if(pending_finish.has_value()) {
+        co_await std::move(*pending_finish);
+    }
     co_return;
 }
 
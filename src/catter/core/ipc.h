@@ -2,6 +2,7 @@
 #include <memory>
 #include <kota/async/async.h>
 
+#include "env_table.h"
 #include "util/data.h"
 
 namespace catter::ipc {
@@ -29,8 +30,27 @@ public:
     virtual kota::task<data::action> make_decision(data::command cmd) noexcept = 0;
     virtual kota::task<> finish(data::process_result result) noexcept = 0;
     virtual kota::task<> report_error(ipcid_t parent_id, std::string error_msg) noexcept = 0;
+
+    /// Filter handed to the hook of injected commands, intercepting everything by default.
+    virtual data::exec_filter exec_filter() const {
+        return {};
+    }
+
+    /// Whether injected commands may be exec'd by the proxy, see `RequestType::HANDOVER`.
+    virtual bool exec_through() const {
+        return false;
+    }
+
+    /// Capture policy of the command, valid once `make_decision` has completed.
+    virtual data::capture_policy capture_policy() const {
+        return {};
+    }
 };
 
-kota::task<void> accept(std::unique_ptr<InjectService> service, kota::pipe client);
+/// Serves one proxy. `envs` holds the environments of the session, the bases of the environment
+/// deltas the proxies send. Without it the client gets a table of its own.
+kota::task<void> accept(std::unique_ptr<InjectService> service,
+                        kota::pipe client,
+                        std::shared_ptr<EnvTable> envs = nullptr);
 
 }  // namespace catter::ipc
@@ -1,5 +1,11 @@
 #include "apitool.h"
 
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <string>
+#include <vector>
+
 #include "js.h"
 
 namespace catter::apitool {
@@ -9,6 +15,41 @@ std::vector<api_register>& api_registers() {
     static std::vector<api_register> registers{};
     return registers;
 }
+
+std::vector<ApiCounter*>& api_counters() {
+    static std::vector<ApiCounter*> counters{};
+    return counters;
+}
+
+void reset_api_counters() noexcept {
+    for(auto* counter: api_counters()) {
+        counter->calls = 0;
+        counter->timed = 0;
+        counter->elapsed = {};
+    }
+}
+
+std::string format_api_counters() {
+    std::vector<const ApiCounter*> called;
+    for(const auto* counter: api_counters()) {
+        if(counter->calls != 0) {
+            called.push_back(counter);
+        }
+    }
+    std::ranges::sort(called, [](const ApiCounter* lhs, const ApiCounter* rhs) {
+        return lhs->estimated() > rhs->estimated();
+    });
+
+    std::string text;
+    for(const auto* counter: called) {
+        auto micros = std::chrono::duration<double, std::micro>(counter->estimated()).count();
+        text += std::format("\n    {:<40} calls = {:<10} total ~ {:.1f}us",
+                            counter->name,
+                            counter->calls,
+                            micros);
+    }
+    return text;
+}
 }  // namespace catter::apitool
 
 namespace catter::capi::util {
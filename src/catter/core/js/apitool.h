@@ -1,4 +1,6 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <format>
 #include <string>
@@ -22,6 +24,40 @@ using api_register = void (*)(const catter::qjs::CModule&, const catter::qjs::Co
 
 std::vector<api_register>& api_registers();
 
+/// Time one of every N calls of each C API, the others are only counted.
+constexpr uint64_t api_timing_every = 16;
+
+/// Call count of one C API, and the native time of the calls that were timed.
+struct ApiCounter {
+    std::string_view name;
+    uint64_t calls = 0;
+    uint64_t timed = 0;
+    std::chrono::nanoseconds elapsed{};
+
+    /// Native time of all calls, extrapolated from the timed ones.
+    std::chrono::nanoseconds estimated() const noexcept {
+        return timed == 0 ? std::chrono::nanoseconds{} : elapsed / timed * calls;
+    }
+};
+
+/// Counters of every C API called at least once since the last `reset_api_counters`.
+std::vector<ApiCounter*>& api_counters();
+
+void reset_api_counters() noexcept;
+
+/// One line per called C API, the most expensive first.
+std::string format_api_counters();
+
+namespace detail {
+/// Trace one of every N calls of each C API, 0 disables tracing.
+inline uint32_t trace_every = 0;
+}  // namespace detail
+
+/// Selects the sampling of the C API trace channel, 0 (the default) turns it off.
+inline void set_api_trace_sampling(uint32_t every) noexcept {
+    detail::trace_every = every;
+}
+
 template <typename T>
 std::string serialize_value(const T& value) {
     using U = std::remove_cvref_t<T>;
@@ -57,6 +93,16 @@ constexpr std::string_view capi_name() {
     return std::string_view{name.data(), name.size()};
 }
 
+template <auto V>
+ApiCounter& api_counter() {
+    static ApiCounter& counter = []() -> ApiCounter& {
+        static ApiCounter instance{.name = capi_name<V>()};
+        api_counters().push_back(&instance);
+        return instance;
+    }();
+    return counter;
+}
+
 template <auto V, typename Sign = std::remove_pointer_t<decltype(V)>>
 struct hooked {
     static_assert(kota::dependent_false<Sign>, "Unsupported function signature for hooking");
@@ -88,17 +134,45 @@ static R invoke_with_log(const std::string& args_s, CallArgs&&... call_args) {
     }
 }
 
+/// Counts every call, formats arguments only for the traced ones and reads the clock only for one
+/// of every `api_timing_every` calls. Traced calls are not timed, logging would skew the total.
+template <auto V, typename R, typename... CallArgs>
+static R invoke_counted(const auto& serialize, CallArgs&&... call_args) {
+    auto& counter = api_counter<V>();
+    const auto call = counter.calls++;
+    if(detail::trace_every != 0 && call % detail::trace_every == 0) {
+        return invoke_with_log<V, R>(serialize(), std::forward<CallArgs>(call_args)...);
+    }
+    if(call % api_timing_every != api_timing_every - 1) {
+        return V(std::forward<CallArgs>(call_args)...);
+    }
+
+    struct ElapsedGuard {
+        ApiCounter& counter;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        ~ElapsedGuard() {
+            counter.elapsed += std::chrono::steady_clock::now() - start;
+            ++counter.timed;
+        }
+    } guard{counter};
+    return V(std::forward<CallArgs>(call_args)...);
+}
+
 template <auto V, typename R, typename... Args>
 struct hooked<V, R(Args...)> {
     static R call(Args... args) {
-        return invoke_with_log<V, R>(serialize_args(args...), std::forward<Args>(args)...);
+        return invoke_counted<V, R>([&] { return serialize_args(args...); },
+                                    std::forward<Args>(args)...);
     }
 };
 
 template <auto V, typename R, typename... Args>
 struct hooked<V, R(JSContext*, Args...)> {
     static R call(JSContext* ctx, Args... args) {
-        return invoke_with_log<V, R>(serialize_args(args...), ctx, std::forward<Args>(args)...);
+        return invoke_counted<V, R>([&] { return serialize_args(args...); },
+                                    ctx,
+                                    std::forward<Args>(args)...);
     }
 };
 
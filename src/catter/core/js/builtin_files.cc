@@ -27,14 +27,18 @@ uint32_t read_u32(const char*& cursor, const char* end) {
     return value;
 }
 
+/// Set in the blob flags when every content is QuickJS module bytecode.
+constexpr uint32_t blob_flag_bytecode = 1;
+
 struct BuiltinTable {
     std::unordered_map<std::string, std::string_view> entries;
+    bool bytecode = false;
 };
 
 /**
  * Parses an embedded blob once.
  *
- * Layout (little-endian): u32 count, then per entry:
+ * Layout (little-endian): u32 count, u32 flags, then per entry:
  *   u32 name_len, name bytes, u32 content_len, content bytes.
  * All views point into the blob, which lives for the process lifetime.
  */
@@ -42,6 +46,7 @@ BuiltinTable parse_blob(const char* start, const char* end) {
     BuiltinTable table;
     const char* cursor = start;
     const uint32_t count = read_u32(cursor, end);
+    table.bytecode = (read_u32(cursor, end) & blob_flag_bytecode) != 0;
     for(uint32_t i = 0; i < count; ++i) {
         const uint32_t name_len = read_u32(cursor, end);
         if(name_len == 0 || cursor + name_len > end) {
@@ -102,4 +107,8 @@ std::string_view load_builtin_script(std::string_view script_name) {
     return {};
 }
 
+bool builtin_files_are_bytecode() {
+    return builtin_files().modules.bytecode;
+}
+
 }  // namespace catter::js
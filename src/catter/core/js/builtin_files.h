@@ -16,4 +16,10 @@ std::string_view load_builtin_module(std::string_view module_name);
  */
 std::string_view load_builtin_script(std::string_view script_name);
 
+/**
+ * Whether the builtin modules and scripts were packed as QuickJS module
+ * bytecode (the `js-bytecode` build option) instead of source.
+ */
+bool builtin_files_are_bytecode();
+
 }  // namespace catter::js
@@ -0,0 +1,184 @@
+#include "bytecode_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <quickjs.h>
+
+#include "util/crossplat.h"
+#include "util/log.h"
+
+namespace catter::js {
+
+namespace {
+
+/// Bump when the entry layout changes.
+constexpr uint32_t cache_format = 1;
+constexpr std::array<char, 8> cache_magic = {'C', 'A', 'T', 'T', 'E', 'R', 'B', 'C'};
+
+/**
+ * Entry layout (native endian, the cache never leaves the machine):
+ *   magic, u32 format, u32 reserved, u64 key, u64 source size, u64 bytecode hash, bytecode.
+ */
+struct EntryHeader {
+    std::array<char, 8> magic = cache_magic;
+    uint32_t format = cache_format;
+    uint32_t reserved = 0;
+    uint64_t key = 0;
+    uint64_t source_size = 0;
+    uint64_t bytecode_hash = 0;
+};
+
+constexpr uint64_t fnv_offset = 0xcbf29ce484222325ULL;
+
+uint64_t fnv1a(std::string_view bytes, uint64_t hash = fnv_offset) {
+    for(unsigned char byte: bytes) {
+        hash = (hash ^ byte) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t entry_key(std::string_view source, std::string_view module_name) {
+    auto hash = fnv1a(JS_GetVersion());
+    hash = fnv1a(std::string_view("\0", 1), hash);
+    hash = fnv1a(module_name, hash);
+    hash = fnv1a(std::string_view("\0", 1), hash);
+    return fnv1a(source, hash);
+}
+
+std::optional<std::string> read_entry(const std::filesystem::path& path,
+                                      uint64_t key,
+                                      uint64_t source_size) {
+    std::ifstream input(path, std::ios::binary);
+    if(!input) {
+        return std::nullopt;
+    }
+
+    EntryHeader header;
+    if(!input.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+       header.magic != cache_magic || header.format != cache_format || header.key != key ||
+       header.source_size != source_size) {
+        return std::nullopt;
+    }
+
+    std::string bytecode{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+    if(bytecode.empty() || fnv1a(bytecode) != header.bytecode_hash) {
+        return std::nullopt;
+    }
+    return bytecode;
+}
+
+void write_entry(const std::filesystem::path& path,
+                 uint64_t key,
+                 uint64_t source_size,
+                 std::string_view bytecode) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if(ec) {
+        LOG_WARN("Cannot create bytecode cache directory {}: {}",
+                 path.parent_path().string(),
+                 ec.message());
+        return;
+    }
+
+    auto temp = path;
+    temp += std::format(".{:016x}.tmp", util::unique_id());
+    {
+        EntryHeader header{
+            .key = key,
+            .source_size = source_size,
+            .bytecode_hash = fnv1a(bytecode),
+        };
+        std::ofstream output(temp, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(bytecode.data(), static_cast<std::streamsize>(bytecode.size()));
+        if(!output) {
+            LOG_WARN("Cannot write bytecode cache entry {}", temp.string());
+            output.close();
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(temp, path, ec);
+    if(ec) {
+        LOG_WARN("Cannot store bytecode cache entry {}: {}", path.string(), ec.message());
+        std::filesystem::remove(temp, ec);
+    }
+}
+
+}  // namespace
+
+BytecodeCache::BytecodeCache(std::filesystem::path directory,
+                             uint64_t max_bytes,
+                             std::chrono::hours max_age) :
+    dir(std::move(directory)), max_bytes(max_bytes), max_age(max_age) {}
+
+std::string BytecodeCache::module_bytecode(const qjs::Context& ctx,
+                                           std::string_view source,
+                                           std::string_view module_name) {
+    const auto key = entry_key(source, module_name);
+    const auto path = dir / std::format("{:016x}.qjsbc", key);
+
+    if(auto cached = read_entry(path, key, source.size())) {
+        ++counters.hits;
+        std::error_code ec;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+        return std::move(*cached);
+    }
+
+    ++counters.misses;
+    auto bytecode = ctx.compile_module(source, std::string(module_name).c_str());
+    write_entry(path, key, source.size(), bytecode);
+    return bytecode;
+}
+
+size_t BytecodeCache::prune() const {
+    struct File {
+        std::filesystem::path path;
+        std::filesystem::file_time_type time;
+        uintmax_t size;
+    };
+
+    std::vector<File> files;
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(dir, ec);
+    for(; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code entry_ec;
+        if(!it->is_regular_file(entry_ec)) {
+            continue;
+        }
+        const auto size = it->file_size(entry_ec);
+        const auto time = it->last_write_time(entry_ec);
+        if(!entry_ec) {
+            files.push_back({it->path(), time, size});
+        }
+    }
+    if(ec && ec != std::errc::no_such_file_or_directory) {
+        LOG_WARN("Cannot list bytecode cache directory {}: {}", dir.string(), ec.message());
+    }
+
+    // Newest first, everything past the budget goes.
+    std::ranges::sort(files, std::ranges::greater{}, &File::time);
+    const auto cutoff = std::filesystem::file_time_type::clock::now() - max_age;
+    uint64_t kept = 0;
+    size_t removed = 0;
+    for(const auto& file: files) {
+        kept += file.size;
+        if(file.time >= cutoff && kept <= max_bytes) {
+            continue;
+        }
+        std::error_code remove_ec;
+        removed += std::filesystem::remove(file.path, remove_ec) ? 1 : 0;
+    }
+    return removed;
+}
+
+}  // namespace catter::js
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "qjs.h"
+#include "capi/type.h"
+
+namespace catter::js {
+
+/**
+ * On-disk cache of compiled module bytecode, used for user scripts and the files they import.
+ *
+ * Entries are keyed by a hash of the QuickJS version, the module name (relative imports are
+ * resolved against it) and the source, so an edited file or a catter built against another
+ * QuickJS simply misses. Entries are written through a temporary file and renamed into place,
+ * and a broken or foreign entry is treated as a miss, so concurrent catter runs can share one
+ * directory. Failing to write the cache is logged and never fails the script.
+ *
+ * A hit refreshes the modification time of its entry, so `prune` can tell entries in use from
+ * those of scripts long gone.
+ */
+class BytecodeCache {
+public:
+    constexpr static uint64_t default_max_bytes = 256 * 1024 * 1024;
+    constexpr static std::chrono::hours default_max_age{24 * 30};
+
+    explicit BytecodeCache(std::filesystem::path directory,
+                           uint64_t max_bytes = default_max_bytes,
+                           std::chrono::hours max_age = default_max_age);
+
+    /// Bytecode of `source` compiled as module `module_name`, read from the cache when possible.
+    std::string module_bytecode(const qjs::Context& ctx,
+                                std::string_view source,
+                                std::string_view module_name);
+
+    const std::filesystem::path& directory() const noexcept {
+        return dir;
+    }
+
+    BytecodeCacheStats stats() const noexcept {
+        return counters;
+    }
+
+    /// Removes the files under the directory, subdirectories included, not used for `max_age`,
+    /// then the least recently used ones until the rest fits in `max_bytes`. Returns how many
+    /// files were removed. `RuntimeScope::stop` calls it, off the startup path.
+    size_t prune() const;
+
+private:
+    std::filesystem::path dir;
+    uint64_t max_bytes;
+    std::chrono::hours max_age;
+    BytecodeCacheStats counters{};
+};
+
+}  // namespace catter::js
@@ -0,0 +1,61 @@
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "type.h"
+#include "../apitool.h"
+#include "../compiler_identify.h"
+#include "../compiler_probe.h"
+#include "../qjs.h"
+
+namespace {
+
+using namespace catter;
+
+/// Identifies the builtin compiler of `exe`, or of `argv0` when `exe` is unknown and `argv0`
+/// is not empty. Answers are memoized for the session.
+CTX_CAPI(compiler_identify, (JSContext * ctx, std::string exe, std::string argv0)->qjs::Object) {
+    return js::compiler_identify_cache().identify(exe, argv0).to_object(ctx);
+}
+
+/// Probes `compiler` for its target, builtin includes and predefined macros as it would compile
+/// `language` with the command line `args` in the environment `env`. Only the flags that matter
+/// are part of the key, so a build with thousands of commands spawns each compiler a handful of
+/// times at most.
+CTX_ASYNC_CAPI(compiler_probe,
+               (JSContext * ctx,
+                std::string compiler,
+                std::string language,
+                qjs::Object args,
+                qjs::Object env)
+                   ->JsTask<qjs::Object>) {
+    auto strings = [](qjs::Object array) {
+        std::vector<std::string> out;
+        auto len = array["length"].as<uint32_t>();
+        out.reserve(len);
+        for(uint32_t i = 0; i < len; ++i) {
+            out.push_back(array[std::to_string(i)].as<std::string>());
+        }
+        return out;
+    };
+    auto argv = strings(std::move(args));
+
+    std::string error;
+    try {
+        auto probe = co_await js::compiler_probe_cache().probe(std::move(compiler),
+                                                               std::move(language),
+                                                               js::probe_flags(argv),
+                                                               strings(std::move(env)));
+        co_return probe.to_object(ctx);
+    } catch(const std::exception& ex) {
+        error = ex.what();
+    }
+    co_await kota::fail(qjs::Error::internal_error(ctx, "{}", error));
+}
+
+/// Probe, disk and memo counters of the session's compiler probe cache.
+CTX_CAPI(compiler_probe_stats, (JSContext * ctx)->qjs::Object) {
+    return js::compiler_probe_cache().stats().to_object(ctx);
+}
+
+}  // namespace
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <string>
@@ -7,6 +8,7 @@
 
 #include "bridge.h"
 #include "../apitool.h"
+#include "../http_server.h"
 
 namespace qjs = catter::qjs;
 
@@ -203,4 +205,58 @@ CTX_ASYNC_CAPI(http_request,
                                     std::move(proxy_url));
 }
 
+int64_t http_server_id_cnt = 1;
+
+catter::js::HttpServer& server_by_id(int64_t server_id) {
+    auto& servers = catter::js::http_servers();
+    auto it = servers.find(server_id);
+    if(it == servers.end()) {
+        throw qjs::Exception("Invalid HTTP server id: " + std::to_string(server_id));
+    }
+    return *it->second;
+}
+
+CAPI(http_server_listen, (std::string host, int32_t port)->int64_t) {
+    auto server = catter::js::HttpServer::listen(host, port);
+    auto id = http_server_id_cnt++;
+    catter::js::http_servers().emplace(id, std::move(server));
+    return id;
+}
+
+CAPI(http_server_port, (int64_t server_id)->int32_t) {
+    return server_by_id(server_id).port();
+}
+
+CAPI(http_server_route,
+     (int64_t server_id, std::string path, std::string content_type, std::string body)->void) {
+    server_by_id(server_id).route(std::move(path), std::move(content_type), std::move(body));
+}
+
+CAPI(http_server_stream, (int64_t server_id, std::string path, int32_t history)->void) {
+    server_by_id(server_id).stream(std::move(path), static_cast<size_t>(std::max(history, 0)));
+}
+
+CAPI(http_server_publish,
+     (int64_t server_id, std::string path, std::string event, std::string data)->void) {
+    server_by_id(server_id).publish(path, event, data);
+}
+
+CAPI(http_server_end, (int64_t server_id, std::string path)->void) {
+    server_by_id(server_id).end(path);
+}
+
+CAPI(http_server_subscribers, (int64_t server_id, std::string path)->int64_t) {
+    return static_cast<int64_t>(server_by_id(server_id).subscribers(path));
+}
+
+CAPI(http_server_close, (int64_t server_id)->void) {
+    auto& servers = catter::js::http_servers();
+    auto it = servers.find(server_id);
+    if(it == servers.end()) {
+        throw qjs::Exception("Invalid HTTP server id: " + std::to_string(server_id));
+    }
+    it->second->close();
+    servers.erase(it);
+}
+
 }  // namespace
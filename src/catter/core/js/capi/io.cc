@@ -1,8 +1,10 @@
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
+#include <memory>
 #include <print>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "../apitool.h"
@@ -35,18 +37,100 @@ CAPI(stdout_print_blue, (const std::string content)->void) {
 // file read / write
 // notice that we have ensure that is in single thread
 namespace {
+/// Large enough that `std::getline` scans most lines with a single memchr over the get area.
+constexpr size_t file_buffer_size = 1 << 20;
+
+struct OpenFile {
+    std::unique_ptr<char[]> buffer;
+    std::fstream stream;
+};
+
 static int64_t file_id_cnt = 1;
-static std::unordered_map<int64_t, std::fstream> open_files;
+static std::unordered_map<int64_t, OpenFile> open_files;
+
+/// Text read as "ascii" maps every byte to the code unit of the same value, like
+/// `String.fromCharCode`, while JS strings are made from UTF-8.
+std::string latin1_to_utf8(std::string_view bytes) {
+    std::string text;
+    text.reserve(bytes.size());
+    for(char c: bytes) {
+        auto byte = static_cast<unsigned char>(c);
+        if(byte < 0x80) {
+            text += c;
+        } else {
+            text += static_cast<char>(0xc0 | (byte >> 6));
+            text += static_cast<char>(0x80 | (byte & 0x3f));
+        }
+    }
+    return text;
+}
+
+std::string utf8_to_latin1(std::string_view text) {
+    std::string bytes;
+    bytes.reserve(text.size());
+    for(size_t index = 0; index < text.size(); ++index) {
+        auto byte = static_cast<unsigned char>(text[index]);
+        if((byte & 0xe0) == 0xc0 && index + 1 < text.size()) {
+            byte = static_cast<unsigned char>(((byte & 0x1f) << 6) | (text[++index] & 0x3f));
+        }
+        bytes += static_cast<char>(byte);
+    }
+    return bytes;
+}
+
+/// Reads from the read position up to EOF.
+std::string read_to_end(std::fstream& stream) {
+    stream.clear();
+    const auto start = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    const auto end = stream.tellg();
+    stream.seekg(start);
+
+    std::string content(static_cast<size_t>(end - start), '\0');
+    stream.read(content.data(), static_cast<std::streamsize>(content.size()));
+    content.resize(static_cast<size_t>(stream.gcount()));
+    stream.clear();
+    return content;
+}
+
+/// Reads up to `delimiter`, which is consumed but not returned, or up to EOF.
+std::string read_until(std::fstream& stream, std::string_view delimiter) {
+    if(delimiter.empty()) {
+        return read_to_end(stream);
+    }
+
+    // getline finds the last byte, the bytes before it are checked on the collected text.
+    const char last = delimiter.back();
+    const auto prefix = delimiter.substr(0, delimiter.size() - 1);
+    std::string result;
+    std::string chunk;
+    while(std::getline(stream, chunk, last)) {
+        result += chunk;
+        if(stream.eof()) {
+            break;
+        }
+        if(result.ends_with(prefix)) {
+            result.resize(result.size() - prefix.size());
+            break;
+        }
+        result += last;
+    }
+    stream.clear();
+    return result;
+}
 
 CAPI(file_open, (std::string path)->int64_t) {
-    std::fstream fs;
-    fs.exceptions(std::fstream::badbit);
-    fs.open(catter::capi::util::absolute_of(path), std::ios::in | std::ios::out | std::ios::binary);
-    if(!fs.is_open()) {
+    auto id = file_id_cnt++;
+    auto& file = open_files[id];
+    file.buffer = std::make_unique<char[]>(file_buffer_size);
+    file.stream.rdbuf()->pubsetbuf(file.buffer.get(), file_buffer_size);
+    file.stream.exceptions(std::fstream::badbit);
+    file.stream.open(catter::capi::util::absolute_of(path),
+                     std::ios::in | std::ios::out | std::ios::binary);
+    if(!file.stream.is_open()) {
+        open_files.erase(id);
         throw catter::qjs::Exception("Failed to open file: " + path);
     }
-    auto id = file_id_cnt++;
-    open_files.emplace(id, std::move(fs));
     return id;
 }
 
@@ -55,7 +139,7 @@ CAPI(file_close, (int64_t file_id)->void) {
     if(it == open_files.end()) {
         throw catter::qjs::Exception("Invalid file id: " + std::to_string(file_id));
     }
-    it->second.close();
+    it->second.stream.close();
     open_files.erase(it);
 }
 
@@ -72,8 +156,8 @@ CAPI(file_seek_read, (int64_t file_id, int64_t offset, uint32_t whence)->void) {
         case 2: dir = std::ios::end; break;
         default: throw catter::qjs::Exception("Invalid whence: " + std::to_string(whence));
     }
-    it->second.clear();
-    it->second.seekg(offset, dir);
+    it->second.stream.clear();
+    it->second.stream.seekg(offset, dir);
 };
 
 CAPI(file_seek_write, (int64_t file_id, int64_t offset, uint32_t whence)->void) {
@@ -88,8 +172,8 @@ CAPI(file_seek_write, (int64_t file_id, int64_t offset, uint32_t whence)->void)
         case 2: dir = std::ios::end; break;
         default: throw catter::qjs::Exception("Invalid whence: " + std::to_string(whence));
     }
-    it->second.clear();
-    it->second.seekp(offset, dir);
+    it->second.stream.clear();
+    it->second.stream.seekp(offset, dir);
 };
 
 CAPI(file_tell_read, (int64_t file_id)->int64_t) {
@@ -97,8 +181,8 @@ CAPI(file_tell_read, (int64_t file_id)->int64_t) {
     if(it == open_files.end()) {
         throw catter::qjs::Exception("Invalid file id: " + std::to_string(file_id));
     }
-    it->second.clear();
-    return it->second.tellg();
+    it->second.stream.clear();
+    return it->second.stream.tellg();
 };
 
 CAPI(file_tell_write, (int64_t file_id)->int64_t) {
@@ -106,8 +190,8 @@ CAPI(file_tell_write, (int64_t file_id)->int64_t) {
     if(it == open_files.end()) {
         throw catter::qjs::Exception("Invalid file id: " + std::to_string(file_id));
     }
-    it->second.clear();
-    return it->second.tellp();
+    it->second.stream.clear();
+    return it->second.stream.tellp();
 };
 
 /// Receive file_id, size and a ArrayBuffer to write data into
@@ -130,8 +214,31 @@ CAPI(file_read_n, (int64_t file_id, uint32_t buf_size, catter::qjs::Object array
     if(buf == nullptr || reserved_sz < buf_size) {
         throw catter::qjs::Exception("Failed to get ArrayBuffer data or buffer is too small!");
     }
-    it->second.read(reinterpret_cast<char*>(buf), buf_size);
-    return it->second.gcount();
+    it->second.stream.read(reinterpret_cast<char*>(buf), buf_size);
+    return it->second.stream.gcount();
+}
+
+/// Reads text up to `delimiter` (consumed, not returned) or EOF, an empty delimiter reads to EOF.
+/// With `latin1` bytes are decoded like the "ascii" encoding of `TextFileStream`, else as UTF-8.
+CAPI(file_read_until, (int64_t file_id, std::string delimiter, bool latin1)->std::string) {
+    auto it = open_files.find(file_id);
+    if(it == open_files.end()) {
+        throw catter::qjs::Exception("Invalid file id: " + std::to_string(file_id));
+    }
+    if(latin1) {
+        return latin1_to_utf8(read_until(it->second.stream, utf8_to_latin1(delimiter)));
+    }
+    return read_until(it->second.stream, delimiter);
+}
+
+/// Reads text from the read position to EOF, decoded like `file_read_until`.
+CAPI(file_read_all, (int64_t file_id, bool latin1)->std::string) {
+    auto it = open_files.find(file_id);
+    if(it == open_files.end()) {
+        throw catter::qjs::Exception("Invalid file id: " + std::to_string(file_id));
+    }
+    auto content = read_to_end(it->second.stream);
+    return latin1 ? latin1_to_utf8(content) : content;
 }
 
 // Receive file_id, size and a ArrayBuffer to write data from
@@ -150,7 +257,7 @@ CAPI(file_write_n, (int64_t file_id, uint32_t buf_size, catter::qjs::Object arra
     if(buf == nullptr || reserved_sz < buf_size) {
         throw catter::qjs::Exception("Failed to get ArrayBuffer data or buffer is small!");
     }
-    it->second.write(reinterpret_cast<char*>(buf), buf_size);
+    it->second.stream.write(reinterpret_cast<char*>(buf), buf_size);
 }
 
 }  // namespace
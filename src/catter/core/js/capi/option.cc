@@ -3,6 +3,8 @@
 #include <expected>
 #include <format>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -12,6 +14,7 @@
 
 #include "type.h"
 #include "../apitool.h"
+#include "../option_cache.h"
 #include "../qjs.h"
 #include "option/clang.h"
 #include "option/lld_coff.h"
@@ -54,6 +57,17 @@ const kota_opt::OptTable& resolve_table(std::string_view table_name) {
     throw qjs::Exception(std::format("Unknown option table: {}", table_name));
 }
 
+const opt::PrefixIndex& resolve_prefix_index(std::string_view table_name) {
+#define RESOLVE_PREFIX_INDEX(NAME, NS)                                                             \
+    if(table_name == NAME) {                                                                       \
+        return opt::NS::prefix_index();                                                            \
+    }
+    CAPI_OPTION_TABLES(RESOLVE_PREFIX_INDEX)
+#undef RESOLVE_PREFIX_INDEX
+
+    throw qjs::Exception(std::format("Unknown option table: {}", table_name));
+}
+
 std::vector<std::string> copy_values(std::span<const std::string_view> values) {
     std::vector<std::string> copied;
     copied.reserve(values.size());
@@ -121,6 +135,92 @@ CTX_CAPI(option_get_info, (JSContext * ctx, std::string table_name, unsigned int
         .to_object(ctx);
 };
 
+std::string parse_error_message(const js::OptionParseCache::Error& error,
+                                const std::vector<std::string>& args) {
+    const auto failing_arg = error.index < args.size() ? std::string_view(args[error.index])
+                                                       : std::string_view("<end-of-argv>");
+    return std::format("failed to parse '{}' (arg #{}) : {}",
+                       failing_arg,
+                       error.index,
+                       error.reason);
+}
+
+/// Parses `args` through the session's parse cache, see option_cache.h.
+std::shared_ptr<const js::OptionParseCache::Parsed> parse_args(const std::string& table_name,
+                                                               const std::vector<std::string>& args,
+                                                               uint32_t visibility) {
+    const auto& table = resolve_table(table_name);
+    const auto& prefix_index = resolve_prefix_index(table_name);
+
+    kota_opt::ParseOptions options;
+    options.dash_dash_parsing = true;
+    options.visibility = visibility;
+
+    auto parser = [&](std::span<const std::string> all,
+                      size_t from,
+                      const js::OptionParseCache::StopAt& stop_at,
+                      js::OptionParseCache::Parsed& out) -> std::optional<uint32_t> {
+        // Leading plain options are resolved through the prefix index, the option table takes
+        // over from the first argument the index leaves to it.
+        while(from < all.size()) {
+            auto resolved = prefix_index.resolve(all, from, visibility);
+            if(!resolved) {
+                break;
+            }
+            const auto index = static_cast<uint32_t>(from);
+            if(stop_at(index)) {
+                return index;
+            }
+            out.items.push_back(js::OptionItem{
+                .values = resolved->value ? std::vector<std::string>{std::string(*resolved->value)}
+                                          : std::vector<std::string>{},
+                .key = std::string(resolved->spelling),
+                .id = resolved->id,
+                .index = index,
+            });
+            from = resolved->next;
+        }
+        if(from == all.size()) {
+            return std::nullopt;
+        }
+
+        for(auto result: table.parse(all.subspan(from), options)) {
+            if(!result.has_value()) {
+                const auto& error = result.error();
+                out.error = js::OptionParseCache::Error{
+                    .index = static_cast<uint32_t>(error.index + from),
+                    .reason = error.message != nullptr ? error.message : "missing argument",
+                };
+                return std::nullopt;
+            }
+
+            const auto index = static_cast<uint32_t>(result->index + from);
+            if(stop_at(index)) {
+                return index;
+            }
+            auto item = make_option_item(table, *result);
+            item.index = index;
+            out.items.push_back(std::move(item));
+        }
+        return std::nullopt;
+    };
+    return js::option_parse_cache().parse(table_name, visibility, args, parser);
+}
+
+/// A Uint32Array view of `length` elements starting at element `offset` of `buffer`.
+qjs::Object uint32_view(JSContext* ctx, JSValueConst buffer, size_t offset, size_t length) {
+    JSValue view_args[] = {
+        buffer,
+        JS_NewInt64(ctx, static_cast<int64_t>(offset * sizeof(uint32_t))),
+        JS_NewInt64(ctx, static_cast<int64_t>(length)),
+    };
+    qjs::Object view{ctx, JS_NewTypedArray(ctx, 3, view_args, JS_TYPED_ARRAY_UINT32)};
+    if(JS_IsException(view.value())) {
+        throw qjs::JSException::dump(ctx);
+    }
+    return view;
+}
+
 CTX_CAPI(option_parse, (JSContext * ctx, qjs::Parameters params)->void) {
     if(params.size() != 3 && params.size() != 4) {
         throw qjs::Exception(
@@ -137,32 +237,99 @@ CTX_CAPI(option_parse, (JSContext * ctx, qjs::Parameters params)->void) {
 
     auto args = args_object.as<qjs::Array<std::string>>().as<std::vector<std::string>>();
     auto callback = callback_object.as<OptionParseCallback>();
-    const auto& table = resolve_table(table_name);
 
-    kota_opt::ParseOptions options;
-    options.dash_dash_parsing = true;
-    options.visibility = visibility;
-
-    for(auto result: table.parse(args, options)) {
-        if(!result.has_value()) {
-            const auto& error = result.error();
-            const auto failing_arg = error.index < args.size() ? std::string_view(args[error.index])
-                                                               : std::string_view("<end-of-argv>");
-            const auto reason = error.message != nullptr ? error.message : "missing argument";
-
-            callback({qjs::Value::from(ctx,
-                                       std::format("failed to parse '{}' (arg #{}) : {}",
-                                                   failing_arg,
-                                                   error.index,
-                                                   reason))});
+    const auto parsed = parse_args(table_name, args, visibility);
+    for(const auto& item: parsed->items) {
+        if(!callback({qjs::Value::from(item.to_object(ctx))})) {
             return;
         }
+    }
+    if(parsed->error) {
+        callback({qjs::Value::from(ctx, parse_error_message(*parsed->error, args))});
+    }
+}
 
-        const auto& parsed = *result;
-        if(!callback({qjs::Value::from(make_option_item(table, parsed).to_object(ctx))})) {
-            return;
+/**
+ * Parses the whole argument array in one call and returns the items packed as
+ *   { ids, indices, offsets, strings, error? }
+ * `ids` and `indices` are Uint32Arrays with one entry per item. Item i owns
+ * `strings[offsets[i]]` (its key) followed by its values up to `offsets[i + 1]`, so `offsets`
+ * has one more entry than there are items. The three typed arrays share one ArrayBuffer. When
+ * parsing fails, the items before the failing argument are returned together with `error`.
+ */
+CTX_CAPI(option_parse_all, (JSContext * ctx, qjs::Parameters params)->qjs::Object) {
+    if(params.size() != 2 && params.size() != 3) {
+        throw qjs::Exception(
+            std::format("option_parse_all expects 2 or 3 arguments, got {}", params.size()));
+    }
+
+    auto table_name = params[0].as<std::string>();
+    auto args = params[1]
+                    .as<qjs::Object>()
+                    .as<qjs::Array<std::string>>()
+                    .as<std::vector<std::string>>();
+    uint32_t visibility = kAllOptionVisibility;
+    if(params.size() == 3 && !params[2].is_nothing()) {
+        visibility = params[2].as<uint32_t>();
+    }
+    const auto parsed = parse_args(table_name, args, visibility);
+    const auto count = parsed->items.size();
+
+    std::vector<uint32_t> packed(count * 3 + 1);
+    std::vector<std::string_view> strings;
+    strings.reserve(args.size() + count);
+    for(size_t i = 0; i < count; ++i) {
+        const auto& item = parsed->items[i];
+        packed[i] = item.id;
+        packed[count + i] = item.index;
+        packed[count * 2 + i] = static_cast<uint32_t>(strings.size());
+        strings.push_back(item.key);
+        strings.insert(strings.end(), item.values.begin(), item.values.end());
+    }
+    packed[count * 3] = static_cast<uint32_t>(strings.size());
+
+    qjs::Value buffer{ctx,
+                      JS_NewArrayBufferCopy(ctx,
+                                            reinterpret_cast<const uint8_t*>(packed.data()),
+                                            packed.size() * sizeof(uint32_t))};
+    if(buffer.is_exception()) {
+        throw qjs::JSException::dump(ctx);
+    }
+
+    qjs::Value string_table{ctx, JS_NewArray(ctx)};
+    if(string_table.is_exception()) {
+        throw qjs::JSException::dump(ctx);
+    }
+    for(uint32_t i = 0; i < strings.size(); ++i) {
+        JSValue str = JS_NewStringLen(ctx, strings[i].data(), strings[i].size());
+        if(JS_IsException(str) ||
+           JS_DefinePropertyValueUint32(ctx, string_table.value(), i, str, JS_PROP_C_W_E) < 0) {
+            throw qjs::JSException::dump(ctx);
         }
     }
+
+    auto result = qjs::Object::empty_one(ctx);
+    result.set_property("ids", uint32_view(ctx, buffer.value(), 0, count));
+    result.set_property("indices", uint32_view(ctx, buffer.value(), count, count));
+    result.set_property("offsets", uint32_view(ctx, buffer.value(), count * 2, count + 1));
+    result.set_property("strings", string_table);
+    if(parsed->error) {
+        result.set_property("error", parse_error_message(*parsed->error, args));
+    }
+    return result;
+}
+
+/// Hit and reuse counters of the session's option parse cache.
+CTX_CAPI(option_cache_stats, (JSContext * ctx)->qjs::Object) {
+    return js::option_parse_cache().stats().to_object(ctx);
+}
+
+/// Sets the memory budget of the option parse cache in bytes, 0 turns the cache off.
+CAPI(option_cache_set_budget, (int64_t bytes)->void) {
+    if(bytes < 0) {
+        throw qjs::Exception("option_cache_set_budget expects a non-negative size, got {}", bytes);
+    }
+    js::option_parse_cache().set_budget(static_cast<size_t>(bytes));
 }
 
 }  // namespace
@@ -22,4 +22,9 @@ CAPI(service_on_execution, (qjs::Object cb)->void) {
     catter::js::set_on_execution(std::move(cb));
 }
 
+/// Hit and miss counters of the session's bytecode cache for scripts and the files they import.
+CTX_CAPI(bytecode_cache_stats, (JSContext * ctx)->qjs::Object) {
+    return catter::js::bytecode_cache_stats().to_object(ctx);
+}
+
 }  // namespace
@@ -3,7 +3,25 @@
 
 namespace catter::js {
 
-enum class ActionType { skip, drop, abort, modify };
+enum class ActionType { skip, drop, abort, modify, fake };
+
+enum class CaptureMode { none, tail, full };
+
+struct ExecFilter {
+    static ExecFilter make(qjs::Object object) {
+        return make_reflected_object<ExecFilter>(std::move(object));
+    }
+
+    qjs::Object to_object(JSContext* ctx) const {
+        return to_reflected_object(ctx, *this);
+    }
+
+    bool operator== (const ExecFilter&) const = default;
+
+public:
+    std::vector<std::string> allow;
+    std::vector<std::string> deny;
+};
 
 struct CatterOptions {
     enum class StdioMode { inherit, capture };
@@ -21,6 +39,11 @@ struct CatterOptions {
 public:
     bool log;
     StdioMode stdioMode;
+    std::optional<ExecFilter> execFilter;
+    std::optional<bool> execThrough;
+    std::optional<CaptureMode> capture;
+    std::optional<uint32_t> captureLimit;
+    std::optional<std::string> record;
 };
 
 struct CatterRuntime {
@@ -64,9 +87,8 @@ public:
 };
 
 struct CommandData {
-    static CommandData make(qjs::Object object) {
-        return make_reflected_object<CommandData>(std::move(object));
-    }
+    /// Also accepts the lazy objects of `make_command_object`, see command_object.cc.
+    static CommandData make(qjs::Object object);
 
     qjs::Object to_object(JSContext* ctx) const {
         return to_reflected_object(ctx, *this);
@@ -83,6 +105,42 @@ public:
     std::optional<int64_t> parent;
 };
 
+/// Routes nested commands (the `modify` payload) through `CommandData::make` as well.
+template <>
+struct Bridge<CommandData> {
+    static CommandData from_js(const qjs::Value& value) {
+        return CommandData::make(value.as<qjs::Object>());
+    }
+
+    static auto to_js(JSContext* ctx, const CommandData& value) {
+        return to_reflected_object(ctx, value);
+    }
+};
+
+/// What running a process cost, see `data::process_usage`.
+struct ProcessUsage {
+    static ProcessUsage make(qjs::Object object) {
+        return make_reflected_object<ProcessUsage>(std::move(object));
+    }
+
+    qjs::Object to_object(JSContext* ctx) const {
+        return to_reflected_object(ctx, *this);
+    }
+
+    bool operator== (const ProcessUsage&) const = default;
+
+public:
+    /// Microseconds of a monotonic clock shared by every process of the machine.
+    int64_t startUs;
+    int64_t endUs;
+    /// CPU time, peak resident set and block I/O, absent where the platform has no rusage.
+    std::optional<int64_t> userUs;
+    std::optional<int64_t> systemUs;
+    std::optional<int64_t> maxRssKiB;
+    std::optional<int64_t> readBlocks;
+    std::optional<int64_t> writeBlocks;
+};
+
 struct ProcessResult {
     struct name_mapper {
         constexpr static std::string_view map(std::string_view field_name) {
@@ -110,6 +168,8 @@ public:
     int64_t code;
     std::string stdOut;
     std::string stdErr;
+    /// Absent when the command was not run, e.g. dropped.
+    std::optional<ProcessUsage> usage;
 };
 
 struct CatterErr {
@@ -171,11 +231,134 @@ public:
     std::string meta_var;
 };
 
-using Action =
-    TaggedUnion<ActionType::skip, ActionType::drop, ActionType::abort, ActionType::modify>;
+struct OptionCacheStats {
+    static OptionCacheStats make(qjs::Object object) {
+        return make_reflected_object<OptionCacheStats>(std::move(object));
+    }
+
+    qjs::Object to_object(JSContext* ctx) const {
+        return to_reflected_object(ctx, *this);
+    }
+
+    bool operator== (const OptionCacheStats&) const = default;
+
+public:
+    /// Argument vectors answered entirely from the cache.
+    uint64_t hits;
+    /// Argument vectors that reused the prefix or suffix of the previous parse.
+    uint64_t partialHits;
+    uint64_t misses;
+    uint64_t reusedArgs;
+    uint64_t parsedArgs;
+    uint64_t evictions;
+    uint64_t entries;
+    uint64_t bytes;
+    uint64_t budget;
+};
+
+struct BuiltinCompilerIdentity {
+    static BuiltinCompilerIdentity make(qjs::Object object) {
+        return make_reflected_object<BuiltinCompilerIdentity>(std::move(object));
+    }
+
+    qjs::Object to_object(JSContext* ctx) const {
+        return to_reflected_object(ctx, *this);
+    }
+
+    bool operator== (const BuiltinCompilerIdentity&) const = default;
+
+public:
+    /// "gcc", "clang", "clang-cl", "msvc", "nvcc" or "unknown".
+    std::string kind;
+    /// The parser dialect, "gcc", "clang", "msvc", "nvcc" or "unknown".
+    std::string dialect;
+    /// Target triple spelled before the driver name, as in "aarch64-linux-gnu-gcc".
+    std::optional<std::string> targetPrefix;
+};
+
+/// What a gcc or clang style driver reports about itself for one language and set of flags.
+struct CompilerProbe {
+    static CompilerProbe make(qjs::Object object) {
+        return make_reflected_object<CompilerProbe>(std::move(object));
+    }
+
+    qjs::Object to_object(JSContext* ctx) const {
+        return to_reflected_object(ctx, *this);
+    }
+
+    bool operator== (const CompilerProbe&) const = default;
+
+public:
+    /// The default target triple, empty when the driver does not print one.
+    std::string target;
+    /// Builtin `#include <...>` search directories, in search order.
+    std::vector<std::string> includes;
+    /// Predefined macros as "NAME=VALUE", function-like ones as "NAME(ARGS)=VALUE".
+    std::vector<std::string> macros;
+};
+
+struct BytecodeCacheStats {
+    static BytecodeCacheStats make(qjs::Object object) {
+        return make_reflected_object<BytecodeCacheStats>(std::move(object));
+    }
+
+    qjs::Object to_object(JSContext* ctx) const {
+        return to_reflected_object(ctx, *this);
+    }
+
+    bool operator== (const BytecodeCacheStats&) const = default;
+
+public:
+    /// Modules loaded from the on-disk cache.
+    uint64_t hits;
+    /// Modules compiled and written to the cache.
+    uint64_t misses;
+};
+
+struct CompilerProbeStats {
+    static CompilerProbeStats make(qjs::Object object) {
+        return make_reflected_object<CompilerProbeStats>(std::move(object));
+    }
+
+    qjs::Object to_object(JSContext* ctx) const {
+        return to_reflected_object(ctx, *this);
+    }
+
+    bool operator== (const CompilerProbeStats&) const = default;
+
+public:
+    /// Queries answered from the session memo.
+    uint64_t hits;
+    /// Queries that waited for a probe of the same key already running.
+    uint64_t joined;
+    /// Queries answered from the on-disk cache.
+    uint64_t diskHits;
+    /// Compilers actually spawned.
+    uint64_t probes;
+    uint64_t failures;
+};
+
+using Action = TaggedUnion<ActionType::skip,
+                           ActionType::drop,
+                           ActionType::abort,
+                           ActionType::modify,
+                           ActionType::fake>;
+
+TAG<ActionType::skip> {
+    std::optional<CaptureMode> capture;
+    std::optional<uint32_t> captureLimit;
+    bool operator== (const Tag& other) const = default;
+};
 
 TAG<ActionType::modify> {
     CommandData data;
+    std::optional<CaptureMode> capture;
+    std::optional<uint32_t> captureLimit;
+    bool operator== (const Tag& other) const = default;
+};
+
+TAG<ActionType::fake> {
+    std::vector<std::string> outputs;
     bool operator== (const Tag& other) const = default;
 };
 
@@ -0,0 +1,408 @@
+#include "command_object.h"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <quickjs.h>
+
+namespace catter::js {
+
+namespace {
+
+constexpr size_t field_count = 6;
+
+/// JS names of the `CommandData` fields in declaration order, which is also the slot order.
+const std::array<std::string_view, field_count>& field_names() {
+    static const auto names = [] {
+        std::array<std::string_view, field_count> names{};
+        size_t index = 0;
+        CommandData data{};
+        kota::meta::for_each(data, [&]<typename FieldType>(FieldType) {
+            assert(index < field_count && "CommandData gained a field, update field_count.");
+            names[index++] = FieldType::name();
+        });
+        assert(index == field_count && "CommandData lost a field, update field_count.");
+        return names;
+    }();
+    return names;
+}
+
+using FieldAtoms = std::array<JSAtom, field_count>;
+
+/**
+ * Atoms of the field names by runtime, interned when the class is registered there so that a
+ * property access compares atoms instead of strings. They are never freed, the runtime frees its
+ * atom table with it; a runtime reusing the address of a dead one registers the class and interns
+ * the atoms again.
+ */
+std::unordered_map<JSRuntime*, FieldAtoms>& field_atoms() {
+    static std::unordered_map<JSRuntime*, FieldAtoms> atoms;
+    return atoms;
+}
+
+/// Calls `fn(field)` with a reference to field `index` of `data`.
+template <typename Data, typename Fn>
+void visit_field(Data& data, size_t index, Fn&& fn) {
+    size_t current = 0;
+    kota::meta::for_each(data, [&]<typename FieldType>(FieldType field) {
+        if(current++ == index) {
+            fn(field.value());
+        }
+    });
+}
+
+/**
+ * Opaque of a command object.
+ *
+ * A field lives either natively in `data` or, once a script read or assigned it, as a JS value
+ * in `slots`. Properties that are not fields live on `extra`, an ordinary object created on the
+ * first such assignment.
+ */
+struct LazyCommand {
+    CommandData data;
+    FieldAtoms atoms;
+    std::array<JSValue, field_count> slots;
+    /// Bit i set: field i was deleted by the script.
+    uint32_t deleted = 0;
+    JSValue extra = JS_UNDEFINED;
+
+    LazyCommand(CommandData data, const FieldAtoms& atoms) : data(std::move(data)), atoms(atoms) {
+        slots.fill(JS_UNINITIALIZED);
+    }
+
+    bool converted(size_t index) const noexcept {
+        return !JS_IsUninitialized(slots[index]);
+    }
+
+    bool present(size_t index) const {
+        if((deleted & (1U << index)) != 0) {
+            return false;
+        }
+        if(converted(index)) {
+            return true;
+        }
+        bool has_value = true;
+        visit_field(data, index, [&]<typename T>(const T& value) {
+            if constexpr(kota::is_optional_v<T>) {
+                has_value = value.has_value();
+            }
+        });
+        return has_value;
+    }
+
+    /// Stores `value` (taking ownership) as field `index` and drops the native copy.
+    void assign(JSRuntime* rt, size_t index, JSValue value) {
+        JS_FreeValueRT(rt, slots[index]);
+        slots[index] = value;
+        deleted &= ~(1U << index);
+        visit_field(data, index, []<typename T>(T& field) { field = T{}; });
+    }
+
+    /// Converts field `index` into its slot if it still lives natively.
+    void convert(JSContext* ctx, size_t index) {
+        if(converted(index)) {
+            return;
+        }
+        visit_field(data, index, [&]<typename T>(T& field) {
+            if constexpr(kota::is_optional_v<T>) {
+                slots[index] = Bridge<typename T::value_type>::to_js(ctx, *field).release();
+            } else {
+                slots[index] = Bridge<T>::to_js(ctx, field).release();
+            }
+            field = T{};
+        });
+    }
+
+    void erase(JSRuntime* rt, size_t index) {
+        JS_FreeValueRT(rt, slots[index]);
+        slots[index] = JS_UNINITIALIZED;
+        deleted |= 1U << index;
+        visit_field(data, index, []<typename T>(T& field) { field = T{}; });
+    }
+};
+
+using Register = qjs::Object::Register<LazyCommand>;
+
+LazyCommand* opaque_of(JSContext* ctx, JSValueConst obj) {
+    return static_cast<LazyCommand*>(JS_GetOpaque(obj, Register::get(JS_GetRuntime(ctx))));
+}
+
+/// Index of the field named by `prop`, or `field_count` when `prop` is no field (or a symbol).
+size_t field_index(const LazyCommand& command, JSAtom prop) noexcept {
+    size_t index = 0;
+    while(index < field_count && command.atoms[index] != prop) {
+        ++index;
+    }
+    return index;
+}
+
+JSValue extra_of(JSContext* ctx, LazyCommand& command) {
+    if(JS_IsUndefined(command.extra)) {
+        command.extra = JS_NewObject(ctx);
+    }
+    return command.extra;
+}
+
+/// Runs `fn`, turning a C++ exception into a pending JS one; QuickJS callbacks must not throw.
+template <typename Fn>
+int guarded(JSContext* ctx, Fn&& fn) noexcept {
+    try {
+        return fn();
+    } catch(const std::exception& ex) {
+        JS_ThrowInternalError(ctx, "%s", ex.what());
+        return -1;
+    }
+}
+
+int get_own_property(JSContext* ctx, JSPropertyDescriptor* desc, JSValueConst obj, JSAtom prop) {
+    auto* command = opaque_of(ctx, obj);
+    if(command == nullptr) {
+        return 0;
+    }
+
+    const auto index = field_index(*command, prop);
+    if(index == field_count) {
+        if(JS_IsUndefined(command->extra)) {
+            return 0;
+        }
+        return JS_GetOwnProperty(ctx, desc, command->extra, prop);
+    }
+    if(!command->present(index)) {
+        return 0;
+    }
+    if(desc == nullptr) {
+        // Only an existence check (`in`, hasOwnProperty), no need to convert anything.
+        return 1;
+    }
+    return guarded(ctx, [&] {
+        command->convert(ctx, index);
+        desc->flags = JS_PROP_C_W_E;
+        desc->value = JS_DupValue(ctx, command->slots[index]);
+        desc->getter = JS_UNDEFINED;
+        desc->setter = JS_UNDEFINED;
+        return 1;
+    });
+}
+
+int get_own_property_names(JSContext* ctx,
+                           JSPropertyEnum** ptab,
+                           uint32_t* plen,
+                           JSValueConst obj) {
+    auto* command = opaque_of(ctx, obj);
+    if(command == nullptr) {
+        return -1;
+    }
+
+    JSPropertyEnum* extra = nullptr;
+    uint32_t extra_count = 0;
+    if(!JS_IsUndefined(command->extra) &&
+       JS_GetOwnPropertyNames(ctx,
+                              &extra,
+                              &extra_count,
+                              command->extra,
+                              JS_GPN_STRING_MASK | JS_GPN_SYMBOL_MASK) < 0) {
+        return -1;
+    }
+
+    // Allocate at least one entry, a null table reads as an allocation failure.
+    auto* tab = static_cast<JSPropertyEnum*>(
+        js_mallocz(ctx, sizeof(JSPropertyEnum) * (field_count + extra_count + 1)));
+    if(tab == nullptr) {
+        JS_FreePropertyEnum(ctx, extra, extra_count);
+        return -1;
+    }
+
+    uint32_t count = 0;
+    for(size_t index = 0; index < field_count; ++index) {
+        if(command->present(index)) {
+            tab[count].is_enumerable = true;
+            tab[count++].atom = JS_DupAtom(ctx, command->atoms[index]);
+        }
+    }
+    for(uint32_t i = 0; i < extra_count; ++i) {
+        tab[count++] = extra[i];
+    }
+    js_free(ctx, extra);
+
+    *ptab = tab;
+    *plen = count;
+    return 0;
+}
+
+int delete_property(JSContext* ctx, JSValueConst obj, JSAtom prop) {
+    auto* command = opaque_of(ctx, obj);
+    if(command == nullptr) {
+        return 1;
+    }
+
+    const auto index = field_index(*command, prop);
+    if(index == field_count) {
+        if(JS_IsUndefined(command->extra)) {
+            return 1;
+        }
+        return JS_DeleteProperty(ctx, command->extra, prop, 0);
+    }
+    command->erase(JS_GetRuntime(ctx), index);
+    return 1;
+}
+
+int define_own_property(JSContext* ctx,
+                        JSValueConst obj,
+                        JSAtom prop,
+                        JSValueConst val,
+                        JSValueConst getter,
+                        JSValueConst setter,
+                        int flags) {
+    auto* command = opaque_of(ctx, obj);
+    if(command == nullptr) {
+        return -1;
+    }
+
+    const auto index = field_index(*command, prop);
+    if(index == field_count) {
+        return JS_DefineProperty(ctx, extra_of(ctx, *command), prop, val, getter, setter, flags);
+    }
+    if((flags & (JS_PROP_HAS_GET | JS_PROP_HAS_SET)) != 0) {
+        JS_ThrowTypeError(ctx, "command data fields cannot be accessor properties");
+        return -1;
+    }
+    if((flags & JS_PROP_HAS_VALUE) != 0) {
+        command->assign(JS_GetRuntime(ctx), index, JS_DupValue(ctx, val));
+    }
+    return 1;
+}
+
+/// Assigning a field replaces it without converting the old value first.
+int set_property(JSContext* ctx,
+                 JSValueConst obj,
+                 JSAtom prop,
+                 JSValueConst value,
+                 JSValueConst receiver,
+                 int) {
+    auto* command = opaque_of(ctx, obj);
+    if(command == nullptr) {
+        return -1;
+    }
+    if(JS_VALUE_GET_PTR(receiver) != JS_VALUE_GET_PTR(obj)) {
+        // Reached through the prototype chain of another object, which gets its own property.
+        return JS_DefinePropertyValue(ctx, receiver, prop, JS_DupValue(ctx, value), JS_PROP_C_W_E);
+    }
+
+    const auto index = field_index(*command, prop);
+    if(index == field_count) {
+        return JS_SetProperty(ctx, extra_of(ctx, *command), prop, JS_DupValue(ctx, value));
+    }
+    command->assign(JS_GetRuntime(ctx), index, JS_DupValue(ctx, value));
+    return 1;
+}
+
+void finalize(JSRuntime* rt, JSValue obj) {
+    auto* command = static_cast<LazyCommand*>(JS_GetOpaque(obj, Register::get(rt)));
+    if(command == nullptr) {
+        return;
+    }
+    for(auto& slot: command->slots) {
+        JS_FreeValueRT(rt, slot);
+    }
+    JS_FreeValueRT(rt, command->extra);
+    delete command;
+}
+
+void mark(JSRuntime* rt, JSValueConst obj, JS_MarkFunc* mark_func) {
+    auto* command = static_cast<LazyCommand*>(JS_GetOpaque(obj, Register::get(rt)));
+    if(command == nullptr) {
+        return;
+    }
+    for(auto& slot: command->slots) {
+        JS_MarkValue(rt, slot, mark_func);
+    }
+    JS_MarkValue(rt, command->extra, mark_func);
+}
+
+JSClassExoticMethods exotic_methods{
+    .get_own_property = get_own_property,
+    .get_own_property_names = get_own_property_names,
+    .delete_property = delete_property,
+    .define_own_property = define_own_property,
+    .has_property = nullptr,
+    .get_property = nullptr,
+    .set_property = set_property,
+};
+
+JSClassID class_id(JSContext* ctx) {
+    auto rt = JS_GetRuntime(ctx);
+    JSClassID id = Register::get(rt);
+    if(id == JS_INVALID_CLASS_ID) {
+        JSClassDef def{"CommandData", finalize, mark, nullptr, &exotic_methods};
+        id = Register::create(rt, &def);
+
+        auto& atoms = field_atoms()[rt];
+        const auto& names = field_names();
+        for(size_t index = 0; index < field_count; ++index) {
+            atoms[index] = JS_NewAtomLen(ctx, names[index].data(), names[index].size());
+        }
+    }
+
+    // Class prototypes are per context, give the objects Object.prototype in every context.
+    JSValue proto = JS_GetClassProto(ctx, id);
+    if(JS_IsObject(proto)) {
+        JS_FreeValue(ctx, proto);
+    } else {
+        JS_SetClassProto(ctx, id, JS_NewObject(ctx));
+    }
+    return id;
+}
+
+template <typename T>
+T read_slot(JSContext* ctx, JSValueConst slot) {
+    qjs::Value value{ctx, slot};
+    if constexpr(kota::is_optional_v<T>) {
+        if(value.is_undefined()) {
+            return std::nullopt;
+        }
+        return Bridge<typename T::value_type>::from_js(value);
+    } else {
+        return Bridge<T>::from_js(value);
+    }
+}
+
+}  // namespace
+
+qjs::Object make_command_object(JSContext* ctx, CommandData data) {
+    qjs::Object object{ctx, JS_NewObjectClass(ctx, static_cast<int>(class_id(ctx)))};
+    if(JS_IsException(object.value())) {
+        throw qjs::JSException::dump(ctx);
+    }
+    JS_SetOpaque(object.value(),
+                 new LazyCommand(std::move(data), field_atoms().at(JS_GetRuntime(ctx))));
+    return object;
+}
+
+CommandData CommandData::make(qjs::Object object) {
+    auto ctx = object.context();
+    const auto* command = opaque_of(ctx, object.value());
+    if(command == nullptr) {
+        return make_reflected_object<CommandData>(std::move(object));
+    }
+
+    // Untouched fields are copied natively, the others are read back from their JS values.
+    CommandData data = command->data;
+    size_t index = 0;
+    kota::meta::for_each(data, [&]<typename FieldType>(FieldType field) {
+        using field_type = std::remove_const_t<typename FieldType::type>;
+        if((command->deleted & (1U << index)) != 0) {
+            field.value() = read_slot<field_type>(ctx, JS_UNDEFINED);
+        } else if(command->converted(index)) {
+            field.value() = read_slot<field_type>(ctx, command->slots[index]);
+        }
+        ++index;
+    });
+    return data;
+}
+
+}  // namespace catter::js
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "qjs.h"
+#include "capi/type.h"
+
+namespace catter::js {
+
+/**
+ * Wraps `data` in a native object that converts its properties on first access.
+ *
+ * Most `onCommand` callbacks look at `argv` and `cwd` and never touch `env`, yet an eager
+ * conversion copies every environment string into the JS heap for each command. The returned
+ * object keeps the command in C++ and converts a field into a JS value only when a script reads,
+ * enumerates or spreads it. Fields behave as writable, enumerable, configurable data properties;
+ * assigning or deleting one never converts the old value, and other properties are stored as on
+ * an ordinary object.
+ *
+ * `CommandData::make` recognizes these objects and reads back only the fields a script touched,
+ * so returning the callback argument (or wrapping it in `modify`) copies the untouched fields
+ * natively instead of round-tripping them through JS.
+ */
+qjs::Object make_command_object(JSContext* ctx, CommandData data);
+
+}  // namespace catter::js
@@ -0,0 +1,185 @@
+#include "compiler_identify.h"
+
+#include <array>
+#include <optional>
+#include <span>
+
+namespace catter::js {
+
+namespace {
+
+struct Rule {
+    std::string_view kind;
+    std::string_view dialect;
+    /// Driver names, tried in order.
+    std::span<const std::string_view> names;
+    bool versioned;
+    /// Whether a "<prefix>-" may precede the name.
+    bool prefixed;
+    /// Whether that prefix is reported as the target.
+    bool target_prefix;
+};
+
+constexpr std::array cc_names = {std::string_view("cc"), std::string_view("c++")};
+constexpr std::array gcc_names = {std::string_view("gcc"), std::string_view("g++")};
+constexpr std::array clang_names = {std::string_view("clang++"), std::string_view("clang")};
+constexpr std::array clang_cl_names = {std::string_view("clang-cl")};
+constexpr std::array cl_names = {std::string_view("cl")};
+constexpr std::array nvcc_names = {std::string_view("nvcc")};
+
+constexpr std::array<Rule, 6> builtin_rules = {
+    Rule{"gcc",      "gcc",    cc_names,       false, true,  true },
+    Rule{"gcc",      "gcc",    gcc_names,      true,  true,  true },
+    Rule{"clang",    "clang",  clang_names,    true,  true,  true },
+    Rule{"clang-cl", "msvc",   clang_cl_names, true,  true,  true },
+    Rule{"msvc",     "msvc",   cl_names,       false, false, false},
+    Rule{"nvcc",     "nvcc",   nvcc_names,     true,  true,  false},
+};
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool is_alnum(char c) {
+    return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/// `(?:[-_]?\d+(?:[._-][0-9a-zA-Z]+)*)?`
+bool is_version(std::string_view text) {
+    if(text.empty()) {
+        return true;
+    }
+    size_t i = text.front() == '-' || text.front() == '_' ? 1 : 0;
+    const auto digits = i;
+    while(i < text.size() && is_digit(text[i])) {
+        ++i;
+    }
+    if(i == digits) {
+        return false;
+    }
+    while(i < text.size()) {
+        if(text[i] != '.' && text[i] != '_' && text[i] != '-') {
+            return false;
+        }
+        const auto start = ++i;
+        while(i < text.size() && is_alnum(text[i])) {
+            ++i;
+        }
+        if(i == start) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// What may follow the driver name: a version if the rule allows one, then an optional ".exe".
+bool is_tail(std::string_view tail, bool versioned) {
+    auto matches = [&](std::string_view rest) {
+        return versioned ? is_version(rest) : rest.empty();
+    };
+    if(matches(tail)) {
+        return true;
+    }
+    return tail.ends_with(".exe") && matches(tail.substr(0, tail.size() - 4));
+}
+
+bool is_driver(const Rule& rule, std::string_view text) {
+    for(auto name: rule.names) {
+        if(text.starts_with(name) && is_tail(text.substr(name.size()), rule.versioned)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef _WIN32
+std::string lower(std::string_view text) {
+    std::string result(text);
+    for(auto& c: result) {
+        if(c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return result;
+}
+#endif
+
+}  // namespace
+
+BuiltinCompilerIdentity identify_builtin_compiler(std::string_view executable) {
+    // Neither the names, versions nor ".exe" contain a separator, so only the file name counts.
+    const auto separator = executable.find_last_of("/\\");
+    const auto file = separator == std::string_view::npos ? executable
+                                                          : executable.substr(separator + 1);
+#ifdef _WIN32
+    const auto folded = lower(file);
+    const std::string_view name = folded;
+#else
+    const std::string_view name = file;
+#endif
+
+    for(const auto& rule: builtin_rules) {
+        std::optional<std::string_view> prefix;
+        bool matched = false;
+        if(rule.prefixed) {
+            // The longest non-empty "<prefix>-" that leaves a driver name.
+            for(auto dash = name.rfind('-'); dash != std::string_view::npos && dash > 0;
+                dash = name.rfind('-', dash - 1)) {
+                if(is_driver(rule, name.substr(dash + 1))) {
+                    prefix = file.substr(0, dash);
+                    matched = true;
+                    break;
+                }
+            }
+        }
+        if(!matched) {
+            matched = is_driver(rule, name);
+        }
+        if(!matched) {
+            continue;
+        }
+
+        BuiltinCompilerIdentity identity{
+            .kind = std::string(rule.kind),
+            .dialect = std::string(rule.dialect),
+            .targetPrefix = std::nullopt,
+        };
+        if(rule.target_prefix && prefix) {
+            identity.targetPrefix = std::string(*prefix);
+        }
+        return identity;
+    }
+
+    return BuiltinCompilerIdentity{.kind = "unknown", .dialect = "unknown", .targetPrefix = {}};
+}
+
+const BuiltinCompilerIdentity& CompilerIdentifyCache::identify(std::string_view exe,
+                                                                std::string_view argv0) {
+    std::string key;
+    key.reserve(exe.size() + argv0.size() + 1);
+    key.append(exe).push_back('\0');
+    key.append(argv0);
+
+    if(auto it = memo.find(key); it != memo.end()) {
+        ++hit_count;
+        return it->second;
+    }
+
+    auto identity = identify_builtin_compiler(exe);
+    if(identity.kind == "unknown" && !argv0.empty()) {
+        identity = identify_builtin_compiler(argv0);
+    }
+    return memo.emplace(std::move(key), std::move(identity)).first->second;
+}
+
+void CompilerIdentifyCache::reset() {
+    memo.clear();
+    hit_count = 0;
+}
+
+CompilerIdentifyCache& compiler_identify_cache() {
+    static CompilerIdentifyCache cache;
+    return cache;
+}
+
+}  // namespace catter::js
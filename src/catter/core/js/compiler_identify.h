@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "capi/type.h"
+
+namespace catter::js {
+
+/**
+ * Identifies the builtin compiler family of an executable, the native counterpart of the rules
+ * in api/src/cmd/compiler/identify.ts.
+ *
+ * The rules are matched by hand on the file name rather than through regular expressions: an
+ * optional target prefix ending in '-', the driver name, an optional version and an optional
+ * ".exe", case-insensitive on Windows. The first rule that matches wins, and the longest target
+ * prefix is reported as the regular expressions would capture it.
+ */
+BuiltinCompilerIdentity identify_builtin_compiler(std::string_view executable);
+
+/**
+ * Session memo of `identify_builtin_compiler`, keyed by the executable path of the command.
+ * Builds run the same few compilers thousands of times, so nearly every lookup is a hit.
+ */
+class CompilerIdentifyCache {
+public:
+    /// Identifies `exe`, falling back to `argv0` when `exe` is not a known compiler.
+    const BuiltinCompilerIdentity& identify(std::string_view exe, std::string_view argv0);
+
+    void reset();
+
+    size_t size() const {
+        return memo.size();
+    }
+
+    size_t hits() const {
+        return hit_count;
+    }
+
+private:
+    std::unordered_map<std::string, BuiltinCompilerIdentity> memo;
+    size_t hit_count = 0;
+};
+
+/// The memo behind the compiler C API, reset by `RuntimeScope::start`.
+CompilerIdentifyCache& compiler_identify_cache();
+
+}  // namespace catter::js
@@ -0,0 +1,571 @@
+#include "compiler_probe.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <utility>
+#include <cpptrace/exceptions.hpp>
+
+#include "util/crossplat.h"
+#include "util/kotatsu.h"
+#include "util/log.h"
+
+namespace catter::js {
+
+namespace fs = std::filesystem;
+
+struct CompilerProbeCache::Entry {
+    kota::event done{};
+    bool finished = false;
+    std::optional<CompilerProbe> result;
+    std::string error;
+    std::chrono::steady_clock::time_point failed_at{};
+};
+
+namespace {
+
+/// Flags followed by a separate value that belongs to them.
+constexpr std::array<std::string_view, 6> separate_flags = {
+    "-target",
+    "--target",
+    "--sysroot",
+    "-isysroot",
+    "-B",
+    "-mllvm",
+};
+
+constexpr std::array<std::string_view, 11> joined_prefixes = {
+    "--target=",
+    "--sysroot=",
+    "--gcc-toolchain=",
+    "-isysroot",
+    "-B",
+    "-std=",
+    "--std=",
+    "-stdlib=",
+    "-nostdinc",
+    "-m",
+    "-O",
+};
+
+constexpr std::array<std::string_view, 14> exact_flags = {
+    "-ansi",
+    "-pthread",
+    "-nostdlibinc",
+    "-ffreestanding",
+    "-fno-exceptions",
+    "-fno-rtti",
+    "-fopenmp",
+    "-fpic",
+    "-fPIC",
+    "-fpie",
+    "-fPIE",
+    "-fno-pic",
+    "-fno-pie",
+    "-fno-PIC",
+};
+
+#ifdef _WIN32
+constexpr char null_device[] = "NUL";
+constexpr char path_separator = ';';
+#else
+constexpr char null_device[] = "/dev/null";
+constexpr char path_separator = ':';
+#endif
+
+/// Bump when the entry layout changes.
+constexpr uint32_t cache_format = 1;
+constexpr std::array<char, 8> cache_magic = {'C', 'A', 'T', 'T', 'E', 'R', 'C', 'P'};
+
+/**
+ * Entry layout (native endian, the cache never leaves the machine):
+ *   magic, u32 format, u32 reserved, u64 payload hash, payload.
+ * The payload is the key, the target, then the includes and the macros, each a u32 count
+ * followed by the strings. Every string is a u32 length followed by its bytes.
+ */
+struct EntryHeader {
+    std::array<char, 8> magic = cache_magic;
+    uint32_t format = cache_format;
+    uint32_t reserved = 0;
+    uint64_t payload_hash = 0;
+};
+
+uint64_t fnv1a(std::string_view bytes) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(unsigned char byte: bytes) {
+        hash = (hash ^ byte) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void put_u32(std::string& out, size_t value) {
+    const auto narrow = static_cast<uint32_t>(value);
+    out.append(reinterpret_cast<const char*>(&narrow), sizeof(narrow));
+}
+
+void put_string(std::string& out, std::string_view text) {
+    put_u32(out, text.size());
+    out.append(text);
+}
+
+std::string encode_payload(std::string_view key, const CompilerProbe& probe) {
+    std::string out;
+    put_string(out, key);
+    put_string(out, probe.target);
+    put_u32(out, probe.includes.size());
+    for(const auto& include: probe.includes) {
+        put_string(out, include);
+    }
+    put_u32(out, probe.macros.size());
+    for(const auto& macro: probe.macros) {
+        put_string(out, macro);
+    }
+    return out;
+}
+
+class PayloadReader {
+public:
+    explicit PayloadReader(std::string_view bytes) : rest(bytes) {}
+
+    std::optional<uint32_t> u32() {
+        uint32_t value;
+        if(rest.size() < sizeof(value)) {
+            return std::nullopt;
+        }
+        std::memcpy(&value, rest.data(), sizeof(value));
+        rest.remove_prefix(sizeof(value));
+        return value;
+    }
+
+    std::optional<std::string> string() {
+        auto size = u32();
+        if(!size || rest.size() < *size) {
+            return std::nullopt;
+        }
+        std::string value(rest.substr(0, *size));
+        rest.remove_prefix(*size);
+        return value;
+    }
+
+    bool strings(std::vector<std::string>& out) {
+        auto count = u32();
+        if(!count) {
+            return false;
+        }
+        for(uint32_t i = 0; i < *count; ++i) {
+            auto value = string();
+            if(!value) {
+                return false;
+            }
+            out.push_back(std::move(*value));
+        }
+        return true;
+    }
+
+    bool empty() const {
+        return rest.empty();
+    }
+
+private:
+    std::string_view rest;
+};
+
+std::optional<CompilerProbe> read_entry(const fs::path& path, std::string_view key) {
+    std::ifstream input(path, std::ios::binary);
+    if(!input) {
+        return std::nullopt;
+    }
+
+    EntryHeader header;
+    if(!input.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+       header.magic != cache_magic || header.format != cache_format) {
+        return std::nullopt;
+    }
+
+    std::string payload{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+    if(fnv1a(payload) != header.payload_hash) {
+        return std::nullopt;
+    }
+
+    PayloadReader reader(payload);
+    CompilerProbe probe{};
+    auto stored_key = reader.string();
+    auto target = reader.string();
+    if(!stored_key || *stored_key != key || !target || !reader.strings(probe.includes) ||
+       !reader.strings(probe.macros) || !reader.empty()) {
+        return std::nullopt;
+    }
+    probe.target = std::move(*target);
+    return probe;
+}
+
+void write_entry(const fs::path& path, std::string_view key, const CompilerProbe& probe) {
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    if(ec) {
+        LOG_WARN("Cannot create compiler probe cache directory {}: {}",
+                 path.parent_path().string(),
+                 ec.message());
+        return;
+    }
+
+    const auto payload = encode_payload(key, probe);
+    auto temp = path;
+    temp += std::format(".{:016x}.tmp", util::unique_id());
+    {
+        EntryHeader header{.payload_hash = fnv1a(payload)};
+        std::ofstream output(temp, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if(!output) {
+            LOG_WARN("Cannot write compiler probe cache entry {}", temp.string());
+            output.close();
+            fs::remove(temp, ec);
+            return;
+        }
+    }
+
+    fs::rename(temp, path, ec);
+    if(ec) {
+        LOG_WARN("Cannot store compiler probe cache entry {}: {}", path.string(), ec.message());
+        fs::remove(temp, ec);
+    }
+}
+
+bool is_file(const fs::path& path) {
+    std::error_code ec;
+    return fs::is_regular_file(path, ec);
+}
+
+/// The PATH of `env`, or of catter when `env` is empty.
+std::string_view search_path(std::span<const std::string> env) {
+    if(env.empty()) {
+        const char* search = std::getenv("PATH");
+        return search == nullptr ? "" : search;
+    }
+    // The last definition wins, as in the process the command starts.
+    for(auto it = env.rbegin(); it != env.rend(); ++it) {
+        const std::string_view entry = *it;
+#ifdef _WIN32
+        constexpr std::string_view name = "PATH=";
+        if(entry.size() >= name.size() &&
+           std::ranges::equal(entry.substr(0, name.size()), name, [](char a, char b) {
+               return std::toupper(static_cast<unsigned char>(a)) == b;
+           })) {
+            return entry.substr(name.size());
+        }
+#else
+        if(entry.starts_with("PATH=")) {
+            return entry.substr(5);
+        }
+#endif
+    }
+    return "";
+}
+
+/// The executable a command would run for `compiler`, searched in the PATH of `env` when it is a
+/// bare name.
+std::optional<fs::path> resolve_compiler(std::string_view compiler,
+                                         std::span<const std::string> env) {
+    const fs::path path(compiler);
+    if(path.empty()) {
+        return std::nullopt;
+    }
+    if(path.has_parent_path()) {
+        std::error_code ec;
+        auto absolute = fs::absolute(path, ec).lexically_normal();
+        return !ec && is_file(absolute) ? std::optional(absolute) : std::nullopt;
+    }
+
+    auto dirs = search_path(env);
+    while(!dirs.empty()) {
+        const auto end = std::min(dirs.find(path_separator), dirs.size());
+        const auto dir = dirs.substr(0, end);
+        dirs.remove_prefix(std::min(end + 1, dirs.size()));
+        if(dir.empty()) {
+            continue;
+        }
+        auto candidate = (fs::path(dir) / path).lexically_normal();
+        if(is_file(candidate)) {
+            return candidate;
+        }
+#ifdef _WIN32
+        if(!path.has_extension() && is_file(candidate.concat(".exe"))) {
+            return candidate;
+        }
+#endif
+    }
+    return std::nullopt;
+}
+
+std::string_view trim(std::string_view text) {
+    const auto begin = text.find_first_not_of(" \t\r");
+    if(begin == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+}
+
+template <typename Fn>
+void for_each_line(std::string_view text, Fn&& fn) {
+    while(!text.empty()) {
+        const auto end = std::min(text.find('\n'), text.size());
+        auto line = text.substr(0, end);
+        if(line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        fn(line);
+        text.remove_prefix(std::min(end + 1, text.size()));
+    }
+}
+
+kota::task<CompilerProbe> run_probe(fs::path compiler,
+                                    std::string language,
+                                    std::vector<std::string> flags) {
+    std::vector<std::string> args{compiler.string(), "-x", language};
+    args.insert(args.end(), flags.begin(), flags.end());
+    args.insert(args.end(), {"-E", "-dM", "-v", null_device});
+
+    // The search list markers are only recognized in the untranslated output.
+    auto env = util::get_environment();
+    std::erase_if(env, [](const std::string& entry) { return entry.starts_with("LC_ALL="); });
+    env.emplace_back("LC_ALL=C");
+
+    kota::process::options opts{
+        .file = compiler.string(),
+        .args = std::move(args),
+        .env = std::move(env),
+        .cwd = {},
+        .creation = {.windows_hide = true},
+        .streams = {kota::process::stdio::inherit(),
+                     output_stdio(data::CaptureMode::FULL),
+                     output_stdio(data::CaptureMode::FULL)}
+    };
+    auto result = co_await capture_process_result(make_process_event(opts),
+                                                  nullptr,
+                                                  nullptr,
+                                                  {.mode = data::CaptureMode::FULL});
+    if(result.code != 0) {
+        std::string_view last;
+        for_each_line(result.std_err, [&](std::string_view line) {
+            if(!trim(line).empty()) {
+                last = trim(line);
+            }
+        });
+        throw cpptrace::runtime_error(std::format("Probing {} for {} exited with {}: {}",
+                                                  compiler.string(),
+                                                  language,
+                                                  result.code,
+                                                  last));
+    }
+    co_return parse_compiler_probe(result.std_out, result.std_err);
+}
+
+}  // namespace
+
+std::vector<std::string> probe_flags(std::span<const std::string> args) {
+    auto listed = [](const auto& list, std::string_view arg) {
+        return std::ranges::find(list, arg) != list.end();
+    };
+
+    std::vector<std::string> flags;
+    for(size_t i = 0; i < args.size(); ++i) {
+        const std::string_view arg = args[i];
+        if(listed(separate_flags, arg)) {
+            flags.emplace_back(arg);
+            if(i + 1 < args.size()) {
+                flags.push_back(args[++i]);
+            }
+        } else if(listed(exact_flags, arg) ||
+                  std::ranges::any_of(joined_prefixes, [&](std::string_view prefix) {
+                      return arg.starts_with(prefix);
+                  })) {
+            flags.emplace_back(arg);
+        }
+    }
+    return flags;
+}
+
+CompilerProbe parse_compiler_probe(std::string_view std_out, std::string_view std_err) {
+    constexpr std::string_view target_prefix = "Target: ";
+    constexpr std::string_view framework_suffix = " (framework directory)";
+
+    CompilerProbe probe{};
+    bool in_search_list = false;
+    for_each_line(std_err, [&](std::string_view line) {
+        if(in_search_list) {
+            if(line == "End of search list.") {
+                in_search_list = false;
+                return;
+            }
+            auto dir = trim(line);
+            if(dir.ends_with(framework_suffix)) {
+                dir.remove_suffix(framework_suffix.size());
+            }
+            if(!dir.empty()) {
+                probe.includes.push_back(fs::path(dir).lexically_normal().generic_string());
+            }
+        } else if(line == "#include <...> search starts here:") {
+            in_search_list = true;
+        } else if(line.starts_with(target_prefix)) {
+            probe.target = std::string(trim(line.substr(target_prefix.size())));
+        }
+    });
+
+    constexpr std::string_view define = "#define ";
+    for_each_line(std_out, [&](std::string_view line) {
+        if(!line.starts_with(define)) {
+            return;
+        }
+        line.remove_prefix(define.size());
+        auto name_end = std::min(line.find(' '), line.size());
+        // The parameters of a function-like macro may contain spaces.
+        if(auto paren = line.find('('); paren < name_end) {
+            name_end = std::min(line.find(')', paren), line.size() - 1) + 1;
+        }
+        const auto value = name_end < line.size() ? line.substr(name_end + 1) : "";
+        probe.macros.push_back(std::format("{}={}", line.substr(0, name_end), value));
+    });
+    return probe;
+}
+
+void CompilerProbeCache::reset(std::optional<fs::path> directory,
+                               std::chrono::milliseconds failure_ttl) {
+    dir = std::move(directory);
+    this->failure_ttl = failure_ttl;
+    memo.clear();
+    counters = {};
+}
+
+kota::task<CompilerProbe> CompilerProbeCache::probe(std::string compiler,
+                                                    std::string language,
+                                                    std::vector<std::string> flags,
+                                                    std::vector<std::string> env) {
+    auto resolved = resolve_compiler(compiler, env);
+    if(!resolved) {
+        throw cpptrace::runtime_error(std::format("Cannot find compiler {}", compiler));
+    }
+
+    // Both follow symlinks, so a compiler upgraded behind a stable name misses.
+    std::error_code size_ec;
+    std::error_code time_ec;
+    const auto size = fs::file_size(*resolved, size_ec);
+    const auto mtime = fs::last_write_time(*resolved, time_ec);
+    if(size_ec || time_ec) {
+        throw cpptrace::runtime_error(std::format("Cannot stat compiler {}: {}",
+                                                  resolved->string(),
+                                                  (size_ec ? size_ec : time_ec).message()));
+    }
+
+    std::string key = std::format("{}\n{}\n{}\n{}",
+                                  resolved->string(),
+                                  size,
+                                  mtime.time_since_epoch().count(),
+                                  language);
+    for(const auto& flag: flags) {
+        key.push_back('\n');
+        key.append(flag);
+    }
+
+    auto it = memo.find(key);
+    if(it != memo.end() && it->second->finished && !it->second->result &&
+       std::chrono::steady_clock::now() - it->second->failed_at >= failure_ttl) {
+        memo.erase(it);
+        it = memo.end();
+    }
+    if(it != memo.end()) {
+        auto entry = it->second;
+        if(entry->finished) {
+            ++counters.hits;
+        } else {
+            ++counters.joined;
+            co_await entry->done.wait();
+        }
+        if(!entry->result) {
+            throw cpptrace::runtime_error(entry->error);
+        }
+        co_return *entry->result;
+    }
+
+    // Failures stay in the memo for a while too, a broken compiler is not spawned again for
+    // every command.
+    auto entry = std::make_shared<Entry>();
+    memo.emplace(key, entry);
+    std::optional<CompilerProbe> result;
+    std::string error;
+    try {
+        result = co_await load(key, *resolved, std::move(language), std::move(flags));
+    } catch(const std::exception& ex) {
+        ++counters.failures;
+        error = ex.what();
+    }
+    // `cancel` released the waiters already otherwise.
+    if(!entry->finished) {
+        entry->result = result;
+        entry->error = error;
+        entry->failed_at = std::chrono::steady_clock::now();
+        entry->finished = true;
+        entry->done.set();
+    }
+
+    if(!result) {
+        throw cpptrace::runtime_error(error);
+    }
+    co_return std::move(*result);
+}
+
+void CompilerProbeCache::cancel() {
+    std::erase_if(memo, [](const auto& item) {
+        auto& entry = *item.second;
+        if(entry.finished) {
+            return false;
+        }
+        entry.error = "Compiler probe cancelled";
+        entry.failed_at = std::chrono::steady_clock::now();
+        entry.finished = true;
+        entry.done.set();
+        return true;
+    });
+}
+
+kota::task<CompilerProbe> CompilerProbeCache::load(std::string key,
+                                                   fs::path compiler,
+                                                   std::string language,
+                                                   std::vector<std::string> flags) {
+    std::optional<fs::path> path;
+    if(dir) {
+        path = *dir / std::format("{:016x}.probe", fnv1a(key));
+        if(auto cached = read_entry(*path, key)) {
+            ++counters.diskHits;
+            // Pruning the cache goes by last use.
+            std::error_code ec;
+            fs::last_write_time(*path, fs::file_time_type::clock::now(), ec);
+            co_return std::move(*cached);
+        }
+    }
+
+    ++counters.probes;
+    auto probe = co_await run_probe(std::move(compiler), std::move(language), std::move(flags));
+    if(path) {
+        write_entry(*path, key, probe);
+    }
+    co_return probe;
+}
+
+CompilerProbeStats CompilerProbeCache::stats() const {
+    return counters;
+}
+
+CompilerProbeCache& compiler_probe_cache() {
+    static CompilerProbeCache cache;
+    return cache;
+}
+
+}  // namespace catter::js
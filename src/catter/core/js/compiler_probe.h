@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <kota/async/async.h>
+
+#include "capi/type.h"
+
+namespace catter::js {
+
+/**
+ * The flags of a command line that change what the driver reports about itself: the target,
+ * the sysroot and toolchain, the language standard and library, machine flags, optimization
+ * levels and the few code generation flags with a predefined macro. Everything else only changes
+ * what the command does, so commands differing in it share one probe.
+ */
+std::vector<std::string> probe_flags(std::span<const std::string> args);
+
+/// Parses the output of `<compiler> -x <language> <flags> -E -dM -v <null device>`.
+CompilerProbe parse_compiler_probe(std::string_view std_out, std::string_view std_err);
+
+/**
+ * Probes gcc and clang style drivers for their target, builtin include directories and
+ * predefined macros.
+ *
+ * A probe is keyed by the resolved executable, the size and modification time of the file it
+ * points to, the language and the flags, so an upgraded compiler simply misses. Answers are
+ * memoized for the session, concurrent queries of one key wait for a single probe, and with a
+ * directory the answers are kept on disk the way `BytecodeCache` keeps bytecode: written through
+ * a temporary file, broken entries treated as misses, write failures only logged. Failures are
+ * memoized for `failure_ttl` only, a compiler that could not be spawned once is tried again.
+ */
+class CompilerProbeCache {
+public:
+    constexpr static std::chrono::milliseconds default_failure_ttl{5000};
+
+    /// Forgets the session memo and the counters, then caches on disk under `directory` if any.
+    void reset(std::optional<std::filesystem::path> directory,
+               std::chrono::milliseconds failure_ttl = default_failure_ttl);
+
+    /// Probes `compiler` for `language` ("c", "c++", ...) with flags already passed through
+    /// `probe_flags`. A bare compiler name is searched in the PATH of `env`, the environment of
+    /// the command, or of catter when it is empty. Throws when the compiler cannot be found or
+    /// the probe fails.
+    kota::task<CompilerProbe> probe(std::string compiler,
+                                    std::string language,
+                                    std::vector<std::string> flags,
+                                    std::vector<std::string> env = {});
+
+    /// Fails the queries waiting for a running probe and forgets the running probes, so that
+    /// nothing waits for them once the event loop stops. `RuntimeScope::stop` calls it.
+    void cancel();
+
+    CompilerProbeStats stats() const;
+
+private:
+    struct Entry;
+
+    kota::task<CompilerProbe> load(std::string key,
+                                   std::filesystem::path compiler,
+                                   std::string language,
+                                   std::vector<std::string> flags);
+
+    std::optional<std::filesystem::path> dir;
+    std::chrono::milliseconds failure_ttl = default_failure_ttl;
+    /// Finished and running probes of the session by key.
+    std::unordered_map<std::string, std::shared_ptr<Entry>> memo;
+    CompilerProbeStats counters{};
+};
+
+/// The cache behind the compiler probe C API, reset by `RuntimeScope::start`.
+CompilerProbeCache& compiler_probe_cache();
+
+}  // namespace catter::js
@@ -6,6 +6,7 @@
 #include <string_view>
 
 #include "builtin_files.h"
+#include "bytecode_cache.h"
 
 namespace catter::js {
 
@@ -73,6 +74,9 @@ qjs::Module EsmModuleLoader::loader(qjs::Context ctx, std::string_view module_na
         if(source.empty()) {
             throw qjs::Exception("Unknown builtin module '{}'", module_name);
         }
+        if(catter::js::builtin_files_are_bytecode()) {
+            return ctx.load_module_bytecode(source);
+        }
         return ctx.load_module(source, module_name.data());
     }
 
@@ -82,6 +86,9 @@ qjs::Module EsmModuleLoader::loader(qjs::Context ctx, std::string_view module_na
         throw qjs::Exception("Failed to read module '{}'", path.string());
     }
     std::string source{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+    if(cache != nullptr) {
+        return ctx.load_module_bytecode(cache->module_bytecode(ctx, source, module_name));
+    }
     return ctx.load_module(source, module_name.data());
 }
 }  // namespace catter::js
@@ -10,20 +10,27 @@
 
 namespace catter::js {
 
+class BytecodeCache;
+
 /**
  * Path-only ESM loader.
  *
  * Specifiers are resolved relative to the importing file. Explicit absolute paths are also
  * accepted. Extensions are never inferred and directory imports are rejected, matching Node's
  * ESM path rules. All loaded files are treated as ES modules by the caller.
+ * With a bytecode cache, files are loaded from their cached bytecode when it is current.
  */
 class EsmModuleLoader final : public qjs::Runtime::ModuleLoader {
 public:
+    explicit EsmModuleLoader(BytecodeCache* cache = nullptr) noexcept : cache(cache) {}
+
     std::string normalizer(std::string_view referrer_name, std::string_view module_name) override;
     qjs::Module loader(qjs::Context ctx, std::string_view module_name) override;
 
 private:
     std::filesystem::path resolve_path(std::string_view referrer_name,
                                        std::string_view module_name) const;
+
+    BytecodeCache* cache = nullptr;
 };
 }  // namespace catter::js
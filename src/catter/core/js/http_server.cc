@@ -0,0 +1,574 @@
+#include "http_server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <optional>
+#include <utility>
+#include <cpptrace/exceptions.hpp>
+
+#ifndef CATTER_WINDOWS
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#include "util/log.h"
+
+namespace catter::js {
+
+namespace {
+
+struct RequestLine {
+    std::string_view method;
+    std::string_view path;
+};
+
+/// `GET /path?query HTTP/1.1`, the query is dropped.
+RequestLine parse_request_line(std::string_view head) {
+    const auto line = head.substr(0, head.find("\r\n"));
+    const auto method_end = line.find(' ');
+    if(method_end == std::string_view::npos) {
+        return {};
+    }
+    auto target = line.substr(method_end + 1);
+    target = target.substr(0, target.find(' '));
+    return {.method = line.substr(0, method_end), .path = target.substr(0, target.find('?'))};
+}
+
+std::string response_head(std::string_view status,
+                          std::string_view content_type,
+                          std::optional<size_t> length) {
+    auto head = std::format("HTTP/1.1 {}\r\n"
+                            "Content-Type: {}\r\n"
+                            "Cache-Control: no-cache\r\n"
+                            "Access-Control-Allow-Origin: *\r\n"
+                            "Connection: close\r\n",
+                            status,
+                            content_type);
+    if(length) {
+        head += std::format("Content-Length: {}\r\n", *length);
+    }
+    head += "\r\n";
+    return head;
+}
+
+std::string plain_response(std::string_view status) {
+    return response_head(status, "text/plain; charset=utf-8", status.size()) + std::string(status);
+}
+
+#ifndef CATTER_WINDOWS
+#ifdef MSG_NOSIGNAL
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0;
+#endif
+
+// Every descriptor is non-blocking and not inherited by the processes of the build. Where the
+// platform has the flags (Linux), descriptors are created with them, since a process the event
+// loop spawns between creating a descriptor and flagging it would inherit it. Elsewhere (macOS)
+// the flags are set right after.
+#ifndef SOCK_CLOEXEC
+bool prepare_fd(int fd) {
+    return ::fcntl(fd, F_SETFD, FD_CLOEXEC) == 0 &&
+           ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK) == 0;
+}
+#endif
+
+int open_socket(const addrinfo& address) {
+#ifdef SOCK_CLOEXEC
+    return ::socket(address.ai_family,
+                    address.ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                    address.ai_protocol);
+#else
+    const int fd = ::socket(address.ai_family, address.ai_socktype, address.ai_protocol);
+    if(fd >= 0 && !prepare_fd(fd)) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+#endif
+}
+
+bool open_pipe(int (&fds)[2]) {
+#ifdef SOCK_CLOEXEC
+    return ::pipe2(fds, O_CLOEXEC | O_NONBLOCK) == 0;
+#else
+    return ::pipe(fds) == 0 && prepare_fd(fds[0]) && prepare_fd(fds[1]);
+#endif
+}
+
+/// A non-blocking listening socket on the first address of `host` that binds.
+int open_listener(const std::string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    addrinfo* addresses = nullptr;
+    const auto service = std::to_string(port);
+    if(auto err = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses); err != 0) {
+        throw cpptrace::runtime_error(
+            std::format("Cannot listen on {}:{}: {}", host, port, ::gai_strerror(err)));
+    }
+
+    int error = 0;
+    int fd = -1;
+    for(auto* address = addresses; address != nullptr; address = address->ai_next) {
+        fd = open_socket(*address);
+        if(fd < 0) {
+            error = errno;
+            continue;
+        }
+        int enabled = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+        if(::bind(fd, address->ai_addr, address->ai_addrlen) == 0 &&
+           ::listen(fd, SOMAXCONN) == 0) {
+            break;
+        }
+        error = errno;
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(addresses);
+
+    if(fd < 0) {
+        throw cpptrace::runtime_error(
+            std::format("Cannot listen on {}:{}: {}", host, port, std::strerror(error)));
+    }
+    return fd;
+}
+
+uint16_t local_port(int fd) {
+    sockaddr_storage address{};
+    socklen_t length = sizeof(address);
+    if(::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return 0;
+    }
+    if(address.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+    }
+    return ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+}
+#endif
+
+}  // namespace
+
+std::string format_sse_event(std::string_view event, std::string_view data) {
+    std::string text;
+    text.reserve(event.size() + data.size() + 16);
+    if(!event.empty()) {
+        text.append("event: ").append(event).push_back('\n');
+    }
+    // A line break inside a field would end it, so every line of the data gets its own field
+    // and the browser joins them back with '\n'.
+    size_t at = 0;
+    while(true) {
+        const auto end = data.find('\n', at);
+        text.append("data: ").append(data.substr(at, end - at)).push_back('\n');
+        if(end == std::string_view::npos) {
+            break;
+        }
+        at = end + 1;
+    }
+    text.push_back('\n');
+    return text;
+}
+
+HttpServer::HttpServer(int listen_fd, uint16_t port) : listen_fd(listen_fd), bound_port(port) {}
+
+HttpServer::~HttpServer() {
+    close();
+}
+
+std::shared_ptr<HttpServer> HttpServer::listen(const std::string& host, int port) {
+#ifdef CATTER_WINDOWS
+    throw cpptrace::runtime_error("HTTP servers are not supported on Windows");
+#else
+    const int fd = open_listener(host, port);
+    std::shared_ptr<HttpServer> server(new HttpServer(fd, local_port(fd)));
+    if(!open_pipe(server->wake_fds)) {
+        throw cpptrace::runtime_error(
+            std::format("Cannot listen on {}:{}: {}", host, port, std::strerror(errno)));
+    }
+    server->worker = std::thread([raw = server.get()] { raw->serve(); });
+    return server;
+#endif
+}
+
+void HttpServer::route(std::string path, std::string content_type, std::string body) {
+    std::lock_guard lock(this->mutex);
+    this->documents.insert_or_assign(std::move(path),
+                                     Document{std::move(content_type), std::move(body)});
+}
+
+void HttpServer::stream(std::string path, size_t history) {
+    std::lock_guard lock(this->mutex);
+    auto& stream = this->streams[std::move(path)];
+    stream.history_limit = history;
+    while(stream.history.size() > history) {
+        stream.history.pop_front();
+    }
+}
+
+HttpServer::Stream& HttpServer::stream_at(std::string_view path) {
+    auto it = this->streams.find(std::string(path));
+    if(it == this->streams.end()) {
+        throw cpptrace::runtime_error(std::format("No event stream at {}", path));
+    }
+    return it->second;
+}
+
+void HttpServer::wake() noexcept {
+#ifndef CATTER_WINDOWS
+    // One byte is enough until the serving thread has looked at the state again.
+    if(!this->woken.exchange(true)) {
+        const char byte = 0;
+        [[maybe_unused]] auto written = ::write(this->wake_fds[1], &byte, 1);
+    }
+#endif
+}
+
+void HttpServer::publish(std::string_view path, std::string_view event, std::string_view data) {
+    auto text = format_sse_event(event, data);
+    bool delivered = false;
+    {
+        std::lock_guard lock(this->mutex);
+        auto& stream = stream_at(path);
+        if(stream.ended) {
+            throw cpptrace::runtime_error(std::format("Event stream {} has ended", path));
+        }
+
+        std::erase_if(stream.subscribers, [&](const std::shared_ptr<Subscriber>& subscriber) {
+            if(subscriber->gone) {
+                return true;
+            }
+            if(subscriber->pending.size() + text.size() > max_backlog) {
+                LOG_WARN("Dropping a subscriber of {} that fell {} bytes behind",
+                         path,
+                         subscriber->pending.size());
+                subscriber->gone = true;
+                delivered = true;
+                return true;
+            }
+            subscriber->pending += text;
+            delivered = true;
+            return false;
+        });
+
+        if(stream.history_limit > 0) {
+            if(stream.history.size() == stream.history_limit) {
+                stream.history.pop_front();
+            }
+            stream.history.push_back(std::move(text));
+        }
+    }
+    if(delivered) {
+        wake();
+    }
+}
+
+void HttpServer::finish(Stream& stream) {
+    stream.ended = true;
+    for(auto& subscriber: stream.subscribers) {
+        subscriber->last = true;
+    }
+    stream.subscribers.clear();
+}
+
+void HttpServer::end(std::string_view path) {
+    {
+        std::lock_guard lock(this->mutex);
+        finish(stream_at(path));
+    }
+    wake();
+}
+
+size_t HttpServer::subscribers(std::string_view path) const {
+    std::lock_guard lock(this->mutex);
+    auto it = this->streams.find(std::string(path));
+    if(it == this->streams.end()) {
+        return 0;
+    }
+    return std::ranges::count_if(it->second.subscribers,
+                                 [](const auto& subscriber) { return !subscriber->gone; });
+}
+
+void HttpServer::close() {
+    {
+        std::lock_guard lock(this->mutex);
+        if(this->closed) {
+            return;
+        }
+        this->closed = true;
+        for(auto& [_, stream]: this->streams) {
+            finish(stream);
+        }
+    }
+    wake();
+    if(this->worker.joinable()) {
+        this->worker.join();
+    }
+#ifndef CATTER_WINDOWS
+    for(int fd: {this->listen_fd, this->wake_fds[0], this->wake_fds[1]}) {
+        if(fd >= 0) {
+            ::close(fd);
+        }
+    }
+#endif
+    this->listen_fd = this->wake_fds[0] = this->wake_fds[1] = -1;
+}
+
+#ifndef CATTER_WINDOWS
+void HttpServer::serve() noexcept {
+    using clock = std::chrono::steady_clock;
+    std::vector<Connection> connections;
+    std::vector<pollfd> fds;
+    std::optional<clock::time_point> deadline;
+
+    while(true) {
+        bool closing = false;
+        {
+            std::lock_guard lock(this->mutex);
+            closing = this->closed;
+            for(auto& connection: connections) {
+                auto& subscriber = connection.subscriber;
+                if(!subscriber || connection.sent < connection.out.size()) {
+                    continue;
+                }
+                if(subscriber->gone) {
+                    connection.done = true;
+                    continue;
+                }
+                // Everything published meanwhile goes out in one write.
+                connection.out = std::exchange(subscriber->pending, {});
+                connection.sent = 0;
+                connection.done = connection.out.empty() && subscriber->last;
+            }
+        }
+
+        if(closing) {
+            if(!deadline) {
+                deadline = clock::now() + std::chrono::milliseconds(close_timeout_ms);
+            }
+            // Nothing new is accepted or read, only what was already owed goes out.
+            for(auto& connection: connections) {
+                connection.done = connection.done || !connection.responded;
+            }
+        }
+
+        std::erase_if(connections, [&](Connection& connection) {
+            if(!connection.done) {
+                return false;
+            }
+            if(connection.subscriber) {
+                std::lock_guard lock(this->mutex);
+                connection.subscriber->gone = true;
+            }
+            ::close(connection.fd);
+            return true;
+        });
+
+        int timeout = -1;
+        if(deadline) {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                *deadline - clock::now());
+            if(connections.empty() || left.count() <= 0) {
+                break;
+            }
+            timeout = static_cast<int>(left.count());
+        }
+
+        fds.clear();
+        fds.push_back({.fd = this->wake_fds[0], .events = POLLIN, .revents = 0});
+        fds.push_back({.fd = closing ? -1 : this->listen_fd, .events = POLLIN, .revents = 0});
+        for(const auto& connection: connections) {
+            short events = closing ? 0 : POLLIN;
+            if(connection.sent < connection.out.size()) {
+                events |= POLLOUT;
+            }
+            fds.push_back({.fd = connection.fd, .events = events, .revents = 0});
+        }
+
+        if(::poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR) {
+            LOG_WARN("HTTP server stopped: {}", std::strerror(errno));
+            break;
+        }
+
+        if(fds[0].revents & POLLIN) {
+            char bytes[64];
+            while(::read(this->wake_fds[0], bytes, sizeof(bytes)) > 0) {}
+            this->woken.store(false);
+        }
+
+        // Connections accepted below have no entry in `fds` yet.
+        const auto polled = connections.size();
+        for(size_t i = 0; i < polled; ++i) {
+            const auto revents = fds[i + 2].revents;
+            auto& connection = connections[i];
+            if(revents & (POLLIN | POLLHUP | POLLERR)) {
+                receive(connection);
+            }
+            if(!connection.done && (revents & POLLOUT)) {
+                send_out(connection);
+            }
+        }
+
+        if(fds[1].revents & POLLIN) {
+            accept_clients(connections);
+        }
+    }
+
+    for(auto& connection: connections) {
+        if(connection.subscriber) {
+            std::lock_guard lock(this->mutex);
+            connection.subscriber->gone = true;
+        }
+        ::close(connection.fd);
+    }
+}
+
+void HttpServer::accept_clients(std::vector<Connection>& connections) {
+    while(true) {
+#ifdef SOCK_CLOEXEC
+        const int fd = ::accept4(this->listen_fd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+#else
+        const int fd = ::accept(this->listen_fd, nullptr, nullptr);
+#endif
+        if(fd < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_WARN("HTTP server failed to accept a connection: {}", std::strerror(errno));
+            }
+            return;
+        }
+#ifndef SOCK_CLOEXEC
+        if(!prepare_fd(fd)) {
+            ::close(fd);
+            continue;
+        }
+#endif
+#ifdef SO_NOSIGPIPE
+        int enabled = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+        connections.emplace_back().fd = fd;
+    }
+}
+
+void HttpServer::receive(Connection& connection) {
+    char buffer[4096];
+    while(true) {
+        const auto n = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if(n <= 0) {
+            // The peer went away, or shut down its side before the whole request arrived.
+            connection.done = true;
+            return;
+        }
+        if(connection.responded) {
+            // Only a hang up matters once the response has started.
+            continue;
+        }
+        connection.request.append(buffer, static_cast<size_t>(n));
+        if(connection.request.find("\r\n\r\n") != std::string::npos) {
+            respond(connection);
+            send_out(connection);
+            return;
+        }
+        if(connection.request.size() > max_request) {
+            connection.done = true;
+            return;
+        }
+    }
+}
+
+void HttpServer::respond(Connection& connection) {
+    connection.responded = true;
+    const auto request = parse_request_line(connection.request);
+    if(request.method != "GET" && request.method != "HEAD") {
+        connection.out = plain_response("405 Method Not Allowed");
+        return;
+    }
+    const bool with_body = request.method == "GET";
+
+    std::lock_guard lock(this->mutex);
+    if(auto it = this->documents.find(std::string(request.path)); it != this->documents.end()) {
+        const auto& document = it->second;
+        connection.out = response_head("200 OK", document.content_type, document.body.size());
+        if(with_body) {
+            connection.out += document.body;
+        }
+        return;
+    }
+
+    auto it = this->streams.find(std::string(request.path));
+    if(it == this->streams.end()) {
+        connection.out = plain_response("404 Not Found");
+        return;
+    }
+
+    auto& stream = it->second;
+    connection.out = response_head("200 OK", "text/event-stream", std::nullopt);
+    if(with_body) {
+        for(const auto& event: stream.history) {
+            connection.out += event;
+        }
+    }
+    connection.subscriber = std::make_shared<Subscriber>();
+    connection.subscriber->last = stream.ended || !with_body;
+    if(!connection.subscriber->last) {
+        stream.subscribers.push_back(connection.subscriber);
+    }
+}
+
+void HttpServer::send_out(Connection& connection) {
+    while(connection.sent < connection.out.size()) {
+        const auto n = ::send(connection.fd,
+                              connection.out.data() + connection.sent,
+                              connection.out.size() - connection.sent,
+                              send_flags);
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if(n <= 0) {
+            connection.done = true;
+            return;
+        }
+        connection.sent += static_cast<size_t>(n);
+    }
+    if(!connection.subscriber) {
+        connection.done = true;
+    }
+}
+#endif
+
+std::unordered_map<int64_t, std::shared_ptr<HttpServer>>& http_servers() {
+    static std::unordered_map<int64_t, std::shared_ptr<HttpServer>> servers;
+    return servers;
+}
+
+void close_http_servers() {
+    for(auto& [_, server]: http_servers()) {
+        server->close();
+    }
+    http_servers().clear();
+}
+
+}  // namespace catter::js
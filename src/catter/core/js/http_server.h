@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace catter::js {
+
+/// One server-sent event as it goes over the wire, `data` split into one field per line.
+std::string format_sse_event(std::string_view event, std::string_view data);
+
+/**
+ * A small HTTP/1.1 server serving fixed documents and server-sent event streams, so that a
+ * script can feed a dashboard in a browser while the build runs.
+ *
+ * Connections are served by a thread of the server polling non-blocking POSIX sockets, so no
+ * script code runs for a request and the event loop never waits on a browser. Publishing an event
+ * only appends it to the buffer of each subscriber under a lock, so a slow browser never holds up
+ * `on_command`; a subscriber whose buffer grows past `max_backlog` bytes while its previous
+ * write is still in flight is disconnected instead. Each response closes its connection.
+ *
+ * The server does not run on the kota event loop for now, which is also why it is not available
+ * on Windows: `listen` throws there.
+ */
+class HttpServer {
+public:
+    /// Bytes a subscriber may fall behind before it is dropped.
+    constexpr static size_t max_backlog = 8 * 1024 * 1024;
+    /// Bytes of a request head, connections sending more are closed.
+    constexpr static size_t max_request = 16 * 1024;
+    /// How long `close` keeps sending what subscribers have not received yet.
+    constexpr static int close_timeout_ms = 1000;
+
+    /// Listens on `host:port`, port 0 picks a free one. Throws when it cannot.
+    static std::shared_ptr<HttpServer> listen(const std::string& host, int port);
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator= (const HttpServer&) = delete;
+
+    ~HttpServer();
+
+    /// The port the server listens on.
+    uint16_t port() const noexcept {
+        return bound_port;
+    }
+
+    /// Serves `body` at `path`, replacing what was there.
+    void route(std::string path, std::string content_type, std::string body);
+
+    /// Opens an event stream at `path` that replays its last `history` events to every new
+    /// subscriber.
+    void stream(std::string path, size_t history);
+
+    /// Sends an event to the subscribers of the stream at `path`.
+    void publish(std::string_view path, std::string_view event, std::string_view data);
+
+    /// Ends the stream at `path`: subscribers are closed once their buffer is sent, later ones
+    /// receive the history and are closed right away.
+    void end(std::string_view path);
+
+    size_t subscribers(std::string_view path) const;
+
+    /// Stops listening and ends every stream. Subscribers get up to `close_timeout_ms` to
+    /// receive what they are owed, then every connection is closed.
+    void close();
+
+private:
+    struct Document {
+        std::string content_type;
+        std::string body;
+    };
+
+    struct Subscriber {
+        /// Published while the connection was still writing, guarded by `mutex`.
+        std::string pending;
+        /// No event follows, close once `pending` is sent.
+        bool last = false;
+        bool gone = false;
+    };
+
+    struct Stream {
+        size_t history_limit = 0;
+        std::deque<std::string> history;
+        std::vector<std::shared_ptr<Subscriber>> subscribers;
+        bool ended = false;
+    };
+
+    /// Only touched by the serving thread.
+    struct Connection {
+        int fd = -1;
+        std::string request;
+        bool responded = false;
+        std::string out;
+        size_t sent = 0;
+        std::shared_ptr<Subscriber> subscriber;
+        bool done = false;
+    };
+
+    HttpServer(int listen_fd, uint16_t port);
+
+    void serve() noexcept;
+    void accept_clients(std::vector<Connection>& connections);
+    void receive(Connection& connection);
+    void respond(Connection& connection);
+    void send_out(Connection& connection);
+
+    Stream& stream_at(std::string_view path);
+    static void finish(Stream& stream);
+    void wake() noexcept;
+
+    int listen_fd = -1;
+    int wake_fds[2] = {-1, -1};
+    uint16_t bound_port = 0;
+    std::atomic<bool> woken{false};
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Document> documents;
+    std::unordered_map<std::string, Stream> streams;
+    bool closed = false;
+
+    std::thread worker;
+};
+
+/// Servers of the C API by id. `RuntimeScope::stop` closes them, so that no server outlives the
+/// script that opened it.
+std::unordered_map<int64_t, std::shared_ptr<HttpServer>>& http_servers();
+
+void close_http_servers();
+
+}  // namespace catter::js
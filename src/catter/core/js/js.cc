@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <exception>
+#include <format>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -11,7 +12,14 @@
 
 #include "apitool.h"
 #include "async.h"
+#include "builtin_files.h"
+#include "bytecode_cache.h"
+#include "command_object.h"
+#include "compiler_identify.h"
+#include "compiler_probe.h"
 #include "esm_loader.h"
+#include "http_server.h"
+#include "option_cache.h"
 
 namespace catter::js {
 
@@ -33,15 +41,19 @@ struct RuntimeState {
     OnFinish on_finish;
     OnCommand on_command;
     OnExecution on_execution;
+    std::unique_ptr<BytecodeCache> bytecode_cache;
 
     void reset(RuntimeConfig next_config) {
         on_start = {};
         on_finish = {};
         on_command = {};
         on_execution = {};
-        runtime = qjs::Runtime::create();
-        runtime.set_module_loader(std::make_unique<EsmModuleLoader>());
         config = std::move(next_config);
+        bytecode_cache = config.bytecode_cache.has_value()
+                             ? std::make_unique<BytecodeCache>(*config.bytecode_cache)
+                             : nullptr;
+        runtime = qjs::Runtime::create();
+        runtime.set_module_loader(std::make_unique<EsmModuleLoader>(bytecode_cache.get()));
     }
 };
 
@@ -49,7 +61,11 @@ RuntimeState state{};
 
 kota::task<> eval_module(std::string_view input, const char* filename) {
     auto ctx = state.runtime.context();
-    auto result = co_await state.js_loop.promise_to_task<void>(ctx.eval_module(input, filename));
+    auto promise = state.bytecode_cache
+                       ? ctx.eval_module_bytecode(
+                             state.bytecode_cache->module_bytecode(ctx, input, filename))
+                       : ctx.eval_module(input, filename);
+    auto result = co_await state.js_loop.promise_to_task<void>(std::move(promise));
     if(!result) {
         throw result.error().to_exception();
     }
@@ -83,6 +99,11 @@ void RuntimeScope::start(RuntimeConfig config) {
     }
 
     state.reset(std::move(config));
+    apitool::set_api_trace_sampling(state.config.api_trace_sampling);
+    apitool::reset_api_counters();
+    option_parse_cache().reset();
+    compiler_identify_cache().reset();
+    compiler_probe_cache().reset(state.config.compiler_cache);
 
     auto& loop = kota::event_loop::current();
     auto loop_task = state.js_loop.run(state.runtime, loop);
@@ -103,8 +124,39 @@ kota::task<> RuntimeScope::stop() {
         co_return;
     }
 
+    close_http_servers();
+    compiler_probe_cache().cancel();
     co_await state.js_loop.stop();
     started = false;
+
+    if(auto counters = apitool::format_api_counters(); !counters.empty()) {
+        LOG_INFO("C API calls of this session:{}", counters);
+    }
+    if(state.bytecode_cache) {
+        auto stats = state.bytecode_cache->stats();
+        auto pruned = state.bytecode_cache->prune();
+        LOG_INFO("Bytecode cache {}: {} hits, {} misses, {} files pruned",
+                 state.bytecode_cache->directory().string(),
+                 stats.hits,
+                 stats.misses,
+                 pruned);
+    }
+    if(auto stats = compiler_probe_cache().stats(); stats.probes + stats.diskHits > 0) {
+        LOG_INFO("Compiler probes: {} spawned, {} from disk, {} hits, {} joined, {} failed",
+                 stats.probes,
+                 stats.diskHits,
+                 stats.hits,
+                 stats.joined,
+                 stats.failures);
+    }
+    if(auto stats = option_parse_cache().stats(); stats.hits + stats.partialHits > 0) {
+        LOG_INFO("Option parse cache: {} hits, {} partial hits, {} misses, {} of {} args reused",
+                 stats.hits,
+                 stats.partialHits,
+                 stats.misses,
+                 stats.reusedArgs,
+                 stats.reusedArgs + stats.parsedArgs);
+    }
     co_return;
 }
 
@@ -114,10 +166,29 @@ kota::task<> run_script(std::string_view content, std::string_view filepath) {
     co_return;
 }
 
+kota::task<> run_builtin_script(std::string_view script_name) {
+    const auto content = load_builtin_script(script_name);
+    if(content.empty()) {
+        throw cpptrace::runtime_error(std::format("Unknown builtin script '{}'", script_name));
+    }
+    if(!builtin_files_are_bytecode()) {
+        co_await run_script(content, script_name);
+        co_return;
+    }
+
+    auto ctx = state.runtime.context();
+    co_await wait_for_callback_promise(ctx.eval_module_bytecode(content));
+    co_return;
+}
+
 JsLoop& loop() {
     return state.js_loop;
 }
 
+BytecodeCacheStats bytecode_cache_stats() {
+    return state.bytecode_cache ? state.bytecode_cache->stats() : BytecodeCacheStats{};
+}
+
 kota::task<CatterConfig> on_start(const CatterConfig& config) {
     if(!state.on_start) {
         throw cpptrace::runtime_error("service.onStart is not registered");
@@ -148,7 +219,9 @@ kota::task<Action> on_command(uint32_t id, std::expected<CommandData, CatterErr>
     auto command_result = qjs::Object::empty_one(state.on_command.context());
     if(data.has_value()) {
         command_result.set_property("success", true);
-        command_result.set_property("data", data->to_object(state.on_command.context()));
+        command_result.set_property("data",
+                                    make_command_object(state.on_command.context(),
+                                                        std::move(*data)));
     } else {
         command_result.set_property("success", false);
         command_result.set_property("error", data.error().to_object(state.on_command.context()));
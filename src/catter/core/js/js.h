@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <expected>
 #include <filesystem>
+#include <optional>
 #include <string_view>
 #include <kota/async/runtime/task.h>
 
@@ -13,6 +15,12 @@ namespace catter::js {
 
 struct RuntimeConfig {
     std::filesystem::path pwd;
+    /// Log one of every N calls of each C API with its arguments, 0 disables the trace.
+    uint32_t api_trace_sampling = 0;
+    /// Directory of the on-disk bytecode cache for scripts and the files they import, if any.
+    std::optional<std::filesystem::path> bytecode_cache;
+    /// Directory of the on-disk cache of compiler probes, if any.
+    std::optional<std::filesystem::path> compiler_cache;
 };
 
 const RuntimeConfig& get_global_runtime_config();
@@ -36,8 +44,14 @@ private:
 
 kota::task<> run_script(std::string_view content, std::string_view filepath);
 
+/// Runs a builtin script such as "script::cdb", whether it was embedded as source or bytecode.
+kota::task<> run_builtin_script(std::string_view script_name);
+
 JsLoop& loop();
 
+/// Counters of the session's bytecode cache, all zero when it has none.
+BytecodeCacheStats bytecode_cache_stats();
+
 void set_on_start(qjs::Object cb);
 void set_on_finish(qjs::Object cb);
 void set_on_command(qjs::Object cb);
@@ -0,0 +1,223 @@
+#include "option_cache.h"
+
+#include <algorithm>
+#include <format>
+#include <utility>
+
+namespace catter::js {
+
+namespace {
+
+constexpr uint64_t fnv_offset = 0xcbf29ce484222325ULL;
+
+uint64_t fnv1a(std::string_view bytes, uint64_t hash) {
+    for(unsigned char byte: bytes) {
+        hash = (hash ^ byte) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t key_of(std::string_view table, uint32_t visibility, std::span<const uint64_t> arg_hashes) {
+    auto hash = fnv1a(table, fnv_offset);
+    hash = fnv1a(std::string_view(reinterpret_cast<const char*>(&visibility), sizeof(visibility)),
+                 hash);
+    return fnv1a(std::string_view(reinterpret_cast<const char*>(arg_hashes.data()),
+                                  arg_hashes.size_bytes()),
+                 hash);
+}
+
+bool has_dash_dash(std::span<const std::string> args) {
+    return std::ranges::find(args, "--") != args.end();
+}
+
+size_t entry_bytes(const OptionParseCache::Parsed& parsed) {
+    size_t size = sizeof(OptionParseCache::Parsed) + 128;
+    for(const auto& item: parsed.items) {
+        size += sizeof(OptionItem) + item.key.size();
+        for(const auto& value: item.values) {
+            size += sizeof(std::string) + value.size();
+        }
+    }
+    return size;
+}
+
+bool never_stop(uint32_t) {
+    return false;
+}
+
+}  // namespace
+
+std::shared_ptr<const OptionParseCache::Parsed>
+    OptionParseCache::parse(std::string_view table,
+                            uint32_t visibility,
+                            std::span<const std::string> args,
+                            const Parser& parser) {
+    if(budget == 0) {
+        auto parsed = std::make_shared<Parsed>();
+        parser(args, 0, never_stop, *parsed);
+        ++counters.misses;
+        counters.parsedArgs += args.size();
+        return parsed;
+    }
+
+    std::vector<uint64_t> arg_hashes;
+    arg_hashes.reserve(args.size());
+    for(const auto& arg: args) {
+        arg_hashes.push_back(fnv1a(arg, fnv_offset));
+    }
+    const auto hash = key_of(table, visibility, arg_hashes);
+    const auto dash_dash = has_dash_dash(args);
+    auto& reference = references[std::format("{}/{}", table, visibility)];
+    auto remember = [&](std::shared_ptr<const Parsed> parsed) {
+        reference.arg_hashes = std::move(arg_hashes);
+        reference.dash_dash = dash_dash;
+        reference.parsed = std::move(parsed);
+    };
+
+    if(auto it = by_hash.find(hash); it != by_hash.end()) {
+        entries.splice(entries.begin(), entries, it->second);
+        ++counters.hits;
+        counters.reusedArgs += args.size();
+        remember(it->second->parsed);
+        return it->second->parsed;
+    }
+
+    auto parsed = std::make_shared<Parsed>();
+    size_t reused = 0;
+    if(reference.parsed != nullptr && !dash_dash && !reference.dash_dash) {
+        reused = parse_against(reference, args, arg_hashes, parser, *parsed);
+    } else {
+        parser(args, 0, never_stop, *parsed);
+    }
+    if(reused > 0) {
+        ++counters.partialHits;
+    } else {
+        ++counters.misses;
+    }
+    counters.reusedArgs += reused;
+    counters.parsedArgs += args.size() - reused;
+
+    const auto size = entry_bytes(*parsed);
+    if(size <= budget) {
+        evict_to(budget - size);
+        entries.push_front(Entry{
+            .hash = hash,
+            .parsed = parsed,
+            .bytes = size,
+        });
+        by_hash.emplace(hash, entries.begin());
+        bytes += size;
+        remember(parsed);
+    }
+    return parsed;
+}
+
+size_t OptionParseCache::parse_against(const Reference& reference,
+                                       std::span<const std::string> args,
+                                       std::span<const uint64_t> arg_hashes,
+                                       const Parser& parser,
+                                       Parsed& out) const {
+    const auto& ref_hashes = reference.arg_hashes;
+    const auto& ref_items = reference.parsed->items;
+    const auto& ref_error = reference.parsed->error;
+
+    // An item ends where the next one starts. Where the last one ends is unknown: it may take
+    // every argument after it (RemainingArgs such as clang-cl's "/link"), or parsing failed after
+    // it, so it is never reused from the prefix.
+    auto item_end = [&](size_t k) -> size_t {
+        return k + 1 < ref_items.size() ? ref_items[k + 1].index : ref_hashes.size() + 1;
+    };
+
+    const auto prefix = static_cast<size_t>(
+        std::ranges::mismatch(ref_hashes, arg_hashes).in1 - ref_hashes.begin());
+    size_t from = 0;
+    size_t next = 0;
+    if(!ref_items.empty() && ref_items.front().index == 0) {
+        for(; next < ref_items.size() && item_end(next) <= prefix; ++next) {
+            out.items.push_back(ref_items[next]);
+            from = item_end(next);
+        }
+    }
+
+    // Reference items starting inside the common suffix, keyed by where they start in `args`.
+    const auto suffix = static_cast<size_t>(
+        std::ranges::mismatch(ref_hashes.rbegin(),
+                              ref_hashes.rend(),
+                              arg_hashes.rbegin(),
+                              arg_hashes.rend())
+            .in1 -
+        ref_hashes.rbegin());
+    const auto shift =
+        static_cast<int64_t>(args.size()) - static_cast<int64_t>(ref_hashes.size());
+    std::unordered_map<uint32_t, size_t> anchors;
+    for(size_t k = next; k < ref_items.size(); ++k) {
+        const auto start = static_cast<int64_t>(ref_items[k].index);
+        if(start >= static_cast<int64_t>(ref_hashes.size() - suffix) &&
+           start + shift >= static_cast<int64_t>(from)) {
+            anchors.emplace(static_cast<uint32_t>(start + shift), k);
+        }
+    }
+
+    size_t reused = from;
+    const auto stopped =
+        anchors.empty()
+            ? parser(args, from, never_stop, out)
+            : parser(args, from, [&](uint32_t index) { return anchors.contains(index); }, out);
+    if(stopped) {
+        for(size_t k = anchors.at(*stopped); k < ref_items.size(); ++k) {
+            auto item = ref_items[k];
+            item.index = static_cast<uint32_t>(item.index + shift);
+            out.items.push_back(std::move(item));
+        }
+        if(ref_error) {
+            out.error = Error{
+                .index = static_cast<uint32_t>(ref_error->index + shift),
+                .reason = ref_error->reason,
+            };
+        }
+        reused += args.size() - *stopped;
+    }
+    return reused;
+}
+
+void OptionParseCache::reset(size_t next_budget) {
+    entries.clear();
+    by_hash.clear();
+    references.clear();
+    bytes = 0;
+    budget = next_budget;
+    counters = {};
+}
+
+void OptionParseCache::set_budget(size_t next_budget) {
+    budget = next_budget;
+    evict_to(budget);
+    if(budget == 0) {
+        references.clear();
+    }
+}
+
+void OptionParseCache::evict_to(size_t limit) {
+    while(bytes > limit && !entries.empty()) {
+        auto& oldest = entries.back();
+        bytes -= oldest.bytes;
+        by_hash.erase(oldest.hash);
+        entries.pop_back();
+        ++counters.evictions;
+    }
+}
+
+OptionCacheStats OptionParseCache::stats() const {
+    auto result = counters;
+    result.entries = entries.size();
+    result.bytes = bytes;
+    result.budget = budget;
+    return result;
+}
+
+OptionParseCache& option_parse_cache() {
+    static OptionParseCache cache;
+    return cache;
+}
+
+}  // namespace catter::js
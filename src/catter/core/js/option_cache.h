@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "capi/type.h"
+
+namespace catter::js {
+
+/**
+ * Session-scoped memo of option table parses.
+ *
+ * Most commands of a build share their flags and differ only in the source and output. An
+ * argument vector seen before is answered from the cache. For a new one, the previous parse with
+ * the same table and visibility serves as the reference. Its items that lie entirely inside the
+ * common prefix and are followed by another item are reused; the last one may take every
+ * argument after it, like clang-cl's "/link", so it is parsed again. Parsing then stops at the
+ * first item boundary inside the common suffix, and the rest of the reference items are reused
+ * with shifted indices. Parsing runs left to right and an item depends only on the arguments from
+ * where it starts, so the result equals a full parse. Vectors containing "--" are always parsed
+ * in full, since it changes how later arguments parse.
+ *
+ * Entries keep only the hash of their key and the parse, and arguments are compared by hash, so
+ * the cache holds no copy of the arguments it has seen. Entries are evicted least recently used
+ * first once they outgrow the memory budget. A budget of zero turns the cache off.
+ */
+class OptionParseCache {
+public:
+    struct Error {
+        uint32_t index;
+        std::string reason;
+    };
+
+    struct Parsed {
+        std::vector<OptionItem> items;
+        /// Set when parsing failed after `items`.
+        std::optional<Error> error;
+    };
+
+    using StopAt = std::function<bool(uint32_t index)>;
+
+    /**
+     * Parses `args` from index `from` on and appends to `out`, with indices into `args`. Stops
+     * right before an item whose index satisfies `stop_at` and returns that index.
+     */
+    using Parser = std::function<std::optional<uint32_t>(std::span<const std::string> args,
+                                                         size_t from,
+                                                         const StopAt& stop_at,
+                                                         Parsed& out)>;
+
+    constexpr static size_t default_budget = 16 * 1024 * 1024;
+
+    std::shared_ptr<const Parsed> parse(std::string_view table,
+                                        uint32_t visibility,
+                                        std::span<const std::string> args,
+                                        const Parser& parser);
+
+    /// Drops every entry and the statistics and sets a new budget, done when a session starts.
+    void reset(size_t budget = default_budget);
+
+    /// Changes the budget, evicting entries that no longer fit.
+    void set_budget(size_t bytes);
+
+    OptionCacheStats stats() const;
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::shared_ptr<const Parsed> parsed;
+        size_t bytes;
+    };
+
+    /// The last vector parsed with a table and visibility, by the hash of each argument.
+    struct Reference {
+        std::vector<uint64_t> arg_hashes;
+        bool dash_dash = false;
+        std::shared_ptr<const Parsed> parsed;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    size_t parse_against(const Reference& reference,
+                         std::span<const std::string> args,
+                         std::span<const uint64_t> arg_hashes,
+                         const Parser& parser,
+                         Parsed& out) const;
+
+    void evict_to(size_t limit);
+
+    size_t budget = default_budget;
+    size_t bytes = 0;
+    /// Most recently used first.
+    EntryList entries;
+    std::unordered_map<uint64_t, EntryList::iterator> by_hash;
+    /// "table/visibility" -> the last vector parsed with them.
+    std::unordered_map<std::string, Reference> references;
+    OptionCacheStats counters{};
+};
+
+/// The cache behind the option C API, reset by `RuntimeScope::start`.
+OptionParseCache& option_parse_cache();
+
+}  // namespace catter::js
@@ -555,6 +555,47 @@ Module Context::load_module(std::string_view input, const char* module_name) con
     return this->load_module(input.data(), input.size(), module_name);
 }
 
+std::string Context::compile_module(std::string_view input, const char* module_name) const {
+    auto module = this->eval(input,
+                             module_name,
+                             JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_STRICT | JS_EVAL_FLAG_COMPILE_ONLY);
+
+    size_t size = 0;
+    auto* bytecode =
+        JS_WriteObject(this->js_context(), &size, module.value(), JS_WRITE_OBJ_BYTECODE);
+    if(bytecode == nullptr) {
+        throw qjs::JSException::dump(this->js_context());
+    }
+    std::string result(reinterpret_cast<const char*>(bytecode), size);
+    js_free(this->js_context(), bytecode);
+    return result;
+}
+
+Module Context::load_module_bytecode(std::string_view bytecode) const noexcept {
+    return Module{this->js_context(),
+                  JS_ReadObject(this->js_context(),
+                                reinterpret_cast<const uint8_t*>(bytecode.data()),
+                                bytecode.size(),
+                                JS_READ_OBJ_BYTECODE)};
+}
+
+Promise Context::eval_module_bytecode(std::string_view bytecode) const {
+    auto module = this->load_module_bytecode(bytecode);
+    if(!module) {
+        throw qjs::JSException::dump(this->js_context());
+    }
+    if(JS_ResolveModule(this->js_context(), module.value()) < 0) {
+        throw qjs::JSException::dump(this->js_context());
+    }
+
+    auto val = JS_EvalFunction(this->js_context(), module.release());
+    if(this->has_exception()) {
+        JS_FreeValue(this->js_context(), val);
+        throw qjs::JSException::dump(this->js_context());
+    }
+    return Value{this->js_context(), std::move(val)}.as<Promise>();
+}
+
 Object Context::global_this() const noexcept {
     return Object{this->js_context(), JS_GetGlobalObject(this->js_context())};
 }
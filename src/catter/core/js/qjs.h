@@ -1486,6 +1486,18 @@ public:
 
     Module load_module(std::string_view input, const char* module_name) const noexcept;
 
+    /**
+     * Compile a module without evaluating it and serialize it with JS_WriteObject.
+     * The result is what load_module_bytecode() and eval_module_bytecode() accept.
+     */
+    std::string compile_module(std::string_view input, const char* module_name) const;
+
+    /** Like load_module(), from bytecode written by compile_module() or catter-jsc. */
+    Module load_module_bytecode(std::string_view bytecode) const noexcept;
+
+    /** Like eval_module(), from bytecode written by compile_module() or catter-jsc. */
+    Promise eval_module_bytecode(std::string_view bytecode) const;
+
     Object global_this() const noexcept;
 
     bool has_exception() const noexcept;
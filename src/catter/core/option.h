@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <cstdio>
 #include <exception>
 #include <filesystem>
@@ -94,6 +95,27 @@ struct CatterConfig {
         required = false)
     <js::CatterOptions::StdioMode> stdio_mode = js::CatterOptions::StdioMode::inherit;
 
+    DecoKV(
+        names = {"--record"},
+        meta_var = "<Replay File>",
+        help = "record every command, result and error of the build into a line-delimited replay file",
+        required = false)
+    <std::string> record;
+
+    DecoKV(
+        names = {"--trace-api"},
+        meta_var = "<N>",
+        help = "log the arguments and result of one of every N calls of each native API; default to 0 (off)",
+        required = false)
+    <uint32_t> trace_api = 0;
+
+    DecoKV(
+        names = {"--trace-spans"},
+        meta_var = "<Trace File>",
+        help = "record where the time of each exec goes across catter, catter-proxy and the hook into a Chrome/Perfetto trace file",
+        required = false)
+    <std::string> trace_spans;
+
     DecoPack(
         meta_var = "<Args>",
         help =
@@ -0,0 +1,213 @@
+#include "process_watcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#ifdef CATTER_LINUX
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "util/guard.h"
+#include "util/log.h"
+#include "util/span_trace.h"
+
+namespace catter {
+
+#ifdef CATTER_LINUX
+namespace {
+
+/// Prefix of `struct pidfd_info` from <linux/pidfd.h>, which older kernel headers lack.
+struct pidfd_exit_info {
+    uint64_t mask;
+    uint64_t cgroupid;
+    uint32_t pid;
+    uint32_t tgid;
+    uint32_t ppid;
+    uint32_t ruid;
+    uint32_t rgid;
+    uint32_t euid;
+    uint32_t egid;
+    uint32_t suid;
+    uint32_t sgid;
+    uint32_t fsuid;
+    uint32_t fsgid;
+    int32_t exit_code;
+};
+
+static_assert(sizeof(pidfd_exit_info) == 64, "must match PIDFD_INFO_SIZE_VER0");
+
+constexpr uint64_t PIDFD_INFO_EXIT_MASK = 1ULL << 3;
+constexpr unsigned long PIDFD_GET_INFO_REQUEST = _IOWR(0xFF, 11, pidfd_exit_info);
+
+/// How long the real parent may take to reap the process before its status is reported unknown.
+constexpr int reap_timeout_ms = 10'000;
+
+enum class ExitInfo {
+    available,
+    /// The process is a zombie, the kernel records its status once the parent reaps it.
+    pending,
+    unsupported,
+};
+
+ExitInfo query_exit_info(int fd, pidfd_exit_info& info) noexcept {
+    info = pidfd_exit_info{.mask = PIDFD_INFO_EXIT_MASK};
+    if(::ioctl(fd, PIDFD_GET_INFO_REQUEST, &info) != 0) {
+        // ESRCH: gone and not reaped yet; anything else: no PIDFD_GET_INFO (Linux < 6.13)
+        return errno == ESRCH ? ExitInfo::pending : ExitInfo::unsupported;
+    }
+    return (info.mask & PIDFD_INFO_EXIT_MASK) ? ExitInfo::available : ExitInfo::pending;
+}
+
+int64_t to_exit_code(int32_t status) noexcept {
+    if(WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    }
+    if(WIFSIGNALED(status)) {
+        // follow the shell convention
+        return 128 + WTERMSIG(status);
+    }
+    return -1;
+}
+
+/// Waits until `fd` is readable, false once `cancel` is, or when `timeout_ms` passes.
+bool poll_or_cancel(int fd, int cancel, int timeout_ms) noexcept {
+    pollfd fds[2] = {
+        {.fd = fd, .events = POLLIN, .revents = 0},
+        {.fd = cancel, .events = POLLIN, .revents = 0},
+    };
+    while(true) {
+        const int ready = ::poll(fds, 2, timeout_ms);
+        if(ready < 0 && errno == EINTR) {
+            continue;
+        }
+        return ready > 0 && fds[1].revents == 0 && fds[0].revents != 0;
+    }
+}
+
+/// Blocks until the process behind `fd` exits and its parent reaps it, nullopt when cancelled.
+/// The pidfd is readable as soon as the process is a zombie, its status only follows the reap.
+std::optional<int64_t> wait_exit_code(int fd, int cancel) noexcept {
+    if(!poll_or_cancel(fd, cancel, -1)) {
+        return std::nullopt;
+    }
+
+    pidfd_exit_info info{};
+    int backoff_ms = 1;
+    for(int waited_ms = 0;;) {
+        switch(query_exit_info(fd, info)) {
+            case ExitInfo::available: return to_exit_code(info.exit_code);
+            case ExitInfo::unsupported:
+                LOG_WARN("Exit status of watched process is not available: errno {}", errno);
+                return -1;
+            case ExitInfo::pending: break;
+        }
+        if(waited_ms >= reap_timeout_ms) {
+            LOG_WARN("Watched process was not reaped within {} ms, its exit status is unknown",
+                     reap_timeout_ms);
+            return -1;
+        }
+        // sleeping on the cancel pipe alone, it never becomes readable otherwise
+        pollfd sleeper{.fd = cancel, .events = POLLIN, .revents = 0};
+        if(::poll(&sleeper, 1, backoff_ms) > 0) {
+            return std::nullopt;
+        }
+        waited_ms += backoff_ms;
+        backoff_ms = std::min(backoff_ms * 2, 50);
+    }
+}
+
+}  // namespace
+#endif
+
+ProcessWatcher::ProcessWatcher(int fd) noexcept : fd(fd), start(trace::now()) {}
+
+ProcessWatcher::ProcessWatcher(ProcessWatcher&& other) noexcept :
+    fd(std::exchange(other.fd, -1)), start(other.start) {}
+
+ProcessWatcher& ProcessWatcher::operator= (ProcessWatcher&& other) noexcept {
+    if(this != &other) {
+        std::swap(this->fd, other.fd);
+        std::swap(this->start, other.start);
+    }
+    return *this;
+}
+
+ProcessWatcher::~ProcessWatcher() {
+#ifdef CATTER_LINUX
+    if(this->fd >= 0) {
+        ::close(this->fd);
+    }
+#endif
+}
+
+std::optional<ProcessWatcher> ProcessWatcher::open(int64_t pid) noexcept {
+#ifdef CATTER_LINUX
+    auto fd = static_cast<int>(::syscall(SYS_pidfd_open, static_cast<pid_t>(pid), 0));
+    if(fd < 0) {
+        LOG_WARN("pidfd_open({}) failed: errno {}", pid, errno);
+        return std::nullopt;
+    }
+    return ProcessWatcher(fd);
+#else
+    LOG_WARN("Watching process {} is not supported on this platform", pid);
+    return std::nullopt;
+#endif
+}
+
+kota::task<data::process_result> ProcessWatcher::wait() {
+#ifdef CATTER_LINUX
+    // libuv has no pidfd handle, so block in poll on a thread and come back through a relay,
+    // like the process waiter of the windows hook.
+    // The state is shared since setting the event may resume and destroy this frame.
+    struct WaitState {
+        kota::event exited{};
+        int64_t code = -1;
+    };
+
+    // Writing to `cancel` wakes the poller when this frame is destroyed first, e.g. when the
+    // session stops while the process still runs, so joining it never blocks.
+    int cancel[2];
+    if(::pipe2(cancel, O_CLOEXEC) != 0) {
+        LOG_WARN("Cannot watch process: pipe failed with errno {}", errno);
+        co_return data::process_result{};
+    }
+
+    auto state = std::make_shared<WaitState>();
+    auto relay = kota::event_loop::current().create_relay();
+    std::jthread poller(
+        [fd = this->fd, cancel = cancel[0], state, relay = std::move(relay)]() mutable {
+            auto code = wait_exit_code(fd, cancel);
+            if(code.has_value()) {
+                relay.send([state, code = *code]() {
+                    state->code = code;
+                    state->exited.set();
+                });
+            }
+        });
+    auto stop = util::make_guard([&]() noexcept {
+        (void)::write(cancel[1], "", 1);
+        poller.join();
+        ::close(cancel[0]);
+        ::close(cancel[1]);
+    });
+
+    co_await state->exited.wait();
+    co_return data::process_result{
+        .code = state->code,
+        .usage = {.start = this->start, .end = trace::now()},
+    };
+#else
+    co_return data::process_result{};
+#endif
+}
+
+}  // namespace catter
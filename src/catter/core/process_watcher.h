@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <kota/async/async.h>
+
+#include "util/data.h"
+
+namespace catter {
+
+/**
+ * Observes the exit of a process catter did not spawn, so it cannot wait for it.
+ *
+ * Backed by a pidfd on Linux, which must be opened while the process is still alive.
+ */
+class ProcessWatcher {
+public:
+    ProcessWatcher(const ProcessWatcher&) = delete;
+    ProcessWatcher(ProcessWatcher&& other) noexcept;
+    ProcessWatcher& operator= (const ProcessWatcher&) = delete;
+    ProcessWatcher& operator= (ProcessWatcher&& other) noexcept;
+    ~ProcessWatcher();
+
+    /// Returns nullopt when `pid` cannot be watched on this platform or kernel.
+    static std::optional<ProcessWatcher> open(int64_t pid) noexcept;
+
+    /**
+     * Wait for the process to exit.
+     *
+     * The output is never captured. The status is only recorded once the real parent reaps the
+     * process, which this waits for. The code is -1 when the kernel does not report the exit
+     * status of processes that are not our children (Linux < 6.15) or the parent does not reap
+     * it within 10 s. The usage has the time from `open` to the exit only, the rusage of a
+     * process that is not our child is out of reach.
+     *
+     * Destroying the task before the process exits stops waiting right away.
+     */
+    kota::task<data::process_result> wait();
+
+private:
+    explicit ProcessWatcher(int fd) noexcept;
+
+    int fd = -1;
+    data::timestamp_t start = 0;
+};
+
+}  // namespace catter
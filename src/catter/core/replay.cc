@@ -5,13 +5,13 @@
 #include <format>
 #include <fstream>
 #include <iterator>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <cpptrace/exceptions.hpp>
 #include <kota/async/io/loop.h>
 
-#include "js/builtin_files.h"
 #include "js/capi/bridge.h"
 #include "js/js.h"
 #include "js/qjs.h"
@@ -46,14 +46,6 @@ namespace fs = std::filesystem;
 namespace {
 
 std::string load_script_source(const ReplayConfig& config) {
-    if(config.script.starts_with("script::")) {
-        const auto source = js::load_builtin_script(config.script);
-        if(source.empty()) {
-            throw cpptrace::runtime_error("Unknown builtin script '" + config.script + "'");
-        }
-        return std::string(source);
-    }
-
     std::ifstream input(config.script, std::ios::binary);
     if(!input) {
         throw cpptrace::runtime_error("Failed to open script file: " + config.script);
@@ -61,6 +53,19 @@ std::string load_script_source(const ReplayConfig& config) {
     return std::string(std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{});
 }
 
+constexpr int64_t line_delimited_version = 2;
+
+void validate_replay_event(const ReplayEvent& event) {
+    if(event.type.has_value() && *event.type != "command") {
+        throw cpptrace::runtime_error(
+            std::format("Unsupported replay event type: '{}'", *event.type));
+    }
+    if(event.error.has_value() && event.execution.has_value()) {
+        throw cpptrace::runtime_error(
+            std::format("Replay event {} has both 'error' and 'execution'", event.id));
+    }
+}
+
 void validate_replay_file(const ReplayFile& replay) {
     if(!replay.version.has_value()) {
         throw cpptrace::runtime_error("Replay file is missing required field 'version'");
@@ -71,14 +76,90 @@ void validate_replay_file(const ReplayFile& replay) {
     }
 
     for(const auto& event: replay.events) {
-        if(event.type.has_value() && *event.type != "command") {
-            throw cpptrace::runtime_error(
-                std::format("Unsupported replay event type: '{}'", *event.type));
+        validate_replay_event(event);
+    }
+}
+
+void append_json(std::string& out, std::string_view text) {
+    constexpr std::string_view hex = "0123456789abcdef";
+    out += '"';
+    for(char c: text) {
+        switch(c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += hex[static_cast<unsigned char>(c) >> 4];
+                    out += hex[static_cast<unsigned char>(c) & 0xf];
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+void append_json(std::string& out, const std::vector<std::string>& values) {
+    out += '[';
+    for(size_t index = 0; index < values.size(); ++index) {
+        if(index != 0) {
+            out += ", ";
         }
-        if(event.error.has_value() && event.execution.has_value()) {
-            throw cpptrace::runtime_error(
-                std::format("Replay event {} has both 'error' and 'execution'", event.id));
+        append_json(out, values[index]);
+    }
+    out += ']';
+}
+
+/// Appends the members of a process result, without braces.
+void append_process_result(std::string& out, const js::ProcessResult& result) {
+    out += std::format(R"("code": {}, "stdout": )", result.code);
+    append_json(out, result.stdOut);
+    out += R"(, "stderr": )";
+    append_json(out, result.stdErr);
+    if(!result.usage) {
+        return;
+    }
+    const auto& usage = *result.usage;
+    out += std::format(R"(, "usage": {{"startUs": {}, "endUs": {})", usage.startUs, usage.endUs);
+    auto append_counter = [&](std::string_view name, const std::optional<int64_t>& value) {
+        if(value) {
+            out += std::format(R"(, "{}": {})", name, *value);
         }
+    };
+    append_counter("userUs", usage.userUs);
+    append_counter("systemUs", usage.systemUs);
+    append_counter("maxRssKiB", usage.maxRssKiB);
+    append_counter("readBlocks", usage.readBlocks);
+    append_counter("writeBlocks", usage.writeBlocks);
+    out += '}';
+}
+
+bool is_blank(std::string_view line) {
+    return line.find_first_not_of(" \t\r") == std::string_view::npos;
+}
+
+/// Parses the first line when it holds a whole JSON object: the header of a version 2 replay or
+/// a version 1 document written on one line. A version 1 document spanning several lines usually
+/// only opens its object there, which yields nullopt.
+std::optional<qjs::Object> parse_first_line(std::string_view line, const qjs::Runtime& runtime) {
+    const auto first = line.find_first_not_of(" \t\r");
+    const auto last = line.find_last_not_of(" \t\r");
+    if(first == std::string_view::npos || line[first] != '{' || line[last] != '}' ||
+       first == last) {
+        return std::nullopt;
+    }
+
+    try {
+        return qjs::json::parse(std::string(line.substr(first, last - first + 1)),
+                                runtime.context())
+            .as<qjs::Object>();
+    } catch(const qjs::Exception&) {
+        return std::nullopt;
     }
 }
 
@@ -125,25 +206,34 @@ std::expected<js::CommandData, js::CatterErr> to_command_data(const ReplayConfig
     };
 }
 
-kota::task<> replay_task(ReplayConfig config, const ReplayFile& replay) {
+kota::task<> replay_task(ReplayConfig config, ReplayStream& replay) {
     js::RuntimeScope runtime;
     std::exception_ptr error;
     try {
         runtime.start({.pwd = config.working_directory});
 
-        auto source = load_script_source(config);
-        co_await js::run_script(source, config.script);
+        if(config.script.starts_with("script::")) {
+            co_await js::run_builtin_script(config.script);
+        } else {
+            co_await js::run_script(load_script_source(config), config.script);
+        }
 
-        auto script_config = co_await js::on_start(to_catter_config(config, replay));
+        auto script_config =
+            co_await js::on_start(to_catter_config(config, replay.metadata()));
         if(script_config.execute) {
-            for(const auto& event: replay.events) {
-                co_await js::on_command(event.id, to_command_data(config, event));
-                if(event.execution.has_value()) {
-                    co_await js::on_execution(event.id, *event.execution);
+            while(auto event = replay.next()) {
+                if(event->type == "execution") {
+                    co_await js::on_execution(event->id, *event->execution);
+                    continue;
+                }
+                co_await js::on_command(event->id, to_command_data(config, *event));
+                if(event->execution.has_value()) {
+                    co_await js::on_execution(event->id, *event->execution);
                 }
             }
 
-            co_await js::on_finish(replay.finish.value_or(js::ProcessResult{.code = 0}));
+            co_await js::on_finish(
+                replay.metadata().finish.value_or(js::ProcessResult{.code = 0}));
         }
 
     } catch(...) {
@@ -160,22 +250,194 @@ kota::task<> replay_task(ReplayConfig config, const ReplayFile& replay) {
 
 }  // namespace
 
-ReplayFile parse_replay_file(const fs::path& path) {
-    std::ifstream input(path, std::ios::binary);
+ReplayStream::ReplayStream(const fs::path& path) :
+    input(path, std::ios::binary), runtime(qjs::Runtime::create()) {
     if(!input) {
         throw cpptrace::runtime_error("Failed to open replay file: " + path.string());
     }
+
+    std::string first;
+    std::getline(input, first);
+    if(auto object = parse_first_line(first, runtime)) {
+        if((*object)["events"].is_undefined()) {
+            auto header = js::make_reflected_object<ReplayHeader>(*object);
+            if(!header.version.has_value()) {
+                throw cpptrace::runtime_error("Replay file is missing required field 'version'");
+            }
+            if(*header.version != line_delimited_version) {
+                throw cpptrace::runtime_error(
+                    std::format("Unsupported replay file version: {}", *header.version));
+            }
+            this->replay = {
+                .version = header.version,
+                .name = std::move(header.name),
+                .cwd = std::move(header.cwd),
+                .build_system_command = std::move(header.build_system_command),
+            };
+            return;
+        }
+
+        // A version 1 document on a single line, already parsed whole.
+        input.close();
+        load_document(js::make_reflected_object<ReplayFile>(*object));
+        return;
+    }
+
+    // Version 1 documents are a single JSON value spanning the whole file.
+    input.clear();
+    input.seekg(0);
     std::string content(std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{});
+    input.close();
+
+    auto value = qjs::json::parse(content, runtime.context());
+    load_document(js::make_reflected_object<ReplayFile>(value.as<qjs::Object>()));
+}
 
-    auto runtime = qjs::Runtime::create();
-    auto ctx = runtime.context();
-    auto value = qjs::json::parse(content, ctx);
-    auto replay = js::make_reflected_object<ReplayFile>(value.as<qjs::Object>());
-    validate_replay_file(replay);
+ReplayStream::ReplayStream(ReplayFile replay) {
+    load_document(std::move(replay));
+}
+
+void ReplayStream::load_document(ReplayFile document) {
+    validate_replay_file(document);
+    this->events = std::move(document.events);
+    this->replay = std::move(document);
+    this->replay.events.clear();
+}
+
+std::optional<ReplayEvent> ReplayStream::next() {
+    if(input.is_open()) {
+        return next_line();
+    }
+    if(cursor == events.size()) {
+        return std::nullopt;
+    }
+    return std::move(events[cursor++]);
+}
+
+std::optional<ReplayEvent> ReplayStream::next_line() {
+    std::string text;
+    while(std::getline(input, text)) {
+        ++line;
+        if(is_blank(text)) {
+            continue;
+        }
+        try {
+            if(replay.finish.has_value()) {
+                throw cpptrace::runtime_error("unexpected content after the 'finish' line");
+            }
+
+            auto object = qjs::json::parse(text, runtime.context()).as<qjs::Object>();
+            auto type = object["type"];
+            if(!type.is_undefined() && type.as<std::string>() == "finish") {
+                replay.finish = js::make_reflected_object<js::ProcessResult>(object);
+                continue;
+            }
+            if(!type.is_undefined() && type.as<std::string>() == "execution") {
+                ReplayEvent event{
+                    .type = "execution",
+                    .id = object["id"].as<uint32_t>(),
+                    .execution = js::make_reflected_object<js::ProcessResult>(object),
+                };
+                return event;
+            }
+
+            auto event = js::make_reflected_object<ReplayEvent>(object);
+            validate_replay_event(event);
+            return event;
+        } catch(const std::exception& error) {
+            throw cpptrace::runtime_error(std::format("Replay line {}: {}", line, error.what()));
+        }
+    }
+
+    if(input.bad()) {
+        throw cpptrace::runtime_error(std::format("Failed to read replay line {}", line + 1));
+    }
+    input.close();
+    return std::nullopt;
+}
+
+std::string to_replay_line(const ReplayHeader& header) {
+    auto line = std::format(R"({{"version": {})", header.version.value_or(line_delimited_version));
+    if(header.name.has_value()) {
+        line += R"(, "name": )";
+        append_json(line, *header.name);
+    }
+    if(header.cwd.has_value()) {
+        line += R"(, "cwd": )";
+        append_json(line, *header.cwd);
+    }
+    if(header.build_system_command.has_value()) {
+        line += R"(, "build_system_command": )";
+        append_json(line, *header.build_system_command);
+    }
+    line += '}';
+    return line;
+}
+
+std::string to_replay_line(const ReplayEvent& event) {
+    if(event.type == "execution") {
+        auto line = std::format(R"({{"type": "execution", "id": {}, )", event.id);
+        append_process_result(line, event.execution.value_or(js::ProcessResult{}));
+        line += '}';
+        return line;
+    }
+
+    auto line = std::format(R"({{"type": "command", "id": {})", event.id);
+    if(event.parent.has_value()) {
+        line += std::format(R"(, "parent": {})", *event.parent);
+    }
+    if(event.error.has_value()) {
+        line += R"(, "error": {"message": )";
+        append_json(line, event.error->message);
+        if(event.error->parent.has_value()) {
+            line += std::format(R"(, "parent": {})", *event.error->parent);
+        }
+        line += '}';
+    }
+    if(event.cwd.has_value()) {
+        line += R"(, "cwd": )";
+        append_json(line, *event.cwd);
+    }
+    line += R"(, "exe": )";
+    append_json(line, event.exe);
+    line += R"(, "argv": )";
+    append_json(line, event.argv);
+    if(event.env.has_value()) {
+        line += R"(, "env": )";
+        append_json(line, *event.env);
+    }
+    if(event.execution.has_value()) {
+        line += R"(, "execution": {)";
+        append_process_result(line, *event.execution);
+        line += '}';
+    }
+    line += '}';
+    return line;
+}
+
+std::string to_replay_finish_line(const js::ProcessResult& result) {
+    std::string line = R"({"type": "finish", )";
+    append_process_result(line, result);
+    line += '}';
+    return line;
+}
+
+ReplayFile parse_replay_file(const fs::path& path) {
+    ReplayStream stream(path);
+    auto replay = stream.metadata();
+    while(auto event = stream.next()) {
+        replay.events.push_back(std::move(*event));
+    }
+    replay.finish = stream.metadata().finish;
     return replay;
 }
 
-void ReplayRunner::run(ReplayConfig config, const ReplayFile& replay) {
+void ReplayRunner::run(ReplayConfig config, ReplayFile replay) {
+    ReplayStream stream(std::move(replay));
+    run(std::move(config), stream);
+}
+
+void ReplayRunner::run(ReplayConfig config, ReplayStream& replay) {
     auto task = replay_task(std::move(config), replay);
 
     kota::event_loop loop;
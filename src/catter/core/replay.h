@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <optional>
 #include <string>
 #include <vector>
@@ -27,7 +28,7 @@ struct ReplayError {
  * command is processed. `parent` of 0 means no parent command.
  */
 struct ReplayEvent {
-    std::optional<std::string> type;  // "command"
+    std::optional<std::string> type;  // "command", or "execution" in version 2
     uint32_t id = 0;
     std::optional<int64_t> parent;
     std::optional<std::string> cwd;
@@ -54,6 +55,64 @@ struct ReplayFile {
     std::optional<js::ProcessResult> finish;
 };
 
+/**
+ * First line of a line-delimited replay (schema version 2).
+ *
+ * Every following line holds one JSON object: a `ReplayEvent` with `type`
+ * "command" (or no `type`), the result of an earlier command as `id` plus a
+ * `js::ProcessResult` with `type` "execution", or the build result as a
+ * `js::ProcessResult` with `type` "finish", which must be the last line when
+ * present. Recorded builds use "execution" lines so results are replayed in
+ * the order they happened, after the commands started meanwhile.
+ */
+struct ReplayHeader {
+    std::optional<int64_t> version;
+    std::optional<std::string> name;
+    std::optional<std::string> cwd;
+    std::optional<std::vector<std::string>> build_system_command;
+};
+
+/**
+ * Hands out the events of a replay one at a time.
+ *
+ * Version 1 documents are parsed whole, version 2 files are read and parsed
+ * one line at a time so memory stays bounded by the longest line however
+ * long the build is. The format is detected from the first line.
+ */
+class ReplayStream {
+public:
+    explicit ReplayStream(const std::filesystem::path& path);
+
+    explicit ReplayStream(ReplayFile replay);
+
+    /**
+     * Document metadata, `events` is always empty. The `finish` of a version 2
+     * file is only known once `next` has returned `std::nullopt`.
+     */
+    const ReplayFile& metadata() const noexcept {
+        return replay;
+    }
+
+    /**
+     * The next validated event, or `std::nullopt` after the last one. An
+     * "execution" line comes back as an event with `type` "execution" and only
+     * `id` and `execution` set.
+     */
+    std::optional<ReplayEvent> next();
+
+private:
+    void load_document(ReplayFile document);
+
+    std::optional<ReplayEvent> next_line();
+
+    ReplayFile replay;
+    std::vector<ReplayEvent> events;  // Version 1 events, handed out front to back.
+    size_t cursor = 0;
+    std::ifstream input;   // Version 2 lines after the header.
+    qjs::Runtime runtime;  // Parses version 2 lines.
+    uint64_t line = 1;
+};
+
 struct ReplayConfig {
     std::string script;  // "script::cdb" or a script file path.
     std::vector<std::string> script_args;
@@ -67,16 +126,27 @@ struct ReplayConfig {
         .supportActions = {js::ActionType::skip,
                            js::ActionType::drop,
                            js::ActionType::abort,
-                           js::ActionType::modify},
+                           js::ActionType::modify,
+                           js::ActionType::fake},
         .type = js::CatterRuntime::Type::inject,
         .supportParentId = true,
     };
     bool execute = true;
 };
 
+/// Serializes the header line of a version 2 replay, without the newline.
+std::string to_replay_line(const ReplayHeader& header);
+
+/// Serializes a "command" or "execution" line of a version 2 replay, without the newline.
+std::string to_replay_line(const ReplayEvent& event);
+
+/// Serializes the "finish" line of a version 2 replay, without the newline.
+std::string to_replay_finish_line(const js::ProcessResult& result);
+
 /**
  * Parses a replay JSON document with the embedded QuickJS runtime (no
- * third-party JSON dependency) and validates the schema.
+ * third-party JSON dependency) and validates the schema. Version 2 files are
+ * collected into memory, prefer `ReplayStream` for large ones.
  */
 ReplayFile parse_replay_file(const std::filesystem::path& path);
 
@@ -90,7 +160,9 @@ ReplayFile parse_replay_file(const std::filesystem::path& path);
  */
 class ReplayRunner {
 public:
-    void run(ReplayConfig config, const ReplayFile& replay);
+    void run(ReplayConfig config, ReplayFile replay);
+
+    void run(ReplayConfig config, ReplayStream& replay);
 };
 
 }  // namespace catter::core
@@ -1,20 +1,34 @@
 #include "runtime_driver.h"
 
 #include <array>
+#include <condition_variable>
 #include <cstdint>
 #include <expected>
+#include <filesystem>
 #include <format>
+#include <fstream>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <stop_token>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
 #include <utility>
+#include <variant>
+#include <vector>
 #include <cpptrace/exceptions.hpp>
 
 #include "ipc.h"
+#include "replay.h"
 #include "session.h"
 #include "config/catter-proxy.h"
 #include "js/js.h"
 #include "util/crossplat.h"
+#include "util/log.h"
+#include "util/span_trace.h"
 
 namespace catter::core {
 namespace {
@@ -27,9 +41,160 @@ Session::StdioMode to_process_stdio_mode(js::CatterOptions::StdioMode mode) {
     throw cpptrace::runtime_error("Unhandled catter output mode");
 }
 
+data::CaptureMode to_capture_mode(js::CaptureMode mode) {
+    switch(mode) {
+        case js::CaptureMode::none: return data::CaptureMode::NONE;
+        case js::CaptureMode::tail: return data::CaptureMode::TAIL;
+        case js::CaptureMode::full: return data::CaptureMode::FULL;
+    }
+
+    throw cpptrace::runtime_error("Unhandled capture mode");
+}
+
+/// Applies the options of a script on top of `fallback`.
+data::capture_policy to_capture_policy(std::optional<js::CaptureMode> mode,
+                                       std::optional<uint32_t> limit,
+                                       data::capture_policy fallback) {
+    if(mode.has_value()) {
+        fallback.mode = to_capture_mode(*mode);
+    }
+    if(limit.has_value()) {
+        fallback.limit = *limit;
+    }
+    return fallback;
+}
+
+data::exec_filter to_exec_filter(const std::optional<js::ExecFilter>& filter) {
+    if(!filter.has_value()) {
+        return {};
+    }
+#ifdef CATTER_WINDOWS
+    // The payload would have to inject itself into every bypassed process to keep intercepting
+    // its descendants, which only catter-proxy does.
+    if(!filter->allow.empty() || !filter->deny.empty()) {
+        throw cpptrace::runtime_error("options.execFilter is not supported on Windows");
+    }
+#endif
+    return data::exec_filter{.allow = filter->allow, .deny = filter->deny};
+}
+
+/// Appends the lines of a version 2 replay file from a writer thread, which also serializes them,
+/// so recording costs a decision no more than queueing the event. `append` runs on the event loop
+/// and never waits for the writer: once `max_pending` records are queued, further commands are
+/// dropped from the recording, together with their later events, and counted. The header and the
+/// result of the build are always queued. Records still queued are written out when the recorder
+/// is destroyed.
+class ReplayRecorder {
+public:
+    /// The header, a "command" or "execution" event, or the result of the build.
+    using Record = std::variant<ReplayHeader, ReplayEvent, js::ProcessResult>;
+
+    constexpr static size_t max_pending = 1024;
+
+    explicit ReplayRecorder(const std::filesystem::path& path) :
+        output(path, std::ios::binary | std::ios::trunc) {
+        if(!output) {
+            throw cpptrace::runtime_error(
+                std::format("Failed to open replay file for recording: {}", path.string()));
+        }
+        writer = std::jthread([this](std::stop_token stop) { this->drain(stop); });
+    }
+
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator= (const ReplayRecorder&) = delete;
+
+    ~ReplayRecorder() {
+        writer.request_stop();
+        writer.join();
+        if(dropped_commands > 0) {
+            LOG_WARN("The disk fell behind the build, {} commands are missing from the replay file",
+                     dropped_commands);
+        }
+    }
+
+    void append(Record record) {
+        {
+            std::lock_guard lock(mutex);
+            if(failed) {
+                return;
+            }
+            if(auto* event = std::get_if<ReplayEvent>(&record)) {
+                if(dropped_ids.contains(event->id)) {
+                    return;
+                }
+                if(pending.size() >= max_pending) {
+                    // Drop the command as a whole, so that the replay never sees half of it.
+                    dropped_ids.insert(event->id);
+                    ++dropped_commands;
+                    return;
+                }
+            }
+            pending.push_back(std::move(record));
+        }
+        ready.notify_one();
+    }
+
+private:
+    static std::string to_line(const Record& record) {
+        return std::visit(
+            [](const auto& value) {
+                if constexpr(std::is_same_v<std::decay_t<decltype(value)>, js::ProcessResult>) {
+                    return to_replay_finish_line(value);
+                } else {
+                    return to_replay_line(value);
+                }
+            },
+            record);
+    }
+
+    void drain(std::stop_token stop) {
+        std::vector<Record> batch;
+        while(true) {
+            {
+                std::unique_lock lock(mutex);
+                ready.wait(lock, stop, [&] { return !pending.empty(); });
+                if(pending.empty()) {
+                    return;
+                }
+                batch.swap(pending);
+            }
+            for(const auto& record: batch) {
+                output << to_line(record) << '\n';
+            }
+            // Keep what was recorded so far usable if catter dies mid-build.
+            output.flush();
+            if(!output) {
+                LOG_ERROR("Failed to write the replay file, recording stopped");
+                std::lock_guard lock(mutex);
+                failed = true;
+                pending.clear();
+                return;
+            }
+            batch.clear();
+        }
+    }
+
+    std::ofstream output;
+    std::mutex mutex;
+    std::condition_variable_any ready;
+    std::vector<Record> pending;
+    /// Commands left out of the recording, guarded by `mutex`.
+    std::unordered_set<uint32_t> dropped_ids;
+    size_t dropped_commands = 0;
+    bool failed = false;
+    std::jthread writer;  // Last, so it is joined before the members it uses go away.
+};
+
 class InjectService final : public ipc::InjectService {
 public:
-    InjectService(data::ipcid_t id, const js::CatterRuntime* runtime) : id(id), runtime(runtime) {}
+    InjectService(data::ipcid_t id,
+                  const js::CatterRuntime* runtime,
+                  data::exec_filter filter,
+                  bool exec_through,
+                  data::capture_policy capture,
+                  std::shared_ptr<ReplayRecorder> recorder) :
+        id(id), runtime(runtime), filter(std::move(filter)), through(exec_through),
+        capture(capture), recorder(std::move(recorder)) {}
 
     kota::task<data::ipcid_t> create(data::ipcid_t parent_id) noexcept override {
         this->parent_id = parent_id;
@@ -37,6 +202,19 @@ public:
     }
 
     kota::task<data::action> make_decision(data::command cmd) noexcept override {
+        if(recorder) {
+            recorder->append(ReplayEvent{
+                .type = "command",
+                .id = static_cast<uint32_t>(this->id),
+                .parent = this->parent_id == 0 ? std::optional<int64_t>{} : this->parent_id,
+                .cwd = cmd.cwd,
+                .exe = cmd.executable,
+                .argv = cmd.args,
+                .env = cmd.env,
+            });
+        }
+
+        const auto begin = trace::enabled() ? trace::now() : 0;
         auto act = co_await js::on_command(this->id,
                                            js::CommandData{
                                                .cwd = cmd.cwd,
@@ -46,16 +224,22 @@ public:
                                                .runtime = *runtime,
                                                .parent = this->parent_id,
                                            });
+        if(begin != 0) {
+            trace::record("js.on_command", begin, trace::now(), static_cast<uint32_t>(this->id));
+        }
 
         switch(act.type()) {
             case js::ActionType::drop: {
                 co_return data::action{.type = data::action::DROP, .cmd = {}};
             }
             case js::ActionType::skip: {
+                auto& tag = act.get<js::ActionType::skip>();
+                this->capture = to_capture_policy(tag.capture, tag.captureLimit, this->capture);
                 co_return data::action{.type = data::action::INJECT, .cmd = std::move(cmd)};
             }
             case js::ActionType::modify: {
                 auto& tag = act.get<js::ActionType::modify>();
+                this->capture = to_capture_policy(tag.capture, tag.captureLimit, this->capture);
                 co_return data::action{
                     .type = data::action::INJECT,
                     .cmd = {
@@ -66,6 +250,14 @@ public:
                             }
                 };
             }
+            case js::ActionType::fake: {
+                auto& tag = act.get<js::ActionType::fake>();
+                co_return data::action{
+                    .type = data::action::FAKE,
+                    .cmd = std::move(cmd),
+                    .outputs = std::move(tag.outputs),
+                };
+            }
             // TODO: handle js::ActionType::abort
             default: {
                 throw cpptrace::runtime_error("Unhandled action type");
@@ -74,22 +266,59 @@ public:
     }
 
     kota::task<> finish(data::process_result result) noexcept override {
-        co_await js::on_execution(this->id, to_js_process_result(std::move(result)));
+        auto execution = to_js_process_result(std::move(result));
+        if(recorder) {
+            recorder->append(ReplayEvent{
+                .type = "execution",
+                .id = static_cast<uint32_t>(this->id),
+                .execution = execution,
+            });
+        }
+        trace::Span span("js.on_execution", static_cast<uint32_t>(this->id));
+        co_await js::on_execution(this->id, std::move(execution));
         co_return;
     }
 
     kota::task<> report_error(data::ipcid_t parent_id, std::string error_msg) noexcept override {
+        if(recorder) {
+            recorder->append(ReplayEvent{
+                .type = "command",
+                .id = static_cast<uint32_t>(this->id),
+                .error = ReplayError{.message = error_msg, .parent = parent_id},
+            });
+        }
         co_await js::on_command(
             id,
             std::unexpected(js::CatterErr{.msg = std::move(error_msg), .parent = parent_id}));
         co_return;
     }
 
+    data::exec_filter exec_filter() const override {
+        return this->filter;
+    }
+
+    bool exec_through() const override {
+        return this->through;
+    }
+
+    data::capture_policy capture_policy() const override {
+        return this->capture;
+    }
+
     struct Factory {
         const js::CatterRuntime* runtime;
+        data::exec_filter filter;
+        bool exec_through;
+        data::capture_policy capture;
+        std::shared_ptr<ReplayRecorder> recorder;
 
         std::unique_ptr<InjectService> operator() (data::ipcid_t id) const {
-            return std::make_unique<InjectService>(id, runtime);
+            return std::make_unique<InjectService>(id,
+                                                   runtime,
+                                                   filter,
+                                                   exec_through,
+                                                   capture,
+                                                   recorder);
         }
     };
 
@@ -97,6 +326,10 @@ private:
     data::ipcid_t id = 0;
     data::ipcid_t parent_id = 0;
     const js::CatterRuntime* runtime = nullptr;
+    data::exec_filter filter;
+    bool through = false;
+    data::capture_policy capture{};
+    std::shared_ptr<ReplayRecorder> recorder;
 };
 
 class InjectRuntimeDriver final : public RuntimeDriver {
@@ -107,7 +340,10 @@ public:
 
     const js::CatterRuntime& runtime() const noexcept override {
         const static js::CatterRuntime value{
-            .supportActions = {js::ActionType::drop, js::ActionType::skip, js::ActionType::modify},
+            .supportActions = {js::ActionType::drop,
+                               js::ActionType::skip,
+                               js::ActionType::modify,
+                               js::ActionType::fake},
             .type = js::CatterRuntime::Type::inject,
             .supportParentId = true,
         };
@@ -120,6 +356,8 @@ public:
         }
 
         auto proxy_path = util::get_catter_root_path() / config::proxy::EXE_NAME;
+        const auto capture =
+            to_capture_policy(config.options.capture, config.options.captureLimit, {});
         Session::ProcessLaunchPlan launch_plan{
             .cwd = config.buildSystemCommandCwd,
             .executable = proxy_path.string(),
@@ -129,15 +367,36 @@ public:
                        "-p", "0",
                        "--", },
             .mode = to_process_stdio_mode(config.options.stdioMode),
+            .capture = capture,
         };
         util::append_range_to_vector(launch_plan.args, config.buildSystemCommand);
 
+        std::shared_ptr<ReplayRecorder> recorder;
+        if(config.options.record.has_value()) {
+            recorder = std::make_shared<ReplayRecorder>(*config.options.record);
+            recorder->append(ReplayHeader{
+                .version = 2,
+                .cwd = config.buildSystemCommandCwd,
+                .build_system_command = config.buildSystemCommand,
+            });
+        }
+
         Session session;
         auto session_plan =
             Session::make_run_plan(std::move(launch_plan),
-                                   InjectService::Factory{.runtime = &config.runtime});
+                                   InjectService::Factory{
+                                       .runtime = &config.runtime,
+                                       .filter = to_exec_filter(config.options.execFilter),
+                                       .exec_through = config.options.execThrough.value_or(false),
+                                       .capture = capture,
+                                       .recorder = recorder,
+                                   });
 
-        co_return co_await session.run(std::move(session_plan));
+        auto result = co_await session.run(std::move(session_plan));
+        if(recorder) {
+            recorder->append(to_js_process_result(result));
+        }
+        co_return result;
     }
 };
 
@@ -166,11 +425,28 @@ const RuntimeDriver* default_runtime_driver() noexcept {
 }
 
 js::ProcessResult to_js_process_result(data::process_result result) {
-    return js::ProcessResult{
+    js::ProcessResult js_result{
         .code = result.code,
         .stdOut = std::move(result.std_out),
         .stdErr = std::move(result.std_err),
     };
+    const auto& usage = result.usage;
+    if(usage.start == 0) {
+        return js_result;
+    }
+    auto number = [](uint64_t value) { return static_cast<int64_t>(value); };
+    auto& js_usage = js_result.usage.emplace(js::ProcessUsage{
+        .startUs = number(usage.start / 1000),
+        .endUs = number(usage.end / 1000),
+    });
+    if(usage.rusage) {
+        js_usage.userUs = number(usage.user_us);
+        js_usage.systemUs = number(usage.system_us);
+        js_usage.maxRssKiB = number(usage.max_rss_kib);
+        js_usage.readBlocks = number(usage.read_blocks);
+        js_usage.writeBlocks = number(usage.write_blocks);
+    }
+    return js_result;
 }
 
 }  // namespace catter::core
@@ -2,11 +2,14 @@
 
 #include <cassert>
 #include <format>
-#include <list>
+#include <memory>
 #include <optional>
 #include <ranges>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
 #include <cpptrace/exceptions.hpp>
 #include <kota/async/async.h>
 
@@ -16,18 +19,23 @@
 #include "util/guard.h"
 #include "util/kotatsu.h"
 #include "util/log.h"
+#include "util/span_trace.h"
 
 namespace catter {
 
 kota::task<data::process_result> Session::run(RunPlan run_plan) {
+    this->endpoint = config::ipc::make_pipe_name();
 #ifndef _WIN32
-    if(std::filesystem::exists(config::ipc::pipe_name())) {
-        std::filesystem::remove(config::ipc::pipe_name());
+    if(std::filesystem::exists(this->endpoint)) {
+        std::filesystem::remove(this->endpoint);
     }
+    auto cleanup = util::make_guard([&]() noexcept {
+        std::error_code ec;
+        std::filesystem::remove(this->endpoint, ec);
+    });
 #endif
     auto& current_loop = kota::event_loop::current();
-    auto acc_ret =
-        kota::pipe::listen(config::ipc::pipe_name(), kota::pipe::options(), current_loop);
+    auto acc_ret = kota::pipe::listen(this->endpoint, kota::pipe::options(), current_loop);
 
     if(!acc_ret) {
         throw cpptrace::runtime_error(
@@ -40,14 +48,94 @@ kota::task<data::process_result> Session::run(RunPlan run_plan) {
     auto spawn_task = this->spawn(std::move(run_plan.launch_plan.executable),
                                   std::move(run_plan.launch_plan.args),
                                   std::move(run_plan.launch_plan.cwd),
-                                  run_plan.launch_plan.mode);
+                                  run_plan.launch_plan.mode,
+                                  run_plan.launch_plan.capture);
 
     auto [_, process_result] = co_await kota::when_all{std::move(loop_task), std::move(spawn_task)};
     co_return std::move(process_result);
 }
 
+namespace {
+
+/// Failures of client tasks, folded by message so that a build with millions of clients keeps a
+/// bounded record of them.
+class ClientErrors {
+public:
+    void add(data::ipcid_t id, std::string_view message) {
+        ++total;
+        for(auto& entry: entries) {
+            if(entry.message == message) {
+                ++entry.count;
+                return;
+            }
+        }
+        if(entries.size() < max_distinct) {
+            entries.push_back(Entry{.message = std::string(message), .first = id, .count = 1});
+        } else {
+            ++dropped;
+        }
+    }
+
+    bool empty() const {
+        return total == 0;
+    }
+
+    std::string summary() const {
+        std::string text;
+        for(const auto& entry: entries) {
+            text += std::format("Exception in client task {}{}: {}\n",
+                                entry.first,
+                                entry.count > 1 ? std::format(" and {} more", entry.count - 1) : "",
+                                entry.message);
+        }
+        if(dropped > 0) {
+            text += std::format("{} more client tasks failed with other messages\n", dropped);
+        }
+        return text;
+    }
+
+private:
+    constexpr static size_t max_distinct = 32;
+
+    struct Entry {
+        std::string message;
+        data::ipcid_t first;
+        size_t count;
+    };
+
+    std::vector<Entry> entries;
+    size_t total = 0;
+    size_t dropped = 0;
+};
+
+/// Shared by the accept loop and the detached client tasks. Setting `drained` may resume and
+/// finish the loop while a client task is still unwinding, hence the shared ownership.
+struct ClientReaper {
+    size_t active = 0;
+    bool accepting = true;
+    kota::event drained{};
+    ClientErrors errors;
+};
+
+/// Runs one client to completion and records its failure. The task is scheduled detached, so
+/// its frame and the service it owns are freed as soon as the client is done.
+kota::task<void> reap(std::shared_ptr<ClientReaper> reaper,
+                      data::ipcid_t id,
+                      kota::task<void> client) {
+    try {
+        co_await std::move(client);
+    } catch(const std::exception& ex) {
+        reaper->errors.add(id, ex.what());
+    }
+    if(--reaper->active == 0 && !reaper->accepting) {
+        reaper->drained.set();
+    }
+}
+
+}  // namespace
+
 kota::task<void> Session::loop(ClientAcceptor acceptor) {
-    std::list<kota::task<void>> linked_clients;
+    auto reaper = std::make_shared<ClientReaper>();
     for(auto i: std::views::iota(data::ipcid_t(1))) {
         auto client = co_await this->acc->accept();
         if(!client) {
@@ -56,22 +144,17 @@ kota::task<void> Session::loop(ClientAcceptor acceptor) {
             // expected
             break;
         }
-        linked_clients.push_back(acceptor(i, std::move(*client)));
-        kota::event_loop::current().schedule(linked_clients.back());
+        ++reaper->active;
+        kota::event_loop::current().schedule(reap(reaper, i, acceptor(i, std::move(*client))));
         LOG_INFO("Accepted new client with id: {}", i);
     }
 
-    std::string error_msg;
-
-    for(auto& client_task: linked_clients) {
-        try {
-            client_task.result();  // Await completion and propagate exceptions
-        } catch(const std::exception& ex) {
-            error_msg += std::format("Exception in client task: {}\n", ex.what());
-        }
+    reaper->accepting = false;
+    if(reaper->active > 0) {
+        co_await reaper->drained.wait();
     }
-    if(!error_msg.empty()) {
-        throw cpptrace::runtime_error(std::move(error_msg));
+    if(!reaper->errors.empty()) {
+        throw cpptrace::runtime_error(reaper->errors.summary());
     }
     co_return;
 }
@@ -79,7 +162,8 @@ kota::task<void> Session::loop(ClientAcceptor acceptor) {
 kota::task<data::process_result> Session::spawn(std::string executable,
                                                 std::vector<std::string> args,
                                                 std::string cwd,
-                                                StdioMode mode) {
+                                                StdioMode mode,
+                                                data::capture_policy capture) {
     // for exception safety: ensure acceptor is stopped when spawn exits, since spawn failure should
     // prevent the session from running
     auto guard = util::make_guard([&]() noexcept {
@@ -102,21 +186,46 @@ kota::task<data::process_result> Session::spawn(std::string executable,
              cwd,
              args_str);
 
+    // Collecting the output is the whole point of StdioMode::capture, it always needs the pipes.
+    if(mode == StdioMode::capture && capture.mode == data::CaptureMode::NONE) {
+        capture.mode = data::CaptureMode::TAIL;
+    }
+
+    // Every proxy and hook of this session finds the endpoint through the environment.
+    auto env = util::get_environment();
+    std::erase_if(env, [](const std::string& entry) {
+        return entry.starts_with(std::format("{}=", config::ipc::KEY_CATTER_IPC_ENDPOINT));
+    });
+    env.push_back(std::format("{}={}", config::ipc::KEY_CATTER_IPC_ENDPOINT, this->endpoint));
+    std::erase_if(env, [](const std::string& entry) {
+        return entry.starts_with(std::format("{}=", config::ipc::KEY_CATTER_TRACE_DIR));
+    });
+    if(auto dir = trace::directory(); !dir.empty()) {
+        env.push_back(std::format("{}={}", config::ipc::KEY_CATTER_TRACE_DIR, dir));
+    }
+
     kota::process::options opts{
         .file = executable,
         .args = args,
+        .env = std::move(env),
         .cwd = cwd,
         .creation = {.windows_hide = true, .windows_verbatim_arguments = true},
         .streams = {kota::process::stdio::inherit(),
-                     kota::process::stdio::pipe(false, true),
-                     kota::process::stdio::pipe(false, true)}
+                     output_stdio(capture.mode),
+                     output_stdio(capture.mode)}
     };
 
     switch(mode) {
         case StdioMode::inherit:
-            co_return co_await capture_process_result(make_process_event(opts), stdout, stderr);
+            co_return co_await capture_process_result(make_process_event(opts),
+                                                      stdout,
+                                                      stderr,
+                                                      capture);
         case StdioMode::capture:
-            co_return co_await capture_process_result(make_process_event(opts), nullptr, nullptr);
+            co_return co_await capture_process_result(make_process_event(opts),
+                                                      nullptr,
+                                                      nullptr,
+                                                      capture);
     }
 
     std::abort();
@@ -4,7 +4,6 @@
 #include <cstdint>
 #include <filesystem>
 #include <format>
-#include <list>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -48,6 +47,8 @@ public:
         std::string executable;
         std::vector<std::string> args;
         StdioMode mode;
+        /// With `NONE` and `StdioMode::inherit` the process writes to the terminal directly.
+        data::capture_policy capture{};
     };
 
     struct RunPlan {
@@ -67,9 +68,10 @@ public:
         return RunPlan{
             .launch_plan = std::move(launch_plan),
             .callback =
-                [factory = std::forward<ServiceFactoryType>(factory)](data::ipcid_t id,
-                                                                      kota::pipe&& client) {
-                    return ipc::accept(factory(id), std::move(client));
+                [factory = std::forward<ServiceFactoryType>(factory),
+                 envs = std::make_shared<ipc::EnvTable>()](data::ipcid_t id,
+                                                           kota::pipe&& client) {
+                    return ipc::accept(factory(id), std::move(client), envs);
                 },
         };
     }
@@ -88,9 +90,11 @@ private:
     kota::task<data::process_result> spawn(std::string executable,
                                            std::vector<std::string> args,
                                            std::string cwd,
-                                           StdioMode mode);
+                                           StdioMode mode,
+                                           data::capture_policy capture);
 
     std::unique_ptr<PipeAcceptor> acc = nullptr;
+    std::string endpoint{};
 };
 
 }  // namespace catter
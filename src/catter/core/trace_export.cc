@@ -0,0 +1,199 @@
+#include "trace_export.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <cpptrace/exceptions.hpp>
+
+#include "util/log.h"
+#include "util/span_trace.h"
+
+namespace catter::core {
+
+namespace {
+
+struct TraceSpan {
+    std::string name;
+    uint64_t begin;
+    uint64_t end;
+    uint32_t track;
+};
+
+struct TraceFile {
+    uint32_t pid;
+    std::string process;
+    std::vector<TraceSpan> spans;
+};
+
+class Reader {
+public:
+    explicit Reader(std::string_view bytes) : rest(bytes) {}
+
+    template <typename T>
+    std::optional<T> number() {
+        T value;
+        if(rest.size() < sizeof(value)) {
+            return std::nullopt;
+        }
+        std::memcpy(&value, rest.data(), sizeof(value));
+        rest.remove_prefix(sizeof(value));
+        return value;
+    }
+
+    std::optional<std::string> string() {
+        auto size = number<uint32_t>();
+        if(!size || rest.size() < *size) {
+            return std::nullopt;
+        }
+        std::string value(rest.substr(0, *size));
+        rest.remove_prefix(*size);
+        return value;
+    }
+
+    bool magic() {
+        constexpr std::string_view expected(trace::file_magic, sizeof(trace::file_magic));
+        if(!rest.starts_with(expected)) {
+            return false;
+        }
+        rest.remove_prefix(expected.size());
+        return true;
+    }
+
+    bool empty() const {
+        return rest.empty();
+    }
+
+private:
+    std::string_view rest;
+};
+
+std::optional<TraceFile> read_trace_file(const std::filesystem::path& path) {
+    std::ifstream input(path, std::ios::binary);
+    std::string bytes{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+
+    Reader reader(bytes);
+    auto pid = reader.magic() ? reader.number<uint32_t>() : std::nullopt;
+    auto process = pid ? reader.string() : std::nullopt;
+    if(!process) {
+        return std::nullopt;
+    }
+
+    TraceFile file{.pid = *pid, .process = std::move(*process), .spans = {}};
+    while(!reader.empty()) {
+        auto begin = reader.number<uint64_t>();
+        auto end = reader.number<uint64_t>();
+        auto track = reader.number<uint32_t>();
+        auto name = reader.string();
+        if(!begin || !end || !track || !name) {
+            break;
+        }
+        file.spans.push_back(TraceSpan{
+            .name = std::move(*name),
+            .begin = *begin,
+            .end = std::max(*begin, *end),
+            .track = *track,
+        });
+    }
+    return file;
+}
+
+void append_json(std::string& out, std::string_view text) {
+    constexpr std::string_view hex = "0123456789abcdef";
+    out += '"';
+    for(char c: text) {
+        switch(c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += hex[static_cast<unsigned char>(c) >> 4];
+                    out += hex[static_cast<unsigned char>(c) & 0xf];
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+}  // namespace
+
+size_t export_chrome_trace(const std::filesystem::path& directory,
+                           const std::filesystem::path& output) {
+    std::vector<TraceFile> files;
+    std::error_code ec;
+    for(const auto& entry: std::filesystem::directory_iterator(directory, ec)) {
+        if(entry.path().extension() != trace::file_extension) {
+            continue;
+        }
+        if(auto file = read_trace_file(entry.path())) {
+            files.push_back(std::move(*file));
+        } else {
+            LOG_WARN("Skipping broken span file {}", entry.path().string());
+        }
+    }
+
+    uint64_t origin = std::numeric_limits<uint64_t>::max();
+    for(const auto& file: files) {
+        for(const auto& span: file.spans) {
+            origin = std::min(origin, span.begin);
+        }
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    auto next_event = [&]() {
+        if(!first) {
+            out += ",\n";
+        }
+        first = false;
+    };
+
+    size_t count = 0;
+    for(size_t index = 0; index < files.size(); ++index) {
+        const auto& file = files[index];
+        const auto pid = index + 1;
+        next_event();
+        out += std::format(R"({{"ph":"M","name":"process_name","pid":{},"args":{{"name":)",
+                           pid);
+        append_json(out, std::format("{} [{}]", file.process, file.pid));
+        out += "}}";
+
+        for(const auto& span: file.spans) {
+            next_event();
+            out += "{\"ph\":\"X\",\"cat\":\"catter\",\"name\":";
+            append_json(out, span.name);
+            out += std::format(",\"pid\":{},\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                               pid,
+                               span.track,
+                               static_cast<double>(span.begin - origin) / 1000.0,
+                               static_cast<double>(span.end - span.begin) / 1000.0);
+            ++count;
+        }
+    }
+    out += "]}\n";
+
+    std::ofstream stream(output, std::ios::binary | std::ios::trunc);
+    stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if(!stream) {
+        throw cpptrace::runtime_error(
+            std::format("Failed to write the span trace to {}", output.string()));
+    }
+    return count;
+}
+
+}  // namespace catter::core
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace catter::core {
+
+/**
+ * Merges the span files that the processes of a traced session wrote under `directory` (see
+ * `util/span_trace.h`) into one Chrome trace event file at `output`, which chrome://tracing and
+ * Perfetto open directly.
+ *
+ * Each file becomes a process of its own, named after the process and its pid, since an image
+ * replaced through exec keeps the pid of the previous one. Times are relative to the earliest
+ * span. A file cut short by a crash keeps the spans before the cut. Returns the number of spans
+ * written and throws when `output` cannot be written.
+ */
+size_t export_chrome_trace(const std::filesystem::path& directory,
+                           const std::filesystem::path& output);
+
+}  // namespace catter::core
@@ -2,4 +2,7 @@
 
 namespace catter::config::core {
 constexpr static char LOG_PATH_REL[] = "log/catter.log";
+constexpr static char BYTECODE_CACHE_PATH_REL[] = "cache";
+constexpr static char COMPILER_CACHE_PATH_REL[] = "cache/compiler";
+constexpr static char TRACE_PATH_REL[] = "trace";
 };  // namespace catter::config::core
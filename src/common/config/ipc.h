@@ -1,15 +1,55 @@
 #pragma once
+#include <cstdlib>
+#include <format>
+#include <random>
+#include <string>
+#include <string_view>
+
+#ifndef CATTER_WINDOWS
+#include <sys/un.h>
+#endif
+
 #include "util/crossplat.h"
 
 namespace catter::config::ipc {
 
-inline std::string_view pipe_name() {
+/// Carries the endpoint of the session to catter-proxy and to the hooked processes.
+constexpr static char KEY_CATTER_IPC_ENDPOINT[] = "__key_catter_ipc_endpoint_v1";
+
+/// Carries the environment of the parent command to the proxies of its children, in the format
+/// of `util::encode_env_base`, so that they send only what changed.
+constexpr static char KEY_CATTER_ENV_BASE[] = "__key_catter_env_base_v1";
+
+/// Carries the directory that every process of a traced session writes its spans to, see
+/// `util/span_trace.h`. Unlike the keys above it is an ordinary variable of the build
+/// environment, the hook neither drops nor re-adds it.
+constexpr static char KEY_CATTER_TRACE_DIR[] = "__key_catter_trace_dir_v1";
+
+/// A fresh endpoint for one session. The pid and a random nonce keep concurrent catter runs,
+/// and a stale socket left by a crashed one, from colliding.
+inline std::string make_pipe_name() {
+    auto nonce = std::random_device{}();
+    auto name = std::format("catter-ipc-{}-{:08x}", util::get_process_id(), nonce);
 #ifdef CATTER_WINDOWS
-    return R"(\\.\pipe\catter-ipc)";
+    return std::format(R"(\\.\pipe\{})", name);
 #else
-    static std::string path = util::get_catter_data_path() / "pipe-catter-ipc.sock";
+    auto path = (util::get_catter_data_path() / (name + ".sock")).string();
+    // A socket path must fit `sun_path` (108 bytes on Linux, 104 on macOS) with its terminator,
+    // which a deep $HOME does not.
+    if(path.size() >= sizeof(sockaddr_un::sun_path)) {
+        path = "/tmp/" + name + ".sock";
+    }
     return path;
 #endif
 }
 
+/// The endpoint of the session this process belongs to, empty outside of a session.
+inline std::string_view pipe_name() {
+    static std::string endpoint = [] {
+        const char* value = std::getenv(KEY_CATTER_IPC_ENDPOINT);
+        return value == nullptr ? std::string() : std::string(value);
+    }();
+    return endpoint;
+}
+
 }  // namespace catter::config::ipc
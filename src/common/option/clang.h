@@ -2,6 +2,8 @@
 
 #include <kota/deco/option.h>
 
+#include "option/prefix_index.h"
+
 namespace catter::opt::clang {
 
 enum ID : unsigned {
@@ -38,4 +40,6 @@ enum DriverClass : unsigned {
 
 const kota::option::OptTable& table();
 
+const PrefixIndex& prefix_index();
+
 }  // namespace catter::opt::clang
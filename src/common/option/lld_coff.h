@@ -2,6 +2,8 @@
 
 #include <kota/deco/option.h>
 
+#include "option/prefix_index.h"
+
 namespace catter::opt::lld_coff {
 
 enum ID : unsigned {
@@ -28,4 +30,6 @@ enum ID : unsigned {
 
 const kota::option::OptTable& table();
 
+const PrefixIndex& prefix_index();
+
 }  // namespace catter::opt::lld_coff
@@ -89,4 +89,9 @@ const kota_opt::OptTable& table() {
     return opt_table;
 }
 
+const PrefixIndex& prefix_index() {
+    const static auto index = PrefixIndex(std::span<const kota_opt::Option>(detail::OptionInfos));
+    return index;
+}
+
 }  // namespace catter::opt::lld_mingw
@@ -0,0 +1,181 @@
+#include "option/prefix_index.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace catter::opt {
+
+namespace kota_opt = kota::option;
+
+PrefixIndex::PrefixIndex(std::span<const kota_opt::Option> options) : options(options) {
+    struct BuildNode {
+        std::vector<std::pair<unsigned char, uint32_t>> children;
+        std::vector<Entry> entries;
+    };
+
+    std::vector<BuildNode> trie(1);
+    auto walk = [&](uint32_t node, std::string_view bytes) {
+        for(unsigned char byte: bytes) {
+            const auto& children = trie[node].children;
+            auto it = std::ranges::find(children, byte, &std::pair<unsigned char, uint32_t>::first);
+            if(it != children.end()) {
+                node = it->second;
+                continue;
+            }
+            const auto child = static_cast<uint32_t>(trie.size());
+            trie[node].children.emplace_back(byte, child);
+            trie.emplace_back();
+            node = child;
+        }
+        return node;
+    };
+
+    for(uint32_t i = 0; i < options.size(); ++i) {
+        const auto& option = options[i];
+        // Groups, <input> and <unknown> have no prefix and are never matched by spelling.
+        if(option.prefixes.empty()) {
+            continue;
+        }
+        // The prefixed name is spelled with the first prefix.
+        const auto name = option.prefixed_name.substr(option.prefixes.front().size());
+        for(auto prefix: option.prefixes) {
+            const auto node = walk(walk(0, prefix), name);
+            trie[node].entries.push_back(Entry{
+                .option = i,
+                .prefix_size = static_cast<uint16_t>(prefix.size()),
+                .name_size = static_cast<uint16_t>(name.size()),
+            });
+        }
+    }
+
+    nodes.resize(trie.size());
+    for(size_t id = 0; id < trie.size(); ++id) {
+        auto& build = trie[id];
+        std::ranges::sort(build.children);
+        nodes[id] = Node{
+            .first_edge = static_cast<uint32_t>(edges.size()),
+            .edge_count = static_cast<uint32_t>(build.children.size()),
+            .first_entry = static_cast<uint32_t>(entries.size()),
+            .entry_count = static_cast<uint32_t>(build.entries.size()),
+        };
+        for(auto [byte, child]: build.children) {
+            edges.push_back(Edge{.byte = byte, .node = child});
+        }
+        entries.insert(entries.end(), build.entries.begin(), build.entries.end());
+    }
+}
+
+std::optional<PrefixIndex::Resolved> PrefixIndex::resolve(std::span<const std::string> args,
+                                                          size_t index,
+                                                          uint32_t visibility) const {
+    const std::string_view arg = args[index];
+    if(arg == "-" || arg == "--") {
+        return std::nullopt;
+    }
+
+    // Visible spellings the argument starts with, shortest first.
+    std::array<Entry, 16> found;
+    size_t count = 0;
+    uint32_t node = 0;
+    for(size_t depth = 0;; ++depth) {
+        const auto& current = nodes[node];
+        for(uint32_t e = current.first_entry; e < current.first_entry + current.entry_count; ++e) {
+            if((options[entries[e].option].visibility & visibility) == 0) {
+                continue;
+            }
+            if(count == found.size()) {
+                return std::nullopt;
+            }
+            found[count++] = entries[e];
+        }
+        if(depth == arg.size()) {
+            break;
+        }
+
+        const auto first = edges.begin() + current.first_edge;
+        const auto last = first + current.edge_count;
+        const auto byte = static_cast<unsigned char>(arg[depth]);
+        auto it = std::ranges::lower_bound(first, last, byte, {}, &Edge::byte);
+        if(it == last || it->byte != byte) {
+            break;
+        }
+        node = it->node;
+    }
+
+    // The option table tries longer names first. Names of the same length are the same spelling
+    // here and stay in table order, which is the order it tries them in. When the matches went
+    // through different prefixes the pick depends on how it sorts names, so that is left to it.
+    auto candidates = std::span(found).first(count);
+    for(const auto& entry: candidates) {
+        if(entry.prefix_size != candidates.front().prefix_size) {
+            return std::nullopt;
+        }
+    }
+    std::ranges::stable_sort(candidates, std::ranges::greater{}, &Entry::name_size);
+
+    const bool has_next = index + 1 < args.size();
+    for(size_t k = 0; k < candidates.size(); ++k) {
+        const auto& option = options[candidates[k].option];
+        const size_t size = candidates[k].prefix_size + candidates[k].name_size;
+        const bool exact = size == arg.size();
+        Resolved resolved{
+            .id = option.id,
+            .spelling = arg.substr(0, size),
+            .value = std::nullopt,
+            .next = static_cast<uint32_t>(index + 1),
+        };
+
+        switch(option.kind) {
+            case kota_opt::Kind::Flag: {
+                if(!exact) {
+                    continue;
+                }
+                break;
+            }
+
+            case kota_opt::Kind::Separate: {
+                if(!exact) {
+                    continue;
+                }
+                if(!has_next) {
+                    return std::nullopt;
+                }
+                resolved.value = args[index + 1];
+                resolved.next += 1;
+                break;
+            }
+
+            case kota_opt::Kind::Joined: {
+                // An empty joined value is rare enough to leave to the option table.
+                if(exact) {
+                    return std::nullopt;
+                }
+                resolved.value = arg.substr(size);
+                break;
+            }
+
+            case kota_opt::Kind::JoinedOrSeparate: {
+                if(!exact) {
+                    resolved.value = arg.substr(size);
+                } else if(has_next) {
+                    resolved.value = args[index + 1];
+                    resolved.next += 1;
+                } else {
+                    return std::nullopt;
+                }
+                break;
+            }
+
+            default: return std::nullopt;
+        }
+
+        if(option.alias_id != 0 || option.alias_args != nullptr) {
+            return std::nullopt;
+        }
+        return resolved;
+    }
+    return std::nullopt;
+}
+
+}  // namespace catter::opt
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <kota/deco/option.h>
+
+namespace catter::opt {
+
+/**
+ * A byte trie over every prefixed spelling of an option table.
+ *
+ * `kota::option::OptTable` finds the option of an argument by a sorted scan of the whole table.
+ * The index walks the argument once instead and collects the options whose spelling it starts
+ * with. `resolve` only answers for arguments whose outcome it knows for sure: an unaliased Flag,
+ * Joined, Separate or JoinedOrSeparate option, picked the way the option table picks it (longest
+ * name first, skipping options that do not accept the argument). Everything else, such as inputs,
+ * unknown options, "--", aliases, other kinds or a missing value, yields nothing and is left to
+ * the option table.
+ */
+class PrefixIndex {
+public:
+    struct Resolved {
+        unsigned id;
+        /// The option spelling as written, e.g. "-I" for "-Iinclude".
+        std::string_view spelling;
+        /// Joined or separate value; Flags have none.
+        std::optional<std::string_view> value;
+        /// Index of the argument after the option and its value.
+        uint32_t next;
+    };
+
+    explicit PrefixIndex(std::span<const kota::option::Option> options);
+
+    std::optional<Resolved> resolve(std::span<const std::string> args,
+                                    size_t index,
+                                    uint32_t visibility) const;
+
+    size_t node_count() const {
+        return nodes.size();
+    }
+
+private:
+    struct Node {
+        uint32_t first_edge = 0;
+        uint32_t edge_count = 0;
+        uint32_t first_entry = 0;
+        uint32_t entry_count = 0;
+    };
+
+    struct Edge {
+        unsigned char byte;
+        uint32_t node;
+    };
+
+    /// One spelling of an option: `options[option]` spelled with a prefix of `prefix_size` bytes.
+    struct Entry {
+        uint32_t option;
+        uint16_t prefix_size;
+        uint16_t name_size;
+    };
+
+    std::span<const kota::option::Option> options;
+    /// Children of a node are contiguous in `edges` and sorted by byte, the root is node 0.
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    /// Spellings ending at a node, contiguous per node and in table order.
+    std::vector<Entry> entries;
+};
+
+}  // namespace catter::opt
@@ -43,11 +43,16 @@ std::filesystem::path get_executable_path() {
     return std::filesystem::path(buf.data());
 }
 
+uint32_t get_process_id() noexcept {
+    return static_cast<uint32_t>(getpid());
+}
+
 }  // namespace catter::util
 
 #elif defined(CATTER_MAC)
 
 #include <crt_externs.h>
+#include <unistd.h>
 #include <mach-o/dyld.h>
 
 namespace catter::util {
@@ -80,6 +85,10 @@ std::filesystem::path get_executable_path() {
     return std::filesystem::path(buf.data());
 }
 
+uint32_t get_process_id() noexcept {
+    return static_cast<uint32_t>(getpid());
+}
+
 }  // namespace catter::util
 
 #elif defined(CATTER_WINDOWS)
@@ -126,6 +135,10 @@ std::filesystem::path get_catter_data_path() {
     return get_catter_root_path();
 }
 
+uint32_t get_process_id() noexcept {
+    return static_cast<uint32_t>(GetCurrentProcessId());
+}
+
 }  // namespace catter::util
 #endif
 
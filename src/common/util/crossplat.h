@@ -1,5 +1,6 @@
 #pragma once
 #include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <ranges>
 #include <string>
@@ -22,6 +23,8 @@ std::filesystem::path get_executable_path();
  */
 std::filesystem::path get_catter_data_path();
 
+uint32_t get_process_id() noexcept;
+
 inline uint64_t unique_id() {
     auto id = std::this_thread::get_id();
     auto id_hash = std::hash<std::thread::id>{}(id);
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 #include <kota/ipc/protocol.h>
 
 namespace catter::data {
@@ -17,10 +18,39 @@ struct command {
     std::vector<std::string> env{};
 };
 
+/// An environment sent as its difference to the environment of the parent command, which catter
+/// holds already, see util/env_delta.h. The order of the entries and duplicates are kept.
+struct env_delta {
+    /// Of the whole environment, 0 when the environment is sent in full instead.
+    uint64_t hash = 0;
+    /// Of the environment the delta applies to.
+    uint64_t base = 0;
+    /// Indices of the base entries missing from the environment, ascending.
+    std::vector<uint32_t> removed{};
+    /// Entries missing from the base.
+    std::vector<std::string> added{};
+    /// Index of each `added` entry in the environment, ascending.
+    std::vector<uint32_t> added_at{};
+};
+
+/// What running a process cost. Timestamps are nanoseconds of `trace::now()`, 0 when the process
+/// was not run; the other counters are only meaningful with `rusage` set.
+struct process_usage {
+    timestamp_t start = 0;
+    timestamp_t end = 0;
+    bool rusage = false;
+    uint64_t user_us = 0;
+    uint64_t system_us = 0;
+    uint64_t max_rss_kib = 0;
+    uint64_t read_blocks = 0;
+    uint64_t write_blocks = 0;
+};
+
 struct process_result {
     int64_t code = -1;
     std::string std_out{};
     std::string std_err{};
+    process_usage usage{};
 };
 
 struct action {
@@ -28,15 +58,43 @@ struct action {
         DROP,    // Do not execute the command
         INJECT,  // Inject <catter-payload> into the command
         WRAP,    // Wrap the command execution, and return its exit code
+        FAKE,    // Create placeholder `outputs` instead of running the command
     } type;
 
     command cmd;
+    /// Files the command would have produced, relative paths resolve against `cmd.cwd`.
+    std::vector<std::string> outputs{};
+};
+
+/// Executable basename globs deciding which execs the hook sends through catter-proxy.
+///
+/// A command is intercepted when it matches no `deny` pattern and, if `allow` is not empty,
+/// at least one `allow` pattern. Other commands are executed directly by the hook.
+struct exec_filter {
+    std::vector<std::string> allow{};
+    std::vector<std::string> deny{};
 };
 
 enum class ServiceMode : uint8_t {
     INJECT,
 };
 
+/// How much of the stdout/stderr of a command is kept for the script.
+enum class CaptureMode : uint8_t {
+    NONE,  // The command inherits the stdio of its parent, nothing is copied
+    TAIL,  // Forward the output and keep its tail
+    FULL,  // Forward the output and keep all of it
+};
+
+struct capture_policy {
+    CaptureMode mode = CaptureMode::TAIL;
+    uint64_t limit = 64 * 1024;  // Bytes kept per stream with `TAIL`
+};
+
+/// Version of the pipelined request set (`DECIDE` + `COMPLETE`). catter and catter-proxy always
+/// come from the same build, the structs above change without keeping older layouts.
+constexpr inline uint32_t protocol_version = 6;
+
 }  // namespace catter::data
 
 namespace catter::ipc {
@@ -47,6 +105,12 @@ enum class RequestType : uint8_t {
     MAKE_DECISION,
     REPORT_ERROR,
     FINISH,
+    // protocol v2: one round trip for the decision
+    DECIDE,
+    // protocol v2: exec-through, catter watches the proxy pid instead of waiting for COMPLETE
+    HANDOVER,
+    // protocol v2: replacement of FINISH answered before the script runs
+    COMPLETE,
 };
 
 template <RequestType Type>
@@ -90,6 +154,58 @@ struct Request<RequestType::FINISH> {
     using Result = std::nullptr_t;
     constexpr inline static std::string_view method = "finish";
 };
+
+/// Combines CHECK_MODE, CREATE and MAKE_DECISION into a single round trip.
+template <>
+struct Request<RequestType::DECIDE> {
+    struct Params {
+        uint32_t version;
+        data::ServiceMode mode;
+        data::ipcid_t parent_id;
+        /// `cmd.env` is empty when `env` carries the environment as a delta.
+        data::command cmd;
+        data::env_delta env;
+    };
+
+    struct Result {
+        /// false when the daemon does not serve `mode` or `version`.
+        bool accepted;
+        data::ipcid_t id;
+        data::action act;
+        /// Forwarded to the hook of the injected command.
+        data::exec_filter filter;
+        /// The proxy may `HANDOVER` and exec into an injected command instead of spawning it.
+        bool exec_through;
+        data::capture_policy capture;
+        /// The base of the `env` delta is unknown, the proxy sends the environment in full.
+        bool env_missing;
+        /// `act.cmd.env` is left empty since it equals the environment of the request.
+        bool env_unchanged;
+    };
+
+    constexpr inline static std::string_view method = "decide";
+};
+
+/// The proxy is about to exec into the injected command, catter takes over its exit status.
+template <>
+struct Request<RequestType::HANDOVER> {
+    struct Params {
+        int64_t pid;
+    };
+
+    /// false when catter cannot watch the process, the proxy then spawns the command.
+    using Result = bool;
+    constexpr inline static std::string_view method = "handover";
+};
+
+/// Reports the process result. The daemon answers right away and runs the script once the proxy
+/// has hung up; the answer only tells the proxy that the result arrived.
+template <>
+struct Request<RequestType::COMPLETE> {
+    using Params = data::process_result;
+    using Result = std::nullptr_t;
+    constexpr inline static std::string_view method = "complete";
+};
 };  // namespace catter::ipc
 
 namespace kota::ipc::protocol {
@@ -0,0 +1,174 @@
+#include "env_delta.h"
+
+#include <charconv>
+#include <cstddef>
+#include <format>
+#include <unordered_map>
+#include <utility>
+
+#include "config/ipc.h"
+
+namespace catter::util {
+
+namespace {
+
+constexpr size_t hash_digits = 16;
+constexpr size_t fingerprint_digits = 8;
+
+uint32_t fingerprint(std::string_view entry) {
+    return static_cast<uint32_t>(env_entry_hash(entry) >> 32);
+}
+
+template <typename T>
+std::optional<T> parse_hex(std::string_view text) {
+    T value{};
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value, 16);
+    if(ec != std::errc() || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+bool is_base_entry(std::string_view entry) {
+    constexpr std::string_view key = config::ipc::KEY_CATTER_ENV_BASE;
+    return entry.starts_with(key) && entry.size() > key.size() && entry[key.size()] == '=';
+}
+
+}  // namespace
+
+uint64_t env_entry_hash(std::string_view entry) {
+    // FNV-1a, then the splitmix64 finalizer so that both halves are well mixed.
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(auto c: entry) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31);
+}
+
+uint64_t env_hash(std::span<const std::string> env) {
+    // Polynomial in the entry hashes, so the same entries in another order hash differently.
+    uint64_t hash = env.size();
+    for(const auto& entry: env) {
+        hash = hash * 0x9e3779b97f4a7c15ULL + env_entry_hash(entry);
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+std::string encode_env_base(std::span<const std::string> env) {
+    std::string text;
+    text.reserve(hash_digits + env.size() * fingerprint_digits);
+    text += std::format("{:016x}", env_hash(env));
+    for(const auto& entry: env) {
+        text += std::format("{:08x}", fingerprint(entry));
+    }
+    return text;
+}
+
+std::optional<EnvBase> decode_env_base(std::string_view text) {
+    if(text.size() < hash_digits || (text.size() - hash_digits) % fingerprint_digits != 0) {
+        return std::nullopt;
+    }
+    auto hash = parse_hex<uint64_t>(text.substr(0, hash_digits));
+    if(!hash || *hash == 0) {
+        return std::nullopt;
+    }
+
+    EnvBase base{.hash = *hash};
+    base.fingerprints.reserve((text.size() - hash_digits) / fingerprint_digits);
+    for(size_t at = hash_digits; at < text.size(); at += fingerprint_digits) {
+        auto value = parse_hex<uint32_t>(text.substr(at, fingerprint_digits));
+        if(!value) {
+            return std::nullopt;
+        }
+        base.fingerprints.push_back(*value);
+    }
+    return base;
+}
+
+std::optional<EnvBase> take_env_base(std::vector<std::string>& env) {
+    std::optional<EnvBase> base;
+    std::erase_if(env, [&](const std::string& entry) {
+        if(!is_base_entry(entry)) {
+            return false;
+        }
+        base = decode_env_base(std::string_view(entry).substr(entry.find('=') + 1));
+        return true;
+    });
+    return base;
+}
+
+data::env_delta make_env_delta(const EnvBase& base, std::span<const std::string> env) {
+    std::vector<uint32_t> values;
+    values.reserve(env.size());
+    // How often each fingerprint occurs in `env` from the current entry on.
+    std::unordered_map<uint32_t, size_t> ahead;
+    for(const auto& entry: env) {
+        values.push_back(fingerprint(entry));
+        ++ahead[values.back()];
+    }
+
+    const auto& kept = base.fingerprints;
+    data::env_delta delta{.hash = env_hash(env), .base = base.hash};
+    // Base entries before `next` are either kept or removed already.
+    size_t next = 0;
+    for(size_t i = 0; i < env.size(); ++i) {
+        const auto value = values[i];
+        --ahead[value];
+
+        // Keep the next base entry with the same fingerprint, unless that skips one still to
+        // come in `env`, which would then have to be sent in full.
+        auto match = next;
+        while(match < kept.size() && kept[match] != value && ahead[kept[match]] == 0) {
+            ++match;
+        }
+        if(match < kept.size() && kept[match] == value) {
+            for(; next < match; ++next) {
+                delta.removed.push_back(static_cast<uint32_t>(next));
+            }
+            next = match + 1;
+            continue;
+        }
+        delta.added.push_back(env[i]);
+        delta.added_at.push_back(static_cast<uint32_t>(i));
+    }
+    for(; next < kept.size(); ++next) {
+        delta.removed.push_back(static_cast<uint32_t>(next));
+    }
+    return delta;
+}
+
+std::optional<std::vector<std::string>> apply_env_delta(std::span<const std::string> base,
+                                                        const data::env_delta& delta) {
+    if(delta.added_at.size() != delta.added.size()) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> env;
+    env.reserve(base.size() + delta.added.size());
+    size_t removed = 0;
+    size_t added = 0;
+    auto add_due = [&] {
+        while(added < delta.added.size() && delta.added_at[added] <= env.size()) {
+            env.push_back(delta.added[added++]);
+        }
+    };
+    for(size_t i = 0; i < base.size(); ++i) {
+        if(removed < delta.removed.size() && delta.removed[removed] == i) {
+            ++removed;
+            continue;
+        }
+        add_due();
+        env.push_back(base[i]);
+    }
+    env.insert(env.end(), delta.added.begin() + added, delta.added.end());
+
+    if(removed != delta.removed.size() || env_hash(env) != delta.hash) {
+        return std::nullopt;
+    }
+    return env;
+}
+
+}  // namespace catter::util
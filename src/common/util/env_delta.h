@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "data.h"
+
+namespace catter::util {
+
+/// Hash of one `NAME=value` entry, its upper half is the fingerprint of the entry.
+uint64_t env_entry_hash(std::string_view entry);
+
+/// Hash of a whole environment. It depends on the order of the entries and is never 0.
+uint64_t env_hash(std::span<const std::string> env);
+
+/// The environment a command was started with, as its children see it through
+/// `KEY_CATTER_ENV_BASE`: the hash of the environment and the fingerprint of each entry.
+struct EnvBase {
+    uint64_t hash = 0;
+    std::vector<uint32_t> fingerprints{};
+};
+
+/// The value of `KEY_CATTER_ENV_BASE` for a command started with `env`, 16 hex digits of the
+/// hash followed by 8 hex digits per entry.
+std::string encode_env_base(std::span<const std::string> env);
+
+/// nullopt when `text` is not the output of `encode_env_base`.
+std::optional<EnvBase> decode_env_base(std::string_view text);
+
+/// Removes every `KEY_CATTER_ENV_BASE` entry from `env`, returning the decoded value of the last.
+std::optional<EnvBase> take_env_base(std::vector<std::string>& env);
+
+/// The delta turning the environment described by `base` into `env`. Base entries are kept in
+/// their order where `env` has them in the same order, anything else is removed and added back
+/// at its place.
+data::env_delta make_env_delta(const EnvBase& base, std::span<const std::string> env);
+
+/// Applies `delta` to `base`, giving the entries in the order of the environment it was made
+/// from. Returns nullopt when the result does not hash to `delta.hash`, e.g. when two entries
+/// share a fingerprint or `base` has the entries of the delta's base in another order.
+std::optional<std::vector<std::string>> apply_env_delta(std::span<const std::string> base,
+                                                        const data::env_delta& delta);
+
+}  // namespace catter::util
@@ -0,0 +1,155 @@
+#include "fake_output.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <cpptrace/exceptions.hpp>
+
+namespace catter::util {
+
+namespace {
+
+void put_le(std::string& out, uint64_t value, size_t width) {
+    for(size_t i = 0; i < width; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+#ifdef CATTER_WINDOWS
+/// IMAGE_FILE_HEADER with no sections and no symbols.
+std::string coff_object() {
+#if defined(_M_ARM64) || defined(__aarch64__)
+    constexpr uint16_t machine = 0xaa64;  // IMAGE_FILE_MACHINE_ARM64
+#elif defined(_M_IX86) || defined(__i386__)
+    constexpr uint16_t machine = 0x014c;  // IMAGE_FILE_MACHINE_I386
+#else
+    constexpr uint16_t machine = 0x8664;  // IMAGE_FILE_MACHINE_AMD64
+#endif
+    std::string out;
+    put_le(out, machine, 2);
+    put_le(out, 0, 2);  // NumberOfSections
+    put_le(out, 0, 4);  // TimeDateStamp
+    put_le(out, 0, 4);  // PointerToSymbolTable
+    put_le(out, 0, 4);  // NumberOfSymbols
+    put_le(out, 0, 2);  // SizeOfOptionalHeader
+    put_le(out, 0, 2);  // Characteristics
+    return out;
+}
+#elif defined(CATTER_MAC)
+/// mach_header_64 of an MH_OBJECT without load commands.
+std::string macho_object() {
+#if defined(__aarch64__) || defined(__arm64__)
+    constexpr uint32_t cputype = 0x0100000c;  // CPU_TYPE_ARM64
+    constexpr uint32_t cpusubtype = 0;        // CPU_SUBTYPE_ARM64_ALL
+#else
+    constexpr uint32_t cputype = 0x01000007;  // CPU_TYPE_X86_64
+    constexpr uint32_t cpusubtype = 3;        // CPU_SUBTYPE_X86_64_ALL
+#endif
+    std::string out;
+    put_le(out, 0xfeedfacf, 4);  // MH_MAGIC_64
+    put_le(out, cputype, 4);
+    put_le(out, cpusubtype, 4);
+    put_le(out, 1, 4);  // MH_OBJECT
+    put_le(out, 0, 4);  // ncmds
+    put_le(out, 0, 4);  // sizeofcmds
+    put_le(out, 0, 4);  // flags
+    put_le(out, 0, 4);  // reserved
+    return out;
+}
+#else
+/// ELF64 ET_REL holding only the null section and `.shstrtab`.
+std::string elf_object() {
+#if defined(__aarch64__)
+    constexpr uint16_t machine = 183;  // EM_AARCH64
+#elif defined(__riscv)
+    constexpr uint16_t machine = 243;  // EM_RISCV
+#else
+    constexpr uint16_t machine = 62;  // EM_X86_64
+#endif
+    constexpr std::string_view shstrtab{"\0.shstrtab\0", 11};
+    constexpr uint64_t ehsize = 64;
+    constexpr uint64_t shentsize = 64;
+    constexpr uint64_t shoff = (ehsize + shstrtab.size() + 7) / 8 * 8;
+
+    std::string out{"\x7f" "ELF"};
+    out.push_back(2);  // ELFCLASS64
+    out.push_back(1);  // ELFDATA2LSB
+    out.push_back(1);  // EV_CURRENT
+    out.resize(16, '\0');
+    put_le(out, 1, 2);  // ET_REL
+    put_le(out, machine, 2);
+    put_le(out, 1, 4);  // e_version
+    put_le(out, 0, 8);  // e_entry
+    put_le(out, 0, 8);  // e_phoff
+    put_le(out, shoff, 8);
+    put_le(out, 0, 4);  // e_flags
+    put_le(out, ehsize, 2);
+    put_le(out, 0, 2);  // e_phentsize
+    put_le(out, 0, 2);  // e_phnum
+    put_le(out, shentsize, 2);
+    put_le(out, 2, 2);  // e_shnum
+    put_le(out, 1, 2);  // e_shstrndx
+
+    out.append(shstrtab);
+    out.resize(shoff + shentsize, '\0');  // padding and the null section header
+    put_le(out, 1, 4);                    // sh_name, ".shstrtab"
+    put_le(out, 3, 4);                    // SHT_STRTAB
+    put_le(out, 0, 8);                    // sh_flags
+    put_le(out, 0, 8);                    // sh_addr
+    put_le(out, ehsize, 8);               // sh_offset
+    put_le(out, shstrtab.size(), 8);      // sh_size
+    put_le(out, 0, 4);                    // sh_link
+    put_le(out, 0, 4);                    // sh_info
+    put_le(out, 1, 8);                    // sh_addralign
+    put_le(out, 0, 8);                    // sh_entsize
+    return out;
+}
+#endif
+
+}  // namespace
+
+std::string fake_output_bytes(std::string_view extension) {
+    std::string ext(extension);
+    std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if(ext == ".o" || ext == ".obj") {
+#ifdef CATTER_WINDOWS
+        return coff_object();
+#elif defined(CATTER_MAC)
+        return macho_object();
+#else
+        return elf_object();
+#endif
+    }
+    if(ext == ".a" || ext == ".lib") {
+        return "!<arch>\n";
+    }
+    return {};
+}
+
+void write_fake_output(const std::filesystem::path& path) {
+    std::error_code ec;
+    if(path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), ec);
+        if(ec) {
+            throw cpptrace::runtime_error(std::format("Failed to create directory {}: {}",
+                                                      path.parent_path().string(),
+                                                      ec.message()));
+        }
+    }
+
+    const auto bytes = fake_output_bytes(path.extension().string());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if(!file) {
+        throw cpptrace::runtime_error(std::format("Failed to write {}", path.string()));
+    }
+}
+
+}  // namespace catter::util
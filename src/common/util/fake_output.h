@@ -0,0 +1,21 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace catter::util {
+
+/// Contents of a placeholder for a compiler output with the given extension.
+///
+/// Objects (`.o`, `.obj`) get a minimal valid relocatable object for the host platform, with no
+/// sections or symbols, archives (`.a`, `.lib`) get an empty `ar` archive and anything else is
+/// left empty. Extensions are matched case-insensitively.
+std::string fake_output_bytes(std::string_view extension);
+
+/// Creates `path` and its parent directories and fills it with `fake_output_bytes`.
+///
+/// Existing files are overwritten, errors are thrown as `cpptrace::runtime_error`.
+void write_fake_output(const std::filesystem::path& path);
+
+}  // namespace catter::util
@@ -10,6 +10,7 @@
 
 #include "data.h"
 #include "pipe_proxy.h"
+#include "resource_usage.h"
 #include "config/ipc.h"
 
 namespace catter {
@@ -44,14 +45,38 @@ inline process_event make_process_event(kota::process::options& opts) {
     };
 }
 
-inline kota::task<data::process_result> capture_process_result(process_event proc_event,
-                                                               FILE* stdout_sink = stdout,
-                                                               FILE* stderr_sink = stderr) {
+/// The stdout/stderr redirection matching a capture policy. With `NONE` the child writes to the
+/// inherited descriptors directly and no byte passes through this process.
+inline auto output_stdio(data::CaptureMode mode) -> decltype(kota::process::stdio::inherit()) {
+    if(mode == data::CaptureMode::NONE) {
+        return kota::process::stdio::inherit();
+    }
+    return kota::process::stdio::pipe(false, true);
+}
+
+inline kota::task<data::process_result>
+    capture_process_result(process_event proc_event,
+                           FILE* stdout_sink = stdout,
+                           FILE* stderr_sink = stderr,
+                           data::capture_policy capture = {}) {
     auto& current_loop = kota::event_loop::current();
 
+    const util::UsageMeter meter;
     auto [wait_task, stdout_pipe, stderr_pipe] = proc_event(current_loop);
-    util::PipeProxy stdout_proxy(std::move(stdout_pipe), stdout_sink, "stdout");
-    util::PipeProxy stderr_proxy(std::move(stderr_pipe), stderr_sink, "stderr");
+    if(capture.mode == data::CaptureMode::NONE) {
+        // The event must have been spawned with `output_stdio(NONE)`, there is nothing to read.
+        auto code = co_await std::move(wait_task);
+        if(!code) {
+            throw cpptrace::runtime_error(
+                std::format("process wait failed: {}", code.error().message()));
+        }
+        co_return data::process_result{.code = *code, .usage = meter.finish()};
+    }
+
+    const auto limit = capture.mode == data::CaptureMode::FULL ? util::PipeProxy::unlimited
+                                                               : static_cast<size_t>(capture.limit);
+    util::PipeProxy stdout_proxy(std::move(stdout_pipe), stdout_sink, "stdout", limit);
+    util::PipeProxy stderr_proxy(std::move(stderr_pipe), stderr_sink, "stderr", limit);
 
     auto ret = co_await kota::when_all{std::move(wait_task),
                                        stdout_proxy.monitor(),
@@ -68,6 +93,7 @@ inline kota::task<data::process_result> capture_process_result(process_event pro
         .code = code,
         .std_out = stdout_proxy.output(),
         .std_err = stderr_proxy.output(),
+        .usage = meter.finish(),
     };
 }
 }  // namespace catter
@@ -44,4 +44,10 @@ void mute_logger() noexcept {
     ::spdlog::set_level(::spdlog::level::off);
 }
 
+void flush_logger() noexcept {
+    if(auto logger = ::spdlog::default_logger(); logger != nullptr) {
+        logger->flush();
+    }
+}
+
 }  // namespace catter::log
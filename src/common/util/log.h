@@ -32,6 +32,9 @@ void init_logger(const std::string& logger_name,
 
 void mute_logger() noexcept;
 
+/// Writes out what the logger buffered, for a process about to end without unwinding.
+void flush_logger() noexcept;
+
 template <typename Range>
     requires std::ranges::range<std::decay_t<Range>> &&
              std::is_same_v<char, std::ranges::range_value_t<Range>>
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <format>
 #include <span>
 #include <stdexcept>
@@ -10,44 +11,53 @@
 
 namespace catter::util {
 
-void PipeProxy::append_bounded_output(std::string& buffer,
-                                      std::string_view chunk,
-                                      bool& truncated,
-                                      size_t limit) {
+void TailBuffer::append(std::string_view chunk) {
+    if(ring.size() < limit) {
+        const size_t take = std::min(chunk.size(), limit - ring.size());
+        ring.append(chunk.data(), take);
+        total += take;
+        chunk.remove_prefix(take);
+    }
+
     if(chunk.empty()) {
         return;
     }
 
-    if(!truncated && buffer.size() + chunk.size() <= limit) {
-        buffer.append(chunk.data(), chunk.size());
+    total += chunk.size();
+    if(limit == 0) {
         return;
     }
 
-    truncated = true;
-
-    if(limit <= truncation_marker.size()) {
-        buffer.assign(truncation_marker.substr(0, limit));
-        return;
+    // The ring is full: only the last `limit` bytes of the chunk can survive, they overwrite the
+    // oldest bytes starting at the position the stream has reached.
+    if(chunk.size() > limit) {
+        chunk.remove_prefix(chunk.size() - limit);
     }
+    const size_t start = (total - chunk.size()) % limit;
+    const size_t first = std::min(chunk.size(), limit - start);
+    std::memcpy(ring.data() + start, chunk.data(), first);
+    std::memcpy(ring.data(), chunk.data() + first, chunk.size() - first);
+}
 
-    const size_t payload_limit = limit - truncation_marker.size();
-    std::string_view current_payload = buffer;
-    if(current_payload.starts_with(truncation_marker)) {
-        current_payload.remove_prefix(truncation_marker.size());
+std::string TailBuffer::str() const {
+    if(!truncated()) {
+        return ring;
     }
 
-    const size_t keep_from_chunk = std::min(payload_limit, chunk.size());
-    const size_t keep_from_existing = payload_limit - keep_from_chunk;
-    if(current_payload.size() > keep_from_existing) {
-        current_payload.remove_prefix(current_payload.size() - keep_from_existing);
+    if(limit <= truncation_marker.size()) {
+        return std::string(truncation_marker.substr(0, limit));
     }
 
-    std::string next;
-    next.reserve(limit);
-    next.append(truncation_marker);
-    next.append(current_payload);
-    next.append(chunk.substr(chunk.size() - keep_from_chunk));
-    buffer = std::move(next);
+    const size_t payload = limit - truncation_marker.size();
+    const size_t start = (total - payload) % limit;
+    const size_t first = std::min(payload, limit - start);
+
+    std::string result;
+    result.reserve(limit);
+    result.append(truncation_marker);
+    result.append(ring, start, first);
+    result.append(ring, 0, payload - first);
+    return result;
 }
 
 kota::task<void> PipeProxy::monitor() {
@@ -70,9 +80,7 @@ kota::task<void> PipeProxy::monitor() {
 
         // Keep the tail because build failures usually surface the decisive diagnostics last,
         // while the full stream is still forwarded to the sink in real time.
-        PipeProxy::append_bounded_output(output_buffer,
-                                         std::string_view(chunk->data(), chunk->size()),
-                                         output_truncated);
+        output_buffer.append(std::string_view(chunk->data(), chunk->size()));
 
         if(sink != nullptr) {
             std::span<const char> bytes(chunk->data(), chunk->size());
@@ -8,16 +8,42 @@
 
 namespace catter::util {
 
-class PipeProxy {
+/// Keeps the last `limit` bytes written to it.
+///
+/// The storage grows like a string until it holds `limit` bytes, then it wraps and overwrites the
+/// oldest bytes in place, so appending costs O(chunk) however long the stream gets.
+class TailBuffer {
 public:
-    constexpr static size_t output_limit = 64 * 1024;
     constexpr static std::string_view truncation_marker = "[... truncated leading output ...]\n";
 
-    PipeProxy(kota::pipe&& pipe, FILE* sink, std::string_view name) :
-        pipe(std::move(pipe)), sink(sink), name(name) {
-        output_buffer.reserve(1024);
+    explicit TailBuffer(size_t limit) : limit(limit) {}
+
+    void append(std::string_view chunk);
+
+    /// Whether bytes were dropped, `str()` then starts with `truncation_marker`.
+    bool truncated() const noexcept {
+        return total > limit;
     }
 
+    /// The retained output, no longer than `limit` bytes including the marker.
+    std::string str() const;
+
+private:
+    size_t limit;
+    size_t total = 0;
+    std::string ring{};
+};
+
+class PipeProxy {
+public:
+    constexpr static size_t output_limit = 64 * 1024;
+    /// Keeps no more than `limit` bytes of output, `unlimited` keeps everything.
+    constexpr static size_t unlimited = static_cast<size_t>(-1);
+    constexpr static std::string_view truncation_marker = TailBuffer::truncation_marker;
+
+    PipeProxy(kota::pipe&& pipe, FILE* sink, std::string_view name, size_t limit = output_limit) :
+        pipe(std::move(pipe)), sink(sink), name(name), output_buffer(limit) {}
+
     PipeProxy(const PipeProxy&) = delete;
     PipeProxy& operator= (const PipeProxy&) = delete;
     PipeProxy(PipeProxy&&) = delete;
@@ -31,21 +57,15 @@ public:
 
     kota::task<void> monitor();
 
-    static void append_bounded_output(std::string& buffer,
-                                      std::string_view chunk,
-                                      bool& truncated,
-                                      size_t limit = output_limit);
-
-    const std::string& output() const noexcept {
-        return output_buffer;
+    std::string output() const {
+        return output_buffer.str();
     }
 
 private:
     kota::pipe pipe{};
     FILE* sink = nullptr;
     std::string name{};
-    std::string output_buffer{};
-    bool output_truncated = false;
+    TailBuffer output_buffer;
 };
 
 }  // namespace catter::util
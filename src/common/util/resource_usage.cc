@@ -0,0 +1,75 @@
+#include "resource_usage.h"
+
+#include <atomic>
+
+#ifndef CATTER_WINDOWS
+#include <sys/resource.h>
+#endif
+
+#include "span_trace.h"
+
+namespace catter::util {
+
+namespace {
+
+/// Meters of this process still measuring, and meters ever started.
+std::atomic<uint64_t> live_meters{0};
+std::atomic<uint64_t> started_meters{0};
+
+/// Totals of the reaped children, `end` left 0.
+data::process_usage children_totals() noexcept {
+    data::process_usage usage{.start = trace::now()};
+#ifndef CATTER_WINDOWS
+    rusage ru{};
+    if(::getrusage(RUSAGE_CHILDREN, &ru) != 0) {
+        return usage;
+    }
+    auto micros = [](const timeval& time) {
+        return static_cast<uint64_t>(time.tv_sec) * 1'000'000 +
+               static_cast<uint64_t>(time.tv_usec);
+    };
+    usage.rusage = true;
+    usage.user_us = micros(ru.ru_utime);
+    usage.system_us = micros(ru.ru_stime);
+#ifdef CATTER_MAC
+    // bytes on macOS, kilobytes everywhere else
+    usage.max_rss_kib = static_cast<uint64_t>(ru.ru_maxrss) / 1024;
+#else
+    usage.max_rss_kib = static_cast<uint64_t>(ru.ru_maxrss);
+#endif
+    usage.read_blocks = static_cast<uint64_t>(ru.ru_inblock);
+    usage.write_blocks = static_cast<uint64_t>(ru.ru_oublock);
+#endif
+    return usage;
+}
+
+}  // namespace
+
+UsageMeter::UsageMeter() noexcept :
+    generation(started_meters.fetch_add(1) + 1), alone(live_meters.fetch_add(1) == 0) {
+    before = children_totals();
+}
+
+UsageMeter::~UsageMeter() {
+    live_meters.fetch_sub(1);
+}
+
+data::process_usage UsageMeter::finish() const noexcept {
+    auto after = children_totals();
+    data::process_usage usage{.start = before.start, .end = after.start};
+    // Another child reaped meanwhile would be counted as well.
+    const bool exclusive = alone && started_meters.load() == generation;
+    if(!exclusive || !before.rusage || !after.rusage) {
+        return usage;
+    }
+    usage.rusage = true;
+    usage.user_us = after.user_us - before.user_us;
+    usage.system_us = after.system_us - before.system_us;
+    // A high-water mark, it cannot be told apart per child.
+    usage.max_rss_kib = after.max_rss_kib;
+    usage.read_blocks = after.read_blocks - before.read_blocks;
+    usage.write_blocks = after.write_blocks - before.write_blocks;
+    return usage;
+}
+
+}  // namespace catter::util
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+#include "data.h"
+
+namespace catter::util {
+
+/**
+ * Measures a child process from before it is spawned until it has been reaped.
+ *
+ * libuv reaps the children itself, so their `wait4` rusage is not at hand. On Linux and macOS the
+ * counters are instead the growth of `getrusage(RUSAGE_CHILDREN)` over the lifetime of the child,
+ * which includes every descendant the child waited for. They are only exact when the child is the
+ * only one this process runs meanwhile, as in catter-proxy. A meter that overlapped another one,
+ * such as the build of a session and the compiler probes of its script, reports the timestamps
+ * alone with `rusage` false, and so does every meter on Windows.
+ */
+class UsageMeter {
+public:
+    UsageMeter() noexcept;
+
+    UsageMeter(const UsageMeter&) = delete;
+    UsageMeter& operator= (const UsageMeter&) = delete;
+
+    ~UsageMeter();
+
+    /// The usage from the construction until now, call it once the child has been reaped.
+    data::process_usage finish() const noexcept;
+
+private:
+    data::process_usage before{};
+    /// Meters started in this process before this one, this one included.
+    uint64_t generation = 0;
+    /// No other meter was live when this one started.
+    bool alone = false;
+};
+
+}  // namespace catter::util
@@ -0,0 +1,308 @@
+#include "span_trace.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+#ifdef CATTER_WINDOWS
+#include <fcntl.h>
+#include <io.h>
+#include <process.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace catter::trace {
+
+namespace {
+
+/// Bytes serialized before they are written, allocated by `start` so that writing never
+/// allocates.
+constexpr size_t write_buffer_size = 64 * 1024;
+
+struct Record {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+    uint32_t track;
+};
+
+struct Recorder {
+    std::mutex mutex;
+    uint32_t pid = 0;
+    std::string process;
+    std::string dir;
+    std::string path;
+    std::vector<Record> records;
+    std::unique_ptr<char[]> buffer;
+    bool header_written = false;
+};
+
+Recorder& recorder() {
+    static Recorder instance;
+    return instance;
+}
+
+uint32_t process_id() noexcept {
+#ifdef CATTER_WINDOWS
+    return static_cast<uint32_t>(::_getpid());
+#else
+    return static_cast<uint32_t>(::getpid());
+#endif
+}
+
+/// Threads are numbered from 2^31 so that their tracks never collide with the ones passed to
+/// `record`.
+uint32_t thread_track() noexcept {
+    static std::atomic<uint32_t> next{1U << 31};
+    thread_local uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+int open_append(const char* path) noexcept {
+#ifdef CATTER_WINDOWS
+    return ::_open(path, _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+#endif
+}
+
+/// Serializes into a fixed buffer and writes it to `fd` whenever it is full, then closes `fd`,
+/// without allocating. Bytes that cannot be written are dropped, tracing never fails the traced
+/// process.
+class SpanWriter {
+public:
+    SpanWriter(int fd, std::span<char> buffer) noexcept : fd(fd), buffer(buffer) {}
+
+    SpanWriter(const SpanWriter&) = delete;
+    SpanWriter& operator= (const SpanWriter&) = delete;
+
+    ~SpanWriter() {
+        drain();
+#ifdef CATTER_WINDOWS
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    void header(uint32_t pid, std::string_view process) noexcept {
+        put(file_magic, sizeof(file_magic));
+        put_u32(pid);
+        put_string(process);
+    }
+
+    void span(const Record& span) noexcept {
+        put_u64(span.begin);
+        put_u64(span.end);
+        put_u32(span.track);
+        put_string(span.name);
+    }
+
+private:
+    void put(const void* data, size_t size) noexcept {
+        auto bytes = static_cast<const char*>(data);
+        while(size > 0) {
+            if(used == buffer.size()) {
+                drain();
+            }
+            const auto n = std::min(size, buffer.size() - used);
+            std::memcpy(buffer.data() + used, bytes, n);
+            used += n;
+            bytes += n;
+            size -= n;
+        }
+    }
+
+    void put_u32(uint32_t value) noexcept {
+        put(&value, sizeof(value));
+    }
+
+    void put_u64(uint64_t value) noexcept {
+        put(&value, sizeof(value));
+    }
+
+    void put_string(std::string_view text) noexcept {
+        put_u32(static_cast<uint32_t>(text.size()));
+        put(text.data(), text.size());
+    }
+
+    void drain() noexcept {
+        size_t at = 0;
+        while(at < used) {
+#ifdef CATTER_WINDOWS
+            const auto n = ::_write(fd, buffer.data() + at, static_cast<unsigned>(used - at));
+#else
+            const auto n = ::write(fd, buffer.data() + at, used - at);
+#endif
+            if(n <= 0) {
+                break;
+            }
+            at += static_cast<size_t>(n);
+        }
+        used = 0;
+    }
+
+    int fd;
+    std::span<char> buffer;
+    size_t used = 0;
+};
+
+/// Appends the buffered spans to the file of the process, with `rec.mutex` held. Nothing is
+/// written without spans, so a process that records none leaves no file behind.
+void write_out(Recorder& rec, const Record* last = nullptr) noexcept {
+    if(rec.records.empty() && last == nullptr) {
+        return;
+    }
+    if(const int fd = open_append(rec.path.c_str()); fd >= 0) {
+        SpanWriter out(fd, std::span(rec.buffer.get(), write_buffer_size));
+        if(!rec.header_written) {
+            out.header(rec.pid, rec.process);
+            rec.header_written = true;
+        }
+        for(const auto& span: rec.records) {
+            out.span(span);
+        }
+        if(last != nullptr) {
+            out.span(*last);
+        }
+    }
+    rec.records.clear();
+}
+
+/// `<directory>/<pid>-<now>.spans` into `path`, false when it does not fit.
+bool format_path(std::span<char> path, std::string_view directory, uint32_t pid) noexcept {
+    auto at = path.data();
+    const auto end = path.data() + path.size() - 1;
+    auto append = [&](std::string_view text) {
+        if(static_cast<size_t>(end - at) < text.size()) {
+            return false;
+        }
+        at = std::copy(text.begin(), text.end(), at);
+        return true;
+    };
+    auto append_number = [&](uint64_t value) {
+        auto [next, ec] = std::to_chars(at, end, value);
+        at = next;
+        return ec == std::errc();
+    };
+    if(!append(directory) || !append("/") || !append_number(pid) || !append("-") ||
+       !append_number(now()) || !append(file_extension)) {
+        return false;
+    }
+    *at = '\0';
+    return true;
+}
+
+}  // namespace
+
+void start(std::string_view process, std::string_view directory) noexcept {
+    if(directory.empty() || enabled()) {
+        return;
+    }
+    try {
+        auto& rec = recorder();
+        std::lock_guard lock(rec.mutex);
+        rec.pid = process_id();
+        rec.process = process;
+        rec.dir = directory;
+        // A process that execs keeps its pid, the start time tells its images apart.
+        rec.path = rec.dir + "/" + std::to_string(rec.pid) + "-" + std::to_string(now()) +
+                   std::string(file_extension);
+        rec.records.reserve(buffer_capacity);
+        if(!rec.buffer) {
+            rec.buffer = std::make_unique<char[]>(write_buffer_size);
+        }
+        rec.header_written = false;
+        detail::active.store(true, std::memory_order_relaxed);
+    } catch(...) {
+        detail::active.store(false, std::memory_order_relaxed);
+    }
+}
+
+std::string_view directory() noexcept {
+    return enabled() ? std::string_view(recorder().dir) : std::string_view();
+}
+
+uint64_t now() noexcept {
+    // CLOCK_MONOTONIC and QueryPerformanceCounter are both machine-wide.
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+void record(const char* name, uint64_t begin, uint64_t end, uint32_t track) noexcept {
+    if(!enabled()) {
+        return;
+    }
+    auto& rec = recorder();
+    // Never wait: the hook may run in a vfork child while another thread holds the lock.
+    std::unique_lock lock(rec.mutex, std::try_to_lock);
+    if(!lock.owns_lock()) {
+        return;
+    }
+    if(rec.records.size() == buffer_capacity) {
+        write_out(rec);
+    }
+    rec.records.push_back(Record{name, begin, end, track != 0 ? track : thread_track()});
+}
+
+void flush() noexcept {
+    if(!enabled()) {
+        return;
+    }
+    auto& rec = recorder();
+    std::lock_guard lock(rec.mutex);
+    write_out(rec);
+}
+
+void flush_before_exec(const char* name, uint64_t begin) noexcept {
+    if(!enabled()) {
+        return;
+    }
+    const Record last{name, begin, now(), thread_track()};
+    auto& rec = recorder();
+    // Never wait: in a vfork child another thread of the parent may hold the lock.
+    std::unique_lock lock(rec.mutex, std::try_to_lock);
+    if(!lock.owns_lock()) {
+        return;
+    }
+
+    const auto pid = process_id();
+    if(pid == rec.pid) {
+        write_out(rec, &last);
+        return;
+    }
+
+    // A child sharing the memory of the parent: the buffered spans are the parent's to write,
+    // and nothing of the recorder changes.
+    char path[4096];
+    if(!format_path(path, rec.dir, pid)) {
+        return;
+    }
+    if(const int fd = open_append(path); fd >= 0) {
+        char bytes[512];
+        SpanWriter out(fd, bytes);
+        out.header(pid, rec.process);
+        out.span(last);
+    }
+}
+
+void stop() noexcept {
+    if(!enabled()) {
+        return;
+    }
+    auto& rec = recorder();
+    std::lock_guard lock(rec.mutex);
+    write_out(rec);
+    detail::active.store(false, std::memory_order_relaxed);
+}
+
+}  // namespace catter::trace
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Span instrumentation of the exec pipeline, shared by catter, catter-proxy and the hook.
+ *
+ * Every process records into its own buffer and writes it to a binary file of its own under
+ * the trace directory, which catter merges into one Chrome trace when the session ends. It is
+ * compiled in everywhere and costs one load and branch per span until `start` enables it.
+ *
+ * The recorder has no dependency beyond the standard library, so the hook links it directly.
+ */
+namespace catter::trace {
+
+namespace detail {
+inline std::atomic<bool> active{false};
+}  // namespace detail
+
+/// Spans kept in memory before they are written out.
+constexpr size_t buffer_capacity = 4096;
+
+/// Starts recording this process as `process` into a new file under `directory`, nothing
+/// happens when `directory` is empty or recording already started.
+void start(std::string_view process, std::string_view directory) noexcept;
+
+inline bool enabled() noexcept {
+    return detail::active.load(std::memory_order_relaxed);
+}
+
+/// The directory recording goes to, empty when it is off.
+std::string_view directory() noexcept;
+
+/// Nanoseconds of a clock shared by all processes of the machine.
+uint64_t now() noexcept;
+
+/// Records a span, `name` must outlive the process, i.e. be a string literal. Spans go to the
+/// track of the calling thread by default, coroutines interleaved on one thread pass a track of
+/// their own (e.g. the command id) so that their spans do not overlap.
+void record(const char* name, uint64_t begin, uint64_t end, uint32_t track = 0) noexcept;
+
+/// Writes the buffered spans out and closes the file. Recording goes on and reopens the file
+/// when needed.
+void flush() noexcept;
+
+/// Records the span of an exec from `begin` until now and writes it out with the buffered
+/// spans, right before the process image is replaced. It neither waits for the lock nor
+/// allocates, and in a child sharing the memory of its parent (vfork) it leaves the buffer
+/// alone and writes only this span to a file of the child.
+void flush_before_exec(const char* name, uint64_t begin) noexcept;
+
+/// Writes the buffered spans out and stops recording, `start` may begin anew afterwards.
+void stop() noexcept;
+
+/// Records the lifetime of a scope.
+class Span {
+public:
+    explicit Span(const char* name, uint32_t track = 0) noexcept :
+        name(name), track(track), begin(enabled() ? now() : 0) {}
+
+    Span(const Span&) = delete;
+    Span& operator= (const Span&) = delete;
+
+    ~Span() {
+        if(begin != 0) {
+            record(name, begin, now(), track);
+        }
+    }
+
+private:
+    const char* name;
+    uint32_t track;
+    uint64_t begin;
+};
+
+/// On-disk layout, native endian as the files never leave the machine:
+///   magic, u32 pid, u32 name size, name, then per span
+///   u64 begin, u64 end, u32 track, u32 name size, name.
+constexpr char file_magic[8] = {'C', 'A', 'T', 'S', 'P', 'A', 'N', '1'};
+constexpr std::string_view file_extension = ".spans";
+
+}  // namespace catter::trace
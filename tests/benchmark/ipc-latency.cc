@@ -0,0 +1,207 @@
+// Measures the per-exec IPC cost between catter-proxy and the daemon.
+//
+// Each iteration behaves like one intercepted exec: connect, talk to the daemon and hang up.
+// The service answers immediately, so the numbers are pure transport and dispatch latency.
+//
+// usage: bench-ipc-latency [iterations]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <list>
+#include <memory>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cpptrace/exceptions.hpp>
+#include <kota/async/async.h>
+
+#include "ipc.h"
+#include "util/crossplat.h"
+#include "util/data.h"
+#include "util/guard.h"
+#include "util/log.h"
+#include "catter-proxy/ipc.h"
+
+using namespace catter;
+
+namespace {
+
+enum class Protocol {
+    v1,
+    v2,
+};
+
+class NullService final : public ipc::InjectService {
+public:
+    explicit NullService(data::ipcid_t id) : id(id) {}
+
+    kota::task<data::ipcid_t> create(data::ipcid_t) noexcept override {
+        co_return this->id;
+    }
+
+    kota::task<data::action> make_decision(data::command cmd) noexcept override {
+        co_return data::action{.type = data::action::WRAP, .cmd = std::move(cmd)};
+    }
+
+    kota::task<> finish(data::process_result) noexcept override {
+        co_return;
+    }
+
+    kota::task<> report_error(data::ipcid_t, std::string) noexcept override {
+        co_return;
+    }
+
+private:
+    data::ipcid_t id;
+};
+
+std::string endpoint_name() {
+#ifdef CATTER_WINDOWS
+    return std::format(R"(\\.\pipe\catter-bench-ipc-{})", util::unique_id());
+#else
+    return (std::filesystem::temp_directory_path() /
+            std::format("catter-bench-ipc-{}.sock", util::unique_id()))
+        .string();
+#endif
+}
+
+data::command sample_command() {
+    data::command cmd{
+        .cwd = "/tmp/build",
+        .executable = "/usr/bin/clang++",
+        .args = {"clang++", "-c", "main.cc", "-o", "main.o", "-O2", "-g", "-std=c++23"},
+        .env = util::get_environment(),
+    };
+    return cmd;
+}
+
+kota::task<int> talk(Protocol protocol, proxy::ipc::Peer& peer) {
+    auto guard = util::make_guard([&]() noexcept { (void)peer.close(); });
+
+    data::process_result result{.code = 0};
+    switch(protocol) {
+        case Protocol::v1: {
+            if(!co_await peer.check_mode(data::ServiceMode::INJECT)) {
+                throw cpptrace::runtime_error("daemon is not in inject mode");
+            }
+            co_await peer.create(0);
+            co_await peer.make_decision(sample_command());
+            co_await peer.finish(std::move(result));
+            break;
+        }
+        case Protocol::v2: {
+            auto decision = co_await peer.decide(0, sample_command());
+            if(!decision.accepted) {
+                throw cpptrace::runtime_error("daemon rejected the request");
+            }
+            co_await peer.complete(std::move(result));
+            break;
+        }
+    }
+    co_return 0;
+}
+
+kota::task<int64_t> one_exec(Protocol protocol, std::string endpoint) {
+    auto& loop = kota::event_loop::current();
+    const auto start = std::chrono::steady_clock::now();
+
+    auto conn = co_await kota::pipe::connect(endpoint, kota::pipe::options(), loop);
+    if(!conn) {
+        throw cpptrace::runtime_error(
+            std::format("Failed to connect to {}: {}", endpoint, conn.error().message()));
+    }
+    auto peer = proxy::ipc::Peer{
+        kota::ipc::BincodePeer{loop, std::make_unique<kota::ipc::StreamTransport>(std::move(*conn))}
+    };
+    co_await kota::when_all{talk(protocol, peer), peer.run()};
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    co_return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void report(std::string_view name, std::vector<int64_t> samples) {
+    std::ranges::sort(samples);
+    int64_t total = 0;
+    for(auto sample: samples) {
+        total += sample;
+    }
+    auto percentile = [&](double p) {
+        return samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))];
+    };
+    std::println("{}: n={} mean={}us p50={}us p99={}us max={}us",
+                 name,
+                 samples.size(),
+                 total / static_cast<int64_t>(samples.size()),
+                 percentile(0.50),
+                 percentile(0.99),
+                 samples.back());
+}
+
+kota::task<> serve(kota::acceptor<kota::pipe>& acceptor) {
+    std::list<kota::task<void>> clients;
+    for(data::ipcid_t id = 1;; ++id) {
+        auto client = co_await acceptor.accept();
+        if(!client) {
+            break;
+        }
+        clients.push_back(ipc::accept(std::make_unique<NullService>(id), std::move(*client)));
+        kota::event_loop::current().schedule(clients.back());
+    }
+    for(auto& client: clients) {
+        client.result();
+    }
+}
+
+kota::task<> bench(kota::acceptor<kota::pipe>& acceptor, std::string endpoint, int iterations) {
+    auto guard = util::make_guard([&]() noexcept { (void)acceptor.stop(); });
+
+    for(auto [protocol, name]: {std::pair{Protocol::v1, "v1 (check_mode/create/decide/finish)"},
+                                std::pair{Protocol::v2, "v2 (decide + complete)"}}) {
+        std::vector<int64_t> samples;
+        samples.reserve(iterations);
+        for(int i = 0; i < iterations; ++i) {
+            samples.push_back(co_await one_exec(protocol, endpoint));
+        }
+        report(name, std::move(samples));
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    log::mute_logger();
+
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+    const auto endpoint = endpoint_name();
+
+    try {
+        kota::event_loop loop;
+        auto acc = kota::pipe::listen(endpoint, kota::pipe::options(), loop);
+        if(!acc) {
+            throw cpptrace::runtime_error(
+                std::format("Failed to listen on {}: {}", endpoint, acc.error().message()));
+        }
+
+        auto server = serve(*acc);
+        auto client = bench(*acc, endpoint, iterations);
+        loop.schedule(server);
+        loop.schedule(client);
+        loop.run();
+        client.result();
+        server.result();
+    } catch(const std::exception& ex) {
+        std::println("bench failed: {}", ex.what());
+        return 1;
+    }
+
+#ifndef CATTER_WINDOWS
+    std::error_code ec;
+    std::filesystem::remove(endpoint, ec);
+#endif
+    return 0;
+}
@@ -0,0 +1,187 @@
+// Measures how long a fresh runtime takes to load the whole builtin JS library.
+//
+// Every iteration creates a runtime, registers the native module and imports every module of
+// api/dist/manifest.json, once parsing the bundled source and once reading QuickJS bytecode
+// compiled up front. The difference is what the js-bytecode build option saves per start.
+//
+// usage: bench-js-startup [iterations]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <print>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cpptrace/exceptions.hpp>
+
+#include "js/apitool.h"
+#include "js/qjs.h"
+#include "util/log.h"
+
+using namespace catter;
+
+namespace {
+
+constexpr std::string_view js_dist_path = JS_DIST_PATH;
+
+/// Module name -> source or bytecode.
+using ModuleTable = std::map<std::string, std::string, std::less<>>;
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream input(path, std::ios::binary);
+    if(!input) {
+        throw cpptrace::runtime_error(std::format("Failed to read {}", path.string()));
+    }
+    return std::string(std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{});
+}
+
+ModuleTable load_sources() {
+    const std::filesystem::path dist = js_dist_path;
+    auto runtime = qjs::Runtime::create();
+    auto ctx = runtime.context();
+    ctx.global_this().set_property("manifest", read_file(dist / "manifest.json"));
+    auto pairs = ctx.eval_script(
+                        "Object.entries(JSON.parse(manifest).modules).flat().join('\\n')",
+                        "manifest.js")
+                     .as<std::string>();
+
+    ModuleTable sources;
+    std::string_view rest = pairs;
+    while(!rest.empty()) {
+        auto name_end = rest.find('\n');
+        auto file_end = rest.find('\n', name_end + 1);
+        auto name = rest.substr(0, name_end);
+        auto file = rest.substr(name_end + 1, file_end - name_end - 1);
+        sources.emplace(std::string(name), read_file(dist / file));
+        rest = file_end == std::string_view::npos ? std::string_view{} : rest.substr(file_end + 1);
+    }
+    return sources;
+}
+
+ModuleTable compile_all(const ModuleTable& sources) {
+    auto runtime = qjs::Runtime::create();
+    auto ctx = runtime.context();
+    ModuleTable bytecode;
+    for(const auto& [name, source]: sources) {
+        bytecode.emplace(name, ctx.compile_module(source, name.c_str()));
+    }
+    return bytecode;
+}
+
+struct TableLoader : qjs::Runtime::ModuleLoader {
+    TableLoader(const ModuleTable& modules, bool bytecode) : modules(modules), bytecode(bytecode) {}
+
+    std::string normalizer(std::string_view, std::string_view module_name) override {
+        return std::string(module_name);
+    }
+
+    qjs::Module loader(qjs::Context ctx, std::string_view module_name) override {
+        auto it = modules.find(module_name);
+        if(it == modules.end()) {
+            throw qjs::Exception("Unknown builtin module '{}'", module_name);
+        }
+        if(bytecode) {
+            return ctx.load_module_bytecode(it->second);
+        }
+        return ctx.load_module(it->second, it->first.c_str());
+    }
+
+    const ModuleTable& modules;
+    bool bytecode;
+};
+
+int64_t one_start(const ModuleTable& modules, bool bytecode, const std::string& entry) {
+    const auto start = std::chrono::steady_clock::now();
+
+    auto runtime = qjs::Runtime::create();
+    runtime.set_module_loader(std::make_unique<TableLoader>(modules, bytecode));
+    auto ctx = runtime.context();
+    auto& native = ctx.cmodule("catter/native");
+    for(auto& reg: apitool::api_registers()) {
+        reg(native, ctx);
+    }
+
+    auto promise = ctx.eval_module(entry, "bench-entry.js");
+    while(true) {
+        auto job = runtime.execute_pending_job();
+        if(!job) {
+            throw cpptrace::runtime_error("A builtin module failed to evaluate");
+        }
+        if(!*job) {
+            break;
+        }
+    }
+    if(!promise.is_fulfilled()) {
+        throw cpptrace::runtime_error("Loading the builtin modules did not complete");
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void report(std::string_view name, std::vector<int64_t> samples) {
+    std::ranges::sort(samples);
+    int64_t total = 0;
+    for(auto sample: samples) {
+        total += sample;
+    }
+    auto percentile = [&](double p) {
+        return samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))];
+    };
+    std::println("{}: n={} mean={}us p50={}us p99={}us max={}us",
+                 name,
+                 samples.size(),
+                 total / static_cast<int64_t>(samples.size()),
+                 percentile(0.50),
+                 percentile(0.99),
+                 samples.back());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    log::mute_logger();
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+
+    try {
+        const auto sources = load_sources();
+        const auto bytecode = compile_all(sources);
+
+        size_t source_size = 0;
+        size_t bytecode_size = 0;
+        std::string entry;
+        for(const auto& [name, source]: sources) {
+            source_size += source.size();
+            bytecode_size += bytecode.at(name).size();
+            entry += std::format("import \"{}\";\n", name);
+        }
+        std::println("{} modules: source={} bytes bytecode={} bytes",
+                     sources.size(),
+                     source_size,
+                     bytecode_size);
+
+        for(auto [use_bytecode, name]: {std::pair{false, "source (parse + compile)"},
+                                        std::pair{true, "bytecode (JS_ReadObject)"}}) {
+            std::vector<int64_t> samples;
+            samples.reserve(iterations);
+            const auto& modules = use_bytecode ? bytecode : sources;
+            for(int i = 0; i < iterations; ++i) {
+                samples.push_back(one_start(modules, use_bytecode, entry));
+            }
+            report(name, std::move(samples));
+        }
+    } catch(const std::exception& ex) {
+        std::println("bench failed: {}", ex.what());
+        return 1;
+    }
+    return 0;
+}
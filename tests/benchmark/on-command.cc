@@ -0,0 +1,152 @@
+// Measures how fast commands cross into an onCommand-style callback and back.
+//
+// Every command is handed to a JS handler, either as an eagerly converted plain object (the old
+// `CommandData::to_object` path) or as the lazy host object of `make_command_object`, and the
+// returned action is read back with `Action::make`. Three handlers cover the common shapes: one
+// that only looks at argv, one that also scans env, and one that rewrites argv and returns
+// `modify`. The gap between the two conversions on the argv handler is what a build saves when
+// scripts never touch the environment.
+//
+// usage: bench-on-command [commands]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <print>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cpptrace/exceptions.hpp>
+
+#include "js/capi/type.h"
+#include "js/command_object.h"
+#include "js/qjs.h"
+#include "util/log.h"
+
+using namespace catter;
+
+namespace {
+
+using Handler = qjs::Function<qjs::Object(qjs::Object)>;
+
+constexpr size_t distinct_commands = 64;
+
+/// A compile line and environment about the size of a real LLVM build step.
+js::CommandData synthetic_command(size_t index) {
+    js::CommandData command{
+        .cwd = "/home/user/llvm-project/build",
+        .exe = "/usr/bin/clang++",
+        .argv = {"/usr/bin/clang++"},
+        .env = {},
+        .runtime = {.supportActions = {js::ActionType::skip,
+                                       js::ActionType::drop,
+                                       js::ActionType::modify},
+                    .type = js::CatterRuntime::Type::inject,
+                    .supportParentId = true},
+        .parent = static_cast<int64_t>(index / 8),
+    };
+    for(auto flag: {"-DGTEST_HAS_RTTI=0", "-D_GNU_SOURCE", "-D__STDC_CONSTANT_MACROS",
+                    "-D__STDC_FORMAT_MACROS", "-D__STDC_LIMIT_MACROS", "-fPIC",
+                    "-fno-semantic-interposition", "-fvisibility-inlines-hidden",
+                    "-Werror=date-time", "-Wall", "-Wextra", "-Wno-unused-parameter",
+                    "-Wwrite-strings", "-Wcast-qual", "-Wmissing-field-initializers",
+                    "-pedantic", "-Wno-long-long", "-Wimplicit-fallthrough", "-O3",
+                    "-DNDEBUG", "-std=c++17", "-fno-exceptions", "-fno-rtti"}) {
+        command.argv.emplace_back(flag);
+    }
+    for(auto dir: {"lib/Support", "include", "../llvm/include", "../llvm/lib/Support"}) {
+        command.argv.push_back(std::format("-I/home/user/llvm-project/build/{}", dir));
+    }
+    command.argv.push_back("-MD");
+    command.argv.push_back("-MT");
+    command.argv.push_back(
+        std::format("lib/Support/CMakeFiles/LLVMSupport.dir/File{}.cpp.o", index));
+    command.argv.push_back("-c");
+    command.argv.push_back(
+        std::format("/home/user/llvm-project/llvm/lib/Support/File{}.cpp", index));
+
+    for(size_t i = 0; i < 96; ++i) {
+        command.env.push_back(std::format("BUILD_VAR_{}=/opt/toolchain/segment/{}/value", i, i));
+    }
+    command.env.push_back("PATH=/usr/local/bin:/usr/bin:/bin");
+    command.env.push_back("LANG=C.UTF-8");
+    return command;
+}
+
+constexpr std::string_view argv_handler = R"((data) =>
+    data.argv.some((arg) => arg.endsWith(".cpp")) ? { type: "skip" } : { type: "drop" })";
+
+constexpr std::string_view env_handler = R"((data) =>
+    data.argv.length > 0 && !data.env.some((entry) => entry.startsWith("CATTER_"))
+        ? { type: "skip" }
+        : { type: "drop" })";
+
+constexpr std::string_view modify_handler = R"((data) => {
+    data.argv = [...data.argv, "-DCATTER"];
+    return { type: "modify", data };
+})";
+
+/// Total microseconds for `count` commands through `source`.
+int64_t run(std::string_view source,
+            bool lazy,
+            const std::vector<js::CommandData>& commands,
+            size_t count) {
+    auto runtime = qjs::Runtime::create();
+    auto ctx = runtime.context();
+    auto handler = ctx.eval_script(source, "bench-on-command.js").as<qjs::Object>().as<Handler>();
+
+    size_t modified = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < count; ++i) {
+        auto command = commands[i % commands.size()];
+        auto object = lazy ? js::make_command_object(ctx.js_context(), std::move(command))
+                           : command.to_object(ctx.js_context());
+        auto action = js::Action::make(handler(std::move(object)));
+        modified += action.type() == js::ActionType::modify ? 1 : 0;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    if(source == modify_handler && modified != count) {
+        throw cpptrace::runtime_error("The modify handler did not modify every command");
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    log::mute_logger();
+    const size_t count = argc > 1 ? static_cast<size_t>(std::max(1, std::atoi(argv[1]))) : 100'000;
+
+    try {
+        std::vector<js::CommandData> commands;
+        for(size_t i = 0; i < distinct_commands; ++i) {
+            commands.push_back(synthetic_command(i));
+        }
+        std::println("{} commands: argv={} env={} entries each",
+                     count,
+                     commands.front().argv.size(),
+                     commands.front().env.size());
+
+        for(auto [name, source]: {std::pair{"argv only", argv_handler},
+                                  std::pair{"argv + env", env_handler},
+                                  std::pair{"modify argv", modify_handler}}) {
+            for(bool lazy: {false, true}) {
+                const auto total = run(source, lazy, commands, count);
+                std::println("{:<12} {:<6}: total={}ms per-command={}ns rate={}/s",
+                             name,
+                             lazy ? "lazy" : "eager",
+                             total / 1000,
+                             total * 1000 / static_cast<int64_t>(count),
+                             static_cast<int64_t>(count) * 1'000'000 / std::max<int64_t>(total, 1));
+            }
+        }
+    } catch(const std::exception& ex) {
+        std::println("bench failed: {}", ex.what());
+        return 1;
+    }
+    return 0;
+}
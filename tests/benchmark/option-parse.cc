@@ -0,0 +1,154 @@
+// Measures option parsing throughput from JS on real LLVM compile lines.
+//
+// "callback" is how `collect` used to work: option_parse calls back into JS once per argument
+// and every item becomes its own object. "packed" is the current `collect`: option_parse_all
+// returns typed arrays plus a string table in one call and JS builds the items from them.
+// "packedIds" skips building items, which is the floor for scripts that only look at
+// option ids.
+//
+// usage: bench-option-parse [iterations]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <print>
+#include <string_view>
+#include <cpptrace/exceptions.hpp>
+
+#include "js/apitool.h"
+#include "js/qjs.h"
+#include "util/log.h"
+
+using namespace catter;
+
+namespace {
+
+// Compile lines as they appear in the compile_commands.json of an LLVM release build, without
+// the compiler itself.
+constexpr std::string_view bench_script = R"(
+import { option_parse, option_parse_all } from "catter/native";
+
+const lines = [
+  "-DGTEST_HAS_RTTI=0 -D_DEBUG -D_GLIBCXX_ASSERTIONS -D_GNU_SOURCE -D__STDC_CONSTANT_MACROS -D__STDC_FORMAT_MACROS -D__STDC_LIMIT_MACROS -I/work/llvm-project/build/lib/Support -I/work/llvm-project/llvm/lib/Support -I/work/llvm-project/build/include -I/work/llvm-project/llvm/include -fPIC -fno-semantic-interposition -fvisibility-inlines-hidden -Werror=date-time -Wall -Wextra -Wno-unused-parameter -Wwrite-strings -Wcast-qual -Wno-missing-field-initializers -pedantic -Wno-long-long -Wimplicit-fallthrough -Wno-maybe-uninitialized -Wno-nonnull -Wno-class-memaccess -Wno-redundant-move -Wno-pessimizing-move -Wno-noexcept-type -Wdelete-non-virtual-dtor -Wsuggest-override -Wno-comment -Wno-misleading-indentation -Wctad-maybe-unsupported -fdiagnostics-color -ffunction-sections -fdata-sections -O3 -DNDEBUG -std=c++17 -fno-exceptions -funwind-tables -fno-rtti -MD -MT lib/Support/CMakeFiles/LLVMSupport.dir/APInt.cpp.o -MF lib/Support/CMakeFiles/LLVMSupport.dir/APInt.cpp.o.d -o lib/Support/CMakeFiles/LLVMSupport.dir/APInt.cpp.o -c /work/llvm-project/llvm/lib/Support/APInt.cpp",
+  "-DCLANG_EXPORTS -DGTEST_HAS_RTTI=0 -D_DEBUG -D_GLIBCXX_ASSERTIONS -D_GNU_SOURCE -D__STDC_CONSTANT_MACROS -D__STDC_FORMAT_MACROS -D__STDC_LIMIT_MACROS -I/work/llvm-project/build/tools/clang/lib/Sema -I/work/llvm-project/clang/lib/Sema -I/work/llvm-project/clang/include -I/work/llvm-project/build/tools/clang/include -I/work/llvm-project/build/include -I/work/llvm-project/llvm/include -fPIC -fno-semantic-interposition -fvisibility-inlines-hidden -Werror=date-time -Wall -Wextra -Wno-unused-parameter -Wwrite-strings -Wcast-qual -Wno-missing-field-initializers -pedantic -Wno-long-long -Wimplicit-fallthrough -Wno-maybe-uninitialized -Wno-nonnull -Wno-class-memaccess -Wno-redundant-move -Wno-pessimizing-move -Wno-noexcept-type -Wdelete-non-virtual-dtor -Wsuggest-override -Wno-comment -Wno-misleading-indentation -Wctad-maybe-unsupported -fdiagnostics-color -ffunction-sections -fdata-sections -fno-common -Woverloaded-virtual -fno-strict-aliasing -O3 -DNDEBUG -std=c++17 -fno-exceptions -funwind-tables -fno-rtti -MD -MT tools/clang/lib/Sema/CMakeFiles/obj.clangSema.dir/SemaDecl.cpp.o -MF tools/clang/lib/Sema/CMakeFiles/obj.clangSema.dir/SemaDecl.cpp.o.d -o tools/clang/lib/Sema/CMakeFiles/obj.clangSema.dir/SemaDecl.cpp.o -c /work/llvm-project/clang/lib/Sema/SemaDecl.cpp",
+  "-D_DEBUG -D_GLIBCXX_ASSERTIONS -D_GNU_SOURCE -D__STDC_CONSTANT_MACROS -D__STDC_FORMAT_MACROS -D__STDC_LIMIT_MACROS -I/work/llvm-project/build/lib/Support -I/work/llvm-project/llvm/lib/Support -I/work/llvm-project/build/include -I/work/llvm-project/llvm/include -fPIC -Werror=date-time -Wall -W -Wno-unused-parameter -Wwrite-strings -Wno-missing-field-initializers -pedantic -Wno-long-long -Wimplicit-fallthrough -Wno-comment -fdiagnostics-color -ffunction-sections -fdata-sections -O3 -DNDEBUG -std=gnu11 -MD -MT lib/Support/CMakeFiles/LLVMSupport.dir/regcomp.c.o -MF lib/Support/CMakeFiles/LLVMSupport.dir/regcomp.c.o.d -o lib/Support/CMakeFiles/LLVMSupport.dir/regcomp.c.o -c /work/llvm-project/llvm/lib/Support/regcomp.c",
+].map((line) => line.split(" "));
+
+globalThis.argumentsPerRound = lines.reduce((sum, args) => sum + args.length, 0);
+
+globalThis.callback = (rounds) => {
+  let count = 0;
+  for (let round = 0; round < rounds; ++round) {
+    for (const args of lines) {
+      const items = [];
+      option_parse("clang", args, (item) => {
+        if (typeof item === "string") {
+          throw new Error(item);
+        }
+        items.push(item);
+        return true;
+      });
+      count += items.length;
+    }
+  }
+  return count;
+};
+
+globalThis.packed = (rounds) => {
+  let count = 0;
+  for (let round = 0; round < rounds; ++round) {
+    for (const args of lines) {
+      const packed = option_parse_all("clang", args);
+      if (packed.error !== undefined) {
+        throw new Error(packed.error);
+      }
+      const items = new Array(packed.ids.length);
+      for (let i = 0; i < items.length; ++i) {
+        const start = packed.offsets[i];
+        items[i] = {
+          values: packed.strings.slice(start + 1, packed.offsets[i + 1]),
+          key: packed.strings[start],
+          id: packed.ids[i],
+          index: packed.indices[i],
+        };
+      }
+      count += items.length;
+    }
+  }
+  return count;
+};
+
+globalThis.packedIds = (rounds) => {
+  let count = 0;
+  for (let round = 0; round < rounds; ++round) {
+    for (const args of lines) {
+      count += option_parse_all("clang", args).ids.length;
+    }
+  }
+  return count;
+};
+)";
+
+using Bench = qjs::Function<int64_t(int64_t)>;
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    log::mute_logger();
+    const int64_t rounds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+
+    try {
+        auto runtime = qjs::Runtime::create();
+        auto ctx = runtime.context();
+        auto& native = ctx.cmodule("catter/native");
+        for(auto& reg: apitool::api_registers()) {
+            reg(native, ctx);
+        }
+
+        auto promise = ctx.eval_module(bench_script, "bench-option-parse.js");
+        while(true) {
+            auto job = runtime.execute_pending_job();
+            if(!job) {
+                throw cpptrace::runtime_error("The benchmark script failed to evaluate");
+            }
+            if(!*job) {
+                break;
+            }
+        }
+        if(!promise.is_fulfilled()) {
+            throw cpptrace::runtime_error("The benchmark script did not complete");
+        }
+
+        auto global = ctx.global_this();
+        const auto arguments = global["argumentsPerRound"].as<int64_t>();
+        std::println("{} rounds of 3 LLVM compile lines, {} arguments per round", rounds, arguments);
+
+        int64_t expected_items = -1;
+        for(auto name: {"callback", "packed", "packedIds"}) {
+            auto bench = global[name].as<qjs::Object>().as<Bench>();
+            (void)bench(std::max<int64_t>(1, rounds / 20));
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto items = bench(rounds);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            const auto us = std::max<int64_t>(
+                1,
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+            if(expected_items != -1 && items != expected_items) {
+                throw cpptrace::runtime_error("Parsers disagree on the number of items");
+            }
+            expected_items = items;
+            std::println("{:<10}: total={}ms lines/s={} args/s={}",
+                         name,
+                         us / 1000,
+                         rounds * 3 * 1'000'000 / us,
+                         rounds * arguments * 1'000'000 / us);
+        }
+    } catch(const std::exception& ex) {
+        std::println("bench failed: {}", ex.what());
+        return 1;
+    }
+    return 0;
+}
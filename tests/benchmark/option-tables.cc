@@ -0,0 +1,192 @@
+// Measures parse throughput of every option table, through the option table alone and through
+// the prefix index with the option table handling what the index leaves to it.
+//
+// Each table parses an argument vector spelled from its own Flag, Joined, Separate and
+// JoinedOrSeparate options, so the run covers its whole name space rather than a few popular
+// flags. clang additionally parses a compile line of an LLVM release build.
+//
+// usage: bench-option-tables [rounds]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <print>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cpptrace/exceptions.hpp>
+#include <kota/deco/option.h>
+
+#include "option/clang.h"
+#include "option/lld_coff.h"
+#include "option/lld_elf.h"
+#include "option/lld_macho.h"
+#include "option/lld_mingw.h"
+#include "option/lld_wasm.h"
+#include "option/llvm_dlltool.h"
+#include "option/llvm_lib.h"
+#include "option/nvcc.h"
+#include "option/prefix_index.h"
+
+using namespace catter;
+
+namespace {
+
+namespace kota_opt = kota::option;
+
+constexpr uint32_t all_visibility = 0xffffffffU;
+
+constexpr std::string_view llvm_compile_line =
+    "-DGTEST_HAS_RTTI=0 -D_DEBUG -D_GLIBCXX_ASSERTIONS -D_GNU_SOURCE -D__STDC_CONSTANT_MACROS "
+    "-D__STDC_FORMAT_MACROS -D__STDC_LIMIT_MACROS -I/work/llvm-project/build/lib/Support "
+    "-I/work/llvm-project/llvm/lib/Support -I/work/llvm-project/build/include "
+    "-I/work/llvm-project/llvm/include -fPIC -fno-semantic-interposition "
+    "-fvisibility-inlines-hidden -Werror=date-time -Wall -Wextra -Wno-unused-parameter "
+    "-Wwrite-strings -Wcast-qual -Wno-missing-field-initializers -pedantic -Wno-long-long "
+    "-Wimplicit-fallthrough -Wno-maybe-uninitialized -Wno-nonnull -Wno-class-memaccess "
+    "-Wno-redundant-move -Wno-pessimizing-move -Wno-noexcept-type -Wdelete-non-virtual-dtor "
+    "-Wsuggest-override -Wno-comment -Wno-misleading-indentation -Wctad-maybe-unsupported "
+    "-fdiagnostics-color -ffunction-sections -fdata-sections -O3 -DNDEBUG -std=c++17 "
+    "-fno-exceptions -funwind-tables -fno-rtti -MD -MT "
+    "lib/Support/CMakeFiles/LLVMSupport.dir/APInt.cpp.o -MF "
+    "lib/Support/CMakeFiles/LLVMSupport.dir/APInt.cpp.o.d -o "
+    "lib/Support/CMakeFiles/LLVMSupport.dir/APInt.cpp.o -c "
+    "/work/llvm-project/llvm/lib/Support/APInt.cpp";
+
+struct Table {
+    std::string_view name;
+    const kota_opt::OptTable& table;
+    const opt::PrefixIndex& index;
+};
+
+std::vector<std::string> split(std::string_view line) {
+    std::vector<std::string> args;
+    while(!line.empty()) {
+        const auto space = line.find(' ');
+        args.emplace_back(line.substr(0, space));
+        line = space == std::string_view::npos ? std::string_view() : line.substr(space + 1);
+    }
+    return args;
+}
+
+/// Every spelling of the table's plain options, with a value where the kind takes one.
+std::vector<std::string> spelled_options(const kota_opt::OptTable& table) {
+    std::vector<std::string> args;
+    for(const auto& option: table.option_infos) {
+        if(option.prefixes.empty()) {
+            continue;
+        }
+        const auto name = option.prefixed_name.substr(option.prefixes.front().size());
+        for(auto prefix: option.prefixes) {
+            auto spelling = std::string(prefix) + std::string(name);
+            switch(option.kind) {
+                case kota_opt::Kind::Flag: args.push_back(std::move(spelling)); break;
+                case kota_opt::Kind::Joined: args.push_back(spelling + "value"); break;
+                case kota_opt::Kind::Separate:
+                case kota_opt::Kind::JoinedOrSeparate:
+                    args.push_back(std::move(spelling));
+                    args.push_back("value");
+                    break;
+                default: break;
+            }
+        }
+    }
+    return args;
+}
+
+size_t parse_table(const Table& table, std::span<const std::string> args, size_t from) {
+    kota_opt::ParseOptions options;
+    options.dash_dash_parsing = true;
+    options.visibility = all_visibility;
+    size_t items = 0;
+    for(auto parsed: table.table.parse(args.subspan(from), options)) {
+        if(!parsed.has_value()) {
+            break;
+        }
+        ++items;
+    }
+    return items;
+}
+
+size_t parse_indexed(const Table& table, std::span<const std::string> args) {
+    size_t items = 0;
+    size_t at = 0;
+    while(at < args.size()) {
+        auto resolved = table.index.resolve(args, at, all_visibility);
+        if(!resolved) {
+            return items + parse_table(table, args, at);
+        }
+        ++items;
+        at = resolved->next;
+    }
+    return items;
+}
+
+/// Microseconds for `rounds` parses of `args`, and the items of one parse.
+template <typename Parse>
+std::pair<int64_t, size_t> measure(int64_t rounds, const Parse& parse) {
+    size_t items = parse();
+    const auto start = std::chrono::steady_clock::now();
+    for(int64_t round = 0; round < rounds; ++round) {
+        items = parse();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return {std::max<int64_t>(
+                1,
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()),
+            items};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int64_t rounds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+
+    try {
+        const std::vector<Table> tables = {
+            {"clang",        opt::clang::table(),        opt::clang::prefix_index()       },
+            {"lld-coff",     opt::lld_coff::table(),     opt::lld_coff::prefix_index()    },
+            {"lld-elf",      opt::lld_elf::table(),      opt::lld_elf::prefix_index()     },
+            {"lld-macho",    opt::lld_macho::table(),    opt::lld_macho::prefix_index()   },
+            {"lld-mingw",    opt::lld_mingw::table(),    opt::lld_mingw::prefix_index()   },
+            {"lld-wasm",     opt::lld_wasm::table(),     opt::lld_wasm::prefix_index()    },
+            {"nvcc",         opt::nvcc::table(),         opt::nvcc::prefix_index()        },
+            {"llvm-dlltool", opt::llvm_dlltool::table(), opt::llvm_dlltool::prefix_index()},
+            {"llvm-lib",     opt::llvm_lib::table(),     opt::llvm_lib::prefix_index()    },
+        };
+
+        std::println("{} rounds per table", rounds);
+        auto run = [&](const Table& table,
+                       std::string_view label,
+                       std::span<const std::string> args) {
+            const auto [table_us, table_items] =
+                measure(rounds, [&] { return parse_table(table, args, 0); });
+            const auto [index_us, index_items] =
+                measure(rounds, [&] { return parse_indexed(table, args); });
+            if(table_items != index_items) {
+                throw cpptrace::runtime_error(
+                    std::format("{}: the index and the table disagree on the items", label));
+            }
+            std::println("{:<14}: args={} nodes={} table args/s={} indexed args/s={} x{:.2f}",
+                         label,
+                         args.size(),
+                         table.index.node_count(),
+                         rounds * static_cast<int64_t>(args.size()) * 1'000'000 / table_us,
+                         rounds * static_cast<int64_t>(args.size()) * 1'000'000 / index_us,
+                         static_cast<double>(table_us) / static_cast<double>(index_us));
+        };
+
+        for(const auto& table: tables) {
+            run(table, table.name, spelled_options(table.table));
+        }
+        run(tables.front(), "clang (LLVM)", split(llvm_compile_line));
+    } catch(const std::exception& ex) {
+        std::println("bench failed: {}", ex.what());
+        return 1;
+    }
+    return 0;
+}
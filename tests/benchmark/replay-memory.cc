@@ -0,0 +1,106 @@
+// Replays a generated line-delimited trace of a huge build and reports the peak memory of the
+// replay, which must stay bounded by the longest line rather than grow with the trace. CI runs
+// it with a million events through `pixi run replay-memory` and fails when it exceeds the budget.
+//
+// usage: bench-replay-memory [events]
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <cpptrace/exceptions.hpp>
+
+#include "replay.h"
+#include "util/log.h"
+
+using namespace catter;
+namespace fs = std::filesystem;
+
+namespace {
+
+/// Peak resident memory must grow by less than this, the trace itself is several times larger.
+constexpr uint64_t budget_kib = 64 * 1024;
+
+/// Reads a `/proc/self/status` field such as `VmRSS`, in KiB, 0 where there is none.
+uint64_t status_kib(std::string_view field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line)) {
+        if(line.starts_with(field) && line[field.size()] == ':') {
+            return std::stoull(line.substr(field.size() + 1));
+        }
+    }
+    return 0;
+}
+
+void write_trace(const fs::path& replay_path, const fs::path& script_path, uint64_t events) {
+    std::ofstream script(script_path, std::ios::binary);
+    script << "import { register } from \"catter/service\";\n"
+           << "let commands = 0;\n"
+           << "register({\n"
+           << "  onCommand(ctx) { commands += 1; },\n"
+           << "  onFinish() {\n"
+           << "    if (commands !== " << events << ") {\n"
+           << "      throw new Error(`replayed ${commands} commands`);\n"
+           << "    }\n"
+           << "  },\n"
+           << "});\n";
+
+    std::ofstream output(replay_path, std::ios::binary);
+    output << R"({"version": 2, "build_system_command": ["make"]})" << "\n";
+    for(uint64_t id = 1; id <= events; ++id) {
+        output << R"({"type": "command", "id": )" << id
+               << R"(, "parent": 1, "exe": "clang++", "argv": ["clang++", "-c", "src/unit_)" << id
+               << R"(.cc", "-o", "obj/unit_)" << id << R"(.o", "-O2"]})" << "\n";
+    }
+    output << R"({"type": "finish", "code": 0, "stdout": "", "stderr": ""})" << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const uint64_t events = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    log::mute_logger();
+
+    const auto root = fs::temp_directory_path() / "catter-bench-replay-memory";
+    std::error_code ec;
+    fs::create_directories(root, ec);
+    const auto replay_path = root / "large.ndjson";
+    const auto script_path = root / "count.js";
+
+    int code = 0;
+    try {
+        write_trace(replay_path, script_path, events);
+        const auto trace_kib = fs::file_size(replay_path) / 1024;
+
+        const auto baseline_kib = status_kib("VmRSS");
+        // Resets VmHWM to the current RSS so it reports the peak of the replay alone.
+        std::ofstream("/proc/self/clear_refs") << "5";
+
+        core::ReplayStream stream(replay_path);
+        core::ReplayRunner replay;
+        replay.run(core::ReplayConfig{.script = script_path.string(), .working_directory = root},
+                   stream);
+
+        const auto peak_kib = status_kib("VmHWM");
+        std::println("{} events, trace {} KiB, peak RSS +{} KiB (budget {} KiB)",
+                     events,
+                     trace_kib,
+                     peak_kib - baseline_kib,
+                     budget_kib);
+        if(peak_kib != 0 && peak_kib >= baseline_kib + budget_kib) {
+            std::println("bench failed: the replay is not bounded in memory");
+            code = 1;
+        }
+    } catch(const std::exception& ex) {
+        std::println("bench failed: {}", ex.what());
+        code = 1;
+    }
+
+    fs::remove_all(root, ec);
+    return code;
+}
@@ -0,0 +1,240 @@
+// Soaks the inject runtime with a long build of trivial processes and checks that its memory
+// stays flat.
+//
+// The build runs the way `catter -m inject --record <file> script::cdb` runs it: the real
+// InjectService decides every exec through the JS runtime, with the per-session tables behind it
+// (the environment table, the option, compiler and bytecode caches and the replay recorder). The
+// build driver is this binary, which spawns trivial processes a few at a time; the hook turns each
+// of them into one intercepted exec. A thread samples the RSS of this process while the build
+// runs, and the run fails when the RSS of the last half of the build grows past the RSS after
+// warm-up by more than the tolerance.
+//
+// usage: bench-session-soak [processes] [concurrency]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <print>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cpptrace/exceptions.hpp>
+#include <kota/async/async.h>
+
+#include "runtime_driver.h"
+#include "js/js.h"
+#include "util/crossplat.h"
+#include "util/data.h"
+#include "util/kotatsu.h"
+#include "util/log.h"
+
+namespace fs = std::filesystem;
+using namespace catter;
+
+namespace {
+
+constexpr uint64_t tolerance_kib = 8 * 1024;
+
+/// Reads the RSS of this process in KiB, 0 where /proc is not available.
+uint64_t rss_kib() {
+#ifdef CATTER_LINUX
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line)) {
+        if(line.starts_with("VmRSS:")) {
+            return std::stoull(line.substr(6));
+        }
+    }
+#endif
+    return 0;
+}
+
+/// Samples the RSS every few milliseconds from a thread of its own. The driver spawns processes
+/// at a steady rate, so time stands in for progress through the build.
+class RssSampler {
+public:
+    RssSampler() :
+        thread([this](std::stop_token stop) {
+            while(!stop.stop_requested()) {
+                samples.emplace_back(std::chrono::steady_clock::now(), rss_kib());
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }) {}
+
+    /// Stops sampling, then returns the RSS at 10% of the run and the peak of its last half.
+    std::pair<uint64_t, uint64_t> finish() {
+        thread.request_stop();
+        thread.join();
+        if(samples.empty()) {
+            return {0, 0};
+        }
+        const auto begin = samples.front().first;
+        const auto duration = samples.back().first - begin;
+        uint64_t warm_kib = 0;
+        uint64_t late_peak_kib = 0;
+        for(const auto& [time, kib]: samples) {
+            if(warm_kib == 0 && time - begin >= duration / 10) {
+                warm_kib = kib;
+            }
+            if(time - begin >= duration / 2) {
+                late_peak_kib = std::max(late_peak_kib, kib);
+            }
+        }
+        return {warm_kib, late_peak_kib};
+    }
+
+private:
+    std::vector<std::pair<std::chrono::steady_clock::time_point, uint64_t>> samples;
+    std::jthread thread;  // Last, so it stops before `samples` goes away.
+};
+
+/// Runs `--noop` children one after another until `next` reaches `processes`.
+kota::task<> drive_worker(std::string self, uint64_t& next, uint64_t processes) {
+    while(next < processes) {
+        ++next;
+        kota::process::options opts{
+            .file = self,
+            .args = {self, "--noop"},
+            .env = util::get_environment(),
+            .cwd = {},
+            .creation = {.windows_hide = true, .windows_verbatim_arguments = true},
+            .streams = {kota::process::stdio::inherit(),
+                         output_stdio(data::CaptureMode::NONE),
+                         output_stdio(data::CaptureMode::NONE)}
+        };
+        auto result = co_await capture_process_result(make_process_event(opts),
+                                                      nullptr,
+                                                      nullptr,
+                                                      {.mode = data::CaptureMode::NONE});
+        if(result.code != 0) {
+            throw cpptrace::runtime_error(
+                std::format("exec {} exited with {}", next, result.code));
+        }
+    }
+}
+
+int drive(uint64_t processes, uint64_t concurrency) {
+    const auto self = util::get_executable_path().string();
+    uint64_t next = 0;
+    std::vector<kota::task<>> workers;
+    for(uint64_t i = 0; i < concurrency; ++i) {
+        workers.push_back(drive_worker(self, next, processes));
+    }
+
+    kota::event_loop loop;
+    for(auto& worker: workers) {
+        loop.schedule(worker);
+    }
+    loop.run();
+    for(auto& worker: workers) {
+        worker.result();
+    }
+    return 0;
+}
+
+/// The build as `catter -m inject --record` runs it, with script::cdb deciding every exec.
+kota::task<data::process_result> run_build(fs::path dir,
+                                           uint64_t processes,
+                                           uint64_t concurrency) {
+    const auto self = util::get_executable_path().string();
+    const auto* driver = core::default_runtime_driver();
+
+    js::RuntimeScope runtime;
+    data::process_result result;
+    std::exception_ptr error;
+    try {
+        runtime.start({
+            .pwd = dir,
+            .bytecode_cache = dir / "cache",
+            .compiler_cache = dir / "cache" / "compiler",
+        });
+        co_await js::run_builtin_script("script::cdb");
+        auto config = co_await js::on_start(js::CatterConfig{
+            .scriptPath = "script::cdb",
+            .scriptArgs = {"-o", (dir / "compile_commands.json").string()},
+            .buildSystemCommand =
+                {self, "--drive", std::to_string(processes), std::to_string(concurrency)},
+            .buildSystemCommandCwd = dir.string(),
+            .runtime = driver->runtime(),
+            .options = {.log = false,
+                        .stdioMode = js::CatterOptions::StdioMode::inherit,
+                        .record = (dir / "soak.ndjson").string()},
+            .execute = true,
+        });
+        result = co_await driver->execute(config);
+        co_await js::on_finish(core::to_js_process_result(result));
+    } catch(...) {
+        error = std::current_exception();
+    }
+    co_await runtime.stop();
+    if(error) {
+        std::rethrow_exception(error);
+    }
+    co_return result;
+}
+
+int soak(uint64_t processes, uint64_t concurrency) {
+    const auto dir = fs::temp_directory_path() /
+                     std::format("catter-bench-session-soak-{}", util::get_process_id());
+    fs::create_directories(dir);
+
+    RssSampler sampler;
+    auto task = run_build(dir, processes, concurrency);
+    kota::event_loop loop;
+    loop.schedule(task);
+    loop.run();
+    const auto [warm_kib, late_peak_kib] = sampler.finish();
+
+    auto result = task.result();
+    const auto recorded = fs::file_size(dir / "soak.ndjson");
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    if(result.code != 0) {
+        std::println("soak failed: the driver exited with {}", result.code);
+        return 1;
+    }
+
+    std::println("processes={} concurrency={} recorded={}KiB warm rss={}KiB late peak rss={}KiB",
+                 processes,
+                 concurrency,
+                 recorded / 1024,
+                 warm_kib,
+                 late_peak_kib);
+    if(late_peak_kib > warm_kib + tolerance_kib) {
+        std::println("soak failed: RSS grew by {}KiB, more than the {}KiB tolerance",
+                     late_peak_kib - warm_kib,
+                     tolerance_kib);
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    log::mute_logger();
+
+    try {
+        if(argc > 1 && std::string_view(argv[1]) == "--noop") {
+            return 0;
+        }
+        if(argc > 3 && std::string_view(argv[1]) == "--drive") {
+            return drive(std::stoull(argv[2]), std::stoull(argv[3]));
+        }
+
+        const uint64_t processes = argc > 1 ? std::max<uint64_t>(1, std::stoull(argv[1]))
+                                            : 1'000'000;
+        const uint64_t concurrency = argc > 2 ? std::max<uint64_t>(1, std::stoull(argv[2])) : 16;
+        return soak(processes, concurrency);
+    } catch(const std::exception& ex) {
+        std::println("soak failed: {}", ex.what());
+        return 1;
+    }
+}
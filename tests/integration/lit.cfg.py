@@ -127,6 +127,20 @@ match platform.system():
                 hook_path = f"env LD_PRELOAD={asan_path} {hook_path}"
                 catter_path = f"env LD_PRELOAD={asan_path} {catter_path}"
 
+def pidfd_reports_exit_status() -> bool:
+    """PIDFD_GET_INFO reports the status of exited processes since Linux 6.15."""
+    if platform.system() != "Linux":
+        return False
+    try:
+        version = tuple(int(part) for part in platform.release().split("-")[0].split(".")[:2])
+    except ValueError:
+        return False
+    return version >= (6, 15)
+
+
+if pidfd_reports_exit_status():
+    config.available_features.add("pidfd-exit-status")
+
 config.substitutions.append(("%it_catter_hook", hook_path))
 config.substitutions.append(("%it_catter_proxy", it_proxy_path))
 config.substitutions.append(("%it_catter_replay", it_replay_path))
@@ -11,7 +11,7 @@ namespace fs = std::filesystem;
 
 int main(int argc, char* argv[]) {
     if(argc < 3) {
-        std::println(stderr, "usage: it-catter-replay <replay.json> <script> [script args...]");
+        std::println(stderr, "usage: it-catter-replay <replay file> <script> [script args...]");
         return 2;
     }
 
@@ -19,7 +19,7 @@ int main(int argc, char* argv[]) {
         catter::log::mute_logger();
 
         const fs::path replay_path = argv[1];
-        auto replay = catter::core::parse_replay_file(replay_path);
+        catter::core::ReplayStream replay(replay_path);
 
         catter::core::ReplayConfig config;
         config.script = argv[2];
@@ -30,8 +30,8 @@ int main(int argc, char* argv[]) {
         // Relative fixture paths resolve against the replay file directory so
         // checked-in fixtures stay portable across platforms.
         const fs::path base = replay_path.parent_path();
-        if(replay.cwd.has_value()) {
-            fs::path cwd = *replay.cwd;
+        if(const auto& cwd_field = replay.metadata().cwd; cwd_field.has_value()) {
+            fs::path cwd = *cwd_field;
             config.working_directory = cwd.is_absolute() ? cwd : (base / cwd).lexically_normal();
         } else {
             config.working_directory = base;
@@ -3,6 +3,12 @@
 // RUN: "%it_catter_proxy" "%catter_proxy" -p 0 -- "%it_catter_proxy" --child | FileCheck %s --check-prefix=IMPLICIT -DIT_PROXY="%it_catter_proxy"
 // RUN: not "%it_catter_proxy" "%catter_proxy" -p 0 | FileCheck %s --check-prefix=MISSING
 // RUN: not "%it_catter_proxy" "%catter_proxy" -p 0 -- nonexistent-executable-catter-proxy-test | FileCheck %s --check-prefix=NONEXISTENT
+// RUN: "%it_catter_proxy" --capture-none "%catter_proxy" -p 0 -- "%it_catter_proxy" --child | FileCheck %s --check-prefix=CAPTURE-NONE -DIT_PROXY="%it_catter_proxy"
+// RUN: "%it_catter_proxy" --parallel 4 "%catter_proxy" -p 0 -- "%it_catter_proxy" --child | FileCheck %s --check-prefix=PARALLEL
+// RUN: %if system-linux || system-darwin %{ "%it_catter_proxy" --processes 4 "%catter_proxy" -p 0 -- "%it_catter_proxy" --child | FileCheck %s --check-prefix=PROCESSES %}
+// RUN: rm -rf "%t" && "%it_catter_proxy" --fake "%t/out/main.o" "%catter_proxy" -p 0 -- "%it_catter_proxy" --child | FileCheck %s --check-prefix=FAKE
+// RUN: %if system-linux && pidfd-exit-status %{ "%it_catter_proxy" --exec-through "%catter_proxy" -p 0 -- "%it_catter_proxy" --child | FileCheck %s --check-prefixes=EXEC-THROUGH,EXIT-STATUS -DIT_PROXY="%it_catter_proxy" %}
+// RUN: %if system-linux && !pidfd-exit-status %{ "%it_catter_proxy" --exec-through "%catter_proxy" -p 0 -- "%it_catter_proxy" --child | FileCheck %s --check-prefixes=EXEC-THROUGH,NO-EXIT-STATUS -DIT_PROXY="%it_catter_proxy" %}
 //
 // EXPLICIT: event=create service=1 parent=0
 // EXPLICIT-NEXT: event=decision executable="[[IT_PROXY]]" cwd="{{.*}}" argc=2
@@ -33,14 +39,62 @@
 // NONEXISTENT-NEXT: event=error parent=0 message="{{.+}}"
 // NONEXISTENT-NOT: event=finish
 // NONEXISTENT-NEXT: proxy=exit code={{(-1|255|4294967295)}} stdout="" stderr=""
+//
+// The child writes to the inherited stdout of the proxy, nothing is relayed to the service.
+// CAPTURE-NONE: event=create service=1 parent=0
+// CAPTURE-NONE-NEXT: event=decision executable="[[IT_PROXY]]" cwd="{{.*}}" argc=2
+// CAPTURE-NONE-NEXT: event=argument index=0 value="[[IT_PROXY]]"
+// CAPTURE-NONE-NEXT: event=argument index=1 value="--child"
+// CAPTURE-NONE-NEXT: event=finish code=0 stdout="" stderr=""
+// CAPTURE-NONE-NEXT: proxy=exit code=0 stdout="child output" stderr=""
+//
+// Sessions running side by side each get their own endpoint, so every one of them sees exactly
+// the command of its own proxy.
+// PARALLEL-NOT: harness=error
+// PARALLEL: session=0 finished=1 errors=0 code=0 stdout="child output"
+// PARALLEL-NEXT: session=1 finished=1 errors=0 code=0 stdout="child output"
+// PARALLEL-NEXT: session=2 finished=1 errors=0 code=0 stdout="child output"
+// PARALLEL-NEXT: session=3 finished=1 errors=0 code=0 stdout="child output"
+//
+// The same across separate processes, each running one session like concurrent catter runs.
+// PROCESSES-NOT: harness=error
+// PROCESSES: process=0 finished=1 errors=0 code=0 stdout="child output"
+// PROCESSES-NEXT: process=1 finished=1 errors=0 code=0 stdout="child output"
+// PROCESSES-NEXT: process=2 finished=1 errors=0 code=0 stdout="child output"
+// PROCESSES-NEXT: process=3 finished=1 errors=0 code=0 stdout="child output"
+//
+// The command is not run, the proxy creates its output instead.
+// FAKE: event=create service=1 parent=0
+// FAKE: event=finish code=0 stdout="" stderr=""
+// FAKE-NEXT: proxy=exit code=0 stdout="" stderr=""
+// FAKE-NEXT: fake output="{{.*}}main.o" size={{[1-9][0-9]*}}
+//
+// The exit code is only reported by Linux 6.15 and later, the output is not captured. The
+// status is read once the proxy of the build reaps the process, never earlier.
+// EXEC-THROUGH: event=create service=1 parent=0
+// EXEC-THROUGH-NEXT: event=decision executable="[[IT_PROXY]]" cwd="{{.*}}" argc=2
+// EXEC-THROUGH-NEXT: event=argument index=0 value="[[IT_PROXY]]"
+// EXEC-THROUGH-NEXT: event=argument index=1 value="--child"
+// EXIT-STATUS-NEXT: event=finish code=0 stdout="" stderr=""
+// NO-EXIT-STATUS-NEXT: event=finish code=-1 stdout="" stderr=""
+// EXEC-THROUGH-NEXT: proxy=exit code=0 stdout="child output" stderr=""
 // clang-format on
+#include <cerrno>
+#include <cstdlib>
 #include <exception>
+#include <filesystem>
+#include <format>
 #include <memory>
 #include <print>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <vector>
 #include <kota/async/async.h>
+#ifndef CATTER_WINDOWS
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include "ipc.h"
 #include "session.h"
@@ -51,7 +105,11 @@ using namespace catter;
 
 class ServiceImpl : public ipc::InjectService {
 public:
-    explicit ServiceImpl(data::ipcid_t id) : id(id) {}
+    ServiceImpl(data::ipcid_t id,
+                bool through,
+                data::capture_policy capture,
+                std::vector<std::string> fake_outputs) :
+        id(id), through(through), capture(capture), fake_outputs(std::move(fake_outputs)) {}
 
     ~ServiceImpl() override = default;
 
@@ -68,7 +126,17 @@ public:
         for(size_t index = 0; index < cmd.args.size(); ++index) {
             std::println(R"(event=argument index={} value="{}")", index, cmd.args[index]);
         }
-        co_return data::action{.type = data::action::WRAP, .cmd = std::move(cmd)};
+        if(!this->fake_outputs.empty()) {
+            co_return data::action{
+                .type = data::action::FAKE,
+                .cmd = std::move(cmd),
+                .outputs = this->fake_outputs,
+            };
+        }
+        co_return data::action{
+            .type = this->through ? data::action::INJECT : data::action::WRAP,
+            .cmd = std::move(cmd),
+        };
     }
 
     kota::task<> finish(data::process_result result) noexcept override {
@@ -84,19 +152,204 @@ public:
         co_return;
     }
 
+    bool exec_through() const override {
+        return this->through;
+    }
+
+    data::capture_policy capture_policy() const override {
+        return this->capture;
+    }
+
     struct Factory {
+        bool through = false;
+        data::capture_policy capture{};
+        std::vector<std::string> fake_outputs{};
+
         std::unique_ptr<ServiceImpl> operator() (data::ipcid_t id) const {
-            return std::make_unique<ServiceImpl>(id);
+            return std::make_unique<ServiceImpl>(id, through, capture, fake_outputs);
+        }
+    };
+
+private:
+    data::ipcid_t id;
+    bool through;
+    data::capture_policy capture;
+    std::vector<std::string> fake_outputs;
+};
+
+/// Only counts what reaches it, for sessions running side by side.
+class CountingService : public ipc::InjectService {
+public:
+    struct Counters {
+        int finished = 0;
+        int errors = 0;
+    };
+
+    CountingService(data::ipcid_t id, Counters& counters) : id(id), counters(counters) {}
+
+    kota::task<data::ipcid_t> create(data::ipcid_t) noexcept override {
+        co_return this->id;
+    }
+
+    kota::task<data::action> make_decision(data::command cmd) noexcept override {
+        co_return data::action{.type = data::action::WRAP, .cmd = std::move(cmd)};
+    }
+
+    kota::task<> finish(data::process_result) noexcept override {
+        ++counters.finished;
+        co_return;
+    }
+
+    kota::task<> report_error(data::ipcid_t, std::string) noexcept override {
+        ++counters.errors;
+        co_return;
+    }
+
+    struct Factory {
+        Counters* counters;
+
+        std::unique_ptr<CountingService> operator() (data::ipcid_t id) const {
+            return std::make_unique<CountingService>(id, *counters);
         }
     };
 
 private:
     data::ipcid_t id;
+    Counters& counters;
 };
 
 namespace {
 
+struct SessionOutcome {
+    CountingService::Counters counters;
+    data::process_result result;
+
+    std::string line() const {
+        return std::format(R"(finished={} errors={} code={} stdout="{}")",
+                           counters.finished,
+                           counters.errors,
+                           result.code,
+                           log::escape(result.std_out));
+    }
+};
+
+std::vector<SessionOutcome> run_sessions(int count, const std::vector<std::string>& args) {
+    std::vector<Session> sessions(static_cast<size_t>(count));
+    std::vector<SessionOutcome> outcomes(static_cast<size_t>(count));
+    std::vector<kota::task<data::process_result>> tasks;
+    for(size_t index = 0; index < sessions.size(); ++index) {
+        Session::ProcessLaunchPlan launch_plan{
+            .executable = args.front(),
+            .args = args,
+            .mode = Session::StdioMode::capture,
+        };
+        tasks.push_back(sessions[index].run(Session::make_run_plan(
+            std::move(launch_plan),
+            CountingService::Factory{.counters = &outcomes[index].counters})));
+    }
+
+    kota::event_loop loop;
+    for(auto& task: tasks) {
+        loop.schedule(task);
+    }
+    loop.run();
+
+    for(size_t index = 0; index < tasks.size(); ++index) {
+        outcomes[index].result = tasks[index].result();
+    }
+    return outcomes;
+}
+
+int run_parallel(int count, const std::vector<std::string>& args) {
+    int code = 0;
+    const auto outcomes = run_sessions(count, args);
+    for(size_t index = 0; index < outcomes.size(); ++index) {
+        std::println("session={} {}", index, outcomes[index].line());
+        code = code == 0 ? static_cast<int>(outcomes[index].result.code) : code;
+    }
+    return code;
+}
+
+#ifndef CATTER_WINDOWS
+/// Runs one session in each of `count` forked processes at once, each reporting its outcome
+/// through a pipe so that the lines come out in order.
+int run_processes(int count, const std::vector<std::string>& args) {
+    struct Child {
+        pid_t pid;
+        int output;
+    };
+
+    std::vector<Child> children;
+    for(int index = 0; index < count; ++index) {
+        int fds[2];
+        if(::pipe(fds) != 0) {
+            throw std::system_error(errno, std::generic_category(), "pipe");
+        }
+        const pid_t pid = ::fork();
+        if(pid < 0) {
+            throw std::system_error(errno, std::generic_category(), "fork");
+        }
+        if(pid == 0) {
+            ::close(fds[0]);
+            std::string line;
+            try {
+                line = run_sessions(1, args).front().line();
+            } catch(const std::exception& ex) {
+                line = std::format(R"(harness=error message="{}")", log::escape(ex.what()));
+            }
+            (void)::write(fds[1], line.data(), line.size());
+            std::_Exit(0);
+        }
+        ::close(fds[1]);
+        children.push_back({pid, fds[0]});
+    }
+
+    for(size_t index = 0; index < children.size(); ++index) {
+        std::string line;
+        char buffer[256];
+        ssize_t n = 0;
+        while((n = ::read(children[index].output, buffer, sizeof(buffer))) > 0) {
+            line.append(buffer, static_cast<size_t>(n));
+        }
+        ::close(children[index].output);
+        ::waitpid(children[index].pid, nullptr, 0);
+        std::println("process={} {}", index, line);
+    }
+    return 0;
+}
+#endif
+
 int run_proxy(int argc, char* argv[]) {
+    // --exec-through: inject the command and let the proxy exec into it
+    // --capture-none: let the command inherit the stdio of the proxy
+    // --parallel <n>: run n sessions of the command at once on one event loop
+    // --processes <n>: run n sessions of the command at once in n processes
+    // --fake <path>: answer with a fake action creating <path>
+    ServiceImpl::Factory factory;
+    int parallel = 0;
+    int processes = 0;
+    for(; argc > 1 && std::string_view(argv[1]).starts_with("--"); --argc, ++argv) {
+        if(std::string_view(argv[1]) == "--exec-through") {
+            factory.through = true;
+        } else if(std::string_view(argv[1]) == "--capture-none") {
+            factory.capture.mode = data::CaptureMode::NONE;
+        } else if(std::string_view(argv[1]) == "--parallel" && argc > 2) {
+            parallel = std::stoi(argv[2]);
+            --argc;
+            ++argv;
+        } else if(std::string_view(argv[1]) == "--processes" && argc > 2) {
+            processes = std::stoi(argv[2]);
+            --argc;
+            ++argv;
+        } else if(std::string_view(argv[1]) == "--fake" && argc > 2) {
+            factory.fake_outputs.emplace_back(argv[2]);
+            --argc;
+            ++argv;
+        } else {
+            break;
+        }
+    }
+
     const std::string proxy_path = argv[1];
     std::vector<std::string> args;
     args.reserve(static_cast<size_t>(argc - 1));
@@ -105,13 +358,24 @@ int run_proxy(int argc, char* argv[]) {
         args.emplace_back(argv[index]);
     }
 
+    if(parallel > 0) {
+        return run_parallel(parallel, args);
+    }
+#ifndef CATTER_WINDOWS
+    if(processes > 0) {
+        return run_processes(processes, args);
+    }
+#endif
+
+    const auto fake_outputs = factory.fake_outputs;
     Session session;
     Session::ProcessLaunchPlan launch_plan{
         .executable = proxy_path,
         .args = std::move(args),
         .mode = Session::StdioMode::capture,
     };
-    auto task = session.run(Session::make_run_plan(std::move(launch_plan), ServiceImpl::Factory{}));
+    auto task = session.run(
+        Session::make_run_plan(std::move(launch_plan), std::move(factory)));
     kota::event_loop loop;
     loop.schedule(task);
     loop.run();
@@ -121,6 +385,12 @@ int run_proxy(int argc, char* argv[]) {
                  result.code,
                  log::escape(result.std_out),
                  log::escape(result.std_err));
+    for(const auto& output: fake_outputs) {
+        std::error_code ec;
+        std::println(R"(fake output="{}" size={})",
+                     log::escape(output),
+                     std::filesystem::file_size(output, ec));
+    }
     return static_cast<int>(result.code);
 }
 
@@ -63,6 +63,99 @@ TEST_CASE(preload_becomes_empty_when_only_hook_entry_exists) {
     auto cleaned_preload = find_entry(clean_envp, cfg::KEY_PRELOAD);
     EXPECT_TRUE(cleaned_preload == nullptr);
 };
+
+TEST_CASE(inherit_restores_session_entries) {
+    std::string hook_lib = "/opt/catter/";
+    hook_lib += cfg::RELATIVE_PATH_OF_HOOK_LIB;
+    ct::Session session{
+        .proxy_path = "/opt/catter/catter-proxy",
+        .self_id = "5",
+        .filter = ct::ExecFilter::parse("+*gcc*"),
+        .hook_library = hook_lib,
+    };
+
+    std::string command_id = std::string(cfg::KEY_CATTER_COMMAND_ID) + "=42";
+    std::string preload = std::string(cfg::KEY_PRELOAD) + "=/tmp/libkeep.so";
+    std::string lang = "LANG=C";
+
+    char* raw_env[] = {command_id.data(), preload.data(), lang.data(), nullptr};
+    auto inherited = ct::inherit_environment(raw_env, session);
+    auto envp = inherited.data();
+
+    EXPECT_TRUE(std::string_view(find_entry(envp, cfg::KEY_CATTER_COMMAND_ID)) ==
+                std::string(cfg::KEY_CATTER_COMMAND_ID) + "=5");
+    EXPECT_TRUE(std::string_view(find_entry(envp, cfg::KEY_CATTER_PROXY_PATH)) ==
+                std::string(cfg::KEY_CATTER_PROXY_PATH) + "=/opt/catter/catter-proxy");
+    EXPECT_TRUE(std::string_view(find_entry(envp, cfg::KEY_CATTER_EXEC_FILTER)) ==
+                std::string(cfg::KEY_CATTER_EXEC_FILTER) + "=+*gcc*");
+    EXPECT_TRUE(std::string_view(find_entry(envp, cfg::KEY_PRELOAD)) ==
+                preload + ":" + hook_lib);
+    EXPECT_TRUE(find_entry(envp, "LANG") != nullptr);
+};
+
+TEST_CASE(inherit_adds_preload_when_missing) {
+    std::string hook_lib = "/opt/catter/";
+    hook_lib += cfg::RELATIVE_PATH_OF_HOOK_LIB;
+    ct::Session session{.proxy_path = "/opt/catter/catter-proxy",
+                        .self_id = "5",
+                        .hook_library = hook_lib};
+
+    auto inherited = ct::inherit_environment(nullptr, session);
+    auto envp = inherited.data();
+
+    EXPECT_TRUE(std::string_view(find_entry(envp, cfg::KEY_PRELOAD)) ==
+                std::string(cfg::LD_PRELOAD_INIT_ENTRY) + hook_lib);
+    EXPECT_TRUE(find_entry(envp, cfg::KEY_CATTER_EXEC_FILTER) == nullptr);
+};
+
+TEST_CASE(proxy_environment_carries_session_endpoint) {
+    ct::Session session{
+        .proxy_path = "/opt/catter/catter-proxy",
+        .self_id = "5",
+        .endpoint = "/home/u/.catter/catter-ipc-1234-0badf00d.sock",
+    };
+
+    std::string stale = std::string(cfg::KEY_CATTER_IPC_ENDPOINT) + "=/tmp/stale.sock";
+    std::string lang = "LANG=C";
+
+    char* raw_env[] = {stale.data(), lang.data(), nullptr};
+    auto proxied = ct::proxy_environment(raw_env, session);
+    auto envp = proxied.data();
+
+    EXPECT_TRUE(std::string_view(find_entry(envp, cfg::KEY_CATTER_IPC_ENDPOINT)) ==
+                std::string(cfg::KEY_CATTER_IPC_ENDPOINT) + "=" + session.endpoint);
+    EXPECT_TRUE(find_entry(envp, cfg::KEY_CATTER_COMMAND_ID) == nullptr);
+    EXPECT_TRUE(find_entry(envp, "LANG") != nullptr);
+
+    auto scrubbed = ct::proxy_environment(nullptr, session);
+    EXPECT_TRUE(find_entry(scrubbed.data(), cfg::KEY_CATTER_IPC_ENDPOINT) != nullptr);
+};
+
+TEST_CASE(proxy_environment_carries_session_env_base) {
+    ct::Session session{
+        .proxy_path = "/opt/catter/catter-proxy",
+        .self_id = "5",
+        .env_base = "0123456789abcdef00c0ffee",
+    };
+
+    std::string stale = std::string(cfg::KEY_CATTER_ENV_BASE) + "=fedcba9876543210";
+    std::string lang = "LANG=C";
+
+    char* raw_env[] = {stale.data(), lang.data(), nullptr};
+    auto proxied = ct::proxy_environment(raw_env, session);
+    auto envp = proxied.data();
+
+    EXPECT_TRUE(std::string_view(find_entry(envp, cfg::KEY_CATTER_ENV_BASE)) ==
+                std::string(cfg::KEY_CATTER_ENV_BASE) + "=" + session.env_base);
+    EXPECT_TRUE(find_entry(envp, cfg::KEY_CATTER_IPC_ENDPOINT) == nullptr);
+
+    auto sanitized = ct::sanitize_environment(raw_env);
+    EXPECT_TRUE(find_entry(sanitized.data(), cfg::KEY_CATTER_ENV_BASE) == nullptr);
+
+    // Commands bypassing the proxy never see it.
+    auto inherited = ct::inherit_environment(raw_env, session);
+    EXPECT_TRUE(find_entry(inherited.data(), cfg::KEY_CATTER_ENV_BASE) == nullptr);
+};
 };  // TEST_SUITE(env_sanitizer)
 
 }  // namespace
@@ -0,0 +1,60 @@
+#include "exec_filter.h"
+
+#include <string>
+#include <kota/zest/zest.h>
+
+namespace ct = catter;
+
+namespace {
+
+TEST_SUITE(exec_filter) {
+
+TEST_CASE(empty_filter_intercepts_everything) {
+    auto filter = ct::ExecFilter::parse("");
+
+    EXPECT_TRUE(filter.allow.empty());
+    EXPECT_TRUE(filter.deny.empty());
+    EXPECT_TRUE(filter.intercepts("/bin/sh"));
+    EXPECT_TRUE(filter.intercepts("gcc"));
+};
+
+TEST_CASE(parses_allow_and_deny_entries) {
+    auto filter = ct::ExecFilter::parse("+*gcc*:+cc:-cc1*");
+
+    EXPECT_TRUE(filter.spec == "+*gcc*:+cc:-cc1*");
+    EXPECT_TRUE(filter.allow.size() == 2);
+    EXPECT_TRUE(filter.allow.at(0) == "*gcc*");
+    EXPECT_TRUE(filter.allow.at(1) == "cc");
+    EXPECT_TRUE(filter.deny.size() == 1);
+    EXPECT_TRUE(filter.deny.at(0) == "cc1*");
+};
+
+TEST_CASE(ignores_malformed_entries) {
+    auto filter = ct::ExecFilter::parse("+:gcc::-ld");
+
+    EXPECT_TRUE(filter.allow.empty());
+    EXPECT_TRUE(filter.deny.size() == 1);
+    EXPECT_TRUE(filter.deny.at(0) == "ld");
+};
+
+TEST_CASE(allow_list_matches_executable_basename) {
+    auto filter = ct::ExecFilter::parse("+*gcc*:+clang*");
+
+    EXPECT_TRUE(filter.intercepts("/usr/bin/x86_64-linux-gnu-gcc-12"));
+    EXPECT_TRUE(filter.intercepts("/opt/llvm/bin/clang++"));
+    EXPECT_TRUE(filter.intercepts("gcc"));
+    EXPECT_FALSE(filter.intercepts("/bin/sh"));
+    EXPECT_FALSE(filter.intercepts("/usr/lib/gcc/bin/sed"));
+};
+
+TEST_CASE(deny_list_wins_over_allow_list) {
+    auto filter = ct::ExecFilter::parse("+*:-sh:-mkdir");
+
+    EXPECT_TRUE(filter.intercepts("/usr/bin/cc"));
+    EXPECT_FALSE(filter.intercepts("/bin/sh"));
+    EXPECT_FALSE(filter.intercepts("mkdir"));
+};
+
+};  // TEST_SUITE(exec_filter)
+
+}  // namespace
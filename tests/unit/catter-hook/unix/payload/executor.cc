@@ -274,6 +274,74 @@ TEST_CASE(spawn_boundary_returns_error_code) {
     EXPECT_TRUE(spawn_call.calls == 0);
 }
 
+TEST_CASE(execve_bypasses_proxy_for_filtered_executable) {
+    exec_call.reset(23);
+
+    auto executable = create_executable("sed");
+    MutableCStrings argv = {"sed", "-e", "s/a/b/"};
+    MutableCStrings envp = {"LANG=C"};
+
+    auto session = valid_session;
+    session.filter = ct::ExecFilter::parse("+*gcc*:+cc");
+
+    ct::Executor executor;
+    executor.init(session, fake_execve, fake_posix_spawn);
+
+    auto result = executor.execve(executable.c_str(), argv.data(), envp.data());
+
+    EXPECT_TRUE(result == 23);
+    EXPECT_TRUE(exec_call.calls == 1);
+    EXPECT_TRUE(exec_call.path == executable.string());
+    EXPECT_TRUE(exec_call.argv.size() == 3);
+    EXPECT_TRUE(exec_call.argv.at(0) == "sed");
+    EXPECT_TRUE(has_env_entry(exec_call.envp, cfg::KEY_CATTER_COMMAND_ID));
+    EXPECT_TRUE(has_env_entry(exec_call.envp, cfg::KEY_CATTER_PROXY_PATH));
+    EXPECT_TRUE(has_env_entry(exec_call.envp, cfg::KEY_CATTER_EXEC_FILTER));
+    EXPECT_TRUE(has_env_entry(exec_call.envp, "LANG"));
+}
+
+TEST_CASE(execve_keeps_proxy_for_allowed_executable) {
+    exec_call.reset(24);
+
+    auto executable = create_executable("x86_64-linux-gnu-gcc");
+    MutableCStrings argv = {"gcc", "-c", "main.c"};
+
+    auto session = valid_session;
+    session.filter = ct::ExecFilter::parse("+*gcc*:+cc");
+
+    ct::Executor executor;
+    executor.init(session, fake_execve, fake_posix_spawn);
+
+    auto result = executor.execve(executable.c_str(), argv.data(), nullptr);
+
+    EXPECT_TRUE(result == 24);
+    expect_proxy_command(exec_call, session, executable, "gcc");
+    EXPECT_TRUE(!has_env_entry(exec_call.envp, cfg::KEY_CATTER_EXEC_FILTER));
+}
+
+TEST_CASE(posix_spawn_bypasses_proxy_for_denied_executable) {
+    spawn_call.reset(31);
+
+    auto executable = create_executable("mkdir");
+    MutableCStrings argv = {"mkdir", "-p", "out"};
+
+    auto session = valid_session;
+    session.filter = ct::ExecFilter::parse("-mkdir");
+
+    ct::Executor executor;
+    executor.init(session, fake_execve, fake_posix_spawn);
+
+    pid_t pid = 0;
+    auto result =
+        executor.posix_spawn(&pid, executable.c_str(), nullptr, nullptr, argv.data(), nullptr);
+
+    EXPECT_TRUE(result == 31);
+    EXPECT_TRUE(spawn_call.calls == 1);
+    EXPECT_TRUE(spawn_call.path == executable.string());
+    EXPECT_TRUE(spawn_call.argv.at(0) == "mkdir");
+    EXPECT_TRUE(has_env_entry(spawn_call.envp, cfg::KEY_CATTER_COMMAND_ID));
+}
+
 };  // TEST_SUITE(executor)
 
 }  // namespace
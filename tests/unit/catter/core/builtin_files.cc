@@ -36,6 +36,10 @@ TEST_CASE(builtin_script_lookup_returns_embedded_sources) {
     EXPECT_TRUE(!target_tree.empty());
     EXPECT_TRUE(target_tree.find("target-tree") != std::string_view::npos);
 
+    const auto timeline = catter::js::load_builtin_script("script::timeline");
+    EXPECT_TRUE(!timeline.empty());
+    EXPECT_TRUE(timeline.find("timeline") != std::string_view::npos);
+
     EXPECT_TRUE(catter::js::load_builtin_script("script::does-not-exist").empty());
 }
 
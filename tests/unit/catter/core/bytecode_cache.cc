@@ -0,0 +1,170 @@
+#include "js/bytecode_cache.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+
+#include "js/esm_loader.h"
+#include "js/qjs.h"
+
+namespace fs = std::filesystem;
+using namespace catter;
+
+namespace {
+
+struct Fixture {
+    Fixture() {
+        static std::atomic_uint64_t serial{0};
+        root = fs::temp_directory_path() /
+               ("catter_bytecode_cache_" + std::to_string(serial.fetch_add(1)));
+        fs::create_directories(root / "src");
+    }
+
+    ~Fixture() {
+        std::error_code ec;
+        fs::remove_all(root, ec);
+    }
+
+    void write(const fs::path& path, std::string_view source) {
+        std::ofstream output(path, std::ios::binary);
+        output << source;
+    }
+
+    size_t entries() const {
+        size_t count = 0;
+        for(const auto& entry: fs::directory_iterator(root / "cache")) {
+            count += entry.path().extension() == ".qjsbc" ? 1 : 0;
+        }
+        return count;
+    }
+
+    fs::path root;
+};
+
+}  // namespace
+
+TEST_SUITE(bytecode_cache_tests) {
+
+TEST_CASE(same_source_and_name_hit_after_first_compile) {
+    Fixture fixture;
+    auto rt = qjs::Runtime::create();
+    auto ctx = rt.context();
+
+    js::BytecodeCache cache{fixture.root / "cache"};
+    const auto first = cache.module_bytecode(ctx, "export const value = 42;", "/a.js");
+    EXPECT_EQ(cache.stats().misses, 1U);
+    EXPECT_EQ(cache.stats().hits, 0U);
+
+    // A new instance stands for the next catter run.
+    js::BytecodeCache next_run{fixture.root / "cache"};
+    const auto second = next_run.module_bytecode(ctx, "export const value = 42;", "/a.js");
+    EXPECT_EQ(next_run.stats().hits, 1U);
+    EXPECT_EQ(next_run.stats().misses, 0U);
+    EXPECT_TRUE(first == second);
+    EXPECT_TRUE(ctx.load_module_bytecode(second).module_def() != nullptr);
+    EXPECT_EQ(fixture.entries(), 1U);
+}
+
+TEST_CASE(edited_source_other_name_and_broken_entry_miss) {
+    Fixture fixture;
+    auto rt = qjs::Runtime::create();
+    auto ctx = rt.context();
+
+    js::BytecodeCache cache{fixture.root / "cache"};
+    (void)cache.module_bytecode(ctx, "export const value = 42;", "/a.js");
+    (void)cache.module_bytecode(ctx, "export const value = 43;", "/a.js");
+    (void)cache.module_bytecode(ctx, "export const value = 42;", "/b.js");
+    EXPECT_EQ(cache.stats().misses, 3U);
+    EXPECT_EQ(fixture.entries(), 3U);
+
+    for(const auto& entry: fs::directory_iterator(fixture.root / "cache")) {
+        fs::resize_file(entry.path(), fs::file_size(entry.path()) - 1);
+    }
+    const auto bytecode = cache.module_bytecode(ctx, "export const value = 42;", "/a.js");
+    EXPECT_EQ(cache.stats().misses, 4U);
+    EXPECT_TRUE(ctx.load_module_bytecode(bytecode).module_def() != nullptr);
+
+    (void)cache.module_bytecode(ctx, "export const value = 42;", "/a.js");
+    EXPECT_EQ(cache.stats().hits, 1U);
+}
+
+TEST_CASE(compile_errors_are_not_cached) {
+    Fixture fixture;
+    auto rt = qjs::Runtime::create();
+    auto ctx = rt.context();
+
+    js::BytecodeCache cache{fixture.root / "cache"};
+    bool threw = false;
+    try {
+        (void)cache.module_bytecode(ctx, "export const = ;", "/broken.js");
+    } catch(const qjs::Exception&) {
+        threw = true;
+    }
+    EXPECT_TRUE(threw);
+    EXPECT_TRUE(!fs::exists(fixture.root / "cache"));
+}
+
+TEST_CASE(esm_loader_reads_imported_files_through_the_cache) {
+    Fixture fixture;
+    const auto dep = (fixture.root / "src" / "dep.js").string();
+    fixture.write(dep, "export const value = 42;");
+
+    js::BytecodeCache cache{fixture.root / "cache"};
+    js::EsmModuleLoader loader{&cache};
+    for(int run = 0; run < 2; ++run) {
+        auto rt = qjs::Runtime::create();
+        auto ctx = rt.context();
+        auto module = loader.loader(ctx, dep.c_str());
+        EXPECT_TRUE(module.module_def() != nullptr);
+        EXPECT_TRUE(module.module_name().to_string() == dep);
+    }
+    EXPECT_EQ(cache.stats().misses, 1U);
+    EXPECT_EQ(cache.stats().hits, 1U);
+}
+
+TEST_CASE(prune_drops_old_entries_then_the_least_recently_used) {
+    Fixture fixture;
+    auto rt = qjs::Runtime::create();
+    auto ctx = rt.context();
+
+    js::BytecodeCache cache{fixture.root / "cache"};
+    (void)cache.module_bytecode(ctx, "export const value = 1;", "/old.js");
+    (void)cache.module_bytecode(ctx, "export const value = 2;", "/a.js");
+    (void)cache.module_bytecode(ctx, "export const value = 3;", "/b.js");
+    fs::create_directories(fixture.root / "cache" / "compiler");
+    fixture.write(fixture.root / "cache" / "compiler" / "stale.probe", "stale");
+
+    const auto now = fs::file_time_type::clock::now();
+    for(const auto& entry: fs::recursive_directory_iterator(fixture.root / "cache")) {
+        if(entry.is_regular_file()) {
+            fs::last_write_time(entry.path(), now - std::chrono::hours(1));
+        }
+    }
+    fs::last_write_time(fixture.root / "cache" / "compiler" / "stale.probe",
+                        now - std::chrono::hours(24 * 60));
+    // A hit marks the entry as used, so "/old.js" is the least recently used entry now.
+    (void)cache.module_bytecode(ctx, "export const value = 2;", "/a.js");
+    (void)cache.module_bytecode(ctx, "export const value = 3;", "/b.js");
+
+    EXPECT_EQ(cache.prune(), 1U);
+    EXPECT_TRUE(!fs::exists(fixture.root / "cache" / "compiler" / "stale.probe"));
+    EXPECT_EQ(fixture.entries(), 3U);
+
+    uint64_t used = 0;
+    for(const auto& entry: fs::directory_iterator(fixture.root / "cache")) {
+        used += entry.is_regular_file() ? entry.file_size() : 0;
+    }
+    js::BytecodeCache small{fixture.root / "cache", used - 1};
+    EXPECT_EQ(small.prune(), 1U);
+    EXPECT_EQ(fixture.entries(), 2U);
+    EXPECT_EQ(small.module_bytecode(ctx, "export const value = 2;", "/a.js").empty(), false);
+    EXPECT_EQ(small.module_bytecode(ctx, "export const value = 3;", "/b.js").empty(), false);
+    EXPECT_EQ(small.stats().hits, 2U);
+}
+
+};  // TEST_SUITE(bytecode_cache_tests)
@@ -0,0 +1,92 @@
+#include "env_table.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+
+#include "util/env_delta.h"
+
+using namespace catter;
+
+namespace {
+
+ipc::EnvTable::Env make_env(std::vector<std::string> env) {
+    return std::make_shared<const std::vector<std::string>>(std::move(env));
+}
+
+}  // namespace
+
+TEST_SUITE(env_table) {
+TEST_CASE(resolves_deltas_against_interned_bases) {
+    ipc::EnvTable table;
+    auto parent = make_env({"PATH=/usr/bin", "HOME=/root"});
+    table.intern(util::env_hash(*parent), parent);
+
+    auto base = util::decode_env_base(util::encode_env_base(*parent));
+    ASSERT_TRUE(base.has_value());
+
+    // The same environment resolves to the interned one itself.
+    auto same = table.resolve(util::make_env_delta(*base, *parent));
+    EXPECT_TRUE(same == parent);
+
+    const std::vector<std::string> child = {"PATH=/usr/bin", "HOME=/root", "MAKELEVEL=1"};
+    auto resolved = table.resolve(util::make_env_delta(*base, child));
+    ASSERT_TRUE(resolved != nullptr);
+    EXPECT_TRUE(*resolved == child);
+    EXPECT_EQ(table.size(), 2U);
+    EXPECT_TRUE(table.find(util::env_hash(child)) == resolved);
+};
+
+TEST_CASE(unknown_bases_are_not_resolved) {
+    ipc::EnvTable table;
+    const std::vector<std::string> parent = {"PATH=/usr/bin"};
+    auto base = util::decode_env_base(util::encode_env_base(parent));
+    ASSERT_TRUE(base.has_value());
+    const std::vector<std::string> child = {"PATH=/usr/bin", "LANG=C"};
+    EXPECT_TRUE(table.resolve(util::make_env_delta(*base, child)) == nullptr);
+};
+
+TEST_CASE(keeps_the_order_of_resolved_environments) {
+    ipc::EnvTable table;
+    auto parent = make_env({"PATH=/usr/bin", "HOME=/root", "LANG=C"});
+    table.intern(util::env_hash(*parent), parent);
+    auto base = util::decode_env_base(util::encode_env_base(*parent));
+    ASSERT_TRUE(base.has_value());
+
+    // Same entries in another order resolve to their own order.
+    const std::vector<std::string> reordered = {"LANG=C", "PATH=/usr/bin", "HOME=/root"};
+    auto resolved = table.resolve(util::make_env_delta(*base, reordered));
+    ASSERT_TRUE(resolved != nullptr);
+    EXPECT_TRUE(*resolved == reordered);
+
+    // A base with the interned entries in another order is not the interned one.
+    auto other = util::decode_env_base(util::encode_env_base(reordered));
+    ASSERT_TRUE(other.has_value());
+    EXPECT_TRUE(table.find(other->hash) == resolved);
+    ipc::EnvTable fresh;
+    fresh.intern(util::env_hash(*parent), parent);
+    EXPECT_TRUE(fresh.resolve(util::make_env_delta(*other, *parent)) == nullptr);
+};
+
+TEST_CASE(evicts_the_least_recently_used_environment) {
+    ipc::EnvTable table;
+    std::vector<uint64_t> hashes;
+    for(size_t i = 0; i < ipc::EnvTable::max_envs; ++i) {
+        auto env = make_env({"N=" + std::to_string(i)});
+        hashes.push_back(util::env_hash(*env));
+        table.intern(hashes.back(), env);
+    }
+
+    // Using the oldest keeps it, the one interned after it goes instead.
+    EXPECT_TRUE(table.find(hashes[0]) != nullptr);
+    auto extra = make_env({"N=extra"});
+    table.intern(util::env_hash(*extra), extra);
+    EXPECT_EQ(table.size(), ipc::EnvTable::max_envs);
+    EXPECT_TRUE(table.find(hashes[0]) != nullptr);
+    EXPECT_TRUE(table.find(hashes[1]) == nullptr);
+    EXPECT_TRUE(table.find(util::env_hash(*extra)) != nullptr);
+};
+};  // TEST_SUITE(env_table)
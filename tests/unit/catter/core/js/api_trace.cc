@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <string>
+#include <string_view>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+#include <kota/async/io/loop.h>
+
+#include "js_case.h"
+#include "js/apitool.h"
+#include "js/js.h"
+
+namespace {
+
+/// Calls `os_name` `calls` times.
+std::string count_script(uint32_t calls) {
+    return std::format(R"(
+import {{ os_name }} from "catter/native";
+for (let i = 0; i < {}; ++i) {{
+    os_name();
+}}
+)",
+                       calls);
+}
+
+kota::task<> run_counted_script(uint32_t sampling, uint32_t calls) {
+    catter::js::RuntimeScope runtime;
+
+    std::exception_ptr error;
+    try {
+        runtime.start({
+            .pwd = catter::tests::js::js_test_root(),
+            .api_trace_sampling = sampling,
+        });
+        co_await catter::js::run_script(count_script(calls), "api-trace.js");
+    } catch(...) {
+        error = std::current_exception();
+    }
+
+    co_await runtime.stop();
+
+    if(error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/// The counter of `name` as the last session left it, zero when it was never called.
+catter::apitool::ApiCounter counter_of(std::string_view name) {
+    auto& counters = catter::apitool::api_counters();
+    auto it = std::ranges::find_if(counters, [&](const auto* counter) {
+        return counter->name.ends_with(name);
+    });
+    return it == counters.end() ? catter::apitool::ApiCounter{.name = name} : **it;
+}
+
+void run(uint32_t sampling, uint32_t calls) {
+    auto task = run_counted_script(sampling, calls);
+    kota::event_loop loop;
+    loop.schedule(task);
+    loop.run();
+    task.result();
+}
+
+}  // namespace
+
+TEST_SUITE(api_trace_tests) {
+TEST_CASE(counts_every_call_and_times_a_sample) {
+    using catter::apitool::api_timing_every;
+
+    run(0, 2 * api_timing_every + 3);
+    auto counter = counter_of("os_name");
+    EXPECT_EQ(counter.calls, 2 * api_timing_every + 3);
+    EXPECT_EQ(counter.timed, 2U);
+
+    // Each session starts from zero, whatever ran before.
+    run(0, 5);
+    counter = counter_of("os_name");
+    EXPECT_EQ(counter.calls, 5U);
+    EXPECT_EQ(counter.timed, 0U);
+    EXPECT_EQ(counter.elapsed.count(), 0);
+};
+
+TEST_CASE(traced_calls_are_counted_but_not_timed) {
+    run(1, 20);
+    auto counter = counter_of("os_name");
+    EXPECT_EQ(counter.calls, 20U);
+    EXPECT_EQ(counter.timed, 0U);
+    EXPECT_TRUE(!catter::apitool::format_api_counters().empty());
+
+    catter::apitool::reset_api_counters();
+    EXPECT_EQ(counter_of("os_name").calls, 0U);
+    EXPECT_TRUE(catter::apitool::format_api_counters().empty());
+};
+};  // TEST_SUITE(api_trace_tests)
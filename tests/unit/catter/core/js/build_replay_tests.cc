@@ -1,4 +1,5 @@
 #include <atomic>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iterator>
@@ -18,6 +19,7 @@ using catter::core::ReplayConfig;
 using catter::core::ReplayEvent;
 using catter::core::ReplayFile;
 using catter::core::ReplayRunner;
+using catter::core::ReplayStream;
 
 namespace {
 
@@ -101,6 +103,7 @@ void write_existing_database(const fs::path& path, const fs::path& root) {
            << "]\n";
 }
 
+
 }  // namespace
 
 TEST_SUITE(build_replay_tests) {
@@ -135,6 +138,30 @@ TEST_CASE(cdb_generates_compile_database) {
     EXPECT_TRUE(content.find("main.o") != std::string::npos);
 }
 
+TEST_CASE(cdb_fakes_compile_commands_when_asked) {
+    TempFileManager cleanup(make_root());
+    const auto root = cleanup.root;
+    const auto save_path = root / "compile_commands.json";
+
+    // The replay runtime supports the fake action, so `--fake` is accepted and the database is
+    // the same as for a real build.
+    ReplayRunner replay;
+    replay.run(cdb_config(root, {"--output", save_path.string(), "--fake", "--quiet"}),
+               {
+                   .version = 1,
+                   .events =
+                       {
+                           command(1, "make", {"make"}, root),
+                           compile_command(2, root, "src/main.cc", "obj/main.o", 1),
+                       },
+                   .finish = js::ProcessResult{.code = 0},
+               });
+
+    const auto content = read_file(save_path);
+    EXPECT_EQ(count_occurrences(content, "\"file\":"), 1);
+    EXPECT_TRUE(content.find("\"file\": \"src/main.cc\"") != std::string::npos);
+}
+
 TEST_CASE(cdb_does_not_save_on_failure_by_default) {
     TempFileManager cleanup(make_root());
     const auto root = cleanup.root;
@@ -234,4 +261,125 @@ TEST_CASE(cdb_aborts_on_command_failure_and_saves_partial_database) {
     EXPECT_TRUE(content.find("src/broken.cc") != std::string_view::npos);
 }
 
+TEST_CASE(ndjson_replay_matches_document_replay) {
+    TempFileManager cleanup(make_root());
+    const auto root = cleanup.root;
+    const auto replay_path = root / "build.ndjson";
+    const auto save_path = root / "compile_commands.json";
+
+    auto directory = root.string();
+    std::replace(directory.begin(), directory.end(), '\\', '/');
+    {
+        std::ofstream output(replay_path, std::ios::binary);
+        output << R"({"version": 2, "build_system_command": ["make"]})" << "\n"
+               << R"({"type": "command", "id": 1, "exe": "make", "argv": ["make"]})" << "\n"
+               << R"({"type": "command", "id": 2, "parent": 1, "cwd": ")" << directory
+               << R"(", "exe": "clang++", "argv": ["clang++", "-c", "src/main.cc", "-o", )"
+               << R"("obj/main.o"], "execution": {"code": 0, "stdout": "", "stderr": ""}})"
+               << "\r\n\n"
+               << R"({"type": "finish", "code": 0, "stdout": "", "stderr": ""})" << "\n";
+    }
+
+    const auto parsed = core::parse_replay_file(replay_path);
+    EXPECT_TRUE(parsed.version == 2);
+    EXPECT_EQ(parsed.events.size(), 2);
+    EXPECT_TRUE(parsed.finish.has_value());
+
+    ReplayStream stream(replay_path);
+    ReplayRunner replay;
+    replay.run(cdb_config(root, {"--output", save_path.string(), "--quiet"}), stream);
+
+    const auto content = read_file(save_path);
+    EXPECT_EQ(count_occurrences(content, "\"file\":"), 1);
+    EXPECT_TRUE(content.find("src/main.cc") != std::string::npos);
+}
+
+TEST_CASE(first_line_selects_the_replay_format) {
+    TempFileManager cleanup(make_root());
+    const auto root = cleanup.root;
+    const auto single_line = root / "single.json";
+    const auto future = root / "future.ndjson";
+    {
+        std::ofstream(single_line, std::ios::binary)
+            << R"({"version": 1, "events": [{"id": 1, "exe": "make", "argv": ["make"]}]})";
+        std::ofstream(future, std::ios::binary)
+            << R"({"version": 3, "build_system_command": ["make"]})" << "\n"
+            << R"({"type": "command", "id": 1, "exe": "make", "argv": ["make"]})" << "\n";
+    }
+
+    ReplayStream stream(single_line);
+    EXPECT_TRUE(stream.metadata().version == 1);
+    auto event = stream.next();
+    EXPECT_TRUE(event.has_value() && event->exe == "make");
+    EXPECT_TRUE(!stream.next().has_value());
+
+    bool rejected = false;
+    try {
+        ReplayStream unsupported(future);
+    } catch(const std::exception& error) {
+        rejected = std::string_view(error.what()).find("Unsupported replay file version: 3") !=
+                   std::string_view::npos;
+    }
+    EXPECT_TRUE(rejected);
+}
+
+TEST_CASE(recorded_lines_replay_in_recorded_order) {
+    TempFileManager cleanup(make_root());
+    const auto root = cleanup.root;
+    const auto replay_path = root / "recorded.ndjson";
+    const auto save_path = root / "compile_commands.json";
+
+    auto make = command(1, "make", {"make"}, root);
+    make.type = "command";
+    make.env = std::vector<std::string>{"PATH=/usr/bin", "QUOTED=\"a\\b\"\n\x01"};
+    auto compile = compile_command(2, root, "src/main.cc", "obj/main.o", 1);
+    {
+        std::ofstream output(replay_path, std::ios::binary);
+        output << core::to_replay_line(core::ReplayHeader{
+                      .version = 2,
+                      .cwd = root.string(),
+                      .build_system_command = std::vector<std::string>{"make"},
+                  })
+               << "\n"
+               << core::to_replay_line(make) << "\n"
+               << core::to_replay_line(compile) << "\n"
+               << core::to_replay_line(ReplayEvent{
+                      .type = "command",
+                      .id = 3,
+                      .error = core::ReplayError{.message = "spawn failed", .parent = 1},
+                  })
+               << "\n"
+               << core::to_replay_line(ReplayEvent{
+                      .type = "execution",
+                      .id = 2,
+                      .execution = js::ProcessResult{.code = 0, .stdOut = "ok\tdone"},
+                  })
+               << "\n"
+               << core::to_replay_finish_line(js::ProcessResult{.code = 0}) << "\n";
+    }
+
+    ReplayStream stream(replay_path);
+    EXPECT_TRUE(stream.metadata().cwd == root.string());
+    auto first = stream.next();
+    EXPECT_TRUE(first.has_value() && first->env == make.env && first->argv == make.argv);
+    auto second = stream.next();
+    EXPECT_TRUE(second.has_value() && second->parent == 1 && second->argv == compile.argv);
+    auto failed = stream.next();
+    EXPECT_TRUE(failed.has_value() && failed->error.has_value());
+    EXPECT_TRUE(failed->error->message == "spawn failed" && failed->error->parent == 1);
+    auto executed = stream.next();
+    EXPECT_TRUE(executed.has_value() && executed->type == "execution" && executed->id == 2);
+    EXPECT_TRUE(executed->execution.has_value() && executed->execution->stdOut == "ok\tdone");
+    EXPECT_TRUE(!stream.next().has_value());
+    EXPECT_TRUE(stream.metadata().finish.has_value());
+
+    ReplayStream replay_stream(replay_path);
+    ReplayRunner replay;
+    replay.run(cdb_config(root, {"--output", save_path.string(), "--quiet"}), replay_stream);
+
+    const auto content = read_file(save_path);
+    EXPECT_EQ(count_occurrences(content, "\"file\":"), 1);
+    EXPECT_TRUE(content.find("src/main.cc") != std::string::npos);
+}
+
 };  // TEST_SUITE(build_replay_tests)
@@ -0,0 +1,136 @@
+#include "js/command_object.h"
+
+#include <string>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+
+#include "js/qjs.h"
+
+using namespace catter;
+using namespace catter::js;
+
+namespace {
+
+CommandData sample_command() {
+    return CommandData{
+        .cwd = "/src/project",
+        .exe = "/usr/bin/clang++",
+        .argv = {"clang++", "-c", "main.cc", "-o", "main.o"},
+        .env = {"PATH=/usr/bin", "CC=clang", "LANG=C.UTF-8"},
+        .runtime = {.supportActions = {ActionType::skip, ActionType::modify},
+                    .type = CatterRuntime::Type::inject,
+                    .supportParentId = true},
+        .parent = 7,
+    };
+}
+
+std::string eval_string(qjs::Context& ctx, const char* script) {
+    return ctx.eval_script(script, "command_object_test.js").as<std::string>();
+}
+
+}  // namespace
+
+TEST_SUITE(command_object_tests) {
+
+TEST_CASE(reads_like_a_plain_object) {
+    auto rt = qjs::Runtime::create();
+    auto ctx = rt.context();
+    const auto command = sample_command();
+    ctx.global_this().set_property("data", make_command_object(ctx.js_context(), command));
+    ctx.global_this().set_property("plain", command.to_object(ctx.js_context()));
+
+    EXPECT_EQ(eval_string(ctx, "data.argv.join(' ')"), "clang++ -c main.cc -o main.o");
+    EXPECT_EQ(eval_string(ctx, "Object.keys(data).join()"), "cwd,exe,argv,env,runtime,parent");
+    EXPECT_EQ(eval_string(ctx, "String('env' in data && data.hasOwnProperty('cwd'))"), "true");
+    EXPECT_EQ(eval_string(ctx, "JSON.stringify(data) === JSON.stringify(plain) ? 'same' : ''"),
+              "same");
+    EXPECT_EQ(eval_string(ctx, "JSON.stringify({...data}) === JSON.stringify(plain) ? 'same' : ''"),
+              "same");
+    // Converted once, later reads see the same array.
+    EXPECT_EQ(eval_string(ctx, "String(data.env === data.env)"), "true");
+}
+
+TEST_CASE(fields_resolve_in_every_runtime) {
+    // Field names are interned per runtime, each of them must match its own atoms.
+    auto first_rt = qjs::Runtime::create();
+    auto first = first_rt.context();
+    first.global_this().set_property("data",
+                                     make_command_object(first.js_context(), sample_command()));
+    {
+        auto second_rt = qjs::Runtime::create();
+        auto second = second_rt.context();
+        second.eval_script("globalThis.unrelated = { cwd: 1, argv: 2 };", "warmup.js");
+        second.global_this().set_property(
+            "data",
+            make_command_object(second.js_context(), sample_command()));
+        EXPECT_EQ(eval_string(second, "data['ar' + 'gv'][0] + ' ' + data.cwd"),
+                  "clang++ /src/project");
+    }
+    EXPECT_EQ(eval_string(first, "data.extra = 'x'; data.exe + ' ' + data.extra"),
+              "/usr/bin/clang++ x");
+    EXPECT_EQ(eval_string(first, "Object.keys(data).join()"),
+              "cwd,exe,argv,env,runtime,parent,extra");
+}
+
+TEST_CASE(missing_parent_is_not_an_own_property) {
+    auto rt = qjs::Runtime::create();
+    auto ctx = rt.context();
+    auto command = sample_command();
+    command.parent.reset();
+    ctx.global_this().set_property("data", make_command_object(ctx.js_context(), command));
+
+    EXPECT_EQ(eval_string(ctx, "Object.keys(data).join()"), "cwd,exe,argv,env,runtime");
+    EXPECT_EQ(eval_string(ctx, "String(data.parent)"), "undefined");
+}
+
+TEST_CASE(make_reads_back_untouched_and_changed_fields) {
+    auto rt = qjs::Runtime::create();
+    auto ctx = rt.context();
+    const auto command = sample_command();
+
+    auto untouched = make_command_object(ctx.js_context(), command);
+    EXPECT_TRUE(CommandData::make(untouched) == command);
+
+    ctx.global_this().set_property("data", make_command_object(ctx.js_context(), command));
+    auto changed = ctx.eval_script(R"(
+        data.argv = [...data.argv, "-DCATTER"];
+        data.cwd = "/tmp";
+        data.note = "kept on the side";
+        delete data.parent;
+        data;
+    )",
+                                   "command_object_test.js")
+                       .as<qjs::Object>();
+
+    auto expected = command;
+    expected.argv.push_back("-DCATTER");
+    expected.cwd = "/tmp";
+    expected.parent.reset();
+    EXPECT_TRUE(CommandData::make(changed) == expected);
+    EXPECT_EQ(eval_string(ctx, "Object.keys(data).join()"), "cwd,exe,argv,env,runtime,note");
+}
+
+TEST_CASE(modify_action_reads_nested_command_object) {
+    auto rt = qjs::Runtime::create();
+    auto ctx = rt.context();
+    const auto command = sample_command();
+    ctx.global_this().set_property("data", make_command_object(ctx.js_context(), command));
+
+    auto object = ctx.eval_script(R"(
+        data.env = data.env.filter((entry) => !entry.startsWith("LANG="));
+        ({ type: "modify", data });
+    )",
+                                  "command_object_test.js")
+                      .as<qjs::Object>();
+
+    auto action = Action::make(object);
+    auto* modify = action.get_if<ActionType::modify>();
+    EXPECT_TRUE(modify != nullptr);
+    if(modify != nullptr) {
+        auto expected = command;
+        expected.env.pop_back();
+        EXPECT_TRUE(modify->data == expected);
+    }
+}
+
+};  // TEST_SUITE(command_object_tests)
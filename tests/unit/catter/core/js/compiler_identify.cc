@@ -0,0 +1,55 @@
+#include "js/compiler_identify.h"
+
+#include <string>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+
+using namespace catter;
+using namespace catter::js;
+
+TEST_SUITE(compiler_identify_tests) {
+TEST_CASE(builtin_rules) {
+    auto cross = identify_builtin_compiler("/usr/bin/x86_64-linux-gnu-gcc-13");
+    EXPECT_EQ(cross.kind, "gcc");
+    EXPECT_EQ(cross.dialect, "gcc");
+    EXPECT_EQ(cross.targetPrefix.value_or(""), "x86_64-linux-gnu");
+
+    auto clang_cl = identify_builtin_compiler("x86_64-pc-windows-msvc-clang-cl.exe");
+    EXPECT_EQ(clang_cl.kind, "clang-cl");
+    EXPECT_EQ(clang_cl.dialect, "msvc");
+    EXPECT_EQ(clang_cl.targetPrefix.value_or(""), "x86_64-pc-windows-msvc");
+
+    auto versioned = identify_builtin_compiler("clang-cl_20.1");
+    EXPECT_EQ(versioned.kind, "clang-cl");
+    EXPECT_FALSE(versioned.targetPrefix.has_value());
+
+    auto msvc = identify_builtin_compiler(R"(C:\Program Files\MSVC\bin\Hostx64\x64\cl.exe)");
+    EXPECT_EQ(msvc.kind, "msvc");
+
+    auto nvcc = identify_builtin_compiler("/usr/local/cuda/bin/x86_64-nvcc-12.6");
+    EXPECT_EQ(nvcc.kind, "nvcc");
+    EXPECT_FALSE(nvcc.targetPrefix.has_value());
+
+    for(auto unknown: {"cc1plus", "-gcc", "clang-cl.exe.bak", "cl-wrapper.exe", "gfortran",
+                       "distcc", "/usr/bin/collect2-wrapper", "g++-", "gcc-x1"}) {
+        EXPECT_EQ(identify_builtin_compiler(unknown).kind, "unknown");
+    }
+};
+
+TEST_CASE(memo_and_argv0_fallback) {
+    CompilerIdentifyCache cache;
+    EXPECT_EQ(cache.identify("/usr/bin/clang++-20", "clang++").kind, "clang");
+    EXPECT_EQ(cache.identify("/usr/bin/clang++-20", "clang++").kind, "clang");
+    EXPECT_EQ(cache.hits(), 1U);
+
+    auto shim = cache.identify("/opt/wrappers/compile-shim", "aarch64-linux-gnu-g++");
+    EXPECT_EQ(shim.kind, "gcc");
+    EXPECT_EQ(shim.targetPrefix.value_or(""), "aarch64-linux-gnu");
+    EXPECT_EQ(cache.identify("/opt/wrappers/compile-shim", "").kind, "unknown");
+    EXPECT_EQ(cache.size(), 3U);
+
+    cache.reset();
+    EXPECT_EQ(cache.size(), 0U);
+    EXPECT_EQ(cache.hits(), 0U);
+};
+};  // TEST_SUITE(compiler_identify_tests)
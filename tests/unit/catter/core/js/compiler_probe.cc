@@ -0,0 +1,307 @@
+#include "js/compiler_probe.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+
+#include "util/kotatsu.h"
+
+namespace fs = std::filesystem;
+using namespace catter;
+using namespace catter::js;
+
+namespace {
+
+#if defined(CATTER_LINUX) || defined(CATTER_MAC)
+
+/// A fake compiler that counts its runs and answers like gcc after a short delay, so that
+/// concurrent queries overlap with the probe.
+struct Fixture {
+    Fixture() {
+        static std::atomic_uint64_t serial{0};
+        root = fs::temp_directory_path() /
+               ("catter_compiler_probe_" + std::to_string(serial.fetch_add(1)));
+        fs::create_directories(root / "bin");
+        write_compiler(0);
+    }
+
+    ~Fixture() {
+        std::error_code ec;
+        fs::remove_all(root, ec);
+    }
+
+    fs::path compiler() const {
+        return root / "bin" / "fakecc";
+    }
+
+    void write_compiler(int exit_code) {
+        std::ofstream output(compiler(), std::ios::binary | std::ios::trunc);
+        output << "#!/bin/sh\n"
+                  "echo run >> \"$(dirname \"$0\")/runs\"\n"
+                  "sleep 0.2\n"
+                  "echo 'Target: fake-target' >&2\n"
+                  "echo '#include <...> search starts here:' >&2\n"
+                  "echo ' /fake/include' >&2\n"
+                  "echo 'End of search list.' >&2\n"
+                  "echo '#define FAKE 1'\n"
+               << "exit " << exit_code << "\n";
+        output.close();
+        fs::permissions(compiler(), fs::perms::owner_all);
+    }
+
+    size_t runs() const {
+        std::ifstream input(root / "bin" / "runs");
+        return std::count(std::istreambuf_iterator<char>(input),
+                          std::istreambuf_iterator<char>(),
+                          '\n');
+    }
+
+    fs::path root;
+};
+
+/// What a query ended with: the target, or the error.
+kota::task<std::string> outcome(CompilerProbeCache& cache,
+                                std::string compiler,
+                                std::vector<std::string> env = {}) {
+    std::string error;
+    try {
+        auto probe = co_await cache.probe(std::move(compiler), "c", {}, std::move(env));
+        co_return probe.target;
+    } catch(const std::exception& ex) {
+        error = ex.what();
+    }
+    co_return error;
+}
+
+kota::task<std::vector<std::string>> outcomes(CompilerProbeCache& cache,
+                                              std::string compiler,
+                                              size_t count) {
+    std::vector<std::string> results;
+    for(size_t i = 0; i < count; ++i) {
+        results.push_back(co_await outcome(cache, compiler));
+    }
+    co_return results;
+}
+
+kota::task<std::vector<std::string>> concurrent(CompilerProbeCache& cache, std::string compiler) {
+    auto [first, second] =
+        co_await kota::when_all{outcome(cache, compiler), outcome(cache, compiler)};
+    co_return std::vector<std::string>{first, second, co_await outcome(cache, compiler)};
+}
+
+kota::task<std::string> cancel_soon(CompilerProbeCache& cache) {
+    cache.cancel();
+    co_return std::string{};
+}
+
+kota::task<std::vector<std::string>> cancelled(CompilerProbeCache& cache, std::string compiler) {
+    auto [first, second, _] = co_await kota::when_all{outcome(cache, compiler),
+                                                      outcome(cache, compiler),
+                                                      cancel_soon(cache)};
+    co_return std::vector<std::string>{first, second};
+}
+
+template <typename Task>
+auto run(Task task) {
+    kota::event_loop loop;
+    loop.schedule(task);
+    loop.run();
+    return task.result();
+}
+
+#endif
+
+}  // namespace
+
+TEST_SUITE(compiler_probe_tests) {
+TEST_CASE(probe_flags_keep_what_changes_the_answer) {
+    std::vector<std::string> args = {"clang++", "-c", "main.cc", "-o", "main.o", "-Iinclude",
+                                     "-DNDEBUG", "-O2", "-m32", "-target", "arm64-apple-darwin",
+                                     "-std=c++20", "-isystem", "/opt/x", "-fPIC", "-Wall",
+                                     "--sysroot", "/sysroot", "-MD", "-MF", "main.d"};
+    std::vector<std::string> expected = {"-O2", "-m32", "-target", "arm64-apple-darwin",
+                                         "-std=c++20", "-fPIC", "--sysroot", "/sysroot"};
+    EXPECT_TRUE(probe_flags(args) == expected);
+
+    std::vector<std::string> plain = {"cc", "-c", "a.c", "-g", "-Werror"};
+    EXPECT_TRUE(probe_flags(plain).empty());
+};
+
+TEST_CASE(parse_gcc_output) {
+    constexpr std::string_view std_err =
+        "Using built-in specs.\n"
+        "COLLECT_GCC=g++\n"
+        "Target: x86_64-linux-gnu\n"
+        "ignoring nonexistent directory \"/usr/local/include/x86_64-linux-gnu\"\n"
+        "#include \"...\" search starts here:\n"
+        "#include <...> search starts here:\n"
+        " /usr/include/c++/12\n"
+        " /usr/lib/gcc/x86_64-linux-gnu/12/../../../../include/x86_64-linux-gnu\n"
+        " /usr/include\n"
+        "End of search list.\n";
+    constexpr std::string_view std_out =
+        "#define __STDC__ 1\n"
+        "#define __USER_LABEL_PREFIX__ \n"
+        "#define __VERSION__ \"12.2.0\"\n"
+        "#define __has_include(STR) __has_include__(STR)\n";
+
+    auto probe = parse_compiler_probe(std_out, std_err);
+    EXPECT_EQ(probe.target, "x86_64-linux-gnu");
+    EXPECT_EQ(probe.includes.size(), 3U);
+    EXPECT_EQ(probe.includes[0], "/usr/include/c++/12");
+    EXPECT_EQ(probe.includes[1], "/usr/include/x86_64-linux-gnu");
+    std::vector<std::string> macros = {
+        "__STDC__=1",
+        "__USER_LABEL_PREFIX__=",
+        "__VERSION__=\"12.2.0\"",
+        "__has_include(STR)=__has_include__(STR)",
+    };
+    EXPECT_TRUE(probe.macros == macros);
+};
+
+TEST_CASE(parse_clang_framework_dirs) {
+    constexpr std::string_view std_err =
+        "Apple clang version 15.0.0 (clang-1500.3.9.4)\r\n"
+        "Target: arm64-apple-darwin23.4.0\r\n"
+        "#include <...> search starts here:\r\n"
+        " /usr/local/include\r\n"
+        " /Library/Developer/SDKs/MacOSX.sdk/System/Library/Frameworks (framework directory)\r\n"
+        "End of search list.\r\n"
+        " /not/a/search/dir\r\n";
+
+    auto probe = parse_compiler_probe("", std_err);
+    EXPECT_EQ(probe.target, "arm64-apple-darwin23.4.0");
+    EXPECT_EQ(probe.includes.size(), 2U);
+    EXPECT_EQ(probe.includes[1], "/Library/Developer/SDKs/MacOSX.sdk/System/Library/Frameworks");
+    EXPECT_TRUE(probe.macros.empty());
+};
+
+TEST_CASE(concurrent_queries_share_one_probe_and_later_ones_hit_the_memo) {
+#if defined(CATTER_LINUX) || defined(CATTER_MAC)
+    Fixture fixture;
+    CompilerProbeCache cache;
+    cache.reset(std::nullopt);
+
+    auto results = run(concurrent(cache, fixture.compiler().string()));
+    EXPECT_TRUE(results == std::vector<std::string>(3, "fake-target"));
+    EXPECT_EQ(fixture.runs(), 1U);
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.probes, 1U);
+    EXPECT_EQ(stats.joined, 1U);
+    EXPECT_EQ(stats.hits, 1U);
+    EXPECT_EQ(stats.failures, 0U);
+#else
+    EXPECT_TRUE(true);
+#endif
+};
+
+TEST_CASE(failures_are_memoized_until_they_expire) {
+#if defined(CATTER_LINUX) || defined(CATTER_MAC)
+    Fixture fixture;
+    fixture.write_compiler(3);
+    CompilerProbeCache cache;
+    cache.reset(std::nullopt, std::chrono::hours(1));
+
+    auto results = run(outcomes(cache, fixture.compiler().string(), 2));
+    EXPECT_TRUE(results[0].find("exited with 3") != std::string::npos);
+    EXPECT_EQ(results[1], results[0]);
+    EXPECT_EQ(fixture.runs(), 1U);
+    EXPECT_EQ(cache.stats().failures, 1U);
+    EXPECT_EQ(cache.stats().hits, 1U);
+
+    cache.reset(std::nullopt, std::chrono::milliseconds(0));
+    results = run(outcomes(cache, fixture.compiler().string(), 2));
+    EXPECT_TRUE(results[1].find("exited with 3") != std::string::npos);
+    EXPECT_EQ(fixture.runs(), 3U);
+    EXPECT_EQ(cache.stats().failures, 2U);
+#else
+    EXPECT_TRUE(true);
+#endif
+};
+
+TEST_CASE(disk_entries_are_keyed_by_size_and_mtime) {
+#if defined(CATTER_LINUX) || defined(CATTER_MAC)
+    Fixture fixture;
+    CompilerProbeCache cache;
+    const auto compiler = fixture.compiler().string();
+
+    cache.reset(fixture.root / "cache");
+    EXPECT_EQ(run(outcome(cache, compiler)), "fake-target");
+    EXPECT_EQ(cache.stats().probes, 1U);
+
+    // A new session answers from disk.
+    cache.reset(fixture.root / "cache");
+    EXPECT_EQ(run(outcome(cache, compiler)), "fake-target");
+    EXPECT_EQ(cache.stats().diskHits, 1U);
+    EXPECT_EQ(cache.stats().probes, 0U);
+    EXPECT_EQ(fixture.runs(), 1U);
+
+    // Touching the compiler misses.
+    fs::last_write_time(fixture.compiler(),
+                        fs::last_write_time(fixture.compiler()) + std::chrono::seconds(10));
+    cache.reset(fixture.root / "cache");
+    EXPECT_EQ(run(outcome(cache, compiler)), "fake-target");
+    EXPECT_EQ(cache.stats().probes, 1U);
+    EXPECT_EQ(fixture.runs(), 2U);
+
+    // So does a compiler of another size.
+    fixture.write_compiler(0);
+    std::ofstream(fixture.compiler(), std::ios::app) << "# upgraded\n";
+    cache.reset(fixture.root / "cache");
+    EXPECT_EQ(run(outcome(cache, compiler)), "fake-target");
+    EXPECT_EQ(cache.stats().diskHits, 0U);
+    EXPECT_EQ(fixture.runs(), 3U);
+#else
+    EXPECT_TRUE(true);
+#endif
+};
+
+TEST_CASE(bare_names_resolve_in_the_path_of_the_command) {
+#if defined(CATTER_LINUX) || defined(CATTER_MAC)
+    Fixture fixture;
+    CompilerProbeCache cache;
+    cache.reset(std::nullopt);
+
+    std::vector<std::string> env = {"PATH=/nonexistent",
+                                    "HOME=/",
+                                    "PATH=" + (fixture.root / "bin").string()};
+    EXPECT_EQ(run(outcome(cache, "fakecc", env)), "fake-target");
+
+    auto missing = run(outcome(cache, "fakecc", {"PATH=/nonexistent"}));
+    EXPECT_TRUE(missing.find("Cannot find compiler fakecc") != std::string::npos);
+    // Nor does catter's own PATH know it.
+    missing = run(outcome(cache, "fakecc"));
+    EXPECT_TRUE(missing.find("Cannot find compiler fakecc") != std::string::npos);
+#else
+    EXPECT_TRUE(true);
+#endif
+};
+
+TEST_CASE(cancel_releases_queries_waiting_for_a_probe) {
+#if defined(CATTER_LINUX) || defined(CATTER_MAC)
+    Fixture fixture;
+    CompilerProbeCache cache;
+    cache.reset(std::nullopt);
+
+    auto results = run(cancelled(cache, fixture.compiler().string()));
+    EXPECT_EQ(results[0], "fake-target");
+    EXPECT_TRUE(results[1].find("Compiler probe cancelled") != std::string::npos);
+    EXPECT_EQ(cache.stats().joined, 1U);
+
+    // The cancelled probe is forgotten, the next query spawns again.
+    EXPECT_EQ(run(outcome(cache, fixture.compiler().string())), "fake-target");
+    EXPECT_EQ(fixture.runs(), 2U);
+#else
+    EXPECT_TRUE(true);
+#endif
+};
+};  // TEST_SUITE(compiler_probe_tests)
@@ -1,9 +1,12 @@
 #include "js_case.h"
 
+#include "js/http_server.h"
+
 #if defined(CATTER_LINUX) || defined(CATTER_MAC)
 #include <algorithm>
 #include <cctype>
 #include <cerrno>
+#include <chrono>
 #include <cstring>
 #include <format>
 #include <sstream>
@@ -12,6 +15,7 @@
 #include <string_view>
 #include <thread>
 #include <utility>
+#include <vector>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
@@ -247,6 +251,78 @@ private:
     int expected_requests = 0;
     std::jthread worker;
 };
+
+/// Connects to the loopback `port` and sends a GET for `path`, returns the socket.
+int open_request(uint16_t port, std::string_view path, int receive_buffer = 0) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if(fd < 0) {
+        throw std::runtime_error("socket failed");
+    }
+    if(receive_buffer > 0) {
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    const auto request = std::format("GET {} HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n", path);
+    if(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+       ::send(fd, request.data(), request.size(), 0) != static_cast<ssize_t>(request.size())) {
+        ::close(fd);
+        throw std::runtime_error("connect failed");
+    }
+    return fd;
+}
+
+/// Everything the server sends until it closes the connection.
+std::string read_until_closed(int fd) {
+    std::string response;
+    char buffer[64 * 1024];
+    while(true) {
+        const auto n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        if(n <= 0) {
+            break;
+        }
+        response.append(buffer, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return response;
+}
+
+bool wait_for_subscribers(const catter::js::HttpServer& server, std::string_view path) {
+    for(int tries = 0; tries < 5000; ++tries) {
+        if(server.subscribers(path) > 0) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+/// The `data` of each event of a stream response, in order.
+std::vector<std::string> event_data(std::string_view response) {
+    std::vector<std::string> data;
+    auto at = response.find("\r\n\r\n");
+    if(at == std::string_view::npos) {
+        return data;
+    }
+    at += 4;
+    while(at < response.size()) {
+        const auto end = response.find("\n\n", at);
+        const auto event = response.substr(at, end - at);
+        if(const auto field = event.find("data: "); field != std::string_view::npos) {
+            data.emplace_back(event.substr(field + 6));
+        }
+        if(end == std::string_view::npos) {
+            break;
+        }
+        at = end + 2;
+    }
+    return data;
+}
 #endif
 
 }  // namespace
@@ -295,4 +371,151 @@ TEST_CASE(run_http_client_js_file_through_async_loop) {
     EXPECT_TRUE(true);
 #endif
 };
+
+TEST_CASE(format_server_sent_events) {
+    using catter::js::format_sse_event;
+    EXPECT_TRUE(format_sse_event("command", "{}") == "event: command\ndata: {}\n\n");
+    EXPECT_TRUE(format_sse_event("", "a\nb") == "data: a\ndata: b\n\n");
+    EXPECT_TRUE(format_sse_event("done", "") == "event: done\ndata: \n\n");
+};
+
+TEST_CASE(serve_documents_and_event_streams_from_js) {
+#if defined(CATTER_LINUX) || defined(CATTER_MAC)
+    auto f = [&]() {
+        auto source = std::string{R"JS(
+            import { assertThrow } from "catter/debug";
+            import { Client, Server } from "catter/http";
+
+            const server = new Server({ port: 0 });
+            const base = `http://127.0.0.1:${server.port()}`;
+            server.route("/", "text/html", "<h1>build</h1>");
+            const events = server.stream("/events", { history: 5_000 });
+
+            // Subscribe first, the response only completes once the stream ends.
+            const client = new Client();
+            const live = client.get(`${base}/events`, { timeoutMs: 10_000 });
+            for (let tries = 0; events.subscribers() === 0; tries++) {
+              assertThrow(tries < 1_000);
+              const page = await client.get(`${base}/`, { timeoutMs: 5_000 });
+              assertThrow(page.status === 200);
+              assertThrow(page.header("content-type") === "text/html");
+              assertThrow(page.text() === "<h1>build</h1>");
+            }
+
+            // Publishing only queues, so thousands of events fit in a fraction of
+            // a second even though nobody reads them meanwhile.
+            const count = 5_000;
+            const started = Date.now();
+            for (let i = 0; i < count; i++) {
+              events.publish("command", JSON.stringify({ id: i }));
+            }
+            assertThrow(Date.now() - started < 1_000);
+            events.end();
+            assertThrow(events.subscribers() === 0);
+
+            const ids = (response) => {
+              assertThrow(response.status === 200);
+              assertThrow(response.header("content-type") === "text/event-stream");
+              return response
+                .text()
+                .split("\n\n")
+                .filter((event) => event.length > 0)
+                .map((event) => {
+                  const [name, data] = event.split("\n");
+                  assertThrow(name === "event: command");
+                  return JSON.parse(data.slice("data: ".length)).id;
+                });
+            };
+            const delivered = ids(await live);
+            assertThrow(delivered.length === count);
+            assertThrow(delivered.every((id, i) => id === i));
+
+            // A late subscriber gets the history and the end right away.
+            const late = ids(
+              await client.get(`${base}/events`, { timeoutMs: 5_000 }),
+            );
+            assertThrow(late.length === count);
+            assertThrow(late.every((id, i) => id === i));
+
+            const missing = await client.get(`${base}/missing`, {
+              timeoutMs: 5_000,
+            });
+            assertThrow(missing.status === 404);
+
+            client.close();
+            server.close();
+        )JS"};
+
+        catter::tests::js::run_async_js_case(std::move(source), "http-server-test.js");
+    };
+
+    EXPECT_NOTHROWS(f());
+#else
+    EXPECT_TRUE(true);
+#endif
+};
+
+TEST_CASE(event_streams_deliver_live_events_in_order) {
+#if defined(CATTER_LINUX) || defined(CATTER_MAC)
+    auto server = catter::js::HttpServer::listen("127.0.0.1", 0);
+    server->stream("/events", 0);
+    const int fd = open_request(server->port(), "/events");
+    EXPECT_TRUE(wait_for_subscribers(*server, "/events"));
+
+    // Nothing reads the connection while publishing, which must not slow it down.
+    constexpr int count = 5000;
+    const auto started = std::chrono::steady_clock::now();
+    for(int i = 0; i < count; ++i) {
+        server->publish("/events", "command", std::to_string(i));
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    server->end("/events");
+
+    const auto response = read_until_closed(fd);
+    EXPECT_TRUE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+    const auto data = event_data(response);
+    EXPECT_EQ(data.size(), count);
+    bool ordered = true;
+    for(int i = 0; i < static_cast<int>(data.size()); ++i) {
+        ordered = ordered && data[i] == std::to_string(i);
+    }
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(elapsed < std::chrono::seconds(1));
+    server->close();
+#else
+    EXPECT_TRUE(true);
+#endif
+};
+
+TEST_CASE(event_streams_drop_subscribers_past_the_backlog) {
+#if defined(CATTER_LINUX) || defined(CATTER_MAC)
+    using catter::js::HttpServer;
+    auto server = HttpServer::listen("127.0.0.1", 0);
+    server->stream("/events", 0);
+    const int slow = open_request(server->port(), "/events", 4096);
+    EXPECT_TRUE(wait_for_subscribers(*server, "/events"));
+
+    // Nobody reads `slow`, so once the socket buffers are full its backlog only grows.
+    const std::string payload(64 * 1024, 'x');
+    size_t published = 0;
+    while(server->subscribers("/events") > 0 && published < 8 * HttpServer::max_backlog) {
+        server->publish("/events", "chunk", payload);
+        published += payload.size();
+    }
+    EXPECT_EQ(server->subscribers("/events"), 0);
+
+    // The dropped connection is closed without the rest, a new subscriber is served as usual.
+    EXPECT_TRUE(read_until_closed(slow).size() < published);
+    const int fresh = open_request(server->port(), "/events");
+    EXPECT_TRUE(wait_for_subscribers(*server, "/events"));
+    server->publish("/events", "chunk", "after");
+    server->end("/events");
+    const auto data = event_data(read_until_closed(fresh));
+    EXPECT_TRUE(data.size() == 1 && data[0] == "after");
+    server->close();
+#else
+    EXPECT_TRUE(true);
+#endif
+};
+
 };  // TEST_SUITE(js_unit_tests)
@@ -0,0 +1,190 @@
+#include "js/option_cache.h"
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+#include <kota/deco/option.h>
+
+#include "option/clang.h"
+
+namespace kota_opt = kota::option;
+using namespace catter;
+using Cache = js::OptionParseCache;
+
+namespace {
+
+/// A tiny grammar: "-o" takes the next argument, "-x" fails, anything else is one item.
+std::optional<uint32_t> toy_parser(std::span<const std::string> args,
+                                   size_t from,
+                                   const Cache::StopAt& stop_at,
+                                   Cache::Parsed& out) {
+    for(size_t i = from; i < args.size(); ++i) {
+        const auto index = static_cast<uint32_t>(i);
+        if(stop_at(index)) {
+            return index;
+        }
+        if(args[i] == "-x") {
+            out.error = Cache::Error{.index = index, .reason = "bad"};
+            return std::nullopt;
+        }
+        js::OptionItem item{.values = {}, .key = args[i], .id = 1, .index = index};
+        if(args[i] == "-o") {
+            if(i + 1 == args.size()) {
+                out.error = Cache::Error{.index = index + 1, .reason = "missing argument"};
+                return std::nullopt;
+            }
+            item.id = 2;
+            item.values.push_back(args[++i]);
+        }
+        out.items.push_back(std::move(item));
+    }
+    return std::nullopt;
+}
+
+/// The clang table, clang-cl spellings included, parsed the way the option C API parses it.
+std::optional<uint32_t> clang_parser(std::span<const std::string> args,
+                                     size_t from,
+                                     const Cache::StopAt& stop_at,
+                                     Cache::Parsed& out) {
+    kota_opt::ParseOptions options;
+    options.dash_dash_parsing = true;
+    options.visibility = 0xffffffffU;
+    for(auto result: opt::clang::table().parse(args.subspan(from), options)) {
+        if(!result.has_value()) {
+            out.error = Cache::Error{
+                .index = static_cast<uint32_t>(result.error().index + from),
+                .reason = "bad",
+            };
+            return std::nullopt;
+        }
+        const auto index = static_cast<uint32_t>(result->index + from);
+        if(stop_at(index)) {
+            return index;
+        }
+        js::OptionItem item{.values = {},
+                            .key = std::string(result->spelling),
+                            .id = result->id,
+                            .index = index};
+        for(auto value: result->values) {
+            item.values.emplace_back(value);
+        }
+        out.items.push_back(std::move(item));
+    }
+    return std::nullopt;
+}
+
+Cache::Parsed full_parse(const std::vector<std::string>& args,
+                         const Cache::Parser& parser = toy_parser) {
+    Cache::Parsed parsed;
+    parser(args, 0, [](uint32_t) { return false; }, parsed);
+    return parsed;
+}
+
+bool same(const Cache::Parsed& lhs, const Cache::Parsed& rhs) {
+    if(lhs.items != rhs.items || lhs.error.has_value() != rhs.error.has_value()) {
+        return false;
+    }
+    return !lhs.error || (lhs.error->index == rhs.error->index &&
+                          lhs.error->reason == rhs.error->reason);
+}
+
+}  // namespace
+
+TEST_SUITE(option_cache_tests) {
+
+TEST_CASE(identical_vectors_hit) {
+    Cache cache;
+    const std::vector<std::string> args = {"-Wall", "-o", "a.o", "a.cc"};
+    auto first = cache.parse("toy", 0, args, toy_parser);
+    auto second = cache.parse("toy", 0, args, toy_parser);
+    EXPECT_TRUE(first == second);
+    EXPECT_TRUE(same(*second, full_parse(args)));
+
+    auto other_visibility = cache.parse("toy", 1, args, toy_parser);
+    EXPECT_TRUE(other_visibility != first);
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1U);
+    EXPECT_EQ(stats.entries, 2U);
+};
+
+TEST_CASE(shared_prefix_and_suffix_match_a_full_parse) {
+    Cache cache;
+    const std::vector<std::string> a = {"-Wall", "-O2", "-I", "-o", "a.o", "-c", "a.cc", "-g"};
+    const std::vector<std::string> b =
+        {"-Wall", "-O2", "-I", "-o", "bb.o", "x", "-c", "b.cc", "-g"};
+    const std::vector<std::string> c = {"-Wall", "-O2", "-o", "-c", "b.cc", "-g"};
+    const std::vector<std::string> d = {"-Wall", "-O2", "-o", "-c", "b.cc", "-x", "-g"};
+    const std::vector<std::string> e = {"-Wall", "-O2", "-o", "-c", "b.cc", "-x", "-O2", "-g"};
+
+    for(const auto* args: {&a, &b, &c, &d, &e, &a}) {
+        auto parsed = cache.parse("toy", 0, *args, toy_parser);
+        EXPECT_TRUE(same(*parsed, full_parse(*args)));
+    }
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1U);
+    EXPECT_TRUE(stats.partialHits >= 3U);
+    EXPECT_TRUE(stats.reusedArgs > a.size());
+};
+
+TEST_CASE(remaining_args_match_a_full_clang_cl_parse) {
+    Cache cache;
+    const std::vector<std::vector<std::string>> builds = {
+        {"/c", "a.cpp", "/link", "x.lib"},
+        {"/c", "a.cpp", "/link", "x.lib", "y.lib"},
+        {"/c", "a.cpp", "/link", "x.lib", "y.lib", "/DEBUG"},
+        {"/c", "a.cpp", "/linkx.lib"},
+        {"/c", "a.cpp", "/linkx.lib", "y.lib"},
+        {"/c", "/O2", "b.cpp", "/link", "x.lib", "y.lib", "/DEBUG"},
+        {"/c", "/O2", "b.cpp"},
+        {"/c", "/O2", "b.cpp", "/Fob.obj"},
+    };
+    for(const auto& args: builds) {
+        auto parsed = cache.parse("clang", 0xffffffffU, args, clang_parser);
+        EXPECT_TRUE(same(*parsed, full_parse(args, clang_parser)));
+    }
+
+    const auto& link = *cache.parse("clang", 0xffffffffU, builds[1], clang_parser);
+    EXPECT_EQ(link.items.size(), 3U);
+    EXPECT_EQ(link.items.back().values.size(), 2U);
+};
+
+TEST_CASE(dash_dash_is_always_parsed_in_full) {
+    Cache cache;
+    const std::vector<std::string> a = {"-Wall", "--", "-o", "a.o"};
+    const std::vector<std::string> b = {"-Wall", "--", "-o", "b.o"};
+    (void)cache.parse("toy", 0, a, toy_parser);
+    (void)cache.parse("toy", 0, b, toy_parser);
+    EXPECT_EQ(cache.stats().partialHits, 0U);
+    EXPECT_EQ(cache.stats().misses, 2U);
+};
+
+TEST_CASE(budget_bounds_memory) {
+    Cache cache;
+    cache.set_budget(2048);
+    for(int i = 0; i < 64; ++i) {
+        const std::vector<std::string> args = {"-o", "out" + std::to_string(i) + ".o"};
+        (void)cache.parse("toy", 0, args, toy_parser);
+    }
+    auto stats = cache.stats();
+    EXPECT_TRUE(stats.bytes <= 2048U);
+    EXPECT_TRUE(stats.evictions > 0U);
+
+    cache.set_budget(0);
+    EXPECT_EQ(cache.stats().entries, 0U);
+    const std::vector<std::string> args = {"-o", "out.o"};
+    auto first = cache.parse("toy", 0, args, toy_parser);
+    auto second = cache.parse("toy", 0, args, toy_parser);
+    EXPECT_TRUE(first != second);
+    EXPECT_TRUE(same(*second, full_parse(args)));
+
+    cache.reset();
+    EXPECT_EQ(cache.stats().misses, 0U);
+    EXPECT_EQ(cache.stats().budget, Cache::default_budget);
+};
+
+};  // TEST_SUITE(option_cache_tests)
@@ -59,9 +59,26 @@ TEST_CASE(command_data_and_action_conversion) {
 
         };
 
+        Action quiet_skip_action = Tag<ActionType::skip>{.capture = CaptureMode::none};
+        Action short_skip_action = Tag<ActionType::skip>{
+            .capture = CaptureMode::tail,
+            .captureLimit = 4096,
+        };
+        Action full_modify_action = Tag<ActionType::modify>{
+            .data = command_data,
+            .capture = CaptureMode::full,
+        };
+        Action fake_action = Tag<ActionType::fake>{
+            .outputs = {"build/main.o", "/tmp/catter/libmain.a"},
+        };
+
         EXPECT_TRUE(is_roundtrip_equal(ctx, command_data));
         EXPECT_TRUE(is_roundtrip_equal(ctx, modify_action));
         EXPECT_TRUE(is_roundtrip_equal(ctx, skip_action));
+        EXPECT_TRUE(is_roundtrip_equal(ctx, quiet_skip_action));
+        EXPECT_TRUE(is_roundtrip_equal(ctx, short_skip_action));
+        EXPECT_TRUE(is_roundtrip_equal(ctx, full_modify_action));
+        EXPECT_TRUE(is_roundtrip_equal(ctx, fake_action));
     };
 
     EXPECT_NOTHROWS(f());
@@ -90,8 +107,29 @@ TEST_CASE(process_result_and_config_conversion) {
             .execute = true
         };
 
+        auto filtered_config = config;
+        filtered_config.options.execFilter = js::ExecFilter{
+            .allow = {"*gcc*", "clang*"},
+            .deny = {"cc1*"},
+        };
+        filtered_config.options.execThrough = true;
+        filtered_config.options.capture = js::CaptureMode::none;
+        filtered_config.options.captureLimit = 1024 * 1024;
+        filtered_config.options.record = "/tmp/catter-build.ndjson";
+
+        auto measured_result = process_result;
+        measured_result.usage = js::ProcessUsage{
+            .startUs = 1'000,
+            .endUs = 251'000,
+            .userUs = 180'000,
+            .systemUs = 20'000,
+            .maxRssKiB = 65'536,
+        };
+
         EXPECT_TRUE(is_roundtrip_equal(ctx, process_result));
+        EXPECT_TRUE(is_roundtrip_equal(ctx, measured_result));
         EXPECT_TRUE(is_roundtrip_equal(ctx, config));
+        EXPECT_TRUE(is_roundtrip_equal(ctx, filtered_config));
     };
 
     EXPECT_NOTHROWS(f());
@@ -4,6 +4,7 @@
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 #include <cpptrace/exceptions.hpp>
 #include <kota/zest/macro.h>
@@ -247,6 +248,49 @@ TEST_CASE(script_and_module_evaluation_cover_sync_async_and_custom_loading) {
     EXPECT_TRUE(loader_ptr->loaded_name == "virtual:dependency");
 };
 
+TEST_CASE(module_bytecode_roundtrips_through_loader_and_eval) {
+    auto compiler = qjs::Runtime::create();
+    const auto dependency = compiler.context().compile_module(
+        "export const value = 6 * 7;",
+        "virtual:dependency");
+    const auto main = compiler.context().compile_module(R"(
+            import { value } from './dependency.js';
+            globalThis.moduleResult = value + 1;
+        )",
+                                                        "main-module.js");
+    EXPECT_TRUE(!dependency.empty() && !main.empty());
+    EXPECT_TRUE(throws_with_message(
+        [&]() { (void)compiler.context().compile_module("export const = ;", "broken.js"); },
+        "SyntaxError"));
+
+    auto runtime = qjs::Runtime::create();
+    auto ctx = runtime.context();
+
+    struct Loader : public qjs::Runtime::ModuleLoader {
+        explicit Loader(std::string bytecode) : bytecode(std::move(bytecode)) {}
+
+        std::string normalizer(std::string_view, std::string_view) override {
+            return "virtual:dependency";
+        }
+
+        qjs::Module loader(qjs::Context ctx, std::string_view) override {
+            return ctx.load_module_bytecode(bytecode);
+        }
+
+        std::string bytecode;
+    };
+
+    runtime.set_module_loader(std::make_unique<Loader>(dependency));
+
+    auto module_result = ctx.eval_module_bytecode(main);
+    drain_jobs(runtime);
+
+    EXPECT_TRUE(module_result.is_fulfilled());
+    EXPECT_TRUE(ctx.global_this()["moduleResult"].as<int64_t>() == 43);
+    EXPECT_TRUE(throws_with_message([&]() { (void)ctx.eval_module_bytecode("not bytecode"); },
+                                    "Error"));
+};
+
 TEST_CASE(object_property_apis_cover_reads_writes_and_exceptional_access) {
     auto f = [&]() {
         auto runtime = qjs::Runtime::create();
@@ -0,0 +1,162 @@
+#include "trace_export.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+
+#include "util/span_trace.h"
+
+namespace fs = std::filesystem;
+using namespace catter;
+
+namespace {
+
+struct Fixture {
+    Fixture() {
+        static std::atomic_uint64_t serial{0};
+        root = fs::temp_directory_path() /
+               ("catter_trace_export_" + std::to_string(serial.fetch_add(1)));
+        fs::create_directories(root / "spans");
+    }
+
+    ~Fixture() {
+        std::error_code ec;
+        fs::remove_all(root, ec);
+    }
+
+    std::string read(const fs::path& path) const {
+        std::ifstream input(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+    }
+
+    fs::path root;
+};
+
+/// Builds a span file the way `trace::flush` writes it.
+class SpanFile {
+public:
+    SpanFile(uint32_t pid, std::string_view process) {
+        bytes.append(trace::file_magic, sizeof(trace::file_magic));
+        put(pid);
+        put(process);
+    }
+
+    SpanFile& span(std::string_view name, uint64_t begin, uint64_t end, uint32_t track) {
+        put(begin);
+        put(end);
+        put(track);
+        put(name);
+        return *this;
+    }
+
+    void write(const fs::path& path, size_t cut = 0) const {
+        std::ofstream output(path, std::ios::binary);
+        output.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - cut));
+    }
+
+private:
+    template <typename T>
+    void put(T value) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void put(std::string_view text) {
+        put(static_cast<uint32_t>(text.size()));
+        bytes.append(text);
+    }
+
+    std::string bytes;
+};
+
+}  // namespace
+
+TEST_SUITE(trace_export) {
+TEST_CASE(merges_processes_relative_to_the_first_span) {
+    Fixture fixture;
+    SpanFile(42, "catter")
+        .span("ipc.decide", 5'000, 9'000, 7)
+        .write(fixture.root / "spans" / "42-1.spans");
+    SpanFile(43, "catter-proxy")
+        .span("proxy.startup", 1'000, 3'500, 1U << 31)
+        .span("proxy.decide", 4'000, 9'500, 1U << 31)
+        .write(fixture.root / "spans" / "43-1.spans");
+
+    const auto output = fixture.root / "trace.json";
+    EXPECT_EQ(core::export_chrome_trace(fixture.root / "spans", output), 3U);
+
+    const auto json = fixture.read(output);
+    EXPECT_TRUE(json.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    EXPECT_TRUE(json.contains("\"args\":{\"name\":\"catter [42]\"}"));
+    EXPECT_TRUE(json.contains("\"args\":{\"name\":\"catter-proxy [43]\"}"));
+    EXPECT_TRUE(json.contains("\"name\":\"proxy.startup\""));
+    EXPECT_TRUE(json.contains("\"ts\":0.000,\"dur\":2.500"));
+    EXPECT_TRUE(json.contains("\"tid\":7,\"ts\":4.000,\"dur\":4.000"));
+};
+
+TEST_CASE(keeps_the_spans_before_a_cut) {
+    Fixture fixture;
+    SpanFile(7, "catter-hook /bin/sh")
+        .span("hook.execve", 100, 200, 1U << 31)
+        .span("hook.posix_spawn", 300, 400, 1U << 31)
+        .write(fixture.root / "spans" / "7-1.spans", 3);
+    {
+        std::ofstream foreign(fixture.root / "spans" / "8-1.spans", std::ios::binary);
+        foreign << "not a span file";
+    }
+    {
+        std::ofstream ignored(fixture.root / "spans" / "notes.txt", std::ios::binary);
+        ignored << "ignored";
+    }
+
+    const auto output = fixture.root / "trace.json";
+    EXPECT_EQ(core::export_chrome_trace(fixture.root / "spans", output), 1U);
+    const auto json = fixture.read(output);
+    EXPECT_TRUE(json.contains("\"name\":\"hook.execve\""));
+    EXPECT_FALSE(json.contains("hook.posix_spawn"));
+};
+
+TEST_CASE(exports_what_the_recorder_writes) {
+    Fixture fixture;
+    const auto spans = fixture.root / "spans";
+    trace::start("trace-test", spans.string());
+    EXPECT_TRUE(trace::enabled());
+
+    // Nothing recorded leaves no file, not even a header.
+    trace::flush();
+    EXPECT_TRUE(fs::is_empty(spans));
+
+    // One more than the buffer holds writes it out on the way, the rest goes with `flush`.
+    const auto base = trace::now();
+    for(uint64_t i = 0; i <= trace::buffer_capacity; ++i) {
+        trace::record("test.rollover", base + i, base + i + 1, 1);
+    }
+    trace::flush();
+    trace::record("test.after_flush", base, base + 10, 2);
+    trace::flush_before_exec("test.exec", base);
+    trace::record("test.after_exec", base, base + 20, 3);
+    trace::stop();
+    EXPECT_FALSE(trace::enabled());
+    trace::record("test.stopped", base, base + 30, 4);
+
+    size_t files = 0;
+    for([[maybe_unused]] const auto& entry: fs::directory_iterator(spans)) {
+        ++files;
+    }
+    EXPECT_EQ(files, 1U);
+
+    const auto output = fixture.root / "trace.json";
+    EXPECT_EQ(core::export_chrome_trace(spans, output), trace::buffer_capacity + 4);
+    const auto json = fixture.read(output);
+    EXPECT_TRUE(json.contains("trace-test ["));
+    EXPECT_TRUE(json.contains("\"name\":\"test.after_flush\""));
+    EXPECT_TRUE(json.contains("\"name\":\"test.exec\""));
+    EXPECT_TRUE(json.contains("\"name\":\"test.after_exec\""));
+    EXPECT_FALSE(json.contains("test.stopped"));
+};
+};  // TEST_SUITE(trace_export)
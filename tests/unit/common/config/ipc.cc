@@ -0,0 +1,54 @@
+#include "config/ipc.h"
+
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+
+#ifndef CATTER_WINDOWS
+#include <sys/un.h>
+
+namespace {
+
+/// Points $HOME elsewhere for the lifetime of the object.
+class HomeOverride {
+public:
+    explicit HomeOverride(const std::string& home) {
+        if(const char* value = std::getenv("HOME")) {
+            saved = value;
+        }
+        ::setenv("HOME", home.c_str(), 1);
+    }
+
+    ~HomeOverride() {
+        if(saved) {
+            ::setenv("HOME", saved->c_str(), 1);
+        } else {
+            ::unsetenv("HOME");
+        }
+    }
+
+private:
+    std::optional<std::string> saved;
+};
+
+}  // namespace
+#endif
+
+TEST_SUITE(config_ipc) {
+TEST_CASE(pipe_names_are_unique) {
+    EXPECT_TRUE(catter::config::ipc::make_pipe_name() != catter::config::ipc::make_pipe_name());
+};
+
+TEST_CASE(pipe_name_fits_sun_path_under_a_deep_home) {
+#ifndef CATTER_WINDOWS
+    const HomeOverride home("/home/" + std::string(120, 'h'));
+    const auto name = catter::config::ipc::make_pipe_name();
+    EXPECT_TRUE(name.size() < sizeof(sockaddr_un::sun_path));
+    EXPECT_TRUE(name.starts_with("/tmp/catter-ipc-"));
+#else
+    EXPECT_TRUE(true);
+#endif
+};
+};  // TEST_SUITE(config_ipc)
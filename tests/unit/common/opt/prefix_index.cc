@@ -0,0 +1,231 @@
+#include "option/prefix_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+#include <kota/deco/option.h>
+
+#include "option/clang.h"
+#include "option/lld_coff.h"
+#include "option/lld_elf.h"
+#include "option/lld_macho.h"
+#include "option/lld_mingw.h"
+#include "option/lld_wasm.h"
+#include "option/llvm_dlltool.h"
+#include "option/llvm_lib.h"
+#include "option/nvcc.h"
+
+namespace kota_opt = kota::option;
+using namespace catter;
+
+namespace {
+
+struct Table {
+    std::string_view name;
+    const kota_opt::OptTable& table;
+    const opt::PrefixIndex& index;
+};
+
+std::vector<Table> tables() {
+    return {
+        {"clang",        opt::clang::table(),        opt::clang::prefix_index()       },
+        {"lld-coff",     opt::lld_coff::table(),     opt::lld_coff::prefix_index()    },
+        {"lld-elf",      opt::lld_elf::table(),      opt::lld_elf::prefix_index()     },
+        {"lld-macho",    opt::lld_macho::table(),    opt::lld_macho::prefix_index()   },
+        {"lld-mingw",    opt::lld_mingw::table(),    opt::lld_mingw::prefix_index()   },
+        {"lld-wasm",     opt::lld_wasm::table(),     opt::lld_wasm::prefix_index()    },
+        {"nvcc",         opt::nvcc::table(),         opt::nvcc::prefix_index()        },
+        {"llvm-dlltool", opt::llvm_dlltool::table(), opt::llvm_dlltool::prefix_index()},
+        {"llvm-lib",     opt::llvm_lib::table(),     opt::llvm_lib::prefix_index()    },
+    };
+}
+
+/// Appends what the option table parses from `args[from]` on, as text so both paths compare.
+void append_table_results(const kota_opt::OptTable& table,
+                          std::span<const std::string> args,
+                          size_t from,
+                          uint32_t visibility,
+                          std::vector<std::string>& out) {
+    kota_opt::ParseOptions options;
+    options.dash_dash_parsing = true;
+    options.visibility = visibility;
+    std::vector<std::string> tail(args.begin() + from, args.end());
+    for(auto parsed: table.parse(tail, options)) {
+        if(!parsed.has_value()) {
+            out.push_back(std::format("error #{}", parsed.error().index + from));
+            return;
+        }
+        auto line = std::format("{} #{} '{}'", parsed->id, parsed->index + from, parsed->spelling);
+        for(auto value: parsed->values) {
+            line += std::format(" '{}'", value);
+        }
+        out.push_back(std::move(line));
+    }
+}
+
+std::vector<std::string> parse_with_table(const Table& table,
+                                          std::span<const std::string> args,
+                                          uint32_t visibility) {
+    std::vector<std::string> out;
+    append_table_results(table.table, args, 0, visibility, out);
+    return out;
+}
+
+std::vector<std::string> parse_with_index(const Table& table,
+                                          std::span<const std::string> args,
+                                          uint32_t visibility) {
+    std::vector<std::string> out;
+    size_t at = 0;
+    while(at < args.size()) {
+        auto resolved = table.index.resolve(args, at, visibility);
+        if(!resolved) {
+            append_table_results(table.table, args, at, visibility, out);
+            break;
+        }
+        auto line = std::format("{} #{} '{}'", resolved->id, at, resolved->spelling);
+        if(resolved->value) {
+            line += std::format(" '{}'", *resolved->value);
+        }
+        out.push_back(std::move(line));
+        at = resolved->next;
+    }
+    return out;
+}
+
+std::string with_case(std::string_view text, bool upper) {
+    std::string out(text);
+    for(auto& c: out) {
+        const auto byte = static_cast<unsigned char>(c);
+        c = static_cast<char>(upper ? std::toupper(byte) : std::tolower(byte));
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST_SUITE(prefix_index_tests) {
+TEST_CASE(resolves_plain_clang_options) {
+    const auto& index = opt::clang::prefix_index();
+    const std::vector<std::string> args = {"-c", "-Iinclude", "-o", "main.o", "-Wall", "main.cc"};
+
+    auto c = index.resolve(args, 0, 0xffffffffU);
+    ASSERT_TRUE(c.has_value());
+    EXPECT_EQ(c->id, opt::clang::ID_c);
+    EXPECT_FALSE(c->value.has_value());
+    EXPECT_EQ(c->next, 1U);
+
+    auto include = index.resolve(args, 1, 0xffffffffU);
+    ASSERT_TRUE(include.has_value());
+    EXPECT_EQ(include->id, opt::clang::ID_I);
+    EXPECT_EQ(include->spelling, "-I");
+    EXPECT_EQ(*include->value, "include");
+
+    auto output = index.resolve(args, 2, 0xffffffffU);
+    ASSERT_TRUE(output.has_value());
+    EXPECT_EQ(output->id, opt::clang::ID_o);
+    EXPECT_EQ(*output->value, "main.o");
+    EXPECT_EQ(output->next, 4U);
+
+    EXPECT_FALSE(index.resolve(args, 5, 0xffffffffU).has_value());
+};
+
+TEST_CASE(leaves_the_rest_to_the_table) {
+    const auto& index = opt::clang::prefix_index();
+    const std::vector<std::string> args = {"--all-warnings", "--", "-", "-o"};
+    for(size_t i = 0; i < args.size(); ++i) {
+        EXPECT_FALSE(index.resolve(args, i, 0xffffffffU).has_value());
+    }
+};
+
+TEST_CASE(matches_the_table_for_every_spelling) {
+    for(const auto& table: tables()) {
+        size_t checked = 0;
+        size_t mismatches = 0;
+        std::string first_mismatch;
+        for(const auto& option: table.table.option_infos) {
+            if(option.prefixes.empty()) {
+                continue;
+            }
+            const auto name = option.prefixed_name.substr(option.prefixes.front().size());
+            for(auto prefix: option.prefixes) {
+                const auto spelling = std::string(prefix) + std::string(name);
+                const std::vector<std::vector<std::string>> cases = {
+                    {spelling},
+                    {spelling + "v"},
+                    {spelling, "v", "-c"},
+                };
+                for(const auto& args: cases) {
+                    for(uint32_t visibility: {0xffffffffU, 1U}) {
+                        auto expected = parse_with_table(table, args, visibility);
+                        auto actual = parse_with_index(table, args, visibility);
+                        ++checked;
+                        if(expected != actual) {
+                            if(mismatches++ == 0) {
+                                first_mismatch = std::format("{}: '{}' (visibility {})",
+                                                             table.name,
+                                                             args.front(),
+                                                             visibility);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        EXPECT_TRUE(checked > 0);
+        EXPECT_EQ(mismatches, 0U);
+        EXPECT_EQ(first_mismatch, "");
+    }
+};
+
+TEST_CASE(matches_the_table_for_clang_cl_in_any_case) {
+    const Table clang{"clang", opt::clang::table(), opt::clang::prefix_index()};
+    const std::vector<std::vector<std::string>> pinned = {
+        {"/c", "/C", "/Fomain.obj", "/FOmain.obj", "/fomain.obj"},
+        {"/nologo", "/NOLOGO", "/NoLogo", "main.cc"},
+        {"/O2", "/o2", "/o", "out.exe", "/Ox"},
+        {"/Iinclude", "/iinclude", "/I", "include", "/W4", "/w4"},
+        {"/DNAME=1", "/dNAME=1", "/EHsc", "/ehsc", "/MD", "/md"},
+    };
+    for(const auto& args: pinned) {
+        EXPECT_EQ(parse_with_index(clang, args, 0xffffffffU),
+                  parse_with_table(clang, args, 0xffffffffU));
+    }
+
+    size_t checked = 0;
+    size_t mismatches = 0;
+    std::string first_mismatch;
+    for(const auto& option: clang.table.option_infos) {
+        if(std::ranges::find(option.prefixes, "/") == option.prefixes.end()) {
+            continue;
+        }
+        const auto name = option.prefixed_name.substr(option.prefixes.front().size());
+        for(bool upper: {true, false}) {
+            const auto spelling = "/" + with_case(name, upper);
+            const std::vector<std::vector<std::string>> cases = {
+                {spelling},
+                {spelling + "v"},
+                {spelling, "v", "/c"},
+            };
+            for(const auto& args: cases) {
+                ++checked;
+                if(parse_with_index(clang, args, 0xffffffffU) !=
+                   parse_with_table(clang, args, 0xffffffffU)) {
+                    if(mismatches++ == 0) {
+                        first_mismatch = args.front();
+                    }
+                }
+            }
+        }
+    }
+    EXPECT_TRUE(checked > 0);
+    EXPECT_EQ(mismatches, 0U);
+    EXPECT_EQ(first_mismatch, "");
+};
+};  // TEST_SUITE(prefix_index_tests)
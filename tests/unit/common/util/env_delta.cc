@@ -0,0 +1,104 @@
+#include "util/env_delta.h"
+
+#include <string>
+#include <vector>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+
+#include "config/ipc.h"
+
+using namespace catter;
+
+TEST_SUITE(env_delta) {
+TEST_CASE(hash_depends_on_the_order_of_entries) {
+    const std::vector<std::string> env = {"PATH=/usr/bin", "HOME=/root", "LANG=C"};
+    const std::vector<std::string> shuffled = {"LANG=C", "PATH=/usr/bin", "HOME=/root"};
+    EXPECT_TRUE(util::env_hash(env) != util::env_hash(shuffled));
+    const std::vector<std::string> fewer = {"PATH=/usr/bin", "HOME=/root"};
+    EXPECT_TRUE(util::env_hash(env) != util::env_hash(fewer));
+    EXPECT_TRUE(util::env_hash({}) != 0);
+};
+
+TEST_CASE(base_round_trips_through_the_environment) {
+    const std::vector<std::string> parent = {"PATH=/usr/bin", "HOME=/root"};
+    const auto encoded = util::encode_env_base(parent);
+    EXPECT_EQ(encoded.size(), 16U + 2 * 8U);
+
+    std::vector<std::string> env = {
+        "PATH=/usr/bin",
+        std::string(config::ipc::KEY_CATTER_ENV_BASE) + "=" + encoded,
+        "HOME=/root",
+    };
+    auto base = util::take_env_base(env);
+    ASSERT_TRUE(base.has_value());
+    EXPECT_EQ(base->hash, util::env_hash(parent));
+    EXPECT_EQ(base->fingerprints.size(), 2U);
+    EXPECT_EQ(env.size(), 2U);
+
+    EXPECT_FALSE(util::decode_env_base("").has_value());
+    EXPECT_FALSE(util::decode_env_base("0123456789abcdef012").has_value());
+    EXPECT_FALSE(util::decode_env_base("0123456789abcdeg").has_value());
+};
+
+TEST_CASE(delta_carries_only_what_changed) {
+    const std::vector<std::string> parent = {"PATH=/usr/bin", "HOME=/root", "A=1", "A=1", "B=2"};
+    const std::vector<std::string> child = {"HOME=/root", "A=1", "B=2", "PATH=/opt/bin", "C=3"};
+    auto base = util::decode_env_base(util::encode_env_base(parent));
+    ASSERT_TRUE(base.has_value());
+
+    auto delta = util::make_env_delta(*base, child);
+    EXPECT_EQ(delta.base, util::env_hash(parent));
+    EXPECT_EQ(delta.hash, util::env_hash(child));
+    EXPECT_TRUE(delta.removed == std::vector<uint32_t>({0, 3}));
+    EXPECT_TRUE(delta.added == std::vector<std::string>({"PATH=/opt/bin", "C=3"}));
+    EXPECT_TRUE(delta.added_at == std::vector<uint32_t>({3, 4}));
+
+    auto env = util::apply_env_delta(parent, delta);
+    ASSERT_TRUE(env.has_value());
+    EXPECT_TRUE(*env == child);
+
+    auto same = util::make_env_delta(*base, parent);
+    EXPECT_TRUE(same.removed.empty() && same.added.empty());
+    EXPECT_EQ(same.hash, same.base);
+};
+
+TEST_CASE(delta_keeps_order_and_duplicates) {
+    const std::vector<std::string> parent = {"A=1", "B=2", "A=1", "C=3", "D=4"};
+    const std::vector<std::vector<std::string>> children = {
+        {"A=1", "B=9", "A=1", "C=3", "D=4"},
+        {"D=4", "A=1", "B=2", "A=1", "C=3"},
+        {"B=2", "A=1", "A=1", "C=3", "D=4"},
+        {"A=1", "A=1", "B=2", "C=3", "D=4", "A=1"},
+        {"E=5", "A=1", "B=2", "C=3", "D=4", "E=5"},
+        {},
+    };
+    auto base = util::decode_env_base(util::encode_env_base(parent));
+    ASSERT_TRUE(base.has_value());
+    for(const auto& child: children) {
+        auto env = util::apply_env_delta(parent, util::make_env_delta(*base, child));
+        ASSERT_TRUE(env.has_value());
+        EXPECT_TRUE(*env == child);
+    }
+
+    // A changed entry is sent alone and goes back to where it was.
+    auto changed = util::make_env_delta(*base, children[0]);
+    EXPECT_TRUE(changed.removed == std::vector<uint32_t>({1}));
+    EXPECT_TRUE(changed.added_at == std::vector<uint32_t>({1}));
+};
+
+TEST_CASE(apply_rejects_a_delta_for_another_base) {
+    const std::vector<std::string> parent = {"PATH=/usr/bin", "HOME=/root"};
+    auto base = util::decode_env_base(util::encode_env_base(parent));
+    ASSERT_TRUE(base.has_value());
+    const std::vector<std::string> child = {"PATH=/usr/bin", "HOME=/home/u"};
+    const std::vector<std::string> other = {"PATH=/bin", "HOME=/root"};
+    auto delta = util::make_env_delta(*base, child);
+
+    EXPECT_TRUE(util::apply_env_delta(parent, delta).has_value());
+    EXPECT_FALSE(util::apply_env_delta(other, delta).has_value());
+
+    // The same entries in another order are another base.
+    const std::vector<std::string> reordered = {"HOME=/root", "PATH=/usr/bin"};
+    EXPECT_FALSE(util::apply_env_delta(reordered, delta).has_value());
+};
+};  // TEST_SUITE(env_delta)
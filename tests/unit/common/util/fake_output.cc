@@ -0,0 +1,58 @@
+#include "util/fake_output.h"
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+
+#include "util/crossplat.h"
+
+using namespace catter::util;
+
+namespace {
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+}  // namespace
+
+TEST_SUITE(fake_output) {
+TEST_CASE(objects_carry_the_host_object_magic) {
+    auto object = fake_output_bytes(".o");
+#ifdef CATTER_WINDOWS
+    EXPECT_TRUE(object.size() == 20);
+#elif defined(CATTER_MAC)
+    EXPECT_TRUE(object.starts_with("\xcf\xfa\xed\xfe"));
+#else
+    EXPECT_TRUE(object.starts_with("\x7f" "ELF"));
+#endif
+    EXPECT_TRUE(fake_output_bytes(".OBJ") == object);
+};
+
+TEST_CASE(archives_and_other_outputs) {
+    EXPECT_TRUE(fake_output_bytes(".a") == "!<arch>\n");
+    EXPECT_TRUE(fake_output_bytes(".lib") == "!<arch>\n");
+    EXPECT_TRUE(fake_output_bytes(".pch").empty());
+    EXPECT_TRUE(fake_output_bytes("").empty());
+};
+
+TEST_CASE(write_creates_parent_directories) {
+    auto root = std::filesystem::temp_directory_path() /
+                std::format("catter-fake-output-{}", get_process_id());
+    auto object = root / "nested" / "dir" / "main.o";
+    auto archive = root / "libmain.a";
+
+    write_fake_output(object);
+    write_fake_output(archive);
+
+    EXPECT_TRUE(read_file(object) == fake_output_bytes(".o"));
+    EXPECT_TRUE(read_file(archive) == "!<arch>\n");
+
+    std::filesystem::remove_all(root);
+};
+};  // TEST_SUITE(fake_output)
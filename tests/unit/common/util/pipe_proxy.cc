@@ -1,5 +1,6 @@
 #include "util/pipe_proxy.h"
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 #include <kota/zest/macro.h>
@@ -8,36 +9,88 @@
 using namespace catter::util;
 
 TEST_SUITE(pipe_proxy) {
-TEST_CASE(append_bounded_output_keeps_full_text_within_limit) {
-    std::string buffer = "hello";
-    bool truncated = false;
+TEST_CASE(tail_buffer_keeps_full_text_within_limit) {
+    TailBuffer buffer(TailBuffer::truncation_marker.size() + 32);
 
-    PipeProxy::append_bounded_output(buffer,
-                                     " world",
-                                     truncated,
-                                     PipeProxy::truncation_marker.size() + 32);
+    buffer.append("hello");
+    buffer.append(" world");
 
-    EXPECT_FALSE(truncated);
-    EXPECT_TRUE(buffer == "hello world");
+    EXPECT_FALSE(buffer.truncated());
+    EXPECT_TRUE(buffer.str() == "hello world");
 };
 
-TEST_CASE(append_bounded_output_keeps_latest_bytes_after_truncation) {
+TEST_CASE(tail_buffer_keeps_latest_bytes_after_truncation) {
     constexpr size_t payload_limit = 8;
-    const size_t limit = PipeProxy::truncation_marker.size() + payload_limit;
+    const size_t limit = TailBuffer::truncation_marker.size() + payload_limit;
 
-    std::string buffer(40, '0');
-    bool truncated = false;
+    TailBuffer buffer(limit);
+    buffer.append(std::string(40, '0'));
+    buffer.append("abcdefghij");
 
-    PipeProxy::append_bounded_output(buffer, "abcdefghij", truncated, limit);
+    EXPECT_TRUE(buffer.truncated());
+    EXPECT_TRUE(buffer.str().starts_with(TailBuffer::truncation_marker));
+    EXPECT_TRUE(buffer.str().size() == limit);
+    EXPECT_TRUE(buffer.str().substr(TailBuffer::truncation_marker.size()) == "cdefghij");
 
-    EXPECT_TRUE(truncated);
-    EXPECT_TRUE(buffer.starts_with(PipeProxy::truncation_marker));
-    EXPECT_TRUE(buffer.size() == limit);
-    EXPECT_TRUE(buffer.substr(PipeProxy::truncation_marker.size()) == "cdefghij");
+    buffer.append("KLMN");
 
-    PipeProxy::append_bounded_output(buffer, "KLMN", truncated, limit);
+    EXPECT_TRUE(buffer.str().starts_with(TailBuffer::truncation_marker));
+    EXPECT_TRUE(buffer.str().substr(TailBuffer::truncation_marker.size()) == "ghijKLMN");
+};
+
+TEST_CASE(tail_buffer_wraps_chunks_larger_than_limit) {
+    TailBuffer buffer(TailBuffer::truncation_marker.size() + 4);
+
+    buffer.append("0123456789");
+    buffer.append(std::string(60, 'x') + "abcd");
+
+    EXPECT_TRUE(buffer.str().substr(TailBuffer::truncation_marker.size()) == "abcd");
+
+    buffer.append("efg");
+
+    EXPECT_TRUE(buffer.str().substr(TailBuffer::truncation_marker.size()) == "defg");
+};
+
+TEST_CASE(tail_buffer_limit_shorter_than_marker) {
+    TailBuffer buffer(4);
+
+    buffer.append("abcdef");
+
+    EXPECT_TRUE(buffer.str() == TailBuffer::truncation_marker.substr(0, 4));
+};
+
+TEST_CASE(tail_buffer_never_truncates_when_unlimited) {
+    TailBuffer buffer(PipeProxy::unlimited);
+
+    const std::string chunk(PipeProxy::output_limit, 'x');
+    buffer.append(chunk);
+    buffer.append(chunk);
+
+    EXPECT_FALSE(buffer.truncated());
+    EXPECT_TRUE(buffer.str().size() == 2 * PipeProxy::output_limit);
+};
+
+TEST_CASE(tail_buffer_keeps_tail_of_long_streams) {
+    // Many pipe-sized chunks wrap the ring several times, only the last ones must remain.
+    constexpr size_t stream_size = 16 * PipeProxy::output_limit;
+    constexpr size_t chunk_size = 4096;
+
+    std::string chunk(chunk_size, '\0');
+    for(size_t i = 0; i < chunk.size(); ++i) {
+        chunk[i] = static_cast<char>('a' + i % 26);
+    }
+
+    TailBuffer buffer(PipeProxy::output_limit);
+    for(size_t written = 0; written < stream_size; written += chunk_size) {
+        buffer.append(chunk);
+    }
+    const auto output = buffer.str();
 
-    EXPECT_TRUE(buffer.starts_with(PipeProxy::truncation_marker));
-    EXPECT_TRUE(buffer.substr(PipeProxy::truncation_marker.size()) == "ghijKLMN");
+    const size_t payload = PipeProxy::output_limit - TailBuffer::truncation_marker.size();
+    EXPECT_TRUE(output.size() == PipeProxy::output_limit);
+    EXPECT_TRUE(std::string_view(output).ends_with(chunk));
+    EXPECT_TRUE(std::string_view(output)
+                    .substr(TailBuffer::truncation_marker.size())
+                    .starts_with(std::string_view(chunk).substr(chunk_size - payload % chunk_size)));
 };
 };  // TEST_SUITE(pipe_proxy)
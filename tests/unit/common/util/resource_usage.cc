@@ -0,0 +1,75 @@
+#include "util/resource_usage.h"
+
+#include <string>
+#include <vector>
+#include <kota/async/async.h>
+#include <kota/zest/macro.h>
+#include <kota/zest/zest.h>
+
+#include "util/kotatsu.h"
+
+using namespace catter;
+
+namespace {
+
+data::process_result run_child(std::string file, std::vector<std::string> args) {
+    kota::process::options opts{
+        .file = file,
+        .args = std::move(args),
+        .streams = {kota::process::stdio::inherit(),
+                     output_stdio(data::CaptureMode::NONE),
+                     output_stdio(data::CaptureMode::NONE)}
+    };
+    auto task = capture_process_result(make_process_event(opts),
+                                       stdout,
+                                       stderr,
+                                       {.mode = data::CaptureMode::NONE});
+    kota::event_loop loop;
+    loop.schedule(task);
+    loop.run();
+    return task.result();
+}
+
+}  // namespace
+
+TEST_SUITE(resource_usage) {
+TEST_CASE(meter_without_children_measures_time_only) {
+    const util::UsageMeter meter;
+    auto usage = meter.finish();
+
+    EXPECT_TRUE(usage.start != 0);
+    EXPECT_TRUE(usage.end >= usage.start);
+};
+
+#ifndef CATTER_WINDOWS
+TEST_CASE(captured_child_reports_its_usage) {
+    auto result = run_child(
+        "/bin/sh",
+        {"/bin/sh", "-c", "i=0; while [ $i -lt 20000 ]; do i=$((i + 1)); done; exit 3"});
+
+    EXPECT_TRUE(result.code == 3);
+    EXPECT_TRUE(result.usage.start != 0);
+    EXPECT_TRUE(result.usage.end > result.usage.start);
+    EXPECT_TRUE(result.usage.rusage);
+    EXPECT_TRUE(result.usage.user_us + result.usage.system_us > 0);
+    EXPECT_TRUE(result.usage.max_rss_kib > 0);
+};
+
+TEST_CASE(overlapping_meters_report_time_only) {
+    {
+        const util::UsageMeter outer;
+        auto result = run_child("/bin/sh", {"/bin/sh", "-c", "exit 0"});
+        EXPECT_FALSE(result.usage.rusage);
+        EXPECT_TRUE(result.usage.end > result.usage.start);
+
+        auto usage = outer.finish();
+        EXPECT_FALSE(usage.rusage);
+        EXPECT_TRUE(usage.end >= usage.start);
+    }
+
+    // Alone again once the outer meter is gone.
+    auto result = run_child("/bin/sh", {"/bin/sh", "-c", "exit 0"});
+    EXPECT_TRUE(result.usage.rusage);
+};
+#endif
+};  // TEST_SUITE(resource_usage)
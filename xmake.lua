@@ -8,6 +8,9 @@ set_languages("c++23")
 
 option("dev", {default = true})
 option("test", {default = false})
+-- Embed the builtin modules and scripts as QuickJS bytecode (compiled by
+-- catter-jsc) instead of source, so they are not parsed on every start.
+option("js-bytecode", {default = true})
 
 local prefix_includedirs = {}
 
@@ -157,15 +160,30 @@ target("catter-js-types")
         }
     })
 
+target("catter-jsc")
+    set_kind("binary")
+    set_default(false)
+    -- Host tool used by pack.js to compile each builtin module to bytecode.
+    -- pack.js runs it from before_build, so the targets depending on it must
+    -- wait until it is linked; the fence orders only those targets and leaves
+    -- the rest of the build parallel.
+    set_policy("build.fence", true)
+    add_packages("quickjs-ng")
+    add_files("src/catter-jsc/main.cc")
+
 target("catter-js-runtime")
     set_kind("object")
     set_default(false)
     -- One target hosts the whole builtin JS pipeline:
     --  1. build.js (before_build) runs rollup to emit per-module bundles + manifest.json
-    --  2. pack.js (before_build, ordered after build.js) packs them into jslib.bin
+    --  2. pack.js (before_build, ordered after build.js) packs them into jslib.bin,
+    --     compiling every module with catter-jsc when js-bytecode is enabled
     --  3. utils.bin2obj (default build) embeds the blob into one object file
     -- The before_build scripts run before the target's default build, so the
     -- blob always exists when the file-level bin2obj rule processes it.
+    if has_config("js-bytecode") then
+        add_deps("catter-jsc")
+    end
     add_rules("build.js", {
         js_script = "build:runtime",
         js_inputs = {
@@ -214,6 +232,9 @@ target("catter-js-scripts")
     set_default(false)
     -- Builds the builtin service scripts (scripts/) and embeds them as one
     add_deps("catter-js-runtime")
+    if has_config("js-bytecode") then
+        add_deps("catter-jsc")
+    end
     add_rules("build.js", {
         js_dir = "scripts",
         js_script = "build",
@@ -292,6 +313,10 @@ target("catter-hook-unix")
 
     if is_mode("debug") then
         add_deps("common")
+    else
+        -- The span recorder depends on nothing but the standard library.
+        add_includedirs("src/common")
+        add_files("src/common/util/span_trace.cc")
     end
 
     add_cxxflags("-fvisibility=hidden")
@@ -433,6 +458,66 @@ target("it-catter-replay")
     add_files("tests/integration/replay/catter-replay.cc")
     add_deps("common", "catter-core")
 
+target("bench-ipc-latency")
+    set_default(false)
+    set_kind("binary")
+    add_local_prefix_includedirs()
+    add_includedirs("src/")
+    add_files("tests/benchmark/ipc-latency.cc")
+    add_deps("common", "catter-core")
+
+target("bench-js-startup")
+    set_default(false)
+    set_kind("binary")
+    add_local_prefix_includedirs()
+    add_includedirs("src/")
+    add_files("tests/benchmark/js-startup.cc")
+    add_deps("common", "catter-core")
+    add_defines(format([[JS_DIST_PATH="%s"]], path.unix(path.join(os.projectdir(), "api/dist/"))))
+
+target("bench-on-command")
+    set_default(false)
+    set_kind("binary")
+    add_local_prefix_includedirs()
+    add_includedirs("src/")
+    add_files("tests/benchmark/on-command.cc")
+    add_deps("common", "catter-core")
+
+target("bench-option-parse")
+    set_default(false)
+    set_kind("binary")
+    add_local_prefix_includedirs()
+    add_includedirs("src/")
+    add_files("tests/benchmark/option-parse.cc")
+    add_deps("common", "catter-core")
+
+target("bench-option-tables")
+    set_default(false)
+    set_kind("binary")
+    add_local_prefix_includedirs()
+    add_files("tests/benchmark/option-tables.cc")
+    add_deps("common")
+
+target("bench-replay-memory")
+    set_default(false)
+    set_kind("binary")
+    add_local_prefix_includedirs()
+    add_includedirs("src/")
+    add_files("tests/benchmark/replay-memory.cc")
+    add_deps("common", "catter-core")
+
+target("bench-session-soak")
+    set_default(false)
+    set_kind("binary")
+    add_local_prefix_includedirs()
+    add_includedirs("src/")
+    add_files("tests/benchmark/session-soak.cc")
+    -- Runs the build through the real inject runtime, so the proxy and the hook come along.
+    add_deps("common", "catter-core", "catter-proxy")
+    if is_plat("linux", "macosx") then
+        add_deps("catter-hook-unix")
+    end
+
 -- rule("build.js"): runs a JS toolchain build (pnpm script in api/dev/) and
 -- tracks the inputs/outputs for change detection. It hooks into before_build,
 -- so the produced artifacts are ready before the target's default build (e.g.
@@ -507,27 +592,33 @@ rule("build.js")
 -- the JS bundles are produced; utils.bin2obj then embeds the blob during the
 -- target's default build.
 --
--- Blob layout (little-endian): u32 count, then per module:
+-- Blob layout (little-endian): u32 count, u32 flags, then per module:
 --   u32 name_len, name, u32 content_len, content, NUL.
 -- The trailing NUL keeps each content view NUL-terminated in memory, which
 -- QuickJS's tokenizer relies on to detect end of input. This is the
 -- (mod_name, mod_content) array consumed by EsmModuleLoader.
+-- Flags bit 0 is set when js-bytecode is enabled: every content is then the
+-- module bytecode written by catter-jsc (JS_WriteObject) instead of source.
 --
 -- Parameters (set via add_rules("pack.js", { ... })):
 --   pack_manifest  manifest JSON (specifier -> file) listing the module files.
 --   pack_output    the packed blob file to produce (e.g. api/output/lib/jslib.bin).
 --
--- Change detection: repack only when the manifest or any listed module file
--- changed, or when the blob file is missing.
+-- Change detection: repack only when the manifest, any listed module file or
+-- catter-jsc changed, when js-bytecode was toggled, or when the blob file is
+-- missing.
 rule("pack.js")
     add_orders("build.js", "pack.js")
     before_build(function (target, opt)
         import("core.project.depend")
+        import("core.project.config")
         import("core.base.json")
         import("utils.progress")
 
         local pack_manifest = target:extraconf("rules", "pack.js", "pack_manifest")
         local pack_output = target:extraconf("rules", "pack.js", "pack_output")
+        local jsc = config.get("js-bytecode") and target:dep("catter-jsc")
+        local jsc_program = jsc and jsc:targetfile()
 
         local stampfile = target:autogenfile(path.join("rules", "pack.js", target:name() .. ".stamp"))
         os.mkdir(path.directory(stampfile))
@@ -554,10 +645,23 @@ rule("pack.js")
             end
             table.sort(names)
 
+            local function module_content(name)
+                local source_path = path.join(path.directory(manifest_path), modules[name])
+                if not jsc_program then
+                    return read_all(source_path)
+                end
+                local file_name = name:gsub("[/:]", "_") .. ".qjsbc"
+                local bytecode_path = target:autogenfile(path.join("rules", "pack.js", file_name))
+                os.mkdir(path.directory(bytecode_path))
+                os.vrunv(jsc_program, {source_path, name, bytecode_path})
+                return read_all(bytecode_path)
+            end
+
             local out = assert(io.open(output_path, "wb"), "cannot open " .. output_path)
             out:write(string.pack("<I4", #names))
+            out:write(string.pack("<I4", jsc_program and 1 or 0))
             for _, name in ipairs(names) do
-                local content = read_all(path.join(path.directory(manifest_path), modules[name]))
+                local content = module_content(name)
                 out:write(string.pack("<I4", #name))
                 out:write(name)
                 out:write(string.pack("<I4", #content))
@@ -573,6 +677,9 @@ rule("pack.js")
         for _, file in pairs(manifest.modules) do
             table.insert(inputfiles, path.join(path.directory(pack_manifest), file))
         end
+        if jsc_program then
+            table.insert(inputfiles, jsc_program)
+        end
         table.sort(inputfiles)
 
         depend.on_changed(function()
@@ -581,7 +688,7 @@ rule("pack.js")
             io.writefile(stampfile, os.date("%Y-%m-%dT%H:%M:%S"))
         end, {
             files = inputfiles,
-            values = {pack_manifest, pack_output},
+            values = {pack_manifest, pack_output, jsc_program and "bytecode" or "source"},
             dependfile = target:dependfile(stampfile),
             changed = target:is_rebuilt()
                 or not os.isfile(stampfile)